@@ -0,0 +1,145 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+/******************************************************************************
+ * File Name: test_ans.h
+ *
+ * Description: Unit test setup of the ANS library. Included once by every
+ *              library test, it builds the library into the test so that the
+ *              test can check the library control block directly.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+#ifndef _TEST_ANS_H_
+#define _TEST_ANS_H_
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include "test_stubs.h"
+
+/* the library reads CLOCK_MONOTONIC, the tests move the clock by hand */
+#define clock_gettime test_stubs_clock_gettime
+#include "wiced_bt_ans.c"
+#undef clock_gettime
+
+/*******************************************************************************
+ *                                   MACROS
+ *******************************************************************************/
+/* Every alert category */
+#define TEST_ANS_ALL_CATEGORIES ( (1 << ANP_NOTIFY_CATEGORY_COUNT) - 1 )
+
+/*******************************************************************************
+ *                           GLOBAL VARIABLES
+ *******************************************************************************/
+static wiced_bt_ans_gatt_handles_t test_ans_handles =
+{
+    .new_alert = {.supported_category = 0x09, .value = 0x0B, .configuration = 0x0C},
+    .unread_alert = {.supported_category = 0x0E, .value = 0x10, .configuration = 0x11},
+    .notification_control = 0x13,
+};
+
+/*******************************************************************************
+ *                       FUNCTION DEFINITIONS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * Function Name : test_ans_init
+ * *****************************************************************************
+ * Summary :
+ *    Start the library over with every category supported
+ *
+ * Parameters:
+ *    tx_credits:     notifications the library may have in flight
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static inline void test_ans_init(uint8_t tx_credits)
+{
+    test_stubs_reset();
+    TEST_ASSERT(wiced_bt_ans_init(&test_ans_handles) == WICED_BT_SUCCESS);
+    wiced_bt_ans_set_tx_credits(tx_credits);
+    wiced_bt_ans_set_supported_new_alert_categories(0, TEST_ANS_ALL_CATEGORIES);
+    wiced_bt_ans_set_supported_unread_alert_categories(0, TEST_ANS_ALL_CATEGORIES);
+}
+
+/*******************************************************************************
+ * Function Name : test_ans_write
+ * *****************************************************************************
+ * Summary :
+ *    Write a two byte value as a client
+ *
+ * Parameters:
+ *    conn_id:    bearer of the client
+ *    handle:     attribute handle
+ *    byte0:      first byte of the value
+ *    byte1:      second byte of the value
+ *
+ * Return:
+ *    wiced_bt_gatt_status_t: result of the write
+ ******************************************************************************/
+static inline wiced_bt_gatt_status_t test_ans_write(uint16_t conn_id, uint16_t handle, uint8_t byte0, uint8_t byte1)
+{
+    uint8_t value[2] = {byte0, byte1};
+    wiced_bt_gatt_write_req_t write = {.handle = handle, .offset = 0, .p_val = value, .val_len = sizeof(value)};
+
+    return wiced_bt_ans_process_gatt_write_req(conn_id, &write);
+}
+
+/*******************************************************************************
+ * Function Name : test_ans_connect
+ * *****************************************************************************
+ * Summary :
+ *    Connect a client that enables both notifications for every category
+ *
+ * Parameters:
+ *    conn_id:    connection of the client
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static inline void test_ans_connect(uint16_t conn_id)
+{
+    wiced_bt_ans_connection_up(conn_id);
+    TEST_ASSERT(test_ans_write(conn_id, test_ans_handles.new_alert.configuration, 1, 0) == WICED_BT_GATT_SUCCESS);
+    TEST_ASSERT(test_ans_write(conn_id, test_ans_handles.unread_alert.configuration, 1, 0) == WICED_BT_GATT_SUCCESS);
+    TEST_ASSERT(test_ans_write(conn_id, test_ans_handles.notification_control,
+                               ANP_ALERT_CONTROL_CMD_ENABLE_NEW_ALERTS,
+                               ANP_ALERT_CATEGORY_ID_ALL_CONFIGURED) == WICED_BT_GATT_SUCCESS);
+    TEST_ASSERT(test_ans_write(conn_id, test_ans_handles.notification_control,
+                               ANP_ALERT_CONTROL_CMD_ENABLE_UNREAD_STATUS,
+                               ANP_ALERT_CATEGORY_ID_ALL_CONFIGURED) == WICED_BT_GATT_SUCCESS);
+}
+
+#endif /* _TEST_ANS_H_ */
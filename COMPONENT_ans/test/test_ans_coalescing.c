@@ -0,0 +1,154 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+/******************************************************************************
+ * File Name: test_ans_coalescing.c
+ *
+ * Description:
+ * Unit tests of the coalescing windows of the ANS library, which hold the
+ * alerts of a category back and send their final count once the window ends.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include "test_ans.h"
+
+/*******************************************************************************
+ *                                   MACROS
+ *******************************************************************************/
+#define TEST_CONN_ID 5
+
+/*******************************************************************************
+ *                       FUNCTION DEFINITIONS
+ *******************************************************************************/
+
+/* Count of the last notification of a characteristic, -1 if none was sent */
+static int test_coalescing_last_count(uint16_t handle, uint8_t category_id)
+{
+    uint32_t n;
+
+    for (n = test_stubs.ntf_count; n-- != 0;)
+    {
+        const test_stubs_ntf_t *p_ntf = test_stubs_ntf(n);
+
+        if ((p_ntf->handle == handle) && (p_ntf->value[0] == category_id))
+            return p_ntf->value[1];
+    }
+    return -1;
+}
+
+/* A burst goes out as one count when the window ends, windows ending within a connection event join it */
+static void test_coalescing_window(void)
+{
+    uint8_t i;
+
+    test_ans_init(250);
+    TEST_ASSERT(wiced_bt_ans_set_coalescing_window(ANP_ALERT_CATEGORY_ID_EMAIL, 20, WICED_FALSE));
+    TEST_ASSERT(wiced_bt_ans_set_coalescing_window(ANP_ALERT_CATEGORY_ID_SMS_OR_MMS, 10, WICED_TRUE));
+    TEST_ASSERT(!wiced_bt_ans_set_coalescing_window(ANP_NOTIFY_CATEGORY_COUNT, 10, WICED_FALSE));
+    test_ans_connect(TEST_CONN_ID);
+
+    for (i = 0; i < 50; i++)
+    {
+        wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_EMAIL);
+        wiced_bt_ans_process_and_send_unread_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_EMAIL);
+    }
+    TEST_ASSERT(test_stubs.ntf_count == 0);
+    TEST_ASSERT(test_stubs.timer_running && (test_stubs.timer_timeout == 20));
+
+    /* a category without a window is not held */
+    wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_CALL);
+    TEST_ASSERT(test_stubs.ntf_count == 1);
+
+    /* 10 ms rounded up to a 30 ms connection interval, ends 10 ms after the email window */
+    wiced_bt_ans_set_conn_interval(TEST_CONN_ID, 24);
+    wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_SMS_OR_MMS);
+
+    TEST_ASSERT(test_stubs.timer_running && (test_stubs.timer_timeout == 20));
+
+    test_stubs_advance_ms(20);
+    test_stubs_timer_fire();
+    TEST_ASSERT(test_stubs.ntf_count == 4);
+    TEST_ASSERT(test_coalescing_last_count(test_ans_handles.new_alert.value, ANP_ALERT_CATEGORY_ID_EMAIL) == 50);
+    TEST_ASSERT(test_coalescing_last_count(test_ans_handles.unread_alert.value, ANP_ALERT_CATEGORY_ID_EMAIL) == 50);
+    TEST_ASSERT(test_coalescing_last_count(test_ans_handles.new_alert.value, ANP_ALERT_CATEGORY_ID_SMS_OR_MMS) == 1);
+    TEST_ASSERT(!test_stubs.timer_running);
+    test_stubs_transmit(UINT32_MAX);
+}
+
+/* Notify immediately, a clear and disabling the window end a window early */
+static void test_coalescing_window_end(void)
+{
+    uint16_t i;
+
+    test_ans_init(250);
+    wiced_bt_ans_set_coalescing_window(ANP_ALERT_CATEGORY_ID_EMAIL, 20, WICED_FALSE);
+    test_ans_connect(TEST_CONN_ID);
+
+    wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_EMAIL);
+    TEST_ASSERT(test_stubs.ntf_count == 0);
+    test_ans_write(TEST_CONN_ID, test_ans_handles.notification_control,
+                   ANP_ALERT_CONTROL_CMD_NOTIFY_NEW_ALERTS_IMMEDIATE, ANP_ALERT_CATEGORY_ID_EMAIL);
+    TEST_ASSERT(test_stubs.ntf_count == 1);
+    TEST_ASSERT(test_coalescing_last_count(test_ans_handles.new_alert.value, ANP_ALERT_CATEGORY_ID_EMAIL) == 1);
+    test_stubs_advance_ms(20);
+    test_stubs_timer_fire();
+    TEST_ASSERT((test_stubs.ntf_count == 1) && !test_stubs.timer_running);
+
+    wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_EMAIL);
+    TEST_ASSERT(test_stubs.timer_running);
+    wiced_bt_ans_clear_alerts_all(ANP_ALERT_CATEGORY_ID_EMAIL);
+    TEST_ASSERT(!test_stubs.timer_running);
+
+    wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_EMAIL);
+    wiced_bt_ans_set_coalescing_window(ANP_ALERT_CATEGORY_ID_EMAIL, 0, WICED_FALSE);
+    TEST_ASSERT(test_stubs.ntf_count == 2);
+    TEST_ASSERT(test_coalescing_last_count(test_ans_handles.new_alert.value, ANP_ALERT_CATEGORY_ID_EMAIL) == 1);
+
+    /* the count saturates while held */
+    wiced_bt_ans_set_coalescing_window(ANP_ALERT_CATEGORY_ID_NEWS, 1000, WICED_FALSE);
+    for (i = 0; i < 300; i++)
+        wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_NEWS);
+    test_stubs_advance_ms(1000);
+    test_stubs_timer_fire();
+    TEST_ASSERT(test_coalescing_last_count(test_ans_handles.new_alert.value, ANP_ALERT_CATEGORY_ID_NEWS) == 0xFF);
+}
+
+int main(void)
+{
+    test_coalescing_window();
+    test_coalescing_window_end();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,242 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+/******************************************************************************
+ * File Name: test_ans_conn_index.c
+ *
+ * Description:
+ * Unit tests of the conn_id index of the ANS library, the open addressed
+ * hash that finds the control block of a connection from the conn_id of any
+ * of its ATT bearers.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include "test_ans.h"
+
+/*******************************************************************************
+ *                                   MACROS
+ *******************************************************************************/
+/* conn_ids sharing home slot 1 of the index */
+#define TEST_CONN_ID(n) ( (uint16_t)(1 + (n) * ANS_LIB_CONN_INDEX_SIZE) )
+
+#define TEST_CHURN_ROUNDS 20000
+
+/*******************************************************************************
+ *                       FUNCTION DEFINITIONS
+ *******************************************************************************/
+
+/* Every entry is reachable from its home slot without crossing a free slot, and there are num_entries */
+static void test_conn_index_check(uint8_t num_entries)
+{
+    uint8_t entries = 0;
+    uint8_t pos;
+    uint8_t probe;
+
+    for (pos = 0; pos < ANS_LIB_CONN_INDEX_SIZE; pos++)
+    {
+        if (ans_lib_cb.conn_index[pos].idx == ANS_LIB_CONN_INDEX_FREE)
+            continue;
+
+        entries++;
+        for (probe = ans_lib_cb.conn_index[pos].conn_id & ANS_LIB_CONN_INDEX_MASK; probe != pos;
+             probe = (probe + 1) & ANS_LIB_CONN_INDEX_MASK)
+        {
+            TEST_ASSERT(ans_lib_cb.conn_index[probe].idx != ANS_LIB_CONN_INDEX_FREE);
+        }
+    }
+    TEST_ASSERT(entries == num_entries);
+}
+
+/* Removing an entry in the middle of a probe sequence keeps the entries after it reachable */
+static void test_conn_index_backward_shift(void)
+{
+    uint8_t n;
+
+    test_ans_init(WICED_BT_ANS_TX_CREDITS);
+
+    for (n = 0; n < WICED_BT_ANS_MAX_CONNECTIONS; n++)
+        wiced_bt_ans_connection_up(TEST_CONN_ID(n));
+    test_conn_index_check(WICED_BT_ANS_MAX_CONNECTIONS);
+
+    /* no control block left */
+    wiced_bt_ans_connection_up(TEST_CONN_ID(n));
+    TEST_ASSERT(ans_lib_find_conn_cb(TEST_CONN_ID(n)) == NULL);
+
+    wiced_bt_ans_connection_down(TEST_CONN_ID(1));
+    test_conn_index_check(WICED_BT_ANS_MAX_CONNECTIONS - 1);
+    TEST_ASSERT(ans_lib_find_conn_cb(TEST_CONN_ID(1)) == NULL);
+    for (n = 0; n < WICED_BT_ANS_MAX_CONNECTIONS; n++)
+    {
+        if (n != 1)
+            TEST_ASSERT(ans_lib_find_conn_cb(TEST_CONN_ID(n))->conn_id == TEST_CONN_ID(n));
+    }
+
+    /* an entry at the end of the table wraps to the start */
+    wiced_bt_ans_connection_up(ANS_LIB_CONN_INDEX_SIZE - 1);
+    wiced_bt_ans_connection_down(TEST_CONN_ID(0));
+    wiced_bt_ans_connection_down(TEST_CONN_ID(2));
+    wiced_bt_ans_connection_up(2 * ANS_LIB_CONN_INDEX_SIZE - 1);
+    test_conn_index_check(3);
+    TEST_ASSERT(ans_lib_find_conn_cb(2 * ANS_LIB_CONN_INDEX_SIZE - 1) != NULL);
+    wiced_bt_ans_connection_down(ANS_LIB_CONN_INDEX_SIZE - 1);
+    test_conn_index_check(2);
+    TEST_ASSERT(ans_lib_find_conn_cb(2 * ANS_LIB_CONN_INDEX_SIZE - 1) != NULL);
+    TEST_ASSERT(ans_lib_find_conn_cb(TEST_CONN_ID(3)) != NULL);
+}
+
+/* The conn_id of an Enhanced ATT bearer finds its connection until the bearer or the connection goes down */
+static void test_conn_index_bearers(void)
+{
+    ans_lib_conn_cb_t *p_conn;
+
+    test_ans_init(WICED_BT_ANS_TX_CREDITS);
+
+    wiced_bt_ans_connection_up(TEST_CONN_ID(0));
+    wiced_bt_ans_connection_up(TEST_CONN_ID(1));
+    p_conn = ans_lib_find_conn_cb(TEST_CONN_ID(0));
+
+    TEST_ASSERT(wiced_bt_ans_bearer_up(TEST_CONN_ID(0), TEST_CONN_ID(2), 64));
+    TEST_ASSERT(wiced_bt_ans_bearer_up(TEST_CONN_ID(0), TEST_CONN_ID(3), 64));
+    TEST_ASSERT(wiced_bt_ans_bearer_up(TEST_CONN_ID(0), TEST_CONN_ID(4), 64));
+    TEST_ASSERT(!wiced_bt_ans_bearer_up(TEST_CONN_ID(0), TEST_CONN_ID(5), 64));
+    TEST_ASSERT(!wiced_bt_ans_bearer_up(TEST_CONN_ID(6), TEST_CONN_ID(7), 64));
+    test_conn_index_check(5);
+
+    TEST_ASSERT(ans_lib_find_conn_cb(TEST_CONN_ID(3)) == p_conn);
+    TEST_ASSERT(ans_lib_find_conn_cb(TEST_CONN_ID(5)) == NULL);
+
+    /* a bearer reported twice is indexed once */
+    TEST_ASSERT(wiced_bt_ans_bearer_up(TEST_CONN_ID(0), TEST_CONN_ID(3), 64));
+    test_conn_index_check(5);
+
+    wiced_bt_ans_bearer_down(TEST_CONN_ID(2));
+    test_conn_index_check(4);
+    TEST_ASSERT(ans_lib_find_conn_cb(TEST_CONN_ID(2)) == NULL);
+    TEST_ASSERT(ans_lib_find_conn_cb(TEST_CONN_ID(4)) == p_conn);
+
+    /* the connection takes its remaining bearers with it */
+    wiced_bt_ans_connection_down(TEST_CONN_ID(0));
+    test_conn_index_check(1);
+    TEST_ASSERT(ans_lib_find_conn_cb(TEST_CONN_ID(3)) == NULL);
+    TEST_ASSERT(ans_lib_find_conn_cb(TEST_CONN_ID(4)) == NULL);
+    TEST_ASSERT(ans_lib_find_conn_cb(TEST_CONN_ID(1))->conn_id == TEST_CONN_ID(1));
+}
+
+/* Random connections and bearers going up and down, all colliding on few home slots, against a model */
+static void test_conn_index_churn(void)
+{
+    uint16_t conn_id[WICED_BT_ANS_MAX_CONNECTIONS];
+    uint16_t bearer_id[WICED_BT_ANS_MAX_CONNECTIONS][WICED_BT_ANS_MAX_EATT_BEARERS];
+    wiced_bool_t conn_up[WICED_BT_ANS_MAX_CONNECTIONS] = {0};
+    wiced_bool_t bearer_up[WICED_BT_ANS_MAX_CONNECTIONS][WICED_BT_ANS_MAX_EATT_BEARERS] = {{0}};
+    uint8_t entries = 0;
+    uint32_t round;
+    uint8_t c;
+    uint8_t b;
+
+    test_ans_init(WICED_BT_ANS_TX_CREDITS);
+    srand(1);
+
+    for (c = 0; c < WICED_BT_ANS_MAX_CONNECTIONS; c++)
+    {
+        conn_id[c] = (uint16_t)(1 + c * ANS_LIB_CONN_INDEX_SIZE + (c & 1));
+        for (b = 0; b < WICED_BT_ANS_MAX_EATT_BEARERS; b++)
+            bearer_id[c][b] = (uint16_t)(conn_id[c] + (b + 1) * WICED_BT_ANS_MAX_CONNECTIONS * ANS_LIB_CONN_INDEX_SIZE);
+    }
+
+    for (round = 0; round < TEST_CHURN_ROUNDS; round++)
+    {
+        c = (uint8_t)(rand() % WICED_BT_ANS_MAX_CONNECTIONS);
+        b = (uint8_t)(rand() % WICED_BT_ANS_MAX_EATT_BEARERS);
+
+        switch (rand() % 3)
+        {
+        case 0:
+            if (!conn_up[c])
+            {
+                wiced_bt_ans_connection_up(conn_id[c]);
+                conn_up[c] = WICED_TRUE;
+                entries++;
+                break;
+            }
+            wiced_bt_ans_connection_down(conn_id[c]);
+            conn_up[c] = WICED_FALSE;
+            entries--;
+            for (b = 0; b < WICED_BT_ANS_MAX_EATT_BEARERS; b++)
+            {
+                entries -= bearer_up[c][b];
+                bearer_up[c][b] = WICED_FALSE;
+            }
+            break;
+        case 1:
+            if (conn_up[c] && !bearer_up[c][b])
+            {
+                TEST_ASSERT(wiced_bt_ans_bearer_up(conn_id[c], bearer_id[c][b], 64));
+                bearer_up[c][b] = WICED_TRUE;
+                entries++;
+            }
+            break;
+        default:
+            /* a bearer going down is reported like a connection going down */
+            if (bearer_up[c][b])
+            {
+                wiced_bt_ans_connection_down(bearer_id[c][b]);
+                bearer_up[c][b] = WICED_FALSE;
+                entries--;
+            }
+            break;
+        }
+
+        test_conn_index_check(entries);
+        for (c = 0; c < WICED_BT_ANS_MAX_CONNECTIONS; c++)
+        {
+            ans_lib_conn_cb_t *p_conn = ans_lib_find_conn_cb(conn_id[c]);
+
+            TEST_ASSERT((p_conn != NULL) == conn_up[c]);
+            for (b = 0; b < WICED_BT_ANS_MAX_EATT_BEARERS; b++)
+                TEST_ASSERT(bearer_up[c][b] ? (ans_lib_find_conn_cb(bearer_id[c][b]) == p_conn) :
+                                              (ans_lib_find_conn_cb(bearer_id[c][b]) == NULL));
+        }
+    }
+}
+
+int main(void)
+{
+    test_conn_index_backward_shift();
+    test_conn_index_bearers();
+    test_conn_index_churn();
+    return EXIT_SUCCESS;
+}
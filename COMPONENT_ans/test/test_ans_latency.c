@@ -0,0 +1,175 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+/******************************************************************************
+ * File Name: test_ans_latency.c
+ *
+ * Description:
+ * Unit tests of the alert latency histograms of the ANS library: the bucket
+ * of a latency and its bounds, the percentiles, and the stages recorded for
+ * alerts against the fake clock.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include "test_ans.h"
+
+/*******************************************************************************
+ *                                   MACROS
+ *******************************************************************************/
+#define TEST_CONN_ID 5
+
+/*******************************************************************************
+ *                       FUNCTION DEFINITIONS
+ *******************************************************************************/
+
+/* Bucket bounds: exact below 16 us, then at most 1/8 of the latency wide */
+static void test_latency_buckets(void)
+{
+    uint64_t low;
+    uint64_t high;
+    uint64_t us;
+    uint16_t idx;
+
+    for (us = 0; us < 2 * ANS_LIB_LAT_SUB_COUNT; us++)
+    {
+        TEST_ASSERT(ans_lib_latency_bucket(us) == us);
+        TEST_ASSERT(ans_lib_latency_bucket_max((uint16_t)us) == us);
+    }
+
+    for (idx = 2 * ANS_LIB_LAT_SUB_COUNT; idx < ANS_LIB_LAT_BUCKETS; idx++)
+    {
+        low = ans_lib_latency_bucket_max(idx - 1) + 1;
+        high = ans_lib_latency_bucket_max(idx);
+        TEST_ASSERT(high >= low);
+        TEST_ASSERT((high - low + 1) <= (low / ANS_LIB_LAT_SUB_COUNT));
+        TEST_ASSERT(ans_lib_latency_bucket(low) == idx);
+        TEST_ASSERT(ans_lib_latency_bucket(high) == idx);
+    }
+
+    /* latencies past the last bucket are clamped into it */
+    high = ans_lib_latency_bucket_max(ANS_LIB_LAT_BUCKETS - 1);
+    TEST_ASSERT(ans_lib_latency_bucket(high + 1) == ANS_LIB_LAT_BUCKETS - 1);
+    TEST_ASSERT(ans_lib_latency_bucket(UINT64_MAX) == ANS_LIB_LAT_BUCKETS - 1);
+
+    /* monotonic over a spread of latencies */
+    for (us = 1, idx = 0; us < (1ULL << 40); us = us * 3 / 2 + 1)
+    {
+        TEST_ASSERT(ans_lib_latency_bucket(us) >= idx);
+        idx = ans_lib_latency_bucket(us);
+    }
+}
+
+/* Percentiles of recorded latencies */
+static void test_latency_percentiles(void)
+{
+    wiced_bt_ans_latency_t latency;
+    uint32_t i;
+
+    test_ans_init(4);
+
+    for (i = 1; i <= 1000; i++)
+        ans_lib_latency_record(WICED_BT_ANS_LATENCY_TOTAL, ANP_ALERT_CATEGORY_ID_CALL, 1000000, 1000000 + i * 100);
+    ans_lib_latency_record(WICED_BT_ANS_LATENCY_TOTAL, ANP_ALERT_CATEGORY_ID_CALL, 1000000, 1000000 + 5000000);
+
+    /* a start that was not stamped and a clock going back are ignored */
+    ans_lib_latency_record(WICED_BT_ANS_LATENCY_TOTAL, ANP_ALERT_CATEGORY_ID_CALL, 0, 1000000);
+    ans_lib_latency_record(WICED_BT_ANS_LATENCY_TOTAL, ANP_ALERT_CATEGORY_ID_CALL, 1000000, 999999);
+
+    TEST_ASSERT(wiced_bt_ans_get_latency(ANP_ALERT_CATEGORY_ID_CALL, WICED_BT_ANS_LATENCY_TOTAL, &latency));
+    TEST_ASSERT(latency.count == 1001);
+    TEST_ASSERT((latency.min_us == 100) && (latency.max_us == 5000000));
+    TEST_ASSERT((latency.p50_us >= 50100) && (latency.p50_us <= 50100 + 50100 / 8));
+    TEST_ASSERT((latency.p99_us >= 99100) && (latency.p99_us <= 99100 + 99100 / 8));
+    TEST_ASSERT((latency.p999_us >= 100000) && (latency.p999_us <= 100000 + 100000 / 8));
+
+    /* other stages and categories are apart, the category is checked */
+    TEST_ASSERT(wiced_bt_ans_get_latency(ANP_ALERT_CATEGORY_ID_CALL, WICED_BT_ANS_LATENCY_HOLD, &latency));
+    TEST_ASSERT(latency.count == 0);
+    TEST_ASSERT(!wiced_bt_ans_get_latency(ANP_NOTIFY_CATEGORY_COUNT, WICED_BT_ANS_LATENCY_TOTAL, &latency));
+    TEST_ASSERT(!wiced_bt_ans_get_latency(ANP_ALERT_CATEGORY_ID_CALL, WICED_BT_ANS_LATENCY_STAGES, &latency));
+
+    wiced_bt_ans_reset_latency();
+    TEST_ASSERT(wiced_bt_ans_get_latency(ANP_ALERT_CATEGORY_ID_CALL, WICED_BT_ANS_LATENCY_TOTAL, &latency));
+    TEST_ASSERT(latency.count == 0);
+}
+
+/* Stages of alerts sent to a client */
+static void test_latency_stages(void)
+{
+    wiced_bt_ans_latency_t latency;
+
+    test_ans_init(4);
+    test_ans_connect(TEST_CONN_ID);
+
+    wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_CALL);
+    test_stubs_advance_ms(3);
+    test_stubs_transmit(UINT32_MAX);
+
+    wiced_bt_ans_get_latency(ANP_ALERT_CATEGORY_ID_CALL, WICED_BT_ANS_LATENCY_HOLD, &latency);
+    TEST_ASSERT((latency.count == 1) && (latency.max_us == 0));
+    wiced_bt_ans_get_latency(ANP_ALERT_CATEGORY_ID_CALL, WICED_BT_ANS_LATENCY_STACK, &latency);
+    TEST_ASSERT((latency.count == 1) && (latency.max_us == 3000));
+    wiced_bt_ans_get_latency(ANP_ALERT_CATEGORY_ID_CALL, WICED_BT_ANS_LATENCY_TOTAL, &latency);
+    TEST_ASSERT((latency.count == 1) && (latency.p50_us == 3000) && (latency.p999_us == 3000));
+
+    /* alerts pending while the client has them disabled count from the oldest */
+    TEST_ASSERT(test_ans_write(TEST_CONN_ID, test_ans_handles.notification_control,
+                               ANP_ALERT_CONTROL_CMD_DISABLE_NEW_ALERTS, ANP_ALERT_CATEGORY_ID_NEWS) ==
+                WICED_BT_GATT_SUCCESS);
+    wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_NEWS);
+    test_stubs_advance_ms(30);
+    wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_NEWS);
+    TEST_ASSERT(test_ans_write(TEST_CONN_ID, test_ans_handles.notification_control,
+                               ANP_ALERT_CONTROL_CMD_ENABLE_NEW_ALERTS, ANP_ALERT_CATEGORY_ID_NEWS) ==
+                WICED_BT_GATT_SUCCESS);
+    TEST_ASSERT(test_ans_write(TEST_CONN_ID, test_ans_handles.notification_control,
+                               ANP_ALERT_CONTROL_CMD_NOTIFY_NEW_ALERTS_IMMEDIATE, ANP_ALERT_CATEGORY_ID_NEWS) ==
+                WICED_BT_GATT_SUCCESS);
+    test_stubs_transmit(UINT32_MAX);
+
+    wiced_bt_ans_get_latency(ANP_ALERT_CATEGORY_ID_NEWS, WICED_BT_ANS_LATENCY_HOLD, &latency);
+    TEST_ASSERT((latency.count == 1) && (latency.max_us == 30000));
+    wiced_bt_ans_get_latency(ANP_ALERT_CATEGORY_ID_NEWS, WICED_BT_ANS_LATENCY_TOTAL, &latency);
+    TEST_ASSERT((latency.count == 1) && (latency.max_us == 30000));
+}
+
+int main(void)
+{
+    test_latency_buckets();
+    test_latency_percentiles();
+    test_latency_stages();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,179 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+/******************************************************************************
+ * File Name: test_ans_rate_limit.c
+ *
+ * Description:
+ * Unit tests of the per category rate limiter of the ANS library: the token
+ * bucket refill and wait time, the alerts held back and released by the hold
+ * timer, and the single token shared by the two notifications of a batch.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include "test_ans.h"
+
+/*******************************************************************************
+ *                                   MACROS
+ *******************************************************************************/
+#define TEST_CONN_ID 5
+
+/*******************************************************************************
+ *                       FUNCTION DEFINITIONS
+ *******************************************************************************/
+
+/* Token bucket of 100 events per second with a burst of 2 */
+static void test_rate_limit_bucket(void)
+{
+    uint8_t cat = ANP_ALERT_CATEGORY_ID_EMAIL;
+    ans_lib_conn_cb_t *p_conn = &ans_lib_cb.conn[0];
+    uint32_t wait_ms = 0;
+
+    test_ans_init(4);
+    TEST_ASSERT(!wiced_bt_ans_set_rate_limit(cat, 60, 0));
+    TEST_ASSERT(!wiced_bt_ans_set_rate_limit(ANP_NOTIFY_CATEGORY_COUNT, 60, 1));
+    TEST_ASSERT(wiced_bt_ans_set_rate_limit(cat, 6000, 2));
+
+    p_conn->tokens[cat] = 2 * ANS_LIB_TOKEN;
+    p_conn->token_time[cat] = 1000;
+
+    TEST_ASSERT(ans_lib_rate_take(p_conn, cat, 1, 1000, &wait_ms));
+    TEST_ASSERT(ans_lib_rate_take(p_conn, cat, 1, 1000, &wait_ms));
+    TEST_ASSERT(!ans_lib_rate_take(p_conn, cat, 1, 1000, &wait_ms) && (wait_ms == 10));
+
+    /* half a token after 5 ms, nothing is taken */
+    TEST_ASSERT(!ans_lib_rate_take(p_conn, cat, 1, 1005, &wait_ms) && (wait_ms == 5));
+    TEST_ASSERT(p_conn->tokens[cat] == ANS_LIB_TOKEN / 2);
+    TEST_ASSERT(ans_lib_rate_take(p_conn, cat, 1, 1010, &wait_ms));
+    TEST_ASSERT(p_conn->tokens[cat] == 0);
+
+    /* an idle bucket fills up to the burst only */
+    p_conn->tokens[cat] = 0;
+    p_conn->token_time[cat] = 60000;
+    TEST_ASSERT(ans_lib_rate_take(p_conn, cat, 1, 70000, &wait_ms));
+    TEST_ASSERT(p_conn->tokens[cat] == ANS_LIB_TOKEN);
+
+    /* a request larger than the burst takes the full bucket */
+    p_conn->tokens[cat] = 2 * ANS_LIB_TOKEN;
+    TEST_ASSERT(ans_lib_rate_take(p_conn, cat, 3, 70000, &wait_ms));
+    TEST_ASSERT(p_conn->tokens[cat] == 0);
+
+    /* refill across the wrap of the millisecond clock */
+    p_conn->token_time[cat] = 0xFFFFFFF6;
+    TEST_ASSERT(ans_lib_rate_take(p_conn, cat, 1, 4, &wait_ms));
+    TEST_ASSERT(p_conn->tokens[cat] == 400);
+
+    /* no limit on the other categories */
+    p_conn->tokens[ANP_ALERT_CATEGORY_ID_CALL] = 0;
+    TEST_ASSERT(ans_lib_rate_take(p_conn, ANP_ALERT_CATEGORY_ID_CALL, 1, 4, &wait_ms));
+}
+
+/* Alerts past the burst are held back, counted and released by the hold timer */
+static void test_rate_limit_hold(void)
+{
+    wiced_bt_ans_tx_stats_t stats;
+    uint8_t i;
+
+    test_ans_init(200);
+    TEST_ASSERT(wiced_bt_ans_set_rate_limit(ANP_ALERT_CATEGORY_ID_EMAIL, 6000, 2));
+    test_ans_connect(TEST_CONN_ID);
+
+    for (i = 0; i < 10; i++)
+        wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_EMAIL);
+    TEST_ASSERT((test_stubs.ntf_count == 2) && test_stubs.timer_running && (test_stubs.timer_timeout == 10));
+    wiced_bt_ans_get_tx_stats(TEST_CONN_ID, &stats);
+    TEST_ASSERT(stats.throttled[ANP_ALERT_CATEGORY_ID_EMAIL] == 8);
+
+    /* too early, the timer is armed again */
+    test_stubs_advance_ms(5);
+    test_stubs_timer_fire();
+    TEST_ASSERT((test_stubs.ntf_count == 2) && test_stubs.timer_running && (test_stubs.timer_timeout == 5));
+
+    /* one notification carries the count of all held alerts */
+    test_stubs_advance_ms(5);
+    test_stubs_timer_fire();
+    TEST_ASSERT((test_stubs.ntf_count == 3) && !test_stubs.timer_running);
+    TEST_ASSERT(test_stubs_last_ntf()->value[1] == 10);
+
+    /* the bucket is empty again, other categories are not limited */
+    wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_EMAIL);
+    TEST_ASSERT((test_stubs.ntf_count == 3) && test_stubs.timer_running);
+    wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_CALL);
+    TEST_ASSERT(test_stubs.ntf_count == 4);
+
+    test_stubs_advance_ms(10);
+    test_stubs_timer_fire();
+    TEST_ASSERT((test_stubs.ntf_count == 5) && (test_stubs_last_ntf()->value[1] == 11));
+
+    /* a new connection starts with a full bucket */
+    wiced_bt_ans_connection_down(TEST_CONN_ID);
+    test_ans_connect(TEST_CONN_ID);
+    wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_EMAIL);
+    wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_EMAIL);
+    TEST_ASSERT(test_stubs.ntf_count == 7);
+}
+
+/* The New Alert and Unread Alert Status of one batch cost one token */
+static void test_rate_limit_batch(void)
+{
+    wiced_bt_ans_tx_stats_t stats;
+    uint8_t i;
+
+    test_ans_init(20);
+    TEST_ASSERT(wiced_bt_ans_set_rate_limit(ANP_ALERT_CATEGORY_ID_EMAIL, 6, 2));
+    test_ans_connect(TEST_CONN_ID);
+
+    for (i = 0; i < 3; i++)
+    {
+        wiced_bt_ans_begin_batch();
+        wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_EMAIL);
+        wiced_bt_ans_process_and_send_unread_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_EMAIL);
+        wiced_bt_ans_end_batch();
+        test_stubs_transmit(UINT32_MAX);
+    }
+
+    wiced_bt_ans_get_tx_stats(TEST_CONN_ID, &stats);
+    TEST_ASSERT(test_stubs.ntf_count == 4);
+    TEST_ASSERT(stats.throttled[ANP_ALERT_CATEGORY_ID_EMAIL] == 2);
+}
+
+int main(void)
+{
+    test_rate_limit_bucket();
+    test_rate_limit_hold();
+    test_rate_limit_batch();
+    return EXIT_SUCCESS;
+}
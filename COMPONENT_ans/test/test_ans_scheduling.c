@@ -0,0 +1,185 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+/******************************************************************************
+ * File Name: test_ans_scheduling.c
+ *
+ * Description:
+ * Unit tests of the send order of the ANS library TX queue: category
+ * priority first, then the earliest deadline, then the enqueue order, and of
+ * the deadline misses counted from the time of the alert.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include "test_ans.h"
+
+/*******************************************************************************
+ *                                   MACROS
+ *******************************************************************************/
+#define TEST_CONN_ID 5
+
+/*******************************************************************************
+ *                       FUNCTION DEFINITIONS
+ *******************************************************************************/
+
+/* Category of the notification sent after the next transmitted event */
+static uint8_t test_scheduling_next(void)
+{
+    uint32_t sent = test_stubs.ntf_count;
+
+    TEST_ASSERT(test_stubs_transmit(1) == 1);
+    TEST_ASSERT(test_stubs.ntf_count == sent + 1);
+    return test_stubs_last_ntf()->value[0];
+}
+
+/* Order of two queue entries */
+static void test_scheduling_order(void)
+{
+    ans_lib_tx_entry_t a;
+    ans_lib_tx_entry_t b;
+
+    memset(&a, 0, sizeof(a));
+    memset(&b, 0, sizeof(b));
+
+    a.priority = WICED_BT_ANS_PRIORITY_HIGH;
+    b.priority = WICED_BT_ANS_PRIORITY_NORMAL;
+    a.due_us = 2000;
+    b.due_us = 1000;
+    TEST_ASSERT(ans_lib_tx_before(&a, &b) && !ans_lib_tx_before(&b, &a));
+
+    b.priority = WICED_BT_ANS_PRIORITY_HIGH;
+    TEST_ASSERT(ans_lib_tx_before(&b, &a) && !ans_lib_tx_before(&a, &b));
+
+    /* an entry without a deadline goes after one with a deadline */
+    b.due_us = 0;
+    TEST_ASSERT(ans_lib_tx_before(&a, &b) && !ans_lib_tx_before(&b, &a));
+
+    /* same deadline, the older goes first, across a wrap of the sequence */
+    a.due_us = 0;
+    a.seq = 0xFFFFFFFF;
+    b.seq = 1;
+    TEST_ASSERT(ans_lib_tx_before(&a, &b) && !ans_lib_tx_before(&b, &a));
+}
+
+/* A queued urgent alert is sent ahead of older alerts of lower classes */
+static void test_scheduling_preemption(void)
+{
+    wiced_bt_ans_tx_stats_t stats;
+
+    test_ans_init(1);
+    TEST_ASSERT(wiced_bt_ans_set_category_priority(ANP_ALERT_CATEGORY_ID_CALL, WICED_BT_ANS_PRIORITY_URGENT, 5));
+    TEST_ASSERT(!wiced_bt_ans_set_category_priority(ANP_ALERT_CATEGORY_ID_CALL, WICED_BT_ANS_PRIORITY_BULK + 1, 5));
+    test_ans_connect(TEST_CONN_ID);
+
+    wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_SIMPLE_ALERT);
+    TEST_ASSERT(test_stubs.ntf_count == 1);
+
+    wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_EMAIL);
+    wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_NEWS);
+    wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_SCHEDULE_ALERT);
+    wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_MISSED_CALL);
+    wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_CALL);
+    TEST_ASSERT(test_stubs.ntf_count == 1);
+
+    /* the call waits 8 ms for the credit, past its 5 ms deadline */
+    test_stubs_advance_ms(8);
+    TEST_ASSERT(test_scheduling_next() == ANP_ALERT_CATEGORY_ID_CALL);
+    TEST_ASSERT(test_scheduling_next() == ANP_ALERT_CATEGORY_ID_MISSED_CALL);
+    TEST_ASSERT(test_scheduling_next() == ANP_ALERT_CATEGORY_ID_SCHEDULE_ALERT);
+    TEST_ASSERT(test_scheduling_next() == ANP_ALERT_CATEGORY_ID_EMAIL);
+    TEST_ASSERT(test_scheduling_next() == ANP_ALERT_CATEGORY_ID_NEWS);
+
+    wiced_bt_ans_get_tx_stats(TEST_CONN_ID, &stats);
+    TEST_ASSERT(stats.deadline_misses[ANP_ALERT_CATEGORY_ID_CALL] == 1);
+    TEST_ASSERT(stats.deadline_misses[ANP_ALERT_CATEGORY_ID_MISSED_CALL] == 0);
+}
+
+/* Within a class the earliest deadline goes first, alerts without a deadline last */
+static void test_scheduling_deadline(void)
+{
+    test_ans_init(1);
+    wiced_bt_ans_set_category_priority(ANP_ALERT_CATEGORY_ID_NEWS, WICED_BT_ANS_PRIORITY_NORMAL, 0);
+    wiced_bt_ans_set_category_priority(ANP_ALERT_CATEGORY_ID_CALL, WICED_BT_ANS_PRIORITY_NORMAL, 1000);
+    wiced_bt_ans_set_category_priority(ANP_ALERT_CATEGORY_ID_MISSED_CALL, WICED_BT_ANS_PRIORITY_NORMAL, 10);
+    test_ans_connect(TEST_CONN_ID);
+
+    wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_SIMPLE_ALERT);
+    wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_NEWS);
+    wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_CALL);
+    test_stubs_advance_ms(500);
+    wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_MISSED_CALL);
+    TEST_ASSERT(test_stubs.ntf_count == 1);
+
+    TEST_ASSERT(test_scheduling_next() == ANP_ALERT_CATEGORY_ID_MISSED_CALL);
+    TEST_ASSERT(test_scheduling_next() == ANP_ALERT_CATEGORY_ID_CALL);
+    TEST_ASSERT(test_scheduling_next() == ANP_ALERT_CATEGORY_ID_NEWS);
+}
+
+/* The deadline runs from the alert, time held back by the rate limiter counts */
+static void test_scheduling_deadline_from_alert(void)
+{
+    wiced_bt_ans_tx_stats_t stats;
+
+    test_ans_init(1);
+    TEST_ASSERT(wiced_bt_ans_set_rate_limit(ANP_ALERT_CATEGORY_ID_NEWS, 6000, 1));
+    wiced_bt_ans_set_category_priority(ANP_ALERT_CATEGORY_ID_NEWS, WICED_BT_ANS_PRIORITY_NORMAL, 5);
+    test_ans_connect(TEST_CONN_ID);
+
+    wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_NEWS);
+    TEST_ASSERT(test_stubs.ntf_count == 1);
+    test_stubs_transmit(UINT32_MAX);
+
+    /* the bucket refills in 10 ms */
+    wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_NEWS);
+    TEST_ASSERT((test_stubs.ntf_count == 1) && test_stubs.timer_running && (test_stubs.timer_timeout == 10));
+    wiced_bt_ans_get_tx_stats(TEST_CONN_ID, &stats);
+    TEST_ASSERT(stats.deadline_misses[ANP_ALERT_CATEGORY_ID_NEWS] == 0);
+
+    test_stubs_advance_ms(10);
+    test_stubs_timer_fire();
+    TEST_ASSERT(test_stubs.ntf_count == 2);
+    wiced_bt_ans_get_tx_stats(TEST_CONN_ID, &stats);
+    TEST_ASSERT(stats.deadline_misses[ANP_ALERT_CATEGORY_ID_NEWS] == 1);
+}
+
+int main(void)
+{
+    test_scheduling_order();
+    test_scheduling_preemption();
+    test_scheduling_deadline();
+    test_scheduling_deadline_from_alert();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,190 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+/******************************************************************************
+ * File Name: test_ans_text.c
+ *
+ * Description:
+ * Unit tests of the New Alert text of the ANS library: the cut at a UTF-8
+ * character boundary, the truncation at the ATT MTU and data length of the
+ * client and the interned text pool.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include "test_ans.h"
+
+/*******************************************************************************
+ *                                   MACROS
+ *******************************************************************************/
+#define TEST_CONN_ID 5
+
+/* The euro sign, three bytes in UTF-8 */
+#define TEST_EURO "\xe2\x82\xac"
+
+/*******************************************************************************
+ *                       FUNCTION DEFINITIONS
+ *******************************************************************************/
+
+/* Check that the last New Alert carries category, count and text */
+static void test_text_check(uint8_t category_id, const char *p_text, uint16_t text_len)
+{
+    const test_stubs_ntf_t *p_ntf = test_stubs_last_ntf();
+
+    TEST_ASSERT(p_ntf->len == 2 + text_len);
+    TEST_ASSERT(p_ntf->value[0] == category_id);
+    TEST_ASSERT(memcmp(&p_ntf->value[2], p_text, text_len) == 0);
+}
+
+/* Cut points of UTF-8 text */
+static void test_text_utf8_trim(void)
+{
+    const char *p_text = "ab" TEST_EURO "c";
+
+    TEST_ASSERT(ans_lib_utf8_trim(p_text, 6, 6) == 6);
+    TEST_ASSERT(ans_lib_utf8_trim(p_text, 6, 10) == 6);
+    TEST_ASSERT(ans_lib_utf8_trim(p_text, 6, 5) == 5);
+    TEST_ASSERT(ans_lib_utf8_trim(p_text, 6, 4) == 2);
+    TEST_ASSERT(ans_lib_utf8_trim(p_text, 6, 3) == 2);
+    TEST_ASSERT(ans_lib_utf8_trim(p_text, 6, 2) == 2);
+    TEST_ASSERT(ans_lib_utf8_trim(p_text, 6, 0) == 0);
+
+    /* text made only of a character that does not fit */
+    TEST_ASSERT(ans_lib_utf8_trim(TEST_EURO, 3, 2) == 0);
+}
+
+/* The text is truncated to what fits in one New Alert of the connection */
+static void test_text_mtu(void)
+{
+    char text[150];
+    char utf8[47];
+    uint16_t i;
+
+    for (i = 0; i < sizeof(text); i++)
+        text[i] = 'a' + (i % 26);
+
+    test_ans_init(250);
+    test_ans_connect(TEST_CONN_ID);
+    TEST_ASSERT(ans_lib_ntf_value_max(ans_lib_find_conn_cb(TEST_CONN_ID)) == 20);
+
+    /* default MTU of 23 bytes leaves 18 bytes of text */
+    TEST_ASSERT(wiced_bt_ans_process_and_send_new_alert_text(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_EMAIL, text, 150) ==
+                WICED_BT_GATT_SUCCESS);
+    TEST_ASSERT(test_stubs.ntf_count == 1);
+    test_text_check(ANP_ALERT_CATEGORY_ID_EMAIL, text, 18);
+    TEST_ASSERT(test_stubs_last_ntf()->value[1] == 1);
+    test_stubs_transmit(UINT32_MAX);
+
+    /* a character across the end is dropped whole */
+    TEST_ASSERT(wiced_bt_ans_process_and_send_new_alert_text(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_EMAIL,
+                                                             "abcdefghijklmnop" TEST_EURO, 19) == WICED_BT_GATT_SUCCESS);
+    test_text_check(ANP_ALERT_CATEGORY_ID_EMAIL, "abcdefghijklmnop", 16);
+    test_stubs_transmit(UINT32_MAX);
+    TEST_ASSERT(wiced_bt_ans_process_and_send_new_alert_text(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_EMAIL,
+                                                             "abcdefghijklmno" TEST_EURO, 18) == WICED_BT_GATT_SUCCESS);
+    test_text_check(ANP_ALERT_CATEGORY_ID_EMAIL, "abcdefghijklmno" TEST_EURO, 18);
+    test_stubs_transmit(UINT32_MAX);
+
+    /* larger MTU, the text is kept up to WICED_BT_ANS_MAX_TEXT_LEN */
+    wiced_bt_ans_set_mtu(TEST_CONN_ID, 247);
+    TEST_ASSERT(wiced_bt_ans_process_and_send_new_alert_text(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_EMAIL, text, 150) ==
+                WICED_BT_GATT_SUCCESS);
+    test_text_check(ANP_ALERT_CATEGORY_ID_EMAIL, text, WICED_BT_ANS_MAX_TEXT_LEN);
+    test_stubs_transmit(UINT32_MAX);
+
+    wiced_bt_ans_set_mtu(TEST_CONN_ID, 40);
+    memset(utf8, 'a', 34);
+    memcpy(&utf8[34], TEST_EURO, 3);
+    memset(&utf8[37], 'b', 10);
+    TEST_ASSERT(wiced_bt_ans_process_and_send_new_alert_text(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_EMAIL, utf8, 47) ==
+                WICED_BT_GATT_SUCCESS);
+    test_text_check(ANP_ALERT_CATEGORY_ID_EMAIL, utf8, 34);
+    test_stubs_transmit(UINT32_MAX);
+
+    /* an MTU below the default is ignored */
+    wiced_bt_ans_set_mtu(TEST_CONN_ID, 10);
+    TEST_ASSERT(ans_lib_ntf_value_max(ans_lib_find_conn_cb(TEST_CONN_ID)) == 37);
+
+    /* a known data length keeps the New Alert in one link layer packet */
+    wiced_bt_ans_set_mtu(TEST_CONN_ID, 247);
+    wiced_bt_ans_set_data_length(TEST_CONN_ID, 60);
+    TEST_ASSERT(wiced_bt_ans_process_and_send_new_alert_text(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_EMAIL, text, 150) ==
+                WICED_BT_GATT_SUCCESS);
+    test_text_check(ANP_ALERT_CATEGORY_ID_EMAIL, text, 51);
+    test_stubs_transmit(UINT32_MAX);
+
+    wiced_bt_ans_set_data_length(TEST_CONN_ID, 27);
+    TEST_ASSERT(ans_lib_ntf_value_max(ans_lib_find_conn_cb(TEST_CONN_ID)) == 20);
+    wiced_bt_ans_set_data_length(TEST_CONN_ID, 251);
+    TEST_ASSERT(ans_lib_ntf_value_max(ans_lib_find_conn_cb(TEST_CONN_ID)) == ANS_LIB_TX_VALUE_MAX);
+    wiced_bt_ans_set_data_length(TEST_CONN_ID, 5);
+    TEST_ASSERT(ans_lib_ntf_value_max(ans_lib_find_conn_cb(TEST_CONN_ID)) == ANS_LIB_TX_VALUE_MAX);
+}
+
+/* More distinct texts than the pool holds */
+static void test_text_pool(void)
+{
+    char text[8];
+    int len;
+    int i;
+
+    test_ans_init(250);
+    test_ans_connect(TEST_CONN_ID);
+    test_ans_connect(TEST_CONN_ID + 1);
+
+    for (i = 0; i < 10 * WICED_BT_ANS_TEXT_POOL_SIZE; i++)
+    {
+        len = snprintf(text, sizeof(text), "s%d", i);
+        TEST_ASSERT(wiced_bt_ans_process_and_send_new_alert_text_all(i % 10, text, (uint16_t)len) ==
+                    WICED_BT_GATT_SUCCESS);
+        test_stubs_transmit(UINT32_MAX);
+        test_text_check(i % 10, text, (uint16_t)len);
+    }
+
+    /* no text, and a missing text with a length */
+    TEST_ASSERT(wiced_bt_ans_process_and_send_new_alert_text(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_EMAIL, NULL, 0) ==
+                WICED_BT_GATT_SUCCESS);
+    test_text_check(ANP_ALERT_CATEGORY_ID_EMAIL, "", 0);
+    TEST_ASSERT(wiced_bt_ans_process_and_send_new_alert_text(TEST_CONN_ID, ANP_ALERT_CATEGORY_ID_EMAIL, NULL, 3) !=
+                WICED_BT_GATT_SUCCESS);
+}
+
+int main(void)
+{
+    test_text_utf8_trim();
+    test_text_mtu();
+    test_text_pool();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,200 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+/******************************************************************************
+ * File Name: test_ans_tx_queue.c
+ *
+ * Description:
+ * Unit tests of the notification TX queue of the ANS library: TX credits,
+ * a full queue, congestion, a link dropped with notifications in flight and
+ * the bearer kept for urgent alerts.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include "test_ans.h"
+
+/*******************************************************************************
+ *                                   MACROS
+ *******************************************************************************/
+#define TEST_CONN_ID 5
+
+/*******************************************************************************
+ *                       FUNCTION DEFINITIONS
+ *******************************************************************************/
+
+/* Sends wait for a credit, a full queue drops the newest count and resends it once there is room */
+static void test_tx_queue_credits_and_overflow(void)
+{
+    wiced_bt_ans_tx_stats_t stats;
+    uint8_t cat;
+
+    test_ans_init(4);
+    test_ans_connect(TEST_CONN_ID);
+
+    for (cat = 0; cat < 6; cat++)
+        TEST_ASSERT(wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, cat) == WICED_BT_GATT_SUCCESS);
+    TEST_ASSERT(test_stubs.ntf_count == 4);
+    TEST_ASSERT(wiced_bt_ans_get_tx_stats(TEST_CONN_ID, &stats));
+    TEST_ASSERT((stats.queue_depth == 2) && (stats.in_flight == 4));
+
+    /* a newer count of a queued category replaces the queued one */
+    TEST_ASSERT(wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, 5) == WICED_BT_GATT_SUCCESS);
+    wiced_bt_ans_get_tx_stats(TEST_CONN_ID, &stats);
+    TEST_ASSERT(stats.queue_depth == 2);
+
+    TEST_ASSERT(wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, 6) == WICED_BT_GATT_SUCCESS);
+    TEST_ASSERT(wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, 7) == WICED_BT_GATT_SUCCESS);
+    TEST_ASSERT(wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, 2) != WICED_BT_GATT_SUCCESS);
+    wiced_bt_ans_get_tx_stats(TEST_CONN_ID, &stats);
+    TEST_ASSERT((stats.drops == 1) && (stats.max_depth == WICED_BT_ANS_TX_QUEUE_SIZE));
+
+    /* a credit coming back sends the oldest queued entry of the highest class, the missed call */
+    TEST_ASSERT(test_stubs_transmit(1) == 1);
+    TEST_ASSERT(test_stubs.ntf_count == 5);
+    TEST_ASSERT(test_stubs_last_ntf()->value[0] == ANP_ALERT_CATEGORY_ID_MISSED_CALL);
+
+    /* a buffer the library did not send is left to the application */
+    TEST_ASSERT(!wiced_bt_ans_process_buffer_transmitted(test_stubs_ntf(0)->p_data, &stats));
+
+    /* a congested link keeps the entry queued until it clears */
+    test_stubs.ntf_status = WICED_BT_GATT_CONGESTED;
+    TEST_ASSERT(test_stubs_transmit(1) == 1);
+    wiced_bt_ans_get_tx_stats(TEST_CONN_ID, &stats);
+    TEST_ASSERT(stats.congested && (stats.retries == 1));
+    test_stubs.ntf_status = WICED_BT_GATT_SUCCESS;
+    wiced_bt_ans_process_congestion(TEST_CONN_ID, WICED_FALSE);
+    TEST_ASSERT(test_stubs.ntf_count == 6);
+    TEST_ASSERT((test_stubs_last_ntf()->value[0] == ANP_ALERT_CATEGORY_ID_SMS_OR_MMS) &&
+                (test_stubs_last_ntf()->value[1] == 2));
+
+    /* the dropped news count goes out last */
+    test_stubs_transmit(UINT32_MAX);
+    TEST_ASSERT(test_stubs_last_ntf()->value[0] == ANP_ALERT_CATEGORY_ID_NEWS);
+    wiced_bt_ans_get_tx_stats(TEST_CONN_ID, &stats);
+    TEST_ASSERT((stats.queue_depth == 0) && (stats.in_flight == 0) && (stats.sent == 9));
+}
+
+/* A dropped link gives its credits back once, never above the configured number */
+static void test_tx_queue_link_drop(void)
+{
+    uint8_t cat;
+
+    test_ans_init(4);
+    test_ans_connect(TEST_CONN_ID);
+
+    for (cat = 0; cat < 3; cat++)
+        wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, cat);
+    TEST_ASSERT(test_stubs.ntf_count == 3);
+
+    /* fewer credits while three are in flight, then the link drops */
+    wiced_bt_ans_set_tx_credits(2);
+    wiced_bt_ans_connection_down(TEST_CONN_ID);
+    TEST_ASSERT(ans_lib_cb.tx_credits == 2);
+
+    /* late transmitted events of the dropped link are ignored */
+    TEST_ASSERT(test_stubs_transmit(UINT32_MAX) == 3);
+    TEST_ASSERT(ans_lib_cb.tx_credits == 2);
+
+    test_ans_connect(TEST_CONN_ID);
+    for (cat = 0; cat < 5; cat++)
+        wiced_bt_ans_process_and_send_new_alert(TEST_CONN_ID, cat);
+    TEST_ASSERT(test_stubs.ntf_count == 5);
+}
+
+/* Credits are shared by all connections, the last one is kept for urgent and high priority alerts */
+static void test_tx_queue_shared_credits(void)
+{
+    wiced_bt_ans_tx_stats_t stats;
+
+    test_ans_init(2);
+    test_ans_connect(TEST_CONN_ID);
+    test_ans_connect(TEST_CONN_ID + 1);
+
+    wiced_bt_ans_process_and_send_new_alert_all(ANP_ALERT_CATEGORY_ID_EMAIL);
+    TEST_ASSERT(test_stubs.ntf_count == 1);
+    wiced_bt_ans_process_and_send_new_alert_all(ANP_ALERT_CATEGORY_ID_CALL);
+    TEST_ASSERT(test_stubs.ntf_count == 2);
+    TEST_ASSERT(test_stubs_last_ntf()->value[0] == ANP_ALERT_CATEGORY_ID_CALL);
+
+    test_stubs_transmit(UINT32_MAX);
+    TEST_ASSERT(test_stubs.ntf_count == 4);
+    wiced_bt_ans_get_tx_stats(TEST_CONN_ID, &stats);
+    TEST_ASSERT((stats.sent == 2) && (stats.queue_depth == 0) && (stats.in_flight == 0));
+    wiced_bt_ans_get_tx_stats(TEST_CONN_ID + 1, &stats);
+    TEST_ASSERT((stats.sent == 2) && (stats.queue_depth == 0) && (stats.in_flight == 0));
+    TEST_ASSERT(ans_lib_cb.tx_credits == 2);
+}
+
+/* The first EATT bearer is kept for urgent and high priority alerts only while another EATT bearer is open */
+static void test_tx_queue_urgent_bearer(void)
+{
+    ans_lib_conn_cb_t *p_conn;
+    ans_lib_tx_entry_t entry = {0};
+
+    test_ans_init(4);
+    test_ans_connect(TEST_CONN_ID);
+    p_conn = ans_lib_find_conn_cb(TEST_CONN_ID);
+    entry.priority = WICED_BT_ANS_PRIORITY_NORMAL;
+    entry.handle = ans_lib_cb.gatt_handles.new_alert.value;
+
+    /* a lone EATT bearer takes everything */
+    TEST_ASSERT(wiced_bt_ans_bearer_up(TEST_CONN_ID, TEST_CONN_ID + 10, 64));
+    TEST_ASSERT(ans_lib_tx_bearer(p_conn, &entry, 20) == ANS_LIB_BEARER_URGENT);
+
+    TEST_ASSERT(wiced_bt_ans_bearer_up(TEST_CONN_ID, TEST_CONN_ID + 11, 64));
+    TEST_ASSERT(ans_lib_tx_bearer(p_conn, &entry, 20) == ANS_LIB_BEARER_URGENT + 1);
+
+    /* a busy second bearer hands over to the legacy bearer, not to the reserved one */
+    p_conn->bearer[ANS_LIB_BEARER_URGENT + 1].congested = WICED_TRUE;
+    TEST_ASSERT(ans_lib_tx_bearer(p_conn, &entry, 20) == ANS_LIB_BEARER_LEGACY);
+    entry.priority = WICED_BT_ANS_PRIORITY_URGENT;
+    TEST_ASSERT(ans_lib_tx_bearer(p_conn, &entry, 20) == ANS_LIB_BEARER_URGENT);
+
+    /* once the first bearer closes nothing is reserved */
+    p_conn->bearer[ANS_LIB_BEARER_URGENT + 1].congested = WICED_FALSE;
+    wiced_bt_ans_bearer_down(TEST_CONN_ID + 10);
+    entry.priority = WICED_BT_ANS_PRIORITY_NORMAL;
+    TEST_ASSERT(ans_lib_tx_bearer(p_conn, &entry, 20) == ANS_LIB_BEARER_URGENT + 1);
+}
+
+int main(void)
+{
+    test_tx_queue_credits_and_overflow();
+    test_tx_queue_link_drop();
+    test_tx_queue_shared_credits();
+    test_tx_queue_urgent_bearer();
+    return EXIT_SUCCESS;
+}
@@ -39,37 +39,183 @@
 #include "wiced_bt_anp.h"
 #include "wiced_bt_ans.h"
 #include "wiced_bt_trace.h"
+#include "wiced_bt_ans_trace.h"
+#include "wiced_bt_ans_probe.h"
+#include "wiced_timer.h"
 #include "string.h"
+#include <time.h>
 
 #define ANS_STATE_DISCONNECTED 0
 #define ANS_STATE_CONNECTED 1
 
-#ifdef WICED_BT_TRACE_ENABLE
-#define ANS_TRACE_DBG(format, ...) WICED_BT_TRACE("%s: " format, __FUNCTION__, ##__VA_ARGS__)
-#define ANS_TRACE_ERR(format, ...) WICED_BT_TRACE("ERR: %s: " format, __FUNCTION__, ##__VA_ARGS__)
-#else
-#define ANS_TRACE_DBG(...)
-#define ANS_TRACE_ERR(...)
+/* Size of the conn_id -> control block index. It holds the conn_id of every ATT bearer, legacy and
+ * Enhanced, of every connection. Power of two and at least twice the number of bearers so that the
+ * linear probe sequence stays short */
+#define ANS_LIB_CONN_INDEX_SIZE 32
+#define ANS_LIB_CONN_INDEX_MASK (ANS_LIB_CONN_INDEX_SIZE - 1)
+#define ANS_LIB_CONN_INDEX_FREE 0xFF
+
+#if (ANS_LIB_CONN_INDEX_SIZE < (2 * WICED_BT_ANS_MAX_CONNECTIONS * (1 + WICED_BT_ANS_MAX_EATT_BEARERS))) || \
+    (WICED_BT_ANS_MAX_CONNECTIONS >= ANS_LIB_CONN_INDEX_FREE)
+#error "ANS_LIB_CONN_INDEX_SIZE too small for WICED_BT_ANS_MAX_CONNECTIONS"
+#endif
+
+/* Largest characteristic value carried by a queued notification */
+#define ANS_LIB_TX_VALUE_MAX WICED_BT_ANS_MAX_VALUE_LEN
+
+/* Longest text kept for a category, the New Alert carries as much of it as the MTU of the client allows */
+#define ANS_LIB_TEXT_MAX WICED_BT_ANS_MAX_TEXT_LEN
+
+/* ATT MTU until the exchange completes, and the ATT notification header */
+#define ANS_LIB_ATT_MTU_DEFAULT 23
+#define ANS_LIB_ATT_NTF_HDR 3
+
+/* L2CAP basic header ahead of an ATT PDU in a link layer payload */
+#define ANS_LIB_L2CAP_HDR 4
+
+#if (ANS_LIB_TX_VALUE_MAX < (ANS_LIB_ATT_MTU_DEFAULT - ANS_LIB_ATT_NTF_HDR)) || (ANS_LIB_TEXT_MAX > 255)
+#error "WICED_BT_ANS_MAX_VALUE_LEN or WICED_BT_ANS_MAX_TEXT_LEN out of range"
+#endif
+
+/* Reserved text IDs, pool entries are 1..WICED_BT_ANS_TEXT_POOL_SIZE */
+#define ANS_LIB_TEXT_SAMPLE 0   /* built in sample text of the category */
+#define ANS_LIB_TEXT_EMPTY 0xFF /* text did not fit in the pool, the alert goes out without one */
+
+#if (WICED_BT_ANS_TEXT_POOL_SIZE >= ANS_LIB_TEXT_EMPTY)
+#error "WICED_BT_ANS_TEXT_POOL_SIZE too large"
 #endif
 
+/* Handle span of the ANS attributes served by the library, indexed from the lowest handle */
+#define ANS_LIB_ATTR_SPAN 32
+
+/* Attributes served by the library */
+#define ANS_LIB_ATTR_NONE 0
+#define ANS_LIB_ATTR_SUPPORTED_NEW_ALERT 1
+#define ANS_LIB_ATTR_NEW_ALERT_CCCD 2
+#define ANS_LIB_ATTR_SUPPORTED_UNREAD_ALERT 3
+#define ANS_LIB_ATTR_UNREAD_ALERT_CCCD 4
+#define ANS_LIB_ATTR_CONTROL_POINT 5
+
+/* ATT bearers of a connection, the legacy bearer first and then the Enhanced ATT bearers. The first
+ * EATT bearer is kept for urgent and high priority alerts while the client has others */
+#define ANS_LIB_BEARER_MAX (1 + WICED_BT_ANS_MAX_EATT_BEARERS)
+#define ANS_LIB_BEARER_LEGACY 0
+#define ANS_LIB_BEARER_URGENT 1
+#define ANS_LIB_BEARER_NONE 0xFF
+
+/* TX queue entry states */
+#define ANS_TX_ENTRY_FREE 0
+#define ANS_TX_ENTRY_QUEUED 1    /* waiting for a TX credit or for the link to decongest */
+#define ANS_TX_ENTRY_IN_FLIGHT 2 /* handed to the stack, waiting for GATT_APP_BUFFER_TRANSMITTED_EVT */
+
+/* ATT_MULTIPLE_HANDLE_VALUE_NTF of a New Alert and an Unread Alert Status, each value follows
+ * its handle and length */
+#define ANS_LIB_MULTI_NTF_TUPLE_HDR 4
+#define ANS_LIB_MULTI_NTF_MAX (2 * ANS_LIB_MULTI_NTF_TUPLE_HDR + ANS_LIB_TX_VALUE_MAX + 2)
+
+/* Credits kept for urgent and high priority notifications, so that bulk traffic of one
+ * client cannot hold back a call alert of another */
+#define ANS_LIB_TX_PRIORITY_RESERVE 1
+
+/* Rate limiter buckets count milli-tokens, one alert event of a category costs ANS_LIB_TOKEN */
+#define ANS_LIB_TOKEN 1000
+#define ANS_LIB_MS_PER_MINUTE 60000
+
+/* Latency histograms keep ANS_LIB_LAT_SUB_COUNT linear buckets for every power of two of microseconds,
+ * values below 2 * ANS_LIB_LAT_SUB_COUNT are exact and the others within 1 / ANS_LIB_LAT_SUB_COUNT.
+ * The last bucket takes everything from 2^(ANS_LIB_LAT_EXP_COUNT + ANS_LIB_LAT_SUB_BITS) us (~134 s) up */
+#define ANS_LIB_LAT_SUB_BITS 3
+#define ANS_LIB_LAT_SUB_COUNT (1 << ANS_LIB_LAT_SUB_BITS)
+#define ANS_LIB_LAT_EXP_COUNT 24
+#define ANS_LIB_LAT_BUCKETS ((ANS_LIB_LAT_EXP_COUNT + 1) * ANS_LIB_LAT_SUB_COUNT)
+
+/* Connection interval is reported in 1.25 ms units */
+#define ANS_LIB_CONN_INTERVAL_TO_US(interval) ((uint32_t)(interval) * 1250)
+
+/* Recorded in the trace ring of the calling thread and formatted in the background, see wiced_bt_ans_trace.h */
+#define ANS_TRACE_DBG(format, ...) ANS_TRACE(LIB, ANS_TRACE_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#define ANS_TRACE_ERR(format, ...) ANS_TRACE(LIB, ANS_TRACE_LEVEL_ERROR, format, ##__VA_ARGS__)
+
 /* Alerts count */
 typedef struct
 {
     uint8_t num_of_new_alerts;   /* New alerts count */
     uint8_t num_of_unread_count; /* Unread alerts count */
+    uint8_t text_id;             /* Text of the last new alert, ANS_LIB_TEXT_xxx or a text pool entry */
 } notify_data_cb_t;
 
+/* Text with its length, never rescanned once stored */
+typedef struct
+{
+    const char *p_text;
+    uint8_t len;
+} ans_lib_text_ref_t;
+
+/* Interned alert text */
+typedef struct
+{
+    uint32_t hash;                /* FNV-1a hash of the text */
+    uint32_t last_used;           /* Use stamp, the least recently used free entry is recycled first */
+    uint8_t in_use;               /* Entry holds a text */
+    uint8_t refs;                 /* Connection categories currently showing this text */
+    uint8_t len;                  /* Text length */
+    char text[ANS_LIB_TEXT_MAX];  /* Text, not NUL terminated */
+} ans_lib_text_t;
+
+/* Queued notification. The value buffer must stay untouched until the stack reports it transmitted */
+typedef struct
+{
+    uint8_t state;                        /* ANS_TX_ENTRY_xxx */
+    uint8_t category_id;                  /* Alert category carried in the value */
+    uint8_t priority;                     /* wiced_bt_ans_priority_t of the category, lower is sent first */
+    uint16_t handle;                      /* Characteristic value handle */
+    uint16_t len;                         /* Value length */
+    uint32_t seq;                         /* Enqueue order, breaks ties between entries due at the same time */
+    uint64_t due_us;                      /* Time in us the category deadline runs out, 0 for none */
+    uint64_t alert_us;                    /* Time the oldest alert carried in the value was counted */
+    uint64_t queued_us;                   /* Time the entry was queued */
+    uint64_t sent_us;                     /* Time the entry was handed to the stack */
+    uint64_t pair_alert_us;               /* alert_us of the entry sharing the multiple notification */
+    uint8_t pair_category_id;             /* Category of the entry sharing the multiple notification */
+    uint8_t multi_ntf;                    /* In flight as part of the connection multiple notification buffer */
+    uint8_t bearer;                       /* Bearer the entry is in flight on */
+    uint8_t value[ANS_LIB_TX_VALUE_MAX];  /* Characteristic value */
+} ans_lib_tx_entry_t;
+
+/* Slot of the conn_id index, a bearer conn_id points at the control block of its connection */
+typedef struct
+{
+    uint16_t conn_id; /* GATT connection identifier of the bearer */
+    uint8_t idx;      /* Index into conn[], ANS_LIB_CONN_INDEX_FREE for an empty slot */
+} ans_lib_conn_index_t;
+
+/* ATT bearer of a connection */
+typedef struct
+{
+    uint16_t conn_id;  /* GATT connection identifier of the bearer, 0 while closed */
+    uint16_t mtu;      /* Negotiated ATT MTU */
+    uint8_t congested; /* Stack reported the bearer congested, hold it until it clears */
+} ans_lib_bearer_t;
+
+/* Per connection state, one entry for every connected alert notification client */
 typedef struct
 {
     uint16_t conn_id; /* connection identifier */
 
-    uint16_t supported_new_alerts; /* Server supportable new alerts. Cannot be changed during connection
-                                      Each alert category represented using single bit.
-                                      wiced_bt_anp_alert_category_enable_t tells the bit index for different alerts */
+    uint8_t state; /* ANS state of this connection */
+
+    uint16_t conn_interval; /* Connection interval in 1.25 ms units, 0 until the application reports it */
+
+    uint16_t max_tx_octets; /* Link layer TX payload in bytes, 0 until the application reports it */
 
-    uint16_t supported_unread_alerts; /* Server supportable unread alerts. Cannot be changed during connection
-                                         Each alert category represented using single bit.
-                                          wiced_bt_anp_alert_category_enable_t tells the bit index for different alerts */
+
+    ans_lib_bearer_t bearer[ANS_LIB_BEARER_MAX]; /* Legacy ATT bearer and Enhanced ATT bearers */
+
+    uint8_t eatt_bearers; /* Enhanced ATT bearers open */
+
+    uint8_t multi_ntf; /* Client supports ATT_MULTIPLE_HANDLE_VALUE_NTF */
+
+    uint8_t multi_ntf_busy; /* multi_ntf_buf is in flight */
 
     uint16_t client_configured_new_alerts; /* Client configured new alerts.
                                               Each alert category represented using single bit.
@@ -82,304 +228,1741 @@ typedef struct
     uint16_t new_alert_cccd;           /* New alerts client cfg desc */
     uint16_t unread_alert_status_cccd; /* Unread alerts client cfg desc */
 
-    notify_data_cb_t notify_data[ANP_NOTIFY_CATEGORY_COUNT]; /* New alerts, unread alerts count */
+    uint8_t wait_encryption; /* State restored for a bonded client, notifications wait until the link is encrypted */
 
     uint16_t new_alert_not_sent; /* bitmask to tell new alert count changed but not updated to client for the category. wiced_bt_anp_alert_category_enable_t tells the bit index for different alerts */
 
     uint16_t unread_alert_status_not_sent; /* bitmask to tell unread alert count changed but not updated to client for the category. wiced_bt_anp_alert_category_enable_t tells the bit index for different alerts */
 
-    uint8_t state; /* ANS library current state */
+    notify_data_cb_t notify_data[ANP_NOTIFY_CATEGORY_COUNT]; /* New alerts, unread alerts count */
+
+    uint16_t new_alert_held;           /* new alert categories held back by the coalescing window or the rate limiter */
+    uint16_t unread_alert_status_held; /* unread alert categories held back by the coalescing window or the rate limiter */
+    uint16_t throttled_held;           /* categories held back because the rate limiter ran out of tokens */
+    uint16_t rate_paid;                /* categories that took their token in the current batch */
+
+    uint32_t hold_deadline[ANP_NOTIFY_CATEGORY_COUNT]; /* Time in ms to release the category, valid while it is held back */
+
+    uint32_t tokens[ANP_NOTIFY_CATEGORY_COUNT];    /* Rate limiter bucket of every category in milli-tokens */
+    uint32_t token_time[ANP_NOTIFY_CATEGORY_COUNT]; /* Time in ms the bucket was last refilled */
+    uint32_t throttled[ANP_NOTIFY_CATEGORY_COUNT];  /* Alerts deferred by the rate limiter */
+
+    uint16_t new_alert_retry;           /* new alert categories dropped on a full TX queue, resent when space frees up */
+    uint16_t unread_alert_status_retry; /* unread alert categories dropped on a full TX queue */
+
+    uint8_t tx_queued;    /* Entries waiting to be handed to the stack */
+    uint8_t tx_in_flight; /* Entries handed to the stack and not transmitted yet */
+    uint8_t tx_max_depth; /* High watermark of queued + in flight entries */
+    uint32_t tx_seq;      /* Next enqueue sequence number */
+    uint32_t tx_sent;     /* Notifications accepted by the stack */
+    uint32_t tx_drops;    /* Notifications dropped on a full queue or a stack error */
+    uint32_t tx_retries;  /* Sends deferred by congestion and retried later */
+    uint32_t tx_combined; /* New Alert and Unread Alert Status pairs sent in one PDU */
+
+    uint32_t deadline_misses[ANP_NOTIFY_CATEGORY_COUNT]; /* Notifications handed to the stack after their category deadline */
+
+    uint64_t alert_us[ANP_NOTIFY_CATEGORY_COUNT]; /* Time in us the oldest alert not sent yet of the category was counted */
+
+    ans_lib_tx_entry_t tx_queue[WICED_BT_ANS_TX_QUEUE_SIZE]; /* Notification TX queue */
+
+    uint8_t multi_ntf_buf[ANS_LIB_MULTI_NTF_MAX]; /* Handle value tuples of the multiple notification in flight */
+} ans_lib_conn_cb_t;
+
+/* Latency histogram of one stage of one category */
+typedef struct
+{
+    uint32_t count;                         /* Latencies recorded */
+    uint32_t min_us;                        /* Smallest latency */
+    uint32_t max_us;                        /* Largest latency */
+    uint32_t bucket[ANS_LIB_LAT_BUCKETS];   /* Latencies per bucket, see ans_lib_latency_bucket */
+} ans_lib_latency_t;
+
+typedef struct
+{
+    uint16_t supported_new_alerts; /* Server supportable new alerts. Cannot be changed during connection
+                                      Each alert category represented using single bit.
+                                      wiced_bt_anp_alert_category_enable_t tells the bit index for different alerts */
+
+    uint16_t supported_unread_alerts; /* Server supportable unread alerts. Cannot be changed during connection
+                                         Each alert category represented using single bit.
+                                          wiced_bt_anp_alert_category_enable_t tells the bit index for different alerts */
 
     wiced_bt_ans_gatt_handles_t gatt_handles; /* Alert GATT handles */
+
+    uint16_t attr_base; /* Lowest handle served by the library */
+
+    uint8_t attr_index[ANS_LIB_ATTR_SPAN]; /* ANS_LIB_ATTR_xxx of handle attr_base + index */
+
+    uint8_t num_connections; /* Number of connected alert notification clients */
+
+    uint8_t tx_credits; /* Notifications the library may still hand to the stack, shared by all connections
+                           as the controller LE ACL buffers are */
+
+    uint8_t tx_credits_max; /* Configured number of TX credits */
+
+    uint8_t tx_next_conn; /* Round robin start when credits are handed back */
+
+    ans_lib_conn_index_t conn_index[ANS_LIB_CONN_INDEX_SIZE]; /* Open addressed hash of the conn_id of every bearer */
+
+    uint16_t coalescing_window[ANP_NOTIFY_CATEGORY_COUNT]; /* Coalescing window per category in ms, 0 sends every alert */
+
+    uint8_t priority[ANP_NOTIFY_CATEGORY_COUNT]; /* wiced_bt_ans_priority_t of every category */
+
+    uint16_t deadline[ANP_NOTIFY_CATEGORY_COUNT]; /* Delivery deadline per category in ms, 0 for none */
+
+    uint8_t category_order[ANP_NOTIFY_CATEGORY_COUNT]; /* Category IDs sorted by priority, walked whenever several categories are sent */
+
+    uint16_t coalescing_align; /* Categories whose window is rounded up to whole connection intervals */
+
+    uint16_t rate_per_minute[ANP_NOTIFY_CATEGORY_COUNT]; /* Rate limit per category and connection, 0 for none */
+
+    uint8_t rate_burst[ANP_NOTIFY_CATEGORY_COUNT]; /* Notifications a category may send back to back */
+
+    wiced_bool_t hold_timer_running; /* Timer armed for hold_timer_deadline */
+
+    uint32_t hold_timer_deadline; /* Earliest release of a held back category in ms */
+
+    wiced_timer_t hold_timer; /* Fires when the earliest held back category is due */
+
+    wiced_bt_ans_client_state_cback_t p_client_state_cback; /* Restores the state of a bonded client on connection up */
+
+    wiced_bool_t catch_up; /* Send the pending alerts of a client once its link is encrypted */
+
+    uint8_t tx_batch; /* Nesting of sends whose draining is deferred, so related notifications can share a PDU */
+
+    uint32_t text_stamp; /* Use stamp of the text pool */
+
+    ans_lib_text_t text_pool[WICED_BT_ANS_TEXT_POOL_SIZE]; /* Interned alert texts */
+
+    ans_lib_latency_t latency[WICED_BT_ANS_LATENCY_STAGES][ANP_NOTIFY_CATEGORY_COUNT]; /* Alert latency per stage and category */
+
+    ans_lib_conn_cb_t conn[WICED_BT_ANS_MAX_CONNECTIONS]; /* Per connection control blocks */
 } ans_lib_cb_t;
 
 /* ANS library control block */
 ans_lib_cb_t ans_lib_cb;
 
-const char *ans_lib_new_alert_sample_text_str[ANP_NOTIFY_CATEGORY_COUNT] =
-    {
-        "simple_alert", /*Title ofsimple alert*/
-        "john",         /* Sender of Email */
-        "IOT era",      /* Title of the news feed */
-        "Bob",          /* Caller name : Incoming call*/
-        "Alice",        /* Caller Name :Missed call category*/
-        "Dev",          /* Sender Name: SMS/MMS category */
-        "George",       /*Sender Name: SMS/MMS: Voice mail category*/
-        "status_meet",  /* Title of the schedule: Schedule alert category*/
-        "Virus",        /* High Prioritized Aler - Title of the alert category */
-        "Mary",         /*Sender name: Instant message category*/
+#define ANS_LIB_TEXT(str) {str, sizeof(str) - 1}
+
+const ans_lib_text_ref_t ans_lib_new_alert_sample_text[ANP_NOTIFY_CATEGORY_COUNT] =
+    {
+        ANS_LIB_TEXT("simple_alert"), /*Title ofsimple alert*/
+        ANS_LIB_TEXT("john"),         /* Sender of Email */
+        ANS_LIB_TEXT("IOT era"),      /* Title of the news feed */
+        ANS_LIB_TEXT("Bob"),          /* Caller name : Incoming call*/
+        ANS_LIB_TEXT("Alice"),        /* Caller Name :Missed call category*/
+        ANS_LIB_TEXT("Dev"),          /* Sender Name: SMS/MMS category */
+        ANS_LIB_TEXT("George"),       /*Sender Name: SMS/MMS: Voice mail category*/
+        ANS_LIB_TEXT("status_meet"),  /* Title of the schedule: Schedule alert category*/
+        ANS_LIB_TEXT("Virus"),        /* High Prioritized Aler - Title of the alert category */
+        ANS_LIB_TEXT("Mary"),         /*Sender name: Instant message category*/
+};
+
+/* Default priority class of every category */
+const uint8_t ans_lib_default_priority[ANP_NOTIFY_CATEGORY_COUNT] =
+    {
+        WICED_BT_ANS_PRIORITY_NORMAL, /* Simple alert */
+        WICED_BT_ANS_PRIORITY_BULK,   /* Email */
+        WICED_BT_ANS_PRIORITY_BULK,   /* News */
+        WICED_BT_ANS_PRIORITY_URGENT, /* Call */
+        WICED_BT_ANS_PRIORITY_HIGH,   /* Missed call */
+        WICED_BT_ANS_PRIORITY_HIGH,   /* SMS/MMS */
+        WICED_BT_ANS_PRIORITY_HIGH,   /* Voice mail */
+        WICED_BT_ANS_PRIORITY_NORMAL, /* Schedule */
+        WICED_BT_ANS_PRIORITY_URGENT, /* High prioritized alert */
+        WICED_BT_ANS_PRIORITY_HIGH,   /* Instant message */
 };
 
-wiced_bt_gatt_status_t ans_lib_send_new_alert(uint16_t conn_id, uint8_t category_id)
+/* Monotonic time in ms, used for the coalescing windows. Wraps after ~49 days, compare with signed differences */
+uint32_t ans_lib_now_ms(void)
 {
-    wiced_bt_gatt_status_t status;
-    uint8_t new_alert[20];
+    struct timespec ts;
 
-    uint16_t val_len = 2 + strlen(ans_lib_new_alert_sample_text_str[category_id]);
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000);
+}
 
-    if (val_len > 20)
-        val_len = 20;
+/* Monotonic time in us, used for the alert latencies */
+uint64_t ans_lib_now_us(void)
+{
+    struct timespec ts;
 
-    new_alert[0] = category_id;
-    new_alert[1] = ans_lib_cb.notify_data[category_id].num_of_new_alerts;
-    memcpy(&new_alert[2], ans_lib_new_alert_sample_text_str[category_id], val_len - 2);
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
 
-    status = wiced_bt_gatt_server_send_notification(conn_id, ans_lib_cb.gatt_handles.new_alert.value, val_len, new_alert, NULL);
-    if (status == WICED_BT_GATT_SUCCESS)
-    {
-        ans_lib_cb.new_alert_not_sent &= (~(1 << category_id));
-    }
+/* Histogram bucket of a latency */
+uint16_t ans_lib_latency_bucket(uint64_t us)
+{
+    uint8_t exp;
+    uint32_t idx;
 
-    ANS_TRACE_DBG("cat:%d status:%x \n", category_id, status);
+    if (us < 2 * ANS_LIB_LAT_SUB_COUNT)
+        return (uint16_t)us;
 
-    return status;
+    /* the top ANS_LIB_LAT_SUB_BITS + 1 bits select the bucket */
+    exp = (uint8_t)(63 - __builtin_clzll(us) - ANS_LIB_LAT_SUB_BITS);
+    idx = (uint32_t)exp * ANS_LIB_LAT_SUB_COUNT + (uint32_t)(us >> exp);
+
+    return (idx < ANS_LIB_LAT_BUCKETS) ? (uint16_t)idx : (ANS_LIB_LAT_BUCKETS - 1);
 }
 
-wiced_bt_gatt_status_t ans_lib_send_unread_alert(uint16_t conn_id, uint8_t category_id)
+/* Largest latency falling into a histogram bucket */
+uint64_t ans_lib_latency_bucket_max(uint16_t idx)
 {
-    wiced_bt_gatt_status_t status;
-    uint8_t unread_alert[2];
+    uint8_t exp;
 
-    unread_alert[0] = category_id;
-    unread_alert[1] = ans_lib_cb.notify_data[category_id].num_of_unread_count;
+    if (idx < 2 * ANS_LIB_LAT_SUB_COUNT)
+        return idx;
 
-    status = wiced_bt_gatt_server_send_notification(conn_id, ans_lib_cb.gatt_handles.unread_alert.value, 2, unread_alert, NULL);
-    if (status == WICED_BT_GATT_SUCCESS)
+    exp = (uint8_t)(idx / ANS_LIB_LAT_SUB_COUNT - 1);
+    return (((uint64_t)(idx % ANS_LIB_LAT_SUB_COUNT + ANS_LIB_LAT_SUB_COUNT + 1)) << exp) - 1;
+}
+
+/* Record the latency of one stage of an alert, nothing when the start was not stamped */
+void ans_lib_latency_record(uint8_t stage, uint8_t category_id, uint64_t from_us, uint64_t to_us)
+{
+    ans_lib_latency_t *p_hist = &ans_lib_cb.latency[stage][category_id];
+    uint64_t us;
+
+    if ((from_us == 0) || (to_us < from_us))
+        return;
+
+    us = to_us - from_us;
+    p_hist->bucket[ans_lib_latency_bucket(us)]++;
+    if (us > 0xFFFFFFFF)
+        us = 0xFFFFFFFF;
+    if ((p_hist->count == 0) || (us < p_hist->min_us))
+        p_hist->min_us = (uint32_t)us;
+    if (us > p_hist->max_us)
+        p_hist->max_us = (uint32_t)us;
+    p_hist->count++;
+}
+
+/* Latency no more than per_mille of the recorded ones exceed, as the top of its bucket */
+uint32_t ans_lib_latency_percentile(ans_lib_latency_t *p_hist, uint32_t per_mille)
+{
+    uint64_t rank = ((uint64_t)p_hist->count * per_mille + 999) / 1000;
+    uint64_t seen = 0;
+    uint64_t us;
+    uint16_t idx;
+
+    for (idx = 0; idx < ANS_LIB_LAT_BUCKETS; idx++)
     {
-        ans_lib_cb.unread_alert_status_not_sent &= (~(1 << category_id));
+        seen += p_hist->bucket[idx];
+        if ((seen != 0) && (seen >= rank))
+            break;
     }
 
-    ANS_TRACE_DBG("cat:%d status:%x \n", category_id, status);
+    us = (idx < ANS_LIB_LAT_BUCKETS) ? ans_lib_latency_bucket_max(idx) : p_hist->max_us;
+    if (us > p_hist->max_us)
+        us = p_hist->max_us;
+    if (us < p_hist->min_us)
+        us = p_hist->min_us;
+    return (uint32_t)us;
+}
 
-    return status;
+/* An alert of the category is counted, its latency starts unless an older one is still pending */
+void ans_lib_latency_alert(ans_lib_conn_cb_t *p_conn, uint8_t category_id)
+{
+    if (!((p_conn->new_alert_not_sent | p_conn->unread_alert_status_not_sent) & (1 << category_id)))
+        p_conn->alert_us[category_id] = ans_lib_now_us();
 }
 
-void ans_lib_handle_new_alert_immediate_notify(uint16_t conn_id, uint8_t category_id)
+wiced_bool_t ans_lib_new_alert_enabled(ans_lib_conn_cb_t *p_conn, uint8_t category_id)
 {
-    if (ans_lib_cb.new_alert_cccd)
-    {
-        if ((category_id != 0xFF) &&
-            (ans_lib_cb.client_configured_new_alerts & (1 << category_id)) &&
-            (ans_lib_cb.new_alert_not_sent & (1 << category_id)))
-        {
-            ans_lib_send_new_alert(conn_id, category_id);
-        }
-        else if (category_id == 0xFF)
-        {
-            uint8_t cat;
-            for (cat = 0; cat < ANP_NOTIFY_CATEGORY_COUNT; cat++)
-            {
-                if ((ans_lib_cb.client_configured_new_alerts & (1 << cat)) &&
-                    (ans_lib_cb.new_alert_not_sent & (1 << cat)))
-                {
-                    ans_lib_send_new_alert(conn_id, cat);
-                }
-            }
-        }
-    }
+    return ((ans_lib_cb.supported_new_alerts & (1 << category_id)) &&
+            (p_conn->client_configured_new_alerts & (1 << category_id)) &&
+            (p_conn->new_alert_cccd) && !p_conn->wait_encryption) ? WICED_TRUE : WICED_FALSE;
 }
 
-void ans_lib_handle_unread_alert_immediate_notify(uint16_t conn_id, uint8_t category_id)
+wiced_bool_t ans_lib_unread_alert_enabled(ans_lib_conn_cb_t *p_conn, uint8_t category_id)
 {
-    if (ans_lib_cb.unread_alert_status_cccd)
-    {
-        if ((category_id != 0xFF) &&
-            (ans_lib_cb.client_configured_unread_alerts & (1 << category_id)) &&
-            (ans_lib_cb.unread_alert_status_not_sent & (1 << category_id)))
-        {
-            ans_lib_send_unread_alert(conn_id, category_id);
-        }
-        else if (category_id == 0xFF)
-        {
-            uint8_t cat;
-            for (cat = 0; cat < ANP_NOTIFY_CATEGORY_COUNT; cat++)
-            {
-                if ((ans_lib_cb.client_configured_unread_alerts & (1 << cat)) &&
-                    (ans_lib_cb.unread_alert_status_not_sent & (1 << cat)))
-                {
-                    ans_lib_send_unread_alert(conn_id, cat);
-                }
-            }
-        }
-    }
+    return ((ans_lib_cb.supported_unread_alerts & (1 << category_id)) &&
+            (p_conn->client_configured_unread_alerts & (1 << category_id)) &&
+            (p_conn->unread_alert_status_cccd) && !p_conn->wait_encryption) ? WICED_TRUE : WICED_FALSE;
 }
 
-wiced_bt_gatt_status_t ans_lib_handle_client_alert_notification_control_point_write(uint16_t conn_id, wiced_bt_anp_alert_control_cmd_id_t cmd_id,
-                                                                                    wiced_bt_anp_alert_category_id_t category_id)
+/* Rebuild the category walk order after a priority change, categories of one class keep their ID order */
+void ans_lib_sort_categories(void)
 {
-    wiced_bt_gatt_status_t status = WICED_BT_GATT_SUCCESS;
+    uint8_t priority;
+    uint8_t cat;
+    uint8_t n = 0;
 
-    if ((category_id != 0xFF) && (category_id >= ANP_NOTIFY_CATEGORY_COUNT))
+    for (priority = WICED_BT_ANS_PRIORITY_URGENT; priority <= WICED_BT_ANS_PRIORITY_BULK; priority++)
     {
-        if (cmd_id > ANP_ALERT_CONTROL_CMD_NOTIFY_UNREAD_ALERTS_IMMEDIATE)
+        for (cat = 0; cat < ANP_NOTIFY_CATEGORY_COUNT; cat++)
         {
-            ANS_TRACE_ERR("Wrong command ID: %d\n", cmd_id);
-            return ANP_ALERT_NOTIFCATION_CONTROL_POINT_WRITE_CMD_NOT_SUPPORTED;
+            if (ans_lib_cb.priority[cat] == priority)
+                ans_lib_cb.category_order[n++] = cat;
         }
-        return WICED_BT_GATT_INVALID_CFG;
     }
+}
 
-    switch (cmd_id)
-    {
-    case ANP_ALERT_CONTROL_CMD_ENABLE_NEW_ALERTS:
-        if (category_id == 0xFF)
-        {
-            ans_lib_cb.client_configured_new_alerts = ans_lib_cb.supported_new_alerts;
-        }
-        else
-        {
-            ans_lib_cb.client_configured_new_alerts |= (1 << category_id);
-        }
-        break;
+/* Longest prefix of a UTF-8 text that fits in max_len bytes without splitting a character */
+uint16_t ans_lib_utf8_trim(const char *p_text, uint16_t len, uint16_t max_len)
+{
+    if (len <= max_len)
+        return len;
 
-    case ANP_ALERT_CONTROL_CMD_ENABLE_UNREAD_STATUS:
-        if (category_id == 0xFF)
-        {
-            ans_lib_cb.client_configured_unread_alerts = ans_lib_cb.supported_unread_alerts;
-        }
-        else
-        {
-            ans_lib_cb.client_configured_unread_alerts |= (1 << category_id);
-        }
-        break;
+    /* p_text[max_len] is the first byte left out, step back while it continues a character */
+    len = max_len;
+    while ((len != 0) && ((p_text[len] & 0xC0) == 0x80))
+        len--;
 
-    case ANP_ALERT_CONTROL_CMD_DISABLE_NEW_ALERTS:
-        if (category_id == 0xFF)
-        {
-            ans_lib_cb.client_configured_new_alerts = 0;
-        }
-        else
+    return len;
+}
+
+uint32_t ans_lib_text_hash(const char *p_text, uint8_t len)
+{
+    uint32_t hash = 2166136261u;
+
+    while (len--)
+        hash = (hash ^ (uint8_t)*p_text++) * 16777619u;
+
+    return hash;
+}
+
+/* Find or store a text in the pool and return its ID. Repeated senders hit the stored copy */
+uint8_t ans_lib_text_intern(const char *p_text, uint16_t text_len)
+{
+    ans_lib_text_t *p_slot = NULL;
+    ans_lib_text_t *p_entry;
+    uint8_t len;
+    uint32_t hash;
+    uint8_t i;
+
+    if (p_text == NULL)
+        p_text = "";
+
+    len = (uint8_t)ans_lib_utf8_trim(p_text, text_len, ANS_LIB_TEXT_MAX);
+    hash = ans_lib_text_hash(p_text, len);
+
+    for (i = 0; i < WICED_BT_ANS_TEXT_POOL_SIZE; i++)
+    {
+        p_entry = &ans_lib_cb.text_pool[i];
+        if (!p_entry->in_use)
         {
-            ans_lib_cb.client_configured_new_alerts &= (~(1 << category_id));
+            if ((p_slot == NULL) || p_slot->in_use)
+                p_slot = p_entry;
+            continue;
         }
-        break;
-
-    case ANP_ALERT_CONTROL_CMD_DISABLE_UNREAD_ALERTS:
-        if (category_id == 0xFF)
+        if ((p_entry->hash == hash) && (p_entry->len == len) && (memcmp(p_entry->text, p_text, len) == 0))
         {
-            ans_lib_cb.client_configured_unread_alerts = 0;
+            p_entry->last_used = ans_lib_cb.text_stamp++;
+            return i + 1;
         }
-        else
+        /* recycle the least recently used text nobody shows any more */
+        if ((p_entry->refs == 0) &&
+            ((p_slot == NULL) || (p_slot->in_use && ((int32_t)(p_entry->last_used - p_slot->last_used) < 0))))
         {
-            ans_lib_cb.client_configured_unread_alerts &= (~(1 << category_id));
+            p_slot = p_entry;
         }
-        break;
-
-    case ANP_ALERT_CONTROL_CMD_NOTIFY_NEW_ALERTS_IMMEDIATE:
-        ans_lib_handle_new_alert_immediate_notify(conn_id, category_id);
-        break;
-
-    case ANP_ALERT_CONTROL_CMD_NOTIFY_UNREAD_ALERTS_IMMEDIATE:
-        ans_lib_handle_unread_alert_immediate_notify(conn_id, category_id);
-        break;
-
-    default:
-        status = ANP_ALERT_NOTIFCATION_CONTROL_POINT_WRITE_CMD_NOT_SUPPORTED;
-        break;
     }
 
-    if (status == WICED_BT_GATT_SUCCESS)
+    if (p_slot == NULL)
     {
-        ANS_TRACE_DBG("control_point_write:sup na:%x, sup ua:%x, client enabled:: na:%x, ua:%x \n",
-                      ans_lib_cb.supported_unread_alerts, ans_lib_cb.supported_unread_alerts,
-                      ans_lib_cb.client_configured_new_alerts, ans_lib_cb.client_configured_unread_alerts);
+        ANS_TRACE_ERR("text pool full\n");
+        return ANS_LIB_TEXT_EMPTY;
     }
 
-    return status;
+    p_slot->in_use = WICED_TRUE;
+    p_slot->hash = hash;
+    p_slot->len = len;
+    p_slot->last_used = ans_lib_cb.text_stamp++;
+    memcpy(p_slot->text, p_text, len);
+
+    return (uint8_t)(p_slot - ans_lib_cb.text_pool) + 1;
 }
 
-/* Initialize ANS library control block */
-wiced_result_t wiced_bt_ans_init(wiced_bt_ans_gatt_handles_t *p_gatt_handles)
+/* Show a text on a category of a connection, the text it showed before loses a reference */
+void ans_lib_text_assign(ans_lib_conn_cb_t *p_conn, uint8_t category_id, uint8_t text_id)
 {
-    if ((p_gatt_handles == NULL) ||
-        (p_gatt_handles->new_alert.supported_category == 0) ||
-        (p_gatt_handles->new_alert.configuration == 0) ||
-        (p_gatt_handles->new_alert.value == 0) ||
-        (p_gatt_handles->unread_alert.supported_category == 0) ||
-        (p_gatt_handles->unread_alert.configuration == 0) ||
-        (p_gatt_handles->unread_alert.value == 0))
-    {
-        ANS_TRACE_ERR("Wrong GATT Handle\n");
-        return WICED_BT_BADARG;
-    }
+    uint8_t old_id = p_conn->notify_data[category_id].text_id;
 
-    /* Clear the Alert Control Block */
-    memset(&ans_lib_cb, 0, sizeof(ans_lib_cb));
+    if ((text_id != ANS_LIB_TEXT_SAMPLE) && (text_id != ANS_LIB_TEXT_EMPTY))
+        ans_lib_cb.text_pool[text_id - 1].refs++;
 
-    /* Save the Alert GATT Handles */
-    memcpy(&ans_lib_cb.gatt_handles, p_gatt_handles, sizeof(ans_lib_cb.gatt_handles));
+    if ((old_id != ANS_LIB_TEXT_SAMPLE) && (old_id != ANS_LIB_TEXT_EMPTY))
+        ans_lib_cb.text_pool[old_id - 1].refs--;
 
-    return WICED_BT_SUCCESS;
+    p_conn->notify_data[category_id].text_id = text_id;
 }
 
-/* Application calls this API, when ANS server establish connection with ANC */
-void wiced_bt_ans_connection_up(uint16_t conn_id)
+/* Text shown on a category of a connection */
+ans_lib_text_ref_t ans_lib_text_get(ans_lib_conn_cb_t *p_conn, uint8_t category_id)
 {
-    ans_lib_cb.conn_id = conn_id;
-    ans_lib_cb.state = ANS_STATE_CONNECTED;
-}
+    uint8_t text_id = p_conn->notify_data[category_id].text_id;
+    ans_lib_text_ref_t text = {"", 0};
 
-/* Application calls this API, when ANS server disconnected from ANC */
-void wiced_bt_ans_connection_down(uint16_t conn_id)
-{
-    ans_lib_cb.conn_id = conn_id;
-    ans_lib_cb.state = ANS_STATE_DISCONNECTED;
+    if (text_id == ANS_LIB_TEXT_SAMPLE)
+    {
+        text = ans_lib_new_alert_sample_text[category_id];
+    }
+    else if (text_id != ANS_LIB_TEXT_EMPTY)
+    {
+        text.p_text = ans_lib_cb.text_pool[text_id - 1].text;
+        text.len = ans_lib_cb.text_pool[text_id - 1].len;
+    }
+    return text;
 }
 
-/* Application calls this API, when user configure the supportable new alerts*/
-void wiced_bt_ans_set_supported_new_alert_categories(uint16_t conn_id, wiced_bt_anp_alert_category_enable_t supported_new_alert_cat)
+/* Bearer of a connection with the given conn_id, ANS_LIB_BEARER_NONE if there is none */
+uint8_t ans_lib_find_bearer(ans_lib_conn_cb_t *p_conn, uint16_t conn_id)
 {
-    /* cannot be changed during connection */
-    if (ans_lib_cb.conn_id == 0)
+    uint8_t bearer;
+
+    for (bearer = 0; bearer < ANS_LIB_BEARER_MAX; bearer++)
     {
-        ans_lib_cb.supported_new_alerts = supported_new_alert_cat;
+        if ((conn_id != 0) && (p_conn->bearer[bearer].conn_id == conn_id))
+            return bearer;
     }
+    return ANS_LIB_BEARER_NONE;
 }
 
-/* Application calls this API, when user configure the supportable unread alerts*/
-void wiced_bt_ans_set_supported_unread_alert_categories(uint16_t conn_id, wiced_bt_anp_alert_category_enable_t supported_unread_alert_cat)
+/* Find the control block of a connection, returns NULL if conn_id is not connected. The conn_id of an
+ * Enhanced ATT bearer finds the connection it belongs to */
+ans_lib_conn_cb_t *ans_lib_find_conn_cb(uint16_t conn_id)
 {
-    /* cannot be changed during connection */
-    if (ans_lib_cb.conn_id == 0)
+    uint8_t pos = conn_id & ANS_LIB_CONN_INDEX_MASK;
+
+    while (ans_lib_cb.conn_index[pos].idx != ANS_LIB_CONN_INDEX_FREE)
     {
-        ans_lib_cb.supported_unread_alerts = supported_unread_alert_cat;
+        if (ans_lib_cb.conn_index[pos].conn_id == conn_id)
+            return &ans_lib_cb.conn[ans_lib_cb.conn_index[pos].idx];
+
+        pos = (pos + 1) & ANS_LIB_CONN_INDEX_MASK;
     }
+    return NULL;
 }
 
-/* Application calls this API, when ANC read the ANS services using GATT read operation */
-wiced_bt_gatt_status_t wiced_bt_ans_process_gatt_read_req(uint16_t conn_id, wiced_bt_gatt_read_t *p_read_hdr,
-                                                          uint8_t *p_read, uint16_t *p_read_len)
+/* Add the conn_id of a bearer of conn[idx] to the index */
+void ans_lib_conn_index_add(uint16_t conn_id, uint8_t idx)
 {
-    wiced_bt_gatt_status_t status = WICED_BT_GATT_SUCCESS;
+    uint8_t pos = conn_id & ANS_LIB_CONN_INDEX_MASK;
+
+    while (ans_lib_cb.conn_index[pos].idx != ANS_LIB_CONN_INDEX_FREE)
+        pos = (pos + 1) & ANS_LIB_CONN_INDEX_MASK;
+
+    ans_lib_cb.conn_index[pos].conn_id = conn_id;
+    ans_lib_cb.conn_index[pos].idx = idx;
+}
+
+/* Remove the conn_id of a bearer from the index. The index uses linear probing, so the
+ * entries following the freed one are shifted back to keep every probe sequence intact */
+void ans_lib_conn_index_remove(uint16_t conn_id)
+{
+    uint8_t pos = conn_id & ANS_LIB_CONN_INDEX_MASK;
+    uint8_t next;
+    uint8_t home;
 
-    if (p_read_hdr->handle == ans_lib_cb.gatt_handles.new_alert.supported_category)
+    while (ans_lib_cb.conn_index[pos].idx != ANS_LIB_CONN_INDEX_FREE)
     {
-        *p_read_len = 2;
-        memcpy(p_read, &ans_lib_cb.supported_new_alerts, 2);
+        if (ans_lib_cb.conn_index[pos].conn_id == conn_id)
+            break;
+        pos = (pos + 1) & ANS_LIB_CONN_INDEX_MASK;
     }
-    else if (p_read_hdr->handle == ans_lib_cb.gatt_handles.new_alert.configuration)
+    if (ans_lib_cb.conn_index[pos].idx == ANS_LIB_CONN_INDEX_FREE)
+        return;
+
+    next = pos;
+    for (;;)
     {
-        *p_read_len = 2;
-        memcpy(p_read, &ans_lib_cb.new_alert_cccd, 2);
+        ans_lib_cb.conn_index[pos].idx = ANS_LIB_CONN_INDEX_FREE;
+        for (;;)
+        {
+            next = (next + 1) & ANS_LIB_CONN_INDEX_MASK;
+            if (ans_lib_cb.conn_index[next].idx == ANS_LIB_CONN_INDEX_FREE)
+                return;
+
+            /* entry at next can move to pos only if its home slot is not in (pos, next] */
+            home = ans_lib_cb.conn_index[next].conn_id & ANS_LIB_CONN_INDEX_MASK;
+            if (((next - home) & ANS_LIB_CONN_INDEX_MASK) >= ((next - pos) & ANS_LIB_CONN_INDEX_MASK))
+                break;
+        }
+        ans_lib_cb.conn_index[pos] = ans_lib_cb.conn_index[next];
+        pos = next;
     }
-    else if (p_read_hdr->handle == ans_lib_cb.gatt_handles.unread_alert.supported_category)
+}
+
+/* Allocate a control block for a new connection and add it to the conn_id index */
+ans_lib_conn_cb_t *ans_lib_alloc_conn_cb(uint16_t conn_id)
+{
+    ans_lib_conn_cb_t *p_conn;
+    uint8_t idx;
+
+    if ((p_conn = ans_lib_find_conn_cb(conn_id)) != NULL)
+        return p_conn;
+
+    for (idx = 0; idx < WICED_BT_ANS_MAX_CONNECTIONS; idx++)
     {
-        *p_read_len = 2;
-        memcpy(p_read, &ans_lib_cb.supported_unread_alerts, 2);
+        if (ans_lib_cb.conn[idx].state == ANS_STATE_DISCONNECTED)
+            break;
     }
-    else if (p_read_hdr->handle == ans_lib_cb.gatt_handles.unread_alert.configuration)
+    if (idx == WICED_BT_ANS_MAX_CONNECTIONS)
+        return NULL;
+
+    p_conn = &ans_lib_cb.conn[idx];
+    memset(p_conn, 0, sizeof(*p_conn));
+    p_conn->conn_id = conn_id;
+    p_conn->state = ANS_STATE_CONNECTED;
+    p_conn->bearer[ANS_LIB_BEARER_LEGACY].conn_id = conn_id;
+    p_conn->bearer[ANS_LIB_BEARER_LEGACY].mtu = ANS_LIB_ATT_MTU_DEFAULT;
+
+    ans_lib_conn_index_add(conn_id, idx);
+
+    ans_lib_cb.num_connections++;
+    return p_conn;
+}
+
+/* Release a connection control block and drop the conn_id of all its bearers from the index */
+void ans_lib_free_conn_cb(ans_lib_conn_cb_t *p_conn)
+{
+    uint8_t bearer;
+    uint8_t cat;
+
+    for (bearer = 0; bearer < ANS_LIB_BEARER_MAX; bearer++)
+    {
+        if (p_conn->bearer[bearer].conn_id != 0)
+            ans_lib_conn_index_remove(p_conn->bearer[bearer].conn_id);
+    }
+
+    for (cat = 0; cat < ANP_NOTIFY_CATEGORY_COUNT; cat++)
+        ans_lib_text_assign(p_conn, cat, ANS_LIB_TEXT_SAMPLE);
+
+    /* buffers of a dropped link are not reported transmitted, take their credits back. Their entries are
+     * freed below, so a late transmitted event for one of them is ignored and cannot return a credit twice */
+    if (ans_lib_cb.tx_credits_max - ans_lib_cb.tx_credits > p_conn->tx_in_flight)
+        ans_lib_cb.tx_credits += p_conn->tx_in_flight;
+    else
+        ans_lib_cb.tx_credits = ans_lib_cb.tx_credits_max;
+    p_conn->tx_in_flight = 0;
+    p_conn->tx_queued = 0;
+    memset(p_conn->tx_queue, 0, sizeof(p_conn->tx_queue));
+
+    p_conn->state = ANS_STATE_DISCONNECTED;
+    ans_lib_cb.num_connections--;
+}
+
+/* Put a dropped category back to the pending state so that it is resent later */
+void ans_lib_tx_requeue_category(ans_lib_conn_cb_t *p_conn, ans_lib_tx_entry_t *p_entry)
+{
+    if (p_entry->handle == ans_lib_cb.gatt_handles.new_alert.value)
+    {
+        p_conn->new_alert_not_sent |= (1 << p_entry->category_id);
+        p_conn->new_alert_retry |= (1 << p_entry->category_id);
+    }
+    else
+    {
+        p_conn->unread_alert_status_not_sent |= (1 << p_entry->category_id);
+        p_conn->unread_alert_status_retry |= (1 << p_entry->category_id);
+    }
+}
+
+/* Entry p_a goes out before p_b: higher priority first, then earliest deadline, entries without a
+ * deadline after those with one, then oldest first */
+wiced_bool_t ans_lib_tx_before(ans_lib_tx_entry_t *p_a, ans_lib_tx_entry_t *p_b)
+{
+    if (p_a->priority != p_b->priority)
+        return (p_a->priority < p_b->priority) ? WICED_TRUE : WICED_FALSE;
+
+    if (p_a->due_us != p_b->due_us)
+    {
+        if ((p_a->due_us == 0) || (p_b->due_us == 0))
+            return (p_a->due_us != 0) ? WICED_TRUE : WICED_FALSE;
+        return (p_a->due_us < p_b->due_us) ? WICED_TRUE : WICED_FALSE;
+    }
+
+    return ((int32_t)(p_a->seq - p_b->seq) < 0) ? WICED_TRUE : WICED_FALSE;
+}
+
+/* Drop the queued notifications of a category, a newer count supersedes them */
+void ans_lib_tx_discard(ans_lib_conn_cb_t *p_conn, uint16_t handle, uint8_t category_id)
+{
+    uint8_t i;
+
+    for (i = 0; i < WICED_BT_ANS_TX_QUEUE_SIZE; i++)
+    {
+        if ((p_conn->tx_queue[i].state == ANS_TX_ENTRY_QUEUED) && (p_conn->tx_queue[i].handle == handle) &&
+            (p_conn->tx_queue[i].category_id == category_id))
+        {
+            p_conn->tx_queue[i].state = ANS_TX_ENTRY_FREE;
+            p_conn->tx_queued--;
+        }
+    }
+}
+
+/* Get a TX queue entry for a notification. On a full queue the newest entry of a lower priority
+ * class is pushed back to the pending state to make room */
+ans_lib_tx_entry_t *ans_lib_tx_alloc(ans_lib_conn_cb_t *p_conn, uint16_t handle, uint8_t category_id)
+{
+    ans_lib_tx_entry_t *p_free = NULL;
+    ans_lib_tx_entry_t *p_victim = NULL;
+    ans_lib_tx_entry_t *p_entry;
+    uint8_t priority = ans_lib_cb.priority[category_id];
+    uint8_t i;
+
+    for (i = 0; i < WICED_BT_ANS_TX_QUEUE_SIZE; i++)
+    {
+        p_entry = &p_conn->tx_queue[i];
+        if (p_entry->state == ANS_TX_ENTRY_QUEUED)
+        {
+            if ((p_entry->priority > priority) && ((p_victim == NULL) || ans_lib_tx_before(p_victim, p_entry)))
+                p_victim = p_entry;
+        }
+        else if ((p_entry->state == ANS_TX_ENTRY_FREE) && (p_free == NULL))
+        {
+            p_free = p_entry;
+        }
+    }
+
+    if ((p_free == NULL) && (p_victim != NULL))
+    {
+        ans_lib_tx_requeue_category(p_conn, p_victim);
+        p_conn->tx_queued--;
+        p_free = p_victim;
+    }
+
+    if (p_free != NULL)
+    {
+        p_free->state = ANS_TX_ENTRY_QUEUED;
+        p_free->handle = handle;
+        p_free->category_id = category_id;
+        p_free->priority = priority;
+        p_free->seq = p_conn->tx_seq++;
+        p_free->alert_us = p_conn->alert_us[category_id];
+        p_free->queued_us = ans_lib_now_us();
+        /* the deadline runs from the time the alert was raised, time spent held back or pending counts */
+        p_free->due_us = 0;
+        if (ans_lib_cb.deadline[category_id] != 0)
+        {
+            p_free->due_us = ((p_free->alert_us != 0) ? p_free->alert_us : p_free->queued_us) +
+                             (uint64_t)ans_lib_cb.deadline[category_id] * 1000;
+        }
+        p_free->pair_alert_us = 0;
+        p_conn->tx_queued++;
+        if (p_conn->tx_queued + p_conn->tx_in_flight > p_conn->tx_max_depth)
+            p_conn->tx_max_depth = p_conn->tx_queued + p_conn->tx_in_flight;
+    }
+    return p_free;
+}
+
+/* Next entry to send, the oldest of the highest priority class */
+ans_lib_tx_entry_t *ans_lib_tx_next(ans_lib_conn_cb_t *p_conn)
+{
+    ans_lib_tx_entry_t *p_next = NULL;
+    uint8_t i;
+
+    for (i = 0; i < WICED_BT_ANS_TX_QUEUE_SIZE; i++)
+    {
+        if ((p_conn->tx_queue[i].state == ANS_TX_ENTRY_QUEUED) &&
+            ((p_next == NULL) || ans_lib_tx_before(&p_conn->tx_queue[i], p_next)))
+        {
+            p_next = &p_conn->tx_queue[i];
+        }
+    }
+    return p_next;
+}
+
+/* Queued Unread Alert Status of the category of a New Alert, or the other way round, that can share
+ * a multiple notification with it */
+ans_lib_tx_entry_t *ans_lib_tx_pair(ans_lib_conn_cb_t *p_conn, ans_lib_tx_entry_t *p_entry)
+{
+    uint16_t handle;
+    uint8_t i;
+
+    if (!p_conn->multi_ntf || p_conn->multi_ntf_busy)
+        return NULL;
+
+    if (p_entry->handle == ans_lib_cb.gatt_handles.new_alert.value)
+        handle = ans_lib_cb.gatt_handles.unread_alert.value;
+    else if (p_entry->handle == ans_lib_cb.gatt_handles.unread_alert.value)
+        handle = ans_lib_cb.gatt_handles.new_alert.value;
+    else
+        return NULL;
+
+    for (i = 0; i < WICED_BT_ANS_TX_QUEUE_SIZE; i++)
+    {
+        if ((p_conn->tx_queue[i].state == ANS_TX_ENTRY_QUEUED) && (p_conn->tx_queue[i].handle == handle) &&
+            (p_conn->tx_queue[i].category_id == p_entry->category_id) &&
+            (1 + 2 * ANS_LIB_MULTI_NTF_TUPLE_HDR + p_entry->len + p_conn->tx_queue[i].len <=
+             p_conn->bearer[ANS_LIB_BEARER_LEGACY].mtu))
+        {
+            return &p_conn->tx_queue[i];
+        }
+    }
+    return NULL;
+}
+
+/* Send two queued values in one ATT_MULTIPLE_HANDLE_VALUE_NTF, p_entry is the application context */
+wiced_bt_gatt_status_t ans_lib_send_multi_ntf(ans_lib_conn_cb_t *p_conn, uint16_t conn_id,
+                                              ans_lib_tx_entry_t *p_entry, ans_lib_tx_entry_t *p_pair)
+{
+    ans_lib_tx_entry_t *p_tuple[2] = {p_entry, p_pair};
+    uint8_t *p = p_conn->multi_ntf_buf;
+    uint8_t i;
+
+    for (i = 0; i < 2; i++)
+    {
+        *p++ = (uint8_t)p_tuple[i]->handle;
+        *p++ = (uint8_t)(p_tuple[i]->handle >> 8);
+        *p++ = (uint8_t)p_tuple[i]->len;
+        *p++ = (uint8_t)(p_tuple[i]->len >> 8);
+        memcpy(p, p_tuple[i]->value, p_tuple[i]->len);
+        p += p_tuple[i]->len;
+    }
+
+    return wiced_bt_gatt_server_send_multiple_notifications(conn_id, (int16_t)(p - p_conn->multi_ntf_buf),
+                                                            p_conn->multi_ntf_buf, p_entry);
+}
+
+/* Count a queued entry handed to the stack */
+void ans_lib_tx_sent(ans_lib_conn_cb_t *p_conn, ans_lib_tx_entry_t *p_entry)
+{
+    p_conn->tx_queued--;
+    p_conn->tx_sent++;
+
+    p_entry->sent_us = ans_lib_now_us();
+    ans_lib_latency_record(WICED_BT_ANS_LATENCY_HOLD, p_entry->category_id, p_entry->alert_us, p_entry->queued_us);
+    ans_lib_latency_record(WICED_BT_ANS_LATENCY_QUEUE, p_entry->category_id, p_entry->queued_us, p_entry->sent_us);
+
+    if ((p_entry->due_us != 0) && (p_entry->sent_us > p_entry->due_us))
+    {
+        p_conn->deadline_misses[p_entry->category_id]++;
+    }
+}
+
+/* A bearer that is open, not congested and takes a PDU of pdu_len bytes */
+wiced_bool_t ans_lib_bearer_ready(ans_lib_bearer_t *p_bearer, uint16_t pdu_len)
+{
+    return ((p_bearer->conn_id != 0) && !p_bearer->congested && (pdu_len <= p_bearer->mtu)) ? WICED_TRUE : WICED_FALSE;
+}
+
+/* Bearer to send an entry on. Urgent and high priority alerts start on the first EATT bearer, the others on
+ * the bearer of their characteristic, and a busy bearer hands over to the next one. The first EATT bearer
+ * carries nothing else while it is open next to other open EATT bearers, so that a bulk backlog never
+ * delays a call. The legacy bearer also carries the requests and indications, it takes what no EATT
+ * bearer can */
+uint8_t ans_lib_tx_bearer(ans_lib_conn_cb_t *p_conn, ans_lib_tx_entry_t *p_entry, uint16_t pdu_len)
+{
+    uint8_t num_eatt = WICED_BT_ANS_MAX_EATT_BEARERS;
+    wiced_bool_t reserved = ((p_conn->eatt_bearers > 1) && (p_conn->bearer[ANS_LIB_BEARER_URGENT].conn_id != 0) &&
+                             (p_entry->priority > WICED_BT_ANS_PRIORITY_HIGH)) ? WICED_TRUE : WICED_FALSE;
+    uint8_t first = ANS_LIB_BEARER_URGENT;
+    uint8_t bearer;
+    uint8_t i;
+
+    if (p_conn->eatt_bearers != 0)
+    {
+        if (reserved)
+            first = ANS_LIB_BEARER_URGENT + 1 +
+                    ((p_entry->handle == ans_lib_cb.gatt_handles.unread_alert.value) ? 1 : 0) % (num_eatt - 1);
+
+        for (i = 0; i < num_eatt; i++)
+        {
+            bearer = ANS_LIB_BEARER_URGENT + (first - ANS_LIB_BEARER_URGENT + i) % num_eatt;
+            if ((bearer == ANS_LIB_BEARER_URGENT) && reserved)
+                continue;
+            if (ans_lib_bearer_ready(&p_conn->bearer[bearer], pdu_len))
+                return bearer;
+        }
+    }
+
+    if (ans_lib_bearer_ready(&p_conn->bearer[ANS_LIB_BEARER_LEGACY], pdu_len))
+        return ANS_LIB_BEARER_LEGACY;
+
+    return ANS_LIB_BEARER_NONE;
+}
+
+/* Hand queued notifications to the stack while TX credits last and a bearer takes them */
+void ans_lib_tx_drain(ans_lib_conn_cb_t *p_conn)
+{
+    ans_lib_tx_entry_t *p_entry;
+    ans_lib_tx_entry_t *p_pair;
+    wiced_bt_gatt_status_t status;
+    uint16_t conn_id;
+    uint8_t bearer;
+
+    if (ans_lib_cb.tx_batch)
+        return;
+
+    while ((ans_lib_cb.tx_credits != 0) && ((p_entry = ans_lib_tx_next(p_conn)) != NULL))
+    {
+        if ((p_entry->priority > WICED_BT_ANS_PRIORITY_HIGH) &&
+            (ans_lib_cb.tx_credits <= ANS_LIB_TX_PRIORITY_RESERVE) &&
+            (ans_lib_cb.tx_credits_max > ANS_LIB_TX_PRIORITY_RESERVE))
+        {
+            break;
+        }
+
+        /* a pair no open bearer has room for goes out as two notifications */
+        p_pair = ans_lib_tx_pair(p_conn, p_entry);
+        if ((p_pair != NULL) &&
+            ((bearer = ans_lib_tx_bearer(p_conn, p_entry, 1 + 2 * ANS_LIB_MULTI_NTF_TUPLE_HDR + p_entry->len +
+                                                          p_pair->len)) == ANS_LIB_BEARER_NONE))
+        {
+            p_pair = NULL;
+        }
+        if ((p_pair == NULL) &&
+            ((bearer = ans_lib_tx_bearer(p_conn, p_entry, ANS_LIB_ATT_NTF_HDR + p_entry->len)) == ANS_LIB_BEARER_NONE))
+        {
+            break;
+        }
+        conn_id = p_conn->bearer[bearer].conn_id;
+
+        /* the entry is the application context, it comes back with GATT_APP_BUFFER_TRANSMITTED_EVT */
+        if (p_pair != NULL)
+            status = ans_lib_send_multi_ntf(p_conn, conn_id, p_entry, p_pair);
+        else
+            status = wiced_bt_gatt_server_send_notification(conn_id, p_entry->handle, p_entry->len,
+                                                            p_entry->value, p_entry);
+        if (status == WICED_BT_GATT_SUCCESS)
+        {
+            p_entry->state = ANS_TX_ENTRY_IN_FLIGHT;
+            p_entry->bearer = bearer;
+            p_conn->tx_in_flight++;
+            ans_lib_cb.tx_credits--;
+            ans_lib_tx_sent(p_conn, p_entry);
+
+            /* the pair travels in multi_ntf_buf, its entry is free already */
+            if (p_pair != NULL)
+            {
+                p_entry->multi_ntf = WICED_TRUE;
+                p_conn->multi_ntf_busy = WICED_TRUE;
+                p_conn->tx_combined++;
+                p_pair->state = ANS_TX_ENTRY_FREE;
+                ans_lib_tx_sent(p_conn, p_pair);
+                p_entry->pair_alert_us = p_pair->alert_us;
+                p_entry->pair_category_id = p_pair->category_id;
+            }
+        }
+        else if ((status == WICED_BT_GATT_CONGESTED) || (status == WICED_BT_GATT_NO_RESOURCES) ||
+                 (status == WICED_BT_GATT_BUSY))
+        {
+            /* keep the entry for another bearer, the stack tells us when this one can take more */
+            p_conn->bearer[bearer].congested = WICED_TRUE;
+            p_conn->tx_retries++;
+        }
+        else
+        {
+            ANS_TRACE_ERR("conn_id:%d handle:%04x status:%x\n", conn_id, p_entry->handle, status);
+            ans_lib_tx_requeue_category(p_conn, p_entry);
+            p_entry->state = ANS_TX_ENTRY_FREE;
+            p_conn->tx_queued--;
+            p_conn->tx_drops++;
+        }
+    }
+}
+
+/* Drain every connection, starting after the one served last so that credits are shared fairly */
+void ans_lib_tx_drain_all(void)
+{
+    uint8_t i;
+    uint8_t idx;
+
+    for (i = 0; (i < WICED_BT_ANS_MAX_CONNECTIONS) && (ans_lib_cb.tx_credits != 0); i++)
+    {
+        idx = (ans_lib_cb.tx_next_conn + i) % WICED_BT_ANS_MAX_CONNECTIONS;
+        if (ans_lib_cb.conn[idx].state == ANS_STATE_CONNECTED)
+            ans_lib_tx_drain(&ans_lib_cb.conn[idx]);
+    }
+    ans_lib_cb.tx_next_conn = (ans_lib_cb.tx_next_conn + 1) % WICED_BT_ANS_MAX_CONNECTIONS;
+}
+
+/* Largest New Alert value on the legacy bearer of a connection. Once the data length is known the value
+ * also fits one link layer packet, a longer text would only cost more packets and airtime */
+uint16_t ans_lib_ntf_value_max(ans_lib_conn_cb_t *p_conn)
+{
+    uint16_t value_max = p_conn->bearer[ANS_LIB_BEARER_LEGACY].mtu - ANS_LIB_ATT_NTF_HDR;
+
+    /* a data length below the 27 bytes every link supports is ignored, like an MTU below the default */
+    if ((p_conn->max_tx_octets >= ANS_LIB_ATT_MTU_DEFAULT + ANS_LIB_L2CAP_HDR) &&
+        (value_max > p_conn->max_tx_octets - ANS_LIB_L2CAP_HDR - ANS_LIB_ATT_NTF_HDR))
+    {
+        value_max = p_conn->max_tx_octets - ANS_LIB_L2CAP_HDR - ANS_LIB_ATT_NTF_HDR;
+    }
+
+    return (value_max > ANS_LIB_TX_VALUE_MAX) ? ANS_LIB_TX_VALUE_MAX : value_max;
+}
+
+/* Send a New Alert. The Alert Notification Service has no way to continue a text in another notification,
+ * every New Alert is an alert of its own to the client, so text longer than the value is truncated on a
+ * character boundary */
+wiced_bt_gatt_status_t ans_lib_send_new_alert(ans_lib_conn_cb_t *p_conn, uint8_t category_id)
+{
+    wiced_bt_gatt_status_t status = WICED_BT_GATT_SUCCESS;
+    ans_lib_tx_entry_t *p_entry;
+    ans_lib_text_ref_t text = ans_lib_text_get(p_conn, category_id);
+    uint16_t handle = ans_lib_cb.gatt_handles.new_alert.value;
+    uint16_t text_max = ans_lib_ntf_value_max(p_conn) - 2;
+    uint16_t text_len = text.len;
+
+    ans_lib_tx_discard(p_conn, handle, category_id);
+
+    if (text_len > text_max)
+    {
+        text_len = ans_lib_utf8_trim(text.p_text, text.len, text_max);
+        if (text_len == 0)
+            text_len = text_max; /* not UTF-8, cut anywhere */
+    }
+
+    if ((p_entry = ans_lib_tx_alloc(p_conn, handle, category_id)) == NULL)
+    {
+        /* queue full, the category stays pending and is retried once entries free up */
+        status = WICED_BT_GATT_NO_RESOURCES;
+        p_conn->new_alert_not_sent |= (1 << category_id);
+        p_conn->new_alert_retry |= (1 << category_id);
+        p_conn->tx_drops++;
+        ANS_PROBE(new_alert_failed, p_conn->conn_id, category_id, status);
+    }
+    else
+    {
+        p_entry->value[0] = category_id;
+        p_entry->value[1] = p_conn->notify_data[category_id].num_of_new_alerts;
+        memcpy(&p_entry->value[2], text.p_text, text_len);
+        p_entry->len = 2 + text_len;
+
+        p_conn->new_alert_not_sent &= (~(1 << category_id));
+        p_conn->new_alert_retry &= (~(1 << category_id));
+        p_conn->new_alert_held &= (~(1 << category_id));
+        ANS_PROBE(new_alert_sent, p_conn->conn_id, category_id, status);
+        ans_lib_tx_drain(p_conn);
+    }
+
+    ANS_TRACE_DBG("conn_id:%d cat:%d text:%d of %d status:%x \n", p_conn->conn_id, category_id, text_len, text.len,
+                  status);
+
+    return status;
+}
+
+wiced_bt_gatt_status_t ans_lib_send_unread_alert(ans_lib_conn_cb_t *p_conn, uint8_t category_id)
+{
+    wiced_bt_gatt_status_t status = WICED_BT_GATT_SUCCESS;
+    ans_lib_tx_entry_t *p_entry;
+
+    ans_lib_tx_discard(p_conn, ans_lib_cb.gatt_handles.unread_alert.value, category_id);
+    p_entry = ans_lib_tx_alloc(p_conn, ans_lib_cb.gatt_handles.unread_alert.value, category_id);
+    if (p_entry == NULL)
     {
-        *p_read_len = 2;
-        memcpy(p_read, &ans_lib_cb.unread_alert_status_cccd, 2);
+        p_conn->unread_alert_status_not_sent |= (1 << category_id);
+        p_conn->unread_alert_status_retry |= (1 << category_id);
+        p_conn->tx_drops++;
+        status = WICED_BT_GATT_NO_RESOURCES;
+        ANS_PROBE(unread_alert_failed, p_conn->conn_id, category_id, status);
     }
     else
     {
-        status = WICED_BT_GATT_READ_NOT_PERMIT;
+        p_entry->value[0] = category_id;
+        p_entry->value[1] = p_conn->notify_data[category_id].num_of_unread_count;
+        p_entry->len = 2;
+
+        p_conn->unread_alert_status_not_sent &= (~(1 << category_id));
+        p_conn->unread_alert_status_retry &= (~(1 << category_id));
+        p_conn->unread_alert_status_held &= (~(1 << category_id));
+        ANS_PROBE(unread_alert_sent, p_conn->conn_id, category_id, status);
+        ans_lib_tx_drain(p_conn);
+    }
+
+    ANS_TRACE_DBG("conn_id:%d cat:%d status:%x \n", p_conn->conn_id, category_id, status);
+
+    return status;
+}
+
+/* Resend the categories that were dropped on a full TX queue, as long as the client still wants them */
+void ans_lib_tx_retry(ans_lib_conn_cb_t *p_conn)
+{
+    uint8_t cat;
+    uint8_t i;
+
+    for (i = 0; (i < ANP_NOTIFY_CATEGORY_COUNT) && (p_conn->tx_queued + p_conn->tx_in_flight < WICED_BT_ANS_TX_QUEUE_SIZE); i++)
+    {
+        cat = ans_lib_cb.category_order[i];
+        if (p_conn->new_alert_retry & (1 << cat))
+        {
+            p_conn->new_alert_retry &= (~(1 << cat));
+            if (ans_lib_new_alert_enabled(p_conn, cat) && (p_conn->new_alert_not_sent & (1 << cat)))
+            {
+                ans_lib_send_new_alert(p_conn, cat);
+            }
+        }
+        if (p_conn->unread_alert_status_retry & (1 << cat))
+        {
+            p_conn->unread_alert_status_retry &= (~(1 << cat));
+            if (ans_lib_unread_alert_enabled(p_conn, cat) && (p_conn->unread_alert_status_not_sent & (1 << cat)))
+            {
+                ans_lib_send_unread_alert(p_conn, cat);
+            }
+        }
+    }
+}
+
+/* Take count tokens from the rate limiter bucket of a category. When the bucket runs short nothing is
+ * taken and *p_wait_ms tells when enough tokens will be there */
+wiced_bool_t ans_lib_rate_take(ans_lib_conn_cb_t *p_conn, uint8_t category_id, uint8_t count, uint32_t now,
+                               uint32_t *p_wait_ms)
+{
+    uint32_t rate = ans_lib_cb.rate_per_minute[category_id];
+    uint32_t burst = (uint32_t)ans_lib_cb.rate_burst[category_id] * ANS_LIB_TOKEN;
+    uint32_t need = (uint32_t)count * ANS_LIB_TOKEN;
+    uint64_t refill;
+
+    if (rate == 0)
+        return WICED_TRUE;
+
+    /* rate per minute is rate milli-tokens per 60 ms */
+    refill = ((uint64_t)(uint32_t)(now - p_conn->token_time[category_id]) * rate) / (ANS_LIB_MS_PER_MINUTE / ANS_LIB_TOKEN);
+    if (refill != 0)
+    {
+        p_conn->token_time[category_id] = now;
+        refill += p_conn->tokens[category_id];
+        p_conn->tokens[category_id] = (refill > burst) ? burst : (uint32_t)refill;
+    }
+
+    if (need > burst)
+        need = burst;
+
+    if (p_conn->tokens[category_id] >= need)
+    {
+        p_conn->tokens[category_id] -= need;
+        return WICED_TRUE;
+    }
+
+    *p_wait_ms = ((need - p_conn->tokens[category_id]) * (ANS_LIB_MS_PER_MINUTE / ANS_LIB_TOKEN) + rate - 1) / rate;
+    return WICED_FALSE;
+}
+
+/* Fill the buckets of a new connection */
+void ans_lib_rate_reset(ans_lib_conn_cb_t *p_conn)
+{
+    uint32_t now = ans_lib_now_ms();
+    uint8_t cat;
+
+    for (cat = 0; cat < ANP_NOTIFY_CATEGORY_COUNT; cat++)
+    {
+        p_conn->tokens[cat] = (uint32_t)ans_lib_cb.rate_burst[cat] * ANS_LIB_TOKEN;
+        p_conn->token_time[cat] = now;
+    }
+}
+
+/* Arm the hold timer for the earliest release, or stop it when nothing is held back */
+void ans_lib_hold_timer_update(void)
+{
+    wiced_bool_t found = WICED_FALSE;
+    uint32_t earliest = 0;
+    uint32_t now;
+    uint8_t idx;
+    uint8_t cat;
+
+    for (idx = 0; idx < WICED_BT_ANS_MAX_CONNECTIONS; idx++)
+    {
+        ans_lib_conn_cb_t *p_conn = &ans_lib_cb.conn[idx];
+        uint16_t held = p_conn->new_alert_held | p_conn->unread_alert_status_held;
+
+        if ((p_conn->state != ANS_STATE_CONNECTED) || (held == 0))
+            continue;
+
+        for (cat = 0; cat < ANP_NOTIFY_CATEGORY_COUNT; cat++)
+        {
+            if ((held & (1 << cat)) &&
+                ((!found) || ((int32_t)(p_conn->hold_deadline[cat] - earliest) < 0)))
+            {
+                earliest = p_conn->hold_deadline[cat];
+                found = WICED_TRUE;
+            }
+        }
+    }
+
+    if (!found)
+    {
+        if (ans_lib_cb.hold_timer_running)
+            wiced_stop_timer(&ans_lib_cb.hold_timer);
+        ans_lib_cb.hold_timer_running = WICED_FALSE;
+        return;
+    }
+
+    if (ans_lib_cb.hold_timer_running && (ans_lib_cb.hold_timer_deadline == earliest))
+        return;
+
+    now = ans_lib_now_ms();
+    ans_lib_cb.hold_timer_deadline = earliest;
+    ans_lib_cb.hold_timer_running = WICED_TRUE;
+    wiced_start_timer(&ans_lib_cb.hold_timer,
+                      ((int32_t)(earliest - now) > 0) ? (earliest - now) : 1);
+}
+
+/* Send the final count of every category whose coalescing window has ended. On a connection with a
+ * known interval, windows ending within the next connection event go out together with the expired ones */
+void ans_lib_hold_timeout(WICED_TIMER_PARAM_TYPE param)
+{
+    uint32_t now = ans_lib_now_ms();
+    uint32_t wait_ms;
+    uint32_t slack;
+    uint16_t held;
+    uint8_t idx;
+    uint8_t cat;
+    uint8_t i;
+
+    (void)param;
+    ans_lib_cb.hold_timer_running = WICED_FALSE;
+
+    /* queue the whole flush first, so that both notifications of a category can share a PDU */
+    ans_lib_cb.tx_batch++;
+    for (idx = 0; idx < WICED_BT_ANS_MAX_CONNECTIONS; idx++)
+    {
+        ans_lib_conn_cb_t *p_conn = &ans_lib_cb.conn[idx];
+
+        held = p_conn->new_alert_held | p_conn->unread_alert_status_held;
+        if ((p_conn->state != ANS_STATE_CONNECTED) || (held == 0))
+            continue;
+
+        slack = ANS_LIB_CONN_INTERVAL_TO_US(p_conn->conn_interval) / 1000;
+
+        for (i = 0; i < ANP_NOTIFY_CATEGORY_COUNT; i++)
+        {
+            cat = ans_lib_cb.category_order[i];
+            if (!(held & (1 << cat)))
+                continue;
+
+            if ((int32_t)(p_conn->hold_deadline[cat] - now) >
+                (int32_t)(((ans_lib_cb.coalescing_align & (1 << cat))) ? slack : 0))
+                continue;
+
+            /* the flush is one event of the category whether it carries one or both values, it costs one token */
+            if (!ans_lib_rate_take(p_conn, cat, 1, now, &wait_ms))
+            {
+                p_conn->hold_deadline[cat] = now + wait_ms;
+                p_conn->throttled_held |= (1 << cat);
+                continue;
+            }
+            p_conn->throttled_held &= (~(1 << cat));
+
+            if (p_conn->new_alert_held & (1 << cat))
+            {
+                p_conn->new_alert_held &= (~(1 << cat));
+                if (ans_lib_new_alert_enabled(p_conn, cat) && (p_conn->new_alert_not_sent & (1 << cat)))
+                    ans_lib_send_new_alert(p_conn, cat);
+            }
+            if (p_conn->unread_alert_status_held & (1 << cat))
+            {
+                p_conn->unread_alert_status_held &= (~(1 << cat));
+                if (ans_lib_unread_alert_enabled(p_conn, cat) && (p_conn->unread_alert_status_not_sent & (1 << cat)))
+                    ans_lib_send_unread_alert(p_conn, cat);
+            }
+        }
+    }
+    ans_lib_cb.tx_batch--;
+    ans_lib_tx_drain_all();
+
+    ans_lib_hold_timer_update();
+}
+
+/* Decide whether an alert goes out now. Returns WICED_TRUE when the alert must be held back, either for the
+ * coalescing window of its category or because the rate limiter of its category has no token left */
+wiced_bool_t ans_lib_hold(ans_lib_conn_cb_t *p_conn, uint8_t category_id)
+{
+    uint32_t window_us;
+    uint32_t interval_us;
+    uint32_t wait_ms;
+    uint32_t now;
+
+    /* an open window or an empty bucket just keeps accumulating the count */
+    if ((p_conn->new_alert_held | p_conn->unread_alert_status_held) & (1 << category_id))
+    {
+        if (p_conn->throttled_held & (1 << category_id))
+            p_conn->throttled[category_id]++;
+        return WICED_TRUE;
+    }
+    p_conn->throttled_held &= (~(1 << category_id));
+
+    if (ans_lib_cb.coalescing_window[category_id] == 0)
+    {
+        /* the New Alert and Unread Alert Status of one event are counted in one batch and share a token */
+        if (p_conn->rate_paid & (1 << category_id))
+            return WICED_FALSE;
+
+        now = ans_lib_now_ms();
+        if (ans_lib_rate_take(p_conn, category_id, 1, now, &wait_ms))
+        {
+            if (ans_lib_cb.tx_batch != 0)
+                p_conn->rate_paid |= (1 << category_id);
+            return WICED_FALSE;
+        }
+
+        p_conn->hold_deadline[category_id] = now + wait_ms;
+        p_conn->throttled_held |= (1 << category_id);
+        p_conn->throttled[category_id]++;
+        return WICED_TRUE;
+    }
+
+    window_us = (uint32_t)ans_lib_cb.coalescing_window[category_id] * 1000;
+    interval_us = ANS_LIB_CONN_INTERVAL_TO_US(p_conn->conn_interval);
+    if ((ans_lib_cb.coalescing_align & (1 << category_id)) && (interval_us != 0))
+    {
+        window_us = ((window_us + interval_us - 1) / interval_us) * interval_us;
+    }
+
+    p_conn->hold_deadline[category_id] = ans_lib_now_ms() + (window_us + 999) / 1000;
+    return WICED_TRUE;
+}
+
+void ans_lib_handle_new_alert_immediate_notify(ans_lib_conn_cb_t *p_conn, uint8_t category_id)
+{
+    if (p_conn->new_alert_cccd && !p_conn->wait_encryption)
+    {
+        if ((category_id != 0xFF) &&
+            (p_conn->client_configured_new_alerts & (1 << category_id)) &&
+            (p_conn->new_alert_not_sent & (1 << category_id)))
+        {
+            ans_lib_send_new_alert(p_conn, category_id);
+        }
+        else if (category_id == 0xFF)
+        {
+            uint8_t cat;
+            uint8_t i;
+
+            /* highest priority class first, so a call is not queued behind news and email */
+            for (i = 0; i < ANP_NOTIFY_CATEGORY_COUNT; i++)
+            {
+                cat = ans_lib_cb.category_order[i];
+                if ((p_conn->client_configured_new_alerts & (1 << cat)) &&
+                    (p_conn->new_alert_not_sent & (1 << cat)))
+                {
+                    ans_lib_send_new_alert(p_conn, cat);
+                }
+            }
+        }
+    }
+}
+
+void ans_lib_handle_unread_alert_immediate_notify(ans_lib_conn_cb_t *p_conn, uint8_t category_id)
+{
+    if (p_conn->unread_alert_status_cccd && !p_conn->wait_encryption)
+    {
+        if ((category_id != 0xFF) &&
+            (p_conn->client_configured_unread_alerts & (1 << category_id)) &&
+            (p_conn->unread_alert_status_not_sent & (1 << category_id)))
+        {
+            ans_lib_send_unread_alert(p_conn, category_id);
+        }
+        else if (category_id == 0xFF)
+        {
+            uint8_t cat;
+            uint8_t i;
+
+            /* highest priority class first, so a call is not queued behind news and email */
+            for (i = 0; i < ANP_NOTIFY_CATEGORY_COUNT; i++)
+            {
+                cat = ans_lib_cb.category_order[i];
+                if ((p_conn->client_configured_unread_alerts & (1 << cat)) &&
+                    (p_conn->unread_alert_status_not_sent & (1 << cat)))
+                {
+                    ans_lib_send_unread_alert(p_conn, cat);
+                }
+            }
+        }
+    }
+}
+
+/* Send every category the client missed, counts as they are now, in one batch. A category's new alert and
+ * unread status are queued back to back so they can share a PDU, the highest priority category goes first */
+void ans_lib_catch_up(ans_lib_conn_cb_t *p_conn)
+{
+    uint8_t cat;
+    uint8_t i;
+
+    if ((p_conn->new_alert_not_sent | p_conn->unread_alert_status_not_sent) == 0)
+        return;
+
+    ANS_TRACE_DBG("conn_id:%d catch up new:%x unread:%x\n", p_conn->conn_id, p_conn->new_alert_not_sent,
+                  p_conn->unread_alert_status_not_sent);
+
+    wiced_bt_ans_begin_batch();
+    for (i = 0; i < ANP_NOTIFY_CATEGORY_COUNT; i++)
+    {
+        cat = ans_lib_cb.category_order[i];
+        ans_lib_handle_new_alert_immediate_notify(p_conn, cat);
+        ans_lib_handle_unread_alert_immediate_notify(p_conn, cat);
+    }
+    wiced_bt_ans_end_batch();
+}
+
+wiced_bt_gatt_status_t ans_lib_handle_client_alert_notification_control_point_write(ans_lib_conn_cb_t *p_conn, wiced_bt_anp_alert_control_cmd_id_t cmd_id,
+                                                                                    wiced_bt_anp_alert_category_id_t category_id)
+{
+    wiced_bt_gatt_status_t status = WICED_BT_GATT_SUCCESS;
+
+    if ((category_id != 0xFF) && (category_id >= ANP_NOTIFY_CATEGORY_COUNT))
+    {
+        if (cmd_id > ANP_ALERT_CONTROL_CMD_NOTIFY_UNREAD_ALERTS_IMMEDIATE)
+        {
+            ANS_TRACE_ERR("Wrong command ID: %d\n", cmd_id);
+            return ANP_ALERT_NOTIFCATION_CONTROL_POINT_WRITE_CMD_NOT_SUPPORTED;
+        }
+        return WICED_BT_GATT_INVALID_CFG;
+    }
+
+    switch (cmd_id)
+    {
+    case ANP_ALERT_CONTROL_CMD_ENABLE_NEW_ALERTS:
+        if (category_id == 0xFF)
+        {
+            p_conn->client_configured_new_alerts = ans_lib_cb.supported_new_alerts;
+        }
+        else
+        {
+            p_conn->client_configured_new_alerts |= (1 << category_id);
+        }
+        break;
+
+    case ANP_ALERT_CONTROL_CMD_ENABLE_UNREAD_STATUS:
+        if (category_id == 0xFF)
+        {
+            p_conn->client_configured_unread_alerts = ans_lib_cb.supported_unread_alerts;
+        }
+        else
+        {
+            p_conn->client_configured_unread_alerts |= (1 << category_id);
+        }
+        break;
+
+    case ANP_ALERT_CONTROL_CMD_DISABLE_NEW_ALERTS:
+        if (category_id == 0xFF)
+        {
+            p_conn->client_configured_new_alerts = 0;
+        }
+        else
+        {
+            p_conn->client_configured_new_alerts &= (~(1 << category_id));
+        }
+        break;
+
+    case ANP_ALERT_CONTROL_CMD_DISABLE_UNREAD_ALERTS:
+        if (category_id == 0xFF)
+        {
+            p_conn->client_configured_unread_alerts = 0;
+        }
+        else
+        {
+            p_conn->client_configured_unread_alerts &= (~(1 << category_id));
+        }
+        break;
+
+    case ANP_ALERT_CONTROL_CMD_NOTIFY_NEW_ALERTS_IMMEDIATE:
+        ans_lib_handle_new_alert_immediate_notify(p_conn, category_id);
+        break;
+
+    case ANP_ALERT_CONTROL_CMD_NOTIFY_UNREAD_ALERTS_IMMEDIATE:
+        ans_lib_handle_unread_alert_immediate_notify(p_conn, category_id);
+        break;
+
+    default:
+        status = ANP_ALERT_NOTIFCATION_CONTROL_POINT_WRITE_CMD_NOT_SUPPORTED;
+        break;
+    }
+
+    if (status == WICED_BT_GATT_SUCCESS)
+    {
+        ANS_TRACE_DBG("control_point_write:conn_id:%d sup na:%x, sup ua:%x, client enabled:: na:%x, ua:%x \n", p_conn->conn_id,
+                      ans_lib_cb.supported_new_alerts, ans_lib_cb.supported_unread_alerts,
+                      p_conn->client_configured_new_alerts, p_conn->client_configured_unread_alerts);
+    }
+
+    return status;
+}
+
+/* Initialize ANS library control block */
+/* Build the handle index so that GATT requests find their attribute without comparing every handle */
+wiced_bool_t ans_lib_attr_index_init(void)
+{
+    const uint16_t handles[] = {
+        [ANS_LIB_ATTR_NONE] = 0,
+        [ANS_LIB_ATTR_SUPPORTED_NEW_ALERT] = ans_lib_cb.gatt_handles.new_alert.supported_category,
+        [ANS_LIB_ATTR_NEW_ALERT_CCCD] = ans_lib_cb.gatt_handles.new_alert.configuration,
+        [ANS_LIB_ATTR_SUPPORTED_UNREAD_ALERT] = ans_lib_cb.gatt_handles.unread_alert.supported_category,
+        [ANS_LIB_ATTR_UNREAD_ALERT_CCCD] = ans_lib_cb.gatt_handles.unread_alert.configuration,
+        [ANS_LIB_ATTR_CONTROL_POINT] = ans_lib_cb.gatt_handles.notification_control,
+    };
+    uint8_t attr;
+
+    ans_lib_cb.attr_base = 0xFFFF;
+    for (attr = ANS_LIB_ATTR_SUPPORTED_NEW_ALERT; attr <= ANS_LIB_ATTR_CONTROL_POINT; attr++)
+    {
+        if ((handles[attr] != 0) && (handles[attr] < ans_lib_cb.attr_base))
+            ans_lib_cb.attr_base = handles[attr];
+    }
+
+    memset(ans_lib_cb.attr_index, ANS_LIB_ATTR_NONE, sizeof(ans_lib_cb.attr_index));
+    for (attr = ANS_LIB_ATTR_SUPPORTED_NEW_ALERT; attr <= ANS_LIB_ATTR_CONTROL_POINT; attr++)
+    {
+        if (handles[attr] == 0)
+            continue;
+        if (handles[attr] - ans_lib_cb.attr_base >= ANS_LIB_ATTR_SPAN)
+            return WICED_FALSE;
+        ans_lib_cb.attr_index[handles[attr] - ans_lib_cb.attr_base] = attr;
+    }
+    return WICED_TRUE;
+}
+
+/* Attribute of a handle, ANS_LIB_ATTR_NONE if the library does not serve it */
+uint8_t ans_lib_attr_find(uint16_t handle)
+{
+    uint16_t offset = handle - ans_lib_cb.attr_base;
+
+    return (offset < ANS_LIB_ATTR_SPAN) ? ans_lib_cb.attr_index[offset] : ANS_LIB_ATTR_NONE;
+}
+
+wiced_result_t wiced_bt_ans_init(wiced_bt_ans_gatt_handles_t *p_gatt_handles)
+{
+    uint8_t i;
+
+    if ((p_gatt_handles == NULL) ||
+        (p_gatt_handles->new_alert.supported_category == 0) ||
+        (p_gatt_handles->new_alert.configuration == 0) ||
+        (p_gatt_handles->new_alert.value == 0) ||
+        (p_gatt_handles->unread_alert.supported_category == 0) ||
+        (p_gatt_handles->unread_alert.configuration == 0) ||
+        (p_gatt_handles->unread_alert.value == 0))
+    {
+        ANS_TRACE_ERR("Wrong GATT Handle\n");
+        return WICED_BT_BADARG;
+    }
+
+    /* Clear the Alert Control Block */
+    memset(&ans_lib_cb, 0, sizeof(ans_lib_cb));
+    for (i = 0; i < ANS_LIB_CONN_INDEX_SIZE; i++)
+        ans_lib_cb.conn_index[i].idx = ANS_LIB_CONN_INDEX_FREE;
+    ans_lib_cb.tx_credits = WICED_BT_ANS_TX_CREDITS;
+    ans_lib_cb.tx_credits_max = WICED_BT_ANS_TX_CREDITS;
+    wiced_init_timer(&ans_lib_cb.hold_timer, ans_lib_hold_timeout, 0, WICED_MILLI_SECONDS_TIMER);
+    memcpy(ans_lib_cb.priority, ans_lib_default_priority, sizeof(ans_lib_cb.priority));
+    ans_lib_sort_categories();
+
+    /* Save the Alert GATT Handles */
+    memcpy(&ans_lib_cb.gatt_handles, p_gatt_handles, sizeof(ans_lib_cb.gatt_handles));
+    if (!ans_lib_attr_index_init())
+    {
+        ANS_TRACE_ERR("ANS handles span more than %d\n", ANS_LIB_ATTR_SPAN);
+        return WICED_BT_BADARG;
+    }
+
+    return WICED_BT_SUCCESS;
+}
+
+/* Application calls this API, when ANS server establish connection with ANC */
+void wiced_bt_ans_connection_up(uint16_t conn_id)
+{
+    ans_lib_conn_cb_t *p_conn = ans_lib_alloc_conn_cb(conn_id);
+    wiced_bt_ans_client_state_t state;
+    uint8_t cat;
+
+    if (p_conn == NULL)
+    {
+        ANS_TRACE_ERR("no resources for conn_id:%d\n", conn_id);
+        ANS_PROBE(connection_up, conn_id, ANS_PROBE_NO_CATEGORY, WICED_BT_NO_RESOURCES);
+        return;
+    }
+    ANS_PROBE(connection_up, conn_id, ANS_PROBE_NO_CATEGORY, WICED_BT_SUCCESS);
+    ans_lib_rate_reset(p_conn);
+
+    /* a bonded client continues where it left, once the link is encrypted */
+    if ((ans_lib_cb.p_client_state_cback == NULL) || !ans_lib_cb.p_client_state_cback(conn_id, &state))
+        return;
+
+    p_conn->new_alert_cccd = state.new_alert_cccd;
+    p_conn->unread_alert_status_cccd = state.unread_alert_status_cccd;
+    p_conn->client_configured_new_alerts = state.client_configured_new_alerts & ans_lib_cb.supported_new_alerts;
+    p_conn->client_configured_unread_alerts = state.client_configured_unread_alerts & ans_lib_cb.supported_unread_alerts;
+    p_conn->new_alert_not_sent = state.new_alert_not_sent & ans_lib_cb.supported_new_alerts;
+    p_conn->unread_alert_status_not_sent = state.unread_alert_status_not_sent & ans_lib_cb.supported_unread_alerts;
+    for (cat = 0; cat < ANP_NOTIFY_CATEGORY_COUNT; cat++)
+    {
+        p_conn->notify_data[cat].num_of_new_alerts = state.num_of_new_alerts[cat];
+        p_conn->notify_data[cat].num_of_unread_count = state.num_of_unread_count[cat];
+        p_conn->alert_us[cat] = ans_lib_now_us();
+    }
+    p_conn->wait_encryption = WICED_TRUE;
+
+    ANS_TRACE_DBG("conn_id:%d restored cccd:%d/%d configured:%x/%x\n", conn_id, p_conn->new_alert_cccd,
+                  p_conn->unread_alert_status_cccd, p_conn->client_configured_new_alerts,
+                  p_conn->client_configured_unread_alerts);
+}
+
+/* Application calls this API once the link to the client is encrypted */
+void wiced_bt_ans_connection_encrypted(uint16_t conn_id)
+{
+    ans_lib_conn_cb_t *p_conn = ans_lib_find_conn_cb(conn_id);
+
+    if (p_conn == NULL)
+        return;
+
+    p_conn->wait_encryption = WICED_FALSE;
+
+    if (ans_lib_cb.catch_up)
+        ans_lib_catch_up(p_conn);
+}
+
+/* Application calls this API to send missed alerts as soon as a client's link is encrypted */
+void wiced_bt_ans_set_catch_up(wiced_bool_t enable)
+{
+    ans_lib_cb.catch_up = enable;
+}
+
+/* Application calls this API to keep the state of bonded clients across connections */
+void wiced_bt_ans_register_client_state_cback(wiced_bt_ans_client_state_cback_t p_cback)
+{
+    ans_lib_cb.p_client_state_cback = p_cback;
+}
+
+/* Application calls this API to get the state of a client to keep while it is bonded */
+wiced_bool_t wiced_bt_ans_get_client_state(uint16_t conn_id, wiced_bt_ans_client_state_t *p_state)
+{
+    ans_lib_conn_cb_t *p_conn = ans_lib_find_conn_cb(conn_id);
+    uint8_t cat;
+
+    if (p_conn == NULL)
+        return WICED_FALSE;
+
+    memset(p_state, 0, sizeof(*p_state));
+    p_state->new_alert_cccd = p_conn->new_alert_cccd;
+    p_state->unread_alert_status_cccd = p_conn->unread_alert_status_cccd;
+    p_state->client_configured_new_alerts = p_conn->client_configured_new_alerts;
+    p_state->client_configured_unread_alerts = p_conn->client_configured_unread_alerts;
+    p_state->new_alert_not_sent = p_conn->new_alert_not_sent;
+    p_state->unread_alert_status_not_sent = p_conn->unread_alert_status_not_sent;
+    for (cat = 0; cat < ANP_NOTIFY_CATEGORY_COUNT; cat++)
+    {
+        p_state->num_of_new_alerts[cat] = p_conn->notify_data[cat].num_of_new_alerts;
+        p_state->num_of_unread_count[cat] = p_conn->notify_data[cat].num_of_unread_count;
+    }
+    return WICED_TRUE;
+}
+
+/* Application calls this API, when ANS server disconnected from ANC */
+void wiced_bt_ans_connection_down(uint16_t conn_id)
+{
+    ans_lib_conn_cb_t *p_conn = ans_lib_find_conn_cb(conn_id);
+
+    /* the conn_id of an Enhanced ATT bearer only closes that bearer */
+    if ((p_conn != NULL) && (p_conn->conn_id != conn_id))
+    {
+        wiced_bt_ans_bearer_down(conn_id);
+        return;
+    }
+
+    if (p_conn != NULL)
+    {
+        ANS_PROBE(connection_down, conn_id, ANS_PROBE_NO_CATEGORY, WICED_BT_SUCCESS);
+        ans_lib_free_conn_cb(p_conn);
+        ans_lib_hold_timer_update();
+    }
+}
+
+/* Application calls this API on GATT_CONGESTION_EVT */
+void wiced_bt_ans_process_congestion(uint16_t conn_id, wiced_bool_t congested)
+{
+    ans_lib_conn_cb_t *p_conn = ans_lib_find_conn_cb(conn_id);
+    uint8_t bearer;
+
+    if ((p_conn == NULL) || ((bearer = ans_lib_find_bearer(p_conn, conn_id)) == ANS_LIB_BEARER_NONE))
+        return;
+
+    p_conn->bearer[bearer].congested = congested;
+    if (!congested)
+    {
+        ans_lib_tx_drain(p_conn);
+        ans_lib_tx_retry(p_conn);
+    }
+}
+
+/* Application calls this API on GATT_APP_BUFFER_TRANSMITTED_EVT */
+wiced_bool_t wiced_bt_ans_process_buffer_transmitted(uint8_t *p_app_data, void *p_app_ctx)
+{
+    uint8_t *p_ctx = (uint8_t *)p_app_ctx;
+    ans_lib_tx_entry_t *p_entry = (ans_lib_tx_entry_t *)p_app_ctx;
+    ans_lib_conn_cb_t *p_conn;
+    uint32_t offset;
+    uint64_t now_us;
+
+    /* only contexts pointing into our TX queues belong to the library */
+    if ((p_ctx < (uint8_t *)ans_lib_cb.conn) || (p_ctx >= (uint8_t *)&ans_lib_cb.conn[WICED_BT_ANS_MAX_CONNECTIONS]))
+        return WICED_FALSE;
+
+    p_conn = &ans_lib_cb.conn[(p_ctx - (uint8_t *)ans_lib_cb.conn) / sizeof(ans_lib_conn_cb_t)];
+    offset = (uint32_t)(p_ctx - (uint8_t *)p_conn->tx_queue);
+    if ((p_ctx < (uint8_t *)p_conn->tx_queue) || (offset % sizeof(ans_lib_tx_entry_t) != 0) ||
+        (offset >= sizeof(p_conn->tx_queue)) ||
+        (p_app_data != (p_entry->multi_ntf ? p_conn->multi_ntf_buf : p_entry->value)))
+        return WICED_FALSE;
+
+    /* an entry freed with its connection or bearer has given its credit back already */
+    if ((p_conn->state == ANS_STATE_CONNECTED) && (p_entry->state == ANS_TX_ENTRY_IN_FLIGHT))
+    {
+        now_us = ans_lib_now_us();
+        ans_lib_latency_record(WICED_BT_ANS_LATENCY_STACK, p_entry->category_id, p_entry->sent_us, now_us);
+        ans_lib_latency_record(WICED_BT_ANS_LATENCY_TOTAL, p_entry->category_id, p_entry->alert_us, now_us);
+        if (p_entry->multi_ntf)
+        {
+            ans_lib_latency_record(WICED_BT_ANS_LATENCY_STACK, p_entry->pair_category_id, p_entry->sent_us, now_us);
+            ans_lib_latency_record(WICED_BT_ANS_LATENCY_TOTAL, p_entry->pair_category_id, p_entry->pair_alert_us,
+                                   now_us);
+            p_entry->multi_ntf = WICED_FALSE;
+            p_conn->multi_ntf_busy = WICED_FALSE;
+        }
+        p_entry->state = ANS_TX_ENTRY_FREE;
+        p_conn->tx_in_flight--;
+        if (ans_lib_cb.tx_credits < ans_lib_cb.tx_credits_max)
+            ans_lib_cb.tx_credits++;
+
+        /* transmit complete also means the bearer is moving again */
+        p_conn->bearer[p_entry->bearer].congested = WICED_FALSE;
+        ans_lib_tx_drain(p_conn);
+        ans_lib_tx_retry(p_conn);
+        ans_lib_tx_drain_all();
+    }
+    return WICED_TRUE;
+}
+
+/* Application calls this API to match the TX credits to the controller LE ACL buffers */
+void wiced_bt_ans_set_tx_credits(uint8_t tx_credits)
+{
+    uint8_t in_flight = ans_lib_cb.tx_credits_max - ans_lib_cb.tx_credits;
+
+    if (tx_credits == 0)
+        return;
+
+    ans_lib_cb.tx_credits_max = tx_credits;
+    ans_lib_cb.tx_credits = (tx_credits > in_flight) ? (tx_credits - in_flight) : 0;
+    ans_lib_tx_drain_all();
+}
+
+/* Application calls this API to read the TX queue statistics of a connection */
+wiced_bool_t wiced_bt_ans_get_tx_stats(uint16_t conn_id, wiced_bt_ans_tx_stats_t *p_stats)
+{
+    ans_lib_conn_cb_t *p_conn = ans_lib_find_conn_cb(conn_id);
+
+    if ((p_conn == NULL) || (p_stats == NULL))
+        return WICED_FALSE;
+
+    p_stats->queue_depth = p_conn->tx_queued;
+    p_stats->in_flight = p_conn->tx_in_flight;
+    p_stats->max_depth = p_conn->tx_max_depth;
+    p_stats->congested = p_conn->bearer[ANS_LIB_BEARER_LEGACY].congested;
+    p_stats->eatt_bearers = p_conn->eatt_bearers;
+    p_stats->sent = p_conn->tx_sent;
+    p_stats->drops = p_conn->tx_drops;
+    p_stats->retries = p_conn->tx_retries;
+    p_stats->combined = p_conn->tx_combined;
+    memcpy(p_stats->deadline_misses, p_conn->deadline_misses, sizeof(p_stats->deadline_misses));
+    memcpy(p_stats->throttled, p_conn->throttled, sizeof(p_stats->throttled));
+
+    return WICED_TRUE;
+}
+
+/* Application calls this API to read the alert latency of one stage of a category */
+wiced_bool_t wiced_bt_ans_get_latency(wiced_bt_anp_alert_category_id_t category_id, wiced_bt_ans_latency_stage_t stage,
+                                      wiced_bt_ans_latency_t *p_latency)
+{
+    ans_lib_latency_t *p_hist;
+
+    if ((category_id >= ANP_NOTIFY_CATEGORY_COUNT) || (stage >= WICED_BT_ANS_LATENCY_STAGES) || (p_latency == NULL))
+        return WICED_FALSE;
+
+    p_hist = &ans_lib_cb.latency[stage][category_id];
+    memset(p_latency, 0, sizeof(*p_latency));
+    if ((p_latency->count = p_hist->count) == 0)
+        return WICED_TRUE;
+
+    p_latency->min_us = p_hist->min_us;
+    p_latency->max_us = p_hist->max_us;
+    p_latency->p50_us = ans_lib_latency_percentile(p_hist, 500);
+    p_latency->p99_us = ans_lib_latency_percentile(p_hist, 990);
+    p_latency->p999_us = ans_lib_latency_percentile(p_hist, 999);
+
+    return WICED_TRUE;
+}
+
+/* Application calls this API to start the alert latency histograms over */
+void wiced_bt_ans_reset_latency(void)
+{
+    memset(ans_lib_cb.latency, 0, sizeof(ans_lib_cb.latency));
+}
+
+/* Application calls this API, when user configure the supportable new alerts*/
+void wiced_bt_ans_set_supported_new_alert_categories(uint16_t conn_id, wiced_bt_anp_alert_category_enable_t supported_new_alert_cat)
+{
+    /* the categories are shared by all connections, conn_id is kept for API compatibility */
+    (void)conn_id;
+
+    /* cannot be changed during connection */
+    if (ans_lib_cb.num_connections == 0)
+    {
+        ans_lib_cb.supported_new_alerts = supported_new_alert_cat;
+    }
+}
+
+/* Application calls this API, when user configure the supportable unread alerts*/
+void wiced_bt_ans_set_supported_unread_alert_categories(uint16_t conn_id, wiced_bt_anp_alert_category_enable_t supported_unread_alert_cat)
+{
+    /* the categories are shared by all connections, conn_id is kept for API compatibility */
+    (void)conn_id;
+
+    /* cannot be changed during connection */
+    if (ans_lib_cb.num_connections == 0)
+    {
+        ans_lib_cb.supported_unread_alerts = supported_unread_alert_cat;
+    }
+}
+
+/* Application calls this API to serve a GATT read from the library storage without copying it */
+wiced_bt_gatt_status_t wiced_bt_ans_get_attr_value(uint16_t conn_id, uint16_t handle, const uint8_t **pp_val,
+                                                   uint16_t *p_len)
+{
+    ans_lib_conn_cb_t *p_conn;
+    uint8_t attr = ans_lib_attr_find(handle);
+
+    /* the library runs on little endian hosts, its values are already in air order */
+    switch (attr)
+    {
+    case ANS_LIB_ATTR_SUPPORTED_NEW_ALERT:
+        *pp_val = (const uint8_t *)&ans_lib_cb.supported_new_alerts;
+        break;
+
+    case ANS_LIB_ATTR_SUPPORTED_UNREAD_ALERT:
+        *pp_val = (const uint8_t *)&ans_lib_cb.supported_unread_alerts;
+        break;
+
+    case ANS_LIB_ATTR_NEW_ALERT_CCCD:
+    case ANS_LIB_ATTR_UNREAD_ALERT_CCCD:
+        if ((p_conn = ans_lib_find_conn_cb(conn_id)) == NULL)
+            return WICED_BT_GATT_WRONG_STATE;
+        *pp_val = (attr == ANS_LIB_ATTR_NEW_ALERT_CCCD) ? (const uint8_t *)&p_conn->new_alert_cccd :
+                                                          (const uint8_t *)&p_conn->unread_alert_status_cccd;
+        break;
+
+    default:
+        return WICED_BT_GATT_READ_NOT_PERMIT;
     }
 
+    *p_len = 2;
+    return WICED_BT_GATT_SUCCESS;
+}
+
+/* Application calls this API, when ANC read the ANS services using GATT read operation */
+wiced_bt_gatt_status_t wiced_bt_ans_process_gatt_read_req(uint16_t conn_id, wiced_bt_gatt_read_t *p_read_hdr,
+                                                          uint8_t *p_read, uint16_t *p_read_len)
+{
+    const uint8_t *p_val;
+    uint16_t len;
+    wiced_bt_gatt_status_t status = wiced_bt_ans_get_attr_value(conn_id, p_read_hdr->handle, &p_val, &len);
+
     if (status == WICED_BT_GATT_SUCCESS)
-        ANS_TRACE_DBG("handle:%04x len:%d data:%x status:%x\n", p_read_hdr->handle,
+    {
+        memcpy(p_read, p_val, len);
+        *p_read_len = len;
+        ANS_TRACE_DBG("conn_id:%d handle:%04x len:%d data:%x status:%x\n", conn_id, p_read_hdr->handle,
                       *p_read_len, (p_read[0] + (p_read[1] << 8)), status);
+    }
 
     return status;
 }
@@ -388,47 +1971,135 @@ wiced_bt_gatt_status_t wiced_bt_ans_process_gatt_read_req(uint16_t conn_id, wice
 wiced_bt_gatt_status_t wiced_bt_ans_process_gatt_write_req(uint16_t conn_id, wiced_bt_gatt_write_req_t *p_write)
 {
     wiced_bt_gatt_status_t status = WICED_BT_GATT_INVALID_ATTR_LEN;
+    ans_lib_conn_cb_t *p_conn = ans_lib_find_conn_cb(conn_id);
 
-    if (p_write->handle == ans_lib_cb.gatt_handles.new_alert.configuration)
+    if (p_conn == NULL)
     {
+        ANS_TRACE_ERR("unknown conn_id:%d\n", conn_id);
+        return WICED_BT_GATT_WRONG_STATE;
+    }
+
+    switch (ans_lib_attr_find(p_write->handle))
+    {
+    case ANS_LIB_ATTR_NEW_ALERT_CCCD:
         if (p_write->val_len == 2 && p_write->p_val)
         {
-            ans_lib_cb.new_alert_cccd = p_write->p_val[0] + (p_write->p_val[1] << 8);
+            p_conn->new_alert_cccd = p_write->p_val[0] + (p_write->p_val[1] << 8);
             status = WICED_BT_GATT_SUCCESS;
         }
-    }
-    else if (p_write->handle == ans_lib_cb.gatt_handles.unread_alert.configuration)
-    {
+        break;
+
+    case ANS_LIB_ATTR_UNREAD_ALERT_CCCD:
         if (p_write->val_len == 2 && p_write->p_val)
         {
-            ans_lib_cb.unread_alert_status_cccd = p_write->p_val[0] + (p_write->p_val[1] << 8);
+            p_conn->unread_alert_status_cccd = p_write->p_val[0] + (p_write->p_val[1] << 8);
             status = WICED_BT_GATT_SUCCESS;
         }
-    }
-    else if (p_write->handle == ans_lib_cb.gatt_handles.notification_control)
-    {
+        break;
+
+    case ANS_LIB_ATTR_CONTROL_POINT:
         if (p_write->val_len == 2 && p_write->p_val)
         {
-            status = ans_lib_handle_client_alert_notification_control_point_write(conn_id, p_write->p_val[0], p_write->p_val[1]);
+            status = ans_lib_handle_client_alert_notification_control_point_write(p_conn, p_write->p_val[0], p_write->p_val[1]);
+            ANS_PROBE_CMD(control_point, conn_id, p_write->p_val[1], status, p_write->p_val[0]);
         }
-    }
-    else
-    {
+        break;
+
+    default:
         status = WICED_BT_GATT_WRITE_NOT_PERMIT;
+        break;
     }
 
     if (status == WICED_BT_GATT_SUCCESS)
     {
-        ANS_TRACE_DBG("handle:%04x len:%d data[0,1]:%x %x status:%x\n",
+        ANS_TRACE_DBG("conn_id:%d handle:%04x len:%d data[0,1]:%x %x status:%x\n", conn_id,
                       p_write->handle, p_write->val_len, p_write->p_val[0], p_write->p_val[1], status);
     }
 
     return status;
 }
 
+/* Count new alerts on one connection and send the new count if the client is ready for it */
+wiced_bt_gatt_status_t ans_lib_process_and_send_new_alert(ans_lib_conn_cb_t *p_conn, wiced_bt_anp_alert_category_id_t category_id,
+                                                          uint8_t text_id, uint8_t count)
+{
+    ANS_TRACE_DBG("conn_id:%d Server supports:%x client configured:%x CCCD:%d\n", p_conn->conn_id,
+                  (ans_lib_cb.supported_new_alerts & (1 << category_id)),
+                  (p_conn->client_configured_new_alerts & (1 << category_id)),
+                  p_conn->new_alert_cccd);
+
+    ans_lib_latency_alert(p_conn, category_id);
+    ANS_PROBE(new_alert_accepted, p_conn->conn_id, category_id, WICED_BT_GATT_SUCCESS);
+
+    /* the count is a single octet on the air, saturate rather than wrap on a long burst */
+    if (p_conn->notify_data[category_id].num_of_new_alerts > 0xFF - count)
+        p_conn->notify_data[category_id].num_of_new_alerts = 0xFF;
+    else
+        p_conn->notify_data[category_id].num_of_new_alerts += count;
+
+    /* a held back alert goes out with the text of the latest one */
+    ans_lib_text_assign(p_conn, category_id, text_id);
+
+    if (ans_lib_new_alert_enabled(p_conn, category_id))
+    {
+        if (!ans_lib_hold(p_conn, category_id))
+            return ans_lib_send_new_alert(p_conn, category_id);
+
+        /* still pending, so Notify Immediately flushes it before the window ends */
+        p_conn->new_alert_held |= (1 << category_id);
+        p_conn->new_alert_not_sent |= (1 << category_id);
+        ANS_PROBE(new_alert_deferred, p_conn->conn_id, category_id, WICED_BT_GATT_BUSY);
+        ans_lib_hold_timer_update();
+        return WICED_BT_GATT_SUCCESS;
+    }
+
+    /* Remember the alert category to decide to notify or not on ANP_ALERT_CONTROL_CMD_NOTIFY_NEW_ALERTS_IMMEDIATE */
+    p_conn->new_alert_not_sent |= (1 << category_id);
+    ANS_PROBE(new_alert_deferred, p_conn->conn_id, category_id, WICED_BT_GATT_WRONG_STATE);
+
+    return WICED_BT_GATT_SUCCESS;
+}
+
+/* Count unread alerts on one connection and send the new count if the client is ready for it */
+wiced_bt_gatt_status_t ans_lib_process_and_send_unread_alert(ans_lib_conn_cb_t *p_conn, wiced_bt_anp_alert_category_id_t category_id,
+                                                             uint8_t count)
+{
+    ans_lib_latency_alert(p_conn, category_id);
+    ANS_PROBE(unread_alert_accepted, p_conn->conn_id, category_id, WICED_BT_GATT_SUCCESS);
+
+    if (p_conn->notify_data[category_id].num_of_unread_count > 0xFF - count)
+        p_conn->notify_data[category_id].num_of_unread_count = 0xFF;
+    else
+        p_conn->notify_data[category_id].num_of_unread_count += count;
+
+    if (ans_lib_unread_alert_enabled(p_conn, category_id))
+    {
+        if (!ans_lib_hold(p_conn, category_id))
+            return ans_lib_send_unread_alert(p_conn, category_id);
+
+        p_conn->unread_alert_status_held |= (1 << category_id);
+        p_conn->unread_alert_status_not_sent |= (1 << category_id);
+        ANS_PROBE(unread_alert_deferred, p_conn->conn_id, category_id, WICED_BT_GATT_BUSY);
+        ans_lib_hold_timer_update();
+        return WICED_BT_GATT_SUCCESS;
+    }
+
+    /* Remember the alert category to decide to notify or not on ANP_ALERT_CONTROL_CMD_NOTIFY_NEW_ALERTS_IMMEDIATE */
+    p_conn->unread_alert_status_not_sent |= (1 << category_id);
+    ANS_PROBE(unread_alert_deferred, p_conn->conn_id, category_id, WICED_BT_GATT_WRONG_STATE);
+
+    ANS_TRACE_DBG("conn_id:%d Server supports:%x, client configured:%x, CCCD:%d \n", p_conn->conn_id,
+                  (ans_lib_cb.supported_unread_alerts & (1 << category_id)),
+                  (p_conn->client_configured_unread_alerts & (1 << category_id)), p_conn->unread_alert_status_cccd);
+
+    return WICED_BT_GATT_SUCCESS;
+}
+
 /* Application calls this API, when new alert need to send to ANC */
 wiced_bt_gatt_status_t wiced_bt_ans_process_and_send_new_alert(uint16_t conn_id, wiced_bt_anp_alert_category_id_t category_id)
 {
+    ans_lib_conn_cb_t *p_conn;
+
     ANS_TRACE_DBG("conn_id:%d category_id:%d\n", conn_id, category_id);
 
     if ((category_id == 0xff) || (category_id >= ANP_NOTIFY_CATEGORY_COUNT))
@@ -437,69 +2108,447 @@ wiced_bt_gatt_status_t wiced_bt_ans_process_and_send_new_alert(uint16_t conn_id,
         return WICED_BT_GATT_INVALID_CFG;
     }
 
-    ANS_TRACE_DBG("Server supports:%x client configured:%x CCCD:%d\n",
-                  (ans_lib_cb.supported_new_alerts & (1 << category_id)),
-                  (ans_lib_cb.client_configured_new_alerts & (1 << category_id)),
-                  ans_lib_cb.new_alert_cccd);
+    if ((p_conn = ans_lib_find_conn_cb(conn_id)) == NULL)
+    {
+        ANS_TRACE_ERR("unknown conn_id:%d\n", conn_id);
+        return WICED_BT_GATT_WRONG_STATE;
+    }
+
+    return ans_lib_process_and_send_new_alert(p_conn, category_id, ANS_LIB_TEXT_SAMPLE, 1);
+}
 
-    ans_lib_cb.notify_data[category_id].num_of_new_alerts++;
+/* Application calls this API, when new alert with the sender name or title need to send to ANC */
+wiced_bt_gatt_status_t wiced_bt_ans_process_and_send_new_alert_text(uint16_t conn_id, wiced_bt_anp_alert_category_id_t category_id,
+                                                                    const char *p_text, uint16_t text_len)
+{
+    ans_lib_conn_cb_t *p_conn;
 
-    if ((ans_lib_cb.conn_id) &&
-        (ans_lib_cb.supported_new_alerts & (1 << category_id)) &&
-        (ans_lib_cb.client_configured_new_alerts & (1 << category_id)) &&
-        (ans_lib_cb.new_alert_cccd))
+    if ((category_id >= ANP_NOTIFY_CATEGORY_COUNT) || ((p_text == NULL) && (text_len != 0)))
     {
-        return ans_lib_send_new_alert(conn_id, category_id);
+        ANS_TRACE_ERR("wrong category_id:%x or text\n", category_id);
+        return WICED_BT_GATT_INVALID_CFG;
     }
 
-    /* Remember the alert category to decide to notify or not on ANP_ALERT_CONTROL_CMD_NOTIFY_NEW_ALERTS_IMMEDIATE */
-    ans_lib_cb.new_alert_not_sent |= (1 << category_id);
+    if ((p_conn = ans_lib_find_conn_cb(conn_id)) == NULL)
+    {
+        ANS_TRACE_ERR("unknown conn_id:%d\n", conn_id);
+        return WICED_BT_GATT_WRONG_STATE;
+    }
 
-    return WICED_BT_GATT_SUCCESS;
+    return ans_lib_process_and_send_new_alert(p_conn, category_id, ans_lib_text_intern(p_text, text_len), 1);
 }
 
 /* Application calls this API, when Unread alert need to send to ANC */
 wiced_bt_gatt_status_t wiced_bt_ans_process_and_send_unread_alert(uint16_t conn_id, wiced_bt_anp_alert_category_id_t category_id)
 {
+    ans_lib_conn_cb_t *p_conn;
+
     if ((category_id == 0xff) || (category_id >= ANP_NOTIFY_CATEGORY_COUNT))
     {
         ANS_TRACE_ERR("category_id:%x \n", category_id);
         return WICED_BT_GATT_INVALID_CFG;
     }
 
-    ans_lib_cb.notify_data[category_id].num_of_unread_count++;
+    if ((p_conn = ans_lib_find_conn_cb(conn_id)) == NULL)
+    {
+        ANS_TRACE_ERR("unknown conn_id:%d\n", conn_id);
+        return WICED_BT_GATT_WRONG_STATE;
+    }
+
+    return ans_lib_process_and_send_unread_alert(p_conn, category_id, 1);
+}
 
-    if ((ans_lib_cb.conn_id) &&
-        (ans_lib_cb.supported_unread_alerts & (1 << category_id)) &&
-        (ans_lib_cb.client_configured_unread_alerts & (1 << category_id)) &&
-        (ans_lib_cb.unread_alert_status_cccd))
+/* Application calls this API to hand alerts raised earlier to a client as one count */
+wiced_bt_gatt_status_t wiced_bt_ans_process_and_send_alerts(uint16_t conn_id, wiced_bt_anp_alert_category_id_t category_id,
+                                                            uint8_t count, const char *p_text, uint16_t text_len)
+{
+    ans_lib_conn_cb_t *p_conn;
+
+    if ((category_id >= ANP_NOTIFY_CATEGORY_COUNT) || (count == 0) || ((p_text == NULL) && (text_len != 0)))
     {
-        return ans_lib_send_unread_alert(conn_id, category_id);
+        ANS_TRACE_ERR("wrong category_id:%x count:%d or text\n", category_id, count);
+        return WICED_BT_GATT_INVALID_CFG;
     }
 
-    /* Remember the alert category to decide to notify or not on ANP_ALERT_CONTROL_CMD_NOTIFY_NEW_ALERTS_IMMEDIATE */
-    ans_lib_cb.unread_alert_status_not_sent |= (1 << category_id);
+    if ((p_conn = ans_lib_find_conn_cb(conn_id)) == NULL)
+    {
+        ANS_TRACE_ERR("unknown conn_id:%d\n", conn_id);
+        return WICED_BT_GATT_WRONG_STATE;
+    }
 
-    ANS_TRACE_DBG("conn_id:%d Server supports:%x, client configured:%x, CCCD:%d \n", ans_lib_cb.conn_id,
-                  (ans_lib_cb.supported_unread_alerts & (1 << category_id)),
-                  (ans_lib_cb.client_configured_unread_alerts & (1 << category_id)), ans_lib_cb.unread_alert_status_cccd);
+    /* once counted a notification the queue has no room for is retried, the alerts are not lost */
+    wiced_bt_ans_begin_batch();
+    ans_lib_process_and_send_new_alert(p_conn, category_id,
+                                       (p_text != NULL) ? ans_lib_text_intern(p_text, text_len) : ANS_LIB_TEXT_SAMPLE,
+                                       count);
+    ans_lib_process_and_send_unread_alert(p_conn, category_id, count);
+    wiced_bt_ans_end_batch();
 
     return WICED_BT_GATT_SUCCESS;
 }
 
+/* Count a new alert on every connection, the text is interned once and shared */
+wiced_bt_gatt_status_t ans_lib_process_and_send_new_alert_all(wiced_bt_anp_alert_category_id_t category_id, uint8_t text_id)
+{
+    wiced_bt_gatt_status_t status = WICED_BT_GATT_SUCCESS;
+    wiced_bt_gatt_status_t conn_status;
+    uint8_t idx;
+
+    for (idx = 0; idx < WICED_BT_ANS_MAX_CONNECTIONS; idx++)
+    {
+        if (ans_lib_cb.conn[idx].state != ANS_STATE_CONNECTED)
+            continue;
+
+        /* one failing client must not hold back the others, report the first error */
+        conn_status = ans_lib_process_and_send_new_alert(&ans_lib_cb.conn[idx], category_id, text_id, 1);
+        if ((conn_status != WICED_BT_GATT_SUCCESS) && (status == WICED_BT_GATT_SUCCESS))
+            status = conn_status;
+    }
+
+    return status;
+}
+
+/* Application calls this API, when new alert need to send to every connected ANC */
+wiced_bt_gatt_status_t wiced_bt_ans_process_and_send_new_alert_all(wiced_bt_anp_alert_category_id_t category_id)
+{
+    if ((category_id == 0xff) || (category_id >= ANP_NOTIFY_CATEGORY_COUNT))
+    {
+        ANS_TRACE_ERR("wrong category_id:%x\n", category_id);
+        return WICED_BT_GATT_INVALID_CFG;
+    }
+
+    if (ans_lib_cb.num_connections == 0)
+        return WICED_BT_GATT_WRONG_STATE;
+
+    return ans_lib_process_and_send_new_alert_all(category_id, ANS_LIB_TEXT_SAMPLE);
+}
+
+/* Application calls this API, when new alert with the sender name or title need to send to every connected ANC */
+wiced_bt_gatt_status_t wiced_bt_ans_process_and_send_new_alert_text_all(wiced_bt_anp_alert_category_id_t category_id,
+                                                                        const char *p_text, uint16_t text_len)
+{
+    if ((category_id >= ANP_NOTIFY_CATEGORY_COUNT) || ((p_text == NULL) && (text_len != 0)))
+    {
+        ANS_TRACE_ERR("wrong category_id:%x or text\n", category_id);
+        return WICED_BT_GATT_INVALID_CFG;
+    }
+
+    if (ans_lib_cb.num_connections == 0)
+        return WICED_BT_GATT_WRONG_STATE;
+
+    return ans_lib_process_and_send_new_alert_all(category_id, ans_lib_text_intern(p_text, text_len));
+}
+
+/* Application calls this API, when Unread alert need to send to every connected ANC */
+wiced_bt_gatt_status_t wiced_bt_ans_process_and_send_unread_alert_all(wiced_bt_anp_alert_category_id_t category_id)
+{
+    wiced_bt_gatt_status_t status = WICED_BT_GATT_SUCCESS;
+    wiced_bt_gatt_status_t conn_status;
+    uint8_t idx;
+
+    if ((category_id == 0xff) || (category_id >= ANP_NOTIFY_CATEGORY_COUNT))
+    {
+        ANS_TRACE_ERR("category_id:%x \n", category_id);
+        return WICED_BT_GATT_INVALID_CFG;
+    }
+
+    if (ans_lib_cb.num_connections == 0)
+        return WICED_BT_GATT_WRONG_STATE;
+
+    for (idx = 0; idx < WICED_BT_ANS_MAX_CONNECTIONS; idx++)
+    {
+        if (ans_lib_cb.conn[idx].state != ANS_STATE_CONNECTED)
+            continue;
+
+        conn_status = ans_lib_process_and_send_unread_alert(&ans_lib_cb.conn[idx], category_id, 1);
+        if ((conn_status != WICED_BT_GATT_SUCCESS) && (status == WICED_BT_GATT_SUCCESS))
+            status = conn_status;
+    }
+
+    return status;
+}
+
+/* Reset the counts and pending bits of one category on one connection */
+void ans_lib_clear_alerts(ans_lib_conn_cb_t *p_conn, wiced_bt_anp_alert_category_id_t category_id)
+{
+    p_conn->notify_data[category_id].num_of_new_alerts = 0;
+    ans_lib_text_assign(p_conn, category_id, ANS_LIB_TEXT_SAMPLE);
+    p_conn->notify_data[category_id].num_of_unread_count = 0;
+    p_conn->new_alert_not_sent &= (~(1 << category_id));
+    p_conn->unread_alert_status_not_sent &= (~(1 << category_id));
+    p_conn->new_alert_held &= (~(1 << category_id));
+    p_conn->unread_alert_status_held &= (~(1 << category_id));
+    p_conn->throttled_held &= (~(1 << category_id));
+}
+
 /* Application calls this API, to clear the alerts which are yet to send to alert client */
 wiced_bool_t wiced_bt_ans_clear_alerts(uint16_t conn_id, wiced_bt_anp_alert_category_id_t category_id)
 {
+    ans_lib_conn_cb_t *p_conn;
+
+    if (category_id >= ANP_NOTIFY_CATEGORY_COUNT)
+    {
+        ANS_TRACE_ERR("category_id:%x \n", category_id);
+        return WICED_FALSE;
+    }
+
+    if ((p_conn = ans_lib_find_conn_cb(conn_id)) == NULL)
+    {
+        ANS_TRACE_ERR("unknown conn_id:%d\n", conn_id);
+        return WICED_FALSE;
+    }
+
+    ans_lib_clear_alerts(p_conn, category_id);
+    ans_lib_hold_timer_update();
+
+    return WICED_TRUE;
+}
+
+/* Application calls this API, to clear the alerts of every connected alert client */
+wiced_bool_t wiced_bt_ans_clear_alerts_all(wiced_bt_anp_alert_category_id_t category_id)
+{
+    uint8_t idx;
+
+    if (category_id >= ANP_NOTIFY_CATEGORY_COUNT)
+    {
+        ANS_TRACE_ERR("category_id:%x \n", category_id);
+        return WICED_FALSE;
+    }
+
+    for (idx = 0; idx < WICED_BT_ANS_MAX_CONNECTIONS; idx++)
+    {
+        if (ans_lib_cb.conn[idx].state == ANS_STATE_CONNECTED)
+            ans_lib_clear_alerts(&ans_lib_cb.conn[idx], category_id);
+    }
+    ans_lib_hold_timer_update();
+
+    return WICED_TRUE;
+}
+
+/* Application calls this API to set the coalescing window of an alert category */
+wiced_bool_t wiced_bt_ans_set_coalescing_window(wiced_bt_anp_alert_category_id_t category_id, uint16_t window_ms,
+                                                wiced_bool_t align_to_conn_interval)
+{
+    uint8_t idx;
+
     if (category_id >= ANP_NOTIFY_CATEGORY_COUNT)
     {
         ANS_TRACE_ERR("category_id:%x \n", category_id);
         return WICED_FALSE;
     }
 
-    ans_lib_cb.notify_data[category_id].num_of_new_alerts = 0;
-    ans_lib_cb.notify_data[category_id].num_of_unread_count = 0;
-    ans_lib_cb.new_alert_not_sent &= (~(1 << category_id));
-    ans_lib_cb.unread_alert_status_not_sent &= (~(1 << category_id));
+    ans_lib_cb.coalescing_window[category_id] = window_ms;
+    if (align_to_conn_interval)
+        ans_lib_cb.coalescing_align |= (1 << category_id);
+    else
+        ans_lib_cb.coalescing_align &= (~(1 << category_id));
+
+    /* without a window the held back count goes out right away */
+    if (window_ms == 0)
+    {
+        for (idx = 0; idx < WICED_BT_ANS_MAX_CONNECTIONS; idx++)
+        {
+            if ((ans_lib_cb.conn[idx].state == ANS_STATE_CONNECTED) &&
+                ((ans_lib_cb.conn[idx].new_alert_held | ans_lib_cb.conn[idx].unread_alert_status_held) & (1 << category_id)))
+            {
+                ans_lib_cb.conn[idx].hold_deadline[category_id] = ans_lib_now_ms();
+            }
+        }
+        ans_lib_hold_timeout(0);
+    }
+
+    return WICED_TRUE;
+}
+
+/* Application calls this API to change the priority class and delivery deadline of an alert category */
+wiced_bool_t wiced_bt_ans_set_category_priority(wiced_bt_anp_alert_category_id_t category_id,
+                                                wiced_bt_ans_priority_t priority, uint16_t deadline_ms)
+{
+    if ((category_id >= ANP_NOTIFY_CATEGORY_COUNT) || (priority > WICED_BT_ANS_PRIORITY_BULK))
+    {
+        ANS_TRACE_ERR("category_id:%x priority:%d\n", category_id, priority);
+        return WICED_FALSE;
+    }
+
+    ans_lib_cb.priority[category_id] = priority;
+    ans_lib_cb.deadline[category_id] = deadline_ms;
+    ans_lib_sort_categories();
+
+    return WICED_TRUE;
+}
+
+/* Application calls this API to limit the notification rate of an alert category on every connection */
+wiced_bool_t wiced_bt_ans_set_rate_limit(wiced_bt_anp_alert_category_id_t category_id, uint16_t rate_per_minute,
+                                         uint8_t burst)
+{
+    uint8_t idx;
+
+    if ((category_id >= ANP_NOTIFY_CATEGORY_COUNT) || ((rate_per_minute != 0) && (burst == 0)))
+    {
+        ANS_TRACE_ERR("category_id:%x burst:%d\n", category_id, burst);
+        return WICED_FALSE;
+    }
+
+    ans_lib_cb.rate_per_minute[category_id] = rate_per_minute;
+    ans_lib_cb.rate_burst[category_id] = burst;
+
+    /* connected clients start over with a full bucket */
+    for (idx = 0; idx < WICED_BT_ANS_MAX_CONNECTIONS; idx++)
+    {
+        if (ans_lib_cb.conn[idx].state == ANS_STATE_CONNECTED)
+        {
+            ans_lib_cb.conn[idx].tokens[category_id] = (uint32_t)burst * ANS_LIB_TOKEN;
+            ans_lib_cb.conn[idx].token_time[category_id] = ans_lib_now_ms();
+        }
+    }
+
+    return WICED_TRUE;
+}
+
+/* Application calls this API when the connection interval of a client is known or changes */
+void wiced_bt_ans_set_conn_interval(uint16_t conn_id, uint16_t conn_interval)
+{
+    ans_lib_conn_cb_t *p_conn = ans_lib_find_conn_cb(conn_id);
+
+    if (p_conn != NULL)
+        p_conn->conn_interval = conn_interval;
+}
+
+/* Application calls this API when the data length of a client link is negotiated */
+void wiced_bt_ans_set_data_length(uint16_t conn_id, uint16_t max_tx_octets)
+{
+    ans_lib_conn_cb_t *p_conn = ans_lib_find_conn_cb(conn_id);
+
+    if (p_conn != NULL)
+        p_conn->max_tx_octets = max_tx_octets;
+}
+
+
+/* Application calls this API when the client writes its Client Supported Features */
+void wiced_bt_ans_set_multi_ntf(uint16_t conn_id, wiced_bool_t enable)
+{
+    ans_lib_conn_cb_t *p_conn = ans_lib_find_conn_cb(conn_id);
+
+    if (p_conn != NULL)
+        p_conn->multi_ntf = enable;
+}
+
+/* Application calls this API before sending several alerts that belong together */
+void wiced_bt_ans_begin_batch(void)
+{
+    ans_lib_cb.tx_batch++;
+}
+
+/* Application calls this API after the alerts of a batch, they are sent now */
+void wiced_bt_ans_end_batch(void)
+{
+    uint8_t idx;
+
+    if (ans_lib_cb.tx_batch == 0)
+        return;
+
+    if (--ans_lib_cb.tx_batch == 0)
+    {
+        for (idx = 0; idx < WICED_BT_ANS_MAX_CONNECTIONS; idx++)
+            ans_lib_cb.conn[idx].rate_paid = 0;
+        ans_lib_tx_drain_all();
+    }
+}
+
+/* Application calls this API once the ATT MTU of a client is negotiated */
+void wiced_bt_ans_set_mtu(uint16_t conn_id, uint16_t mtu)
+{
+    ans_lib_conn_cb_t *p_conn = ans_lib_find_conn_cb(conn_id);
+
+    if ((p_conn != NULL) && (mtu >= ANS_LIB_ATT_MTU_DEFAULT))
+    {
+        p_conn->bearer[ANS_LIB_BEARER_LEGACY].mtu = mtu;
+        ANS_TRACE_DBG("conn_id:%d mtu:%d\n", conn_id, mtu);
+    }
+}
+
+/* Application calls this API when an Enhanced ATT bearer to a client opens or is reconfigured */
+wiced_bool_t wiced_bt_ans_bearer_up(uint16_t conn_id, uint16_t bearer_conn_id, uint16_t mtu)
+{
+    ans_lib_conn_cb_t *p_conn = ans_lib_find_conn_cb(conn_id);
+    uint8_t bearer;
+
+    if ((p_conn == NULL) || (bearer_conn_id == 0) || (bearer_conn_id == p_conn->conn_id))
+        return WICED_FALSE;
+
+    if ((bearer = ans_lib_find_bearer(p_conn, bearer_conn_id)) == ANS_LIB_BEARER_NONE)
+    {
+        for (bearer = ANS_LIB_BEARER_URGENT; bearer < ANS_LIB_BEARER_MAX; bearer++)
+        {
+            if (p_conn->bearer[bearer].conn_id == 0)
+                break;
+        }
+        if (bearer == ANS_LIB_BEARER_MAX)
+        {
+            ANS_TRACE_ERR("conn_id:%d no room for bearer conn_id:%d\n", conn_id, bearer_conn_id);
+            return WICED_FALSE;
+        }
+        p_conn->bearer[bearer].conn_id = bearer_conn_id;
+        p_conn->bearer[bearer].congested = WICED_FALSE;
+        p_conn->eatt_bearers++;
+        ans_lib_conn_index_add(bearer_conn_id, (uint8_t)(p_conn - ans_lib_cb.conn));
+    }
+    p_conn->bearer[bearer].mtu = mtu;
+
+    ANS_TRACE_DBG("conn_id:%d bearer:%d conn_id:%d mtu:%d\n", conn_id, bearer, bearer_conn_id, mtu);
 
+    ans_lib_tx_drain(p_conn);
     return WICED_TRUE;
 }
+
+/* Application calls this API when an Enhanced ATT bearer closes */
+void wiced_bt_ans_bearer_down(uint16_t bearer_conn_id)
+{
+    ans_lib_conn_cb_t *p_conn = ans_lib_find_conn_cb(bearer_conn_id);
+    ans_lib_tx_entry_t *p_entry;
+    uint8_t bearer;
+    uint8_t i;
+
+    if ((p_conn == NULL) || ((bearer = ans_lib_find_bearer(p_conn, bearer_conn_id)) == ANS_LIB_BEARER_NONE) ||
+        (bearer == ANS_LIB_BEARER_LEGACY))
+    {
+        return;
+    }
+
+    /* buffers of a closed bearer are not reported transmitted, take their credits back and send the
+     * latest counts of their categories again */
+    for (i = 0; i < WICED_BT_ANS_TX_QUEUE_SIZE; i++)
+    {
+        p_entry = &p_conn->tx_queue[i];
+        if ((p_entry->state != ANS_TX_ENTRY_IN_FLIGHT) || (p_entry->bearer != bearer))
+            continue;
+
+        if (p_entry->multi_ntf)
+        {
+            /* both characteristics of the category were in the multiple notification */
+            p_conn->new_alert_not_sent |= (1 << p_entry->category_id);
+            p_conn->new_alert_retry |= (1 << p_entry->category_id);
+            p_conn->unread_alert_status_not_sent |= (1 << p_entry->category_id);
+            p_conn->unread_alert_status_retry |= (1 << p_entry->category_id);
+            p_entry->multi_ntf = WICED_FALSE;
+            p_conn->multi_ntf_busy = WICED_FALSE;
+        }
+        else
+        {
+            ans_lib_tx_requeue_category(p_conn, p_entry);
+        }
+        p_entry->state = ANS_TX_ENTRY_FREE;
+        p_conn->tx_in_flight--;
+        if (ans_lib_cb.tx_credits < ans_lib_cb.tx_credits_max)
+            ans_lib_cb.tx_credits++;
+    }
+
+    ans_lib_conn_index_remove(bearer_conn_id);
+    memset(&p_conn->bearer[bearer], 0, sizeof(p_conn->bearer[bearer]));
+    p_conn->eatt_bearers--;
+
+    ANS_TRACE_DBG("conn_id:%d bearer:%d closed\n", p_conn->conn_id, bearer);
+
+    ans_lib_tx_retry(p_conn);
+    ans_lib_tx_drain_all();
+}
@@ -60,6 +60,62 @@ extern "C" {
 #include "wiced_bt_gatt.h"
 #include "wiced_bt_types.h"
 
+/**
+* \brief Maximum number of alert notification clients the library can serve at the same time
+*/
+#ifndef WICED_BT_ANS_MAX_CONNECTIONS
+#define WICED_BT_ANS_MAX_CONNECTIONS                    4
+#endif
+
+/**
+* \brief Number of notifications queued per connection while the link is congested or out of TX credits
+*/
+#ifndef WICED_BT_ANS_TX_QUEUE_SIZE
+#define WICED_BT_ANS_TX_QUEUE_SIZE                      8
+#endif
+
+/**
+* \brief Default number of notifications handed to the stack and not transmitted yet, shared by all
+* connections. Use \ref wiced_bt_ans_set_tx_credits to match the controller LE ACL buffer count.
+*/
+#ifndef WICED_BT_ANS_TX_CREDITS
+#define WICED_BT_ANS_TX_CREDITS                         4
+#endif
+
+/**
+* \brief Number of distinct alert texts kept interned. A text is stored once and shared by every
+* connection and every alert showing it.
+*/
+#ifndef WICED_BT_ANS_TEXT_POOL_SIZE
+#define WICED_BT_ANS_TEXT_POOL_SIZE                     16
+#endif
+
+/**
+* \brief Largest New Alert value the library sends in one notification. The value actually sent is
+* also bounded by the ATT MTU of the connection, see \ref wiced_bt_ans_set_mtu. The default fills a
+* single LE data channel PDU once data length extension is in use.
+*/
+#ifndef WICED_BT_ANS_MAX_VALUE_LEN
+#define WICED_BT_ANS_MAX_VALUE_LEN                      244
+#endif
+
+/**
+* \brief Longest alert text kept per category. A New Alert carries as much of it as fits in MTU - 5 bytes
+* of the client, cut at a UTF-8 character boundary. The text is never continued in another New Alert,
+* which the client would count as another alert.
+*/
+#ifndef WICED_BT_ANS_MAX_TEXT_LEN
+#define WICED_BT_ANS_MAX_TEXT_LEN                       100
+#endif
+
+/**
+* \brief Enhanced ATT bearers used per client besides the legacy ATT bearer. The first one is kept for
+* urgent and high priority alerts, New Alert and Unread Alert Status spread over the others.
+*/
+#ifndef WICED_BT_ANS_MAX_EATT_BEARERS
+#define WICED_BT_ANS_MAX_EATT_BEARERS                   3
+#endif
+
 /**
 * \brief List of Handles of an Alert
 */
@@ -80,6 +136,91 @@ typedef struct
     uint16_t notification_control;                      /**< Alert Notification Control handle */
 } wiced_bt_ans_gatt_handles_t;
 
+/**
+* \brief Priority class of an alert category. Queued notifications of a higher class are sent first.
+*
+* By default calls and high prioritized alerts are urgent, missed calls, SMS/MMS, voice mail and instant
+* messages are high, simple and schedule alerts are normal, and email and news are bulk.
+*/
+typedef enum
+{
+    WICED_BT_ANS_PRIORITY_URGENT = 0,                   /**< Sent ahead of everything else */
+    WICED_BT_ANS_PRIORITY_HIGH,                         /**< Sent ahead of normal and bulk */
+    WICED_BT_ANS_PRIORITY_NORMAL,                       /**< Default class */
+    WICED_BT_ANS_PRIORITY_BULK,                         /**< Sent when nothing else is waiting */
+} wiced_bt_ans_priority_t;
+
+/**
+* \brief Notification TX queue statistics of a connection
+*/
+typedef struct
+{
+    uint8_t queue_depth;                                /**< Notifications waiting to be sent */
+    uint8_t in_flight;                                  /**< Notifications handed to the stack, not transmitted yet */
+    uint8_t max_depth;                                  /**< High watermark of queued and in flight notifications */
+    wiced_bool_t congested;                             /**< Legacy ATT bearer currently reported congested */
+    uint8_t eatt_bearers;                               /**< Enhanced ATT bearers open */
+    uint32_t sent;                                      /**< Notifications accepted by the stack */
+    uint32_t drops;                                     /**< Notifications dropped on a full queue or a stack error */
+    uint32_t retries;                                   /**< Sends deferred by congestion and retried later */
+    uint32_t combined;                                  /**< New Alert and Unread Alert Status pairs sent in one multiple notification */
+    uint32_t deadline_misses[ANP_NOTIFY_CATEGORY_COUNT]; /**< Notifications per category sent after the category deadline */
+    uint32_t throttled[ANP_NOTIFY_CATEGORY_COUNT];      /**< Alerts per category deferred by the rate limiter */
+} wiced_bt_ans_tx_stats_t;
+
+/**
+* \brief Stages of the alert latency
+*
+* The latency of an alert starts when the application counts it. While an alert of a category is
+* pending, later alerts of the category are carried by the same notification, the latency counts
+* from the oldest one.
+*/
+typedef enum
+{
+    WICED_BT_ANS_LATENCY_HOLD = 0,                      /**< Alert counted to notification queued: client not ready, coalescing, rate limit */
+    WICED_BT_ANS_LATENCY_QUEUE,                         /**< Notification queued to handed to the stack: TX credits, congestion */
+    WICED_BT_ANS_LATENCY_STACK,                         /**< Notification handed to the stack to reported transmitted */
+    WICED_BT_ANS_LATENCY_TOTAL,                         /**< Alert counted to notification reported transmitted */
+    WICED_BT_ANS_LATENCY_STAGES,
+} wiced_bt_ans_latency_stage_t;
+
+/**
+* \brief Alert latency of one stage of a category, all connections together
+*
+* The percentiles are the upper end of a histogram bucket, within 12.5% of the exact value.
+*/
+typedef struct
+{
+    uint32_t count;                                     /**< Latencies recorded */
+    uint32_t min_us;                                    /**< Smallest latency in us */
+    uint32_t p50_us;                                    /**< Median latency in us */
+    uint32_t p99_us;                                    /**< 99th percentile in us */
+    uint32_t p999_us;                                   /**< 99.9th percentile in us */
+    uint32_t max_us;                                    /**< Largest latency in us */
+} wiced_bt_ans_latency_t;
+
+/**
+* \brief State of a client kept across connections once it is bonded, see
+* \ref wiced_bt_ans_register_client_state_cback
+*/
+typedef struct
+{
+    uint16_t new_alert_cccd;                            /**< New Alert client configuration */
+    uint16_t unread_alert_status_cccd;                  /**< Unread Alert Status client configuration */
+    uint16_t client_configured_new_alerts;              /**< New Alert categories enabled through the control point */
+    uint16_t client_configured_unread_alerts;           /**< Unread Alert Status categories enabled through the control point */
+    uint16_t new_alert_not_sent;                        /**< Categories with a New Alert the client did not receive */
+    uint16_t unread_alert_status_not_sent;              /**< Categories with an Unread Alert Status the client did not receive */
+    uint8_t num_of_new_alerts[ANP_NOTIFY_CATEGORY_COUNT];   /**< New alert count of every category */
+    uint8_t num_of_unread_count[ANP_NOTIFY_CATEGORY_COUNT]; /**< Unread alert count of every category */
+} wiced_bt_ans_client_state_t;
+
+/**
+* \brief Called by \ref wiced_bt_ans_connection_up to get the state a bonded client had on its last
+* connection. Returns WICED_TRUE and fills p_state if the client is bonded and its state is known.
+*/
+typedef wiced_bool_t (*wiced_bt_ans_client_state_cback_t)(uint16_t conn_id, wiced_bt_ans_client_state_t *p_state);
+
 /******************************************************************************
 *          Function Prototypes
 ******************************************************************************/
@@ -92,7 +233,8 @@ typedef struct
 *
 * The application calls this API on an application start to initialize the AIROC BTSDK ANS server library.
 * The ANS GATT Handles are defined in the application. These handles must be passed to
-* the ANS library t initialization time.
+* the ANS library t initialization time. The handles served by the library must lie within 32
+* consecutive handles, as they do within the Alert Notification service.
 *
 * \param           p_gatt_handles : Pointer on a structure containing the Service Handles
 *
@@ -108,6 +250,10 @@ wiced_result_t wiced_bt_ans_init(wiced_bt_ans_gatt_handles_t *p_gatt_handles);
 ***************************************************************************//**
 *
 * The application calls this API when the application is connected with the alert notification client.
+* The library keeps CCCDs, client configured categories and alert counts separately for every connection,
+* up to \ref WICED_BT_ANS_MAX_CONNECTIONS clients at the same time. The state of a bonded client is
+* restored through the callback registered with \ref wiced_bt_ans_register_client_state_cback, its
+* notifications then wait for \ref wiced_bt_ans_connection_encrypted.
 *
 * \param           conn_id : GATT connection ID
 *
@@ -131,6 +277,78 @@ void wiced_bt_ans_connection_up(uint16_t conn_id);
 ******************************************************************************/
 void wiced_bt_ans_connection_down(uint16_t conn_id);
 
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_connection_encrypted
+*
+***************************************************************************//**
+*
+* The application calls this API when the link to a client is encrypted, on BTM_ENCRYPTION_STATUS_EVT.
+* A client whose state was restored on \ref wiced_bt_ans_connection_up gets notifications from now on,
+* without writing its CCCDs or the control point again. With \ref wiced_bt_ans_set_catch_up enabled,
+* the alerts the client missed are sent right away.
+*
+* \param           conn_id : GATT connection ID
+*
+* \return          None.
+*
+******************************************************************************/
+void wiced_bt_ans_connection_encrypted(uint16_t conn_id);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_set_catch_up
+*
+***************************************************************************//**
+*
+* The application calls this API to send the alerts a client missed as soon as its link is encrypted,
+* without waiting for the client to write ANP_ALERT_CONTROL_CMD_NOTIFY_NEW_ALERTS_IMMEDIATE or
+* ANP_ALERT_CONTROL_CMD_NOTIFY_UNREAD_ALERTS_IMMEDIATE. Every pending category the client configured is
+* sent once with its current count, highest priority first, as one batch. Disabled by default.
+*
+* \param           enable : WICED_TRUE to send missed alerts on \ref wiced_bt_ans_connection_encrypted
+*
+* \return          None.
+*
+******************************************************************************/
+void wiced_bt_ans_set_catch_up(wiced_bool_t enable);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_register_client_state_cback
+*
+***************************************************************************//**
+*
+* The application calls this API to keep the state of bonded clients across connections.
+* \ref wiced_bt_ans_connection_up calls p_cback to restore the state the client had, the application
+* saves it with \ref wiced_bt_ans_get_client_state, for example after a CCCD or control point write and
+* before \ref wiced_bt_ans_connection_down.
+*
+* \param           p_cback : Callback returning the state of a bonded client, NULL to disable
+*
+* \return          None.
+*
+******************************************************************************/
+void wiced_bt_ans_register_client_state_cback(wiced_bt_ans_client_state_cback_t p_cback);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_get_client_state
+*
+***************************************************************************//**
+*
+* The application calls this API to get the state of a client to keep while it is bonded. Alerts held
+* back or not sent yet are reported in the not sent categories.
+*
+* \param           conn_id : GATT connection ID
+* \param           p_state : Client state
+*
+* \return          WICED_TRUE   : On success.
+*                  WICED_FALSE  : If conn_id is not connected.
+*
+******************************************************************************/
+wiced_bool_t wiced_bt_ans_get_client_state(uint16_t conn_id, wiced_bt_ans_client_state_t *p_state);
+
 /******************************************************************************
 *
 * Function Name: wiced_bt_ans_set_supported_new_alert_categories
@@ -141,7 +359,7 @@ void wiced_bt_ans_connection_down(uint16_t conn_id);
 * called before the application connects to the alert notification client. Supported new alerts static
 * during the connection.
 *
-* \param           conn_id : GATT connection ID
+* \param           conn_id : GATT connection ID, ignored and kept for API compatibility
 * \param           supported_new_alert_cat  : Server-supported new alert categories.
 *                                             Each category is represented by a bit.
 *                                             The bit is positioned by the category ID value.
@@ -162,7 +380,7 @@ void wiced_bt_ans_set_supported_new_alert_categories(uint16_t conn_id, wiced_bt_
 * called before the application connects to the alert notification client. Supported unread alerts static
 * during the connection.
 *
-* \param           conn_id                     : GATT connection ID
+* \param           conn_id                     : GATT connection ID, ignored and kept for API compatibility
 * \param           supported_unread_alert_cat  : Server-supported unread alert categories.
 *                                                Each category is represented by a bit.
 *                                                The bit is positioned by the category ID value.
@@ -192,6 +410,27 @@ void wiced_bt_ans_set_supported_unread_alert_categories(uint16_t conn_id, wiced_
 wiced_bt_gatt_status_t wiced_bt_ans_process_gatt_read_req(uint16_t conn_id, wiced_bt_gatt_read_t *p_read_hdr, 
                                                           uint8_t *p_read, uint16_t *p_read_len);
 
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_get_attr_value
+*
+***************************************************************************//**
+*
+* The application calls this API to serve a GATT read or read blob request of an ANS attribute straight
+* from the library storage. The value stays valid while the connection is up and may change on the next
+* write or API call, so it must be sent right away.
+*
+* \param           conn_id : GATT connection ID
+* \param           handle  : Attribute handle
+* \param           pp_val  : Receives the value in air order
+* \param           p_len   : Receives the value length
+*
+* \return          Status of the GATT read operation
+*
+******************************************************************************/
+wiced_bt_gatt_status_t wiced_bt_ans_get_attr_value(uint16_t conn_id, uint16_t handle, const uint8_t **pp_val,
+                                                   uint16_t *p_len);
+
 /******************************************************************************
 *
 * Function Name: wiced_bt_ans_process_gatt_write_req
@@ -249,6 +488,109 @@ wiced_bt_gatt_status_t wiced_bt_ans_process_and_send_new_alert(uint16_t conn_id,
 ******************************************************************************/
 wiced_bt_gatt_status_t wiced_bt_ans_process_and_send_unread_alert(uint16_t conn_id, wiced_bt_anp_alert_category_id_t category_id);
 
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_process_and_send_new_alert_all
+*
+***************************************************************************//**
+*
+* The application calls this API to process and send a new alert on given alert category ID to every
+* connected alert notification client. Each connection keeps its own count and is handled the same way as
+* \ref wiced_bt_ans_process_and_send_new_alert.
+*
+* \param           category_id  : New Alert category ID. \ref ANP_ALERT_CATEGORY_ID."Alert category ID".
+*
+* \return          WICED_BT_GATT_WRONG_STATE if no client is connected, otherwise the first failing
+*                  GATT notification status or WICED_BT_GATT_SUCCESS.
+*
+******************************************************************************/
+wiced_bt_gatt_status_t wiced_bt_ans_process_and_send_new_alert_all(wiced_bt_anp_alert_category_id_t category_id);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_process_and_send_unread_alert_all
+*
+***************************************************************************//**
+*
+* The application calls this API to process and send the unread alert on given alert category ID to every
+* connected alert notification client. Each connection keeps its own count and is handled the same way as
+* \ref wiced_bt_ans_process_and_send_unread_alert.
+*
+* \param           category_id  : Unread Alert category ID. \ref ANP_ALERT_CATEGORY_ID. "Alert category ID".
+*
+* \return          WICED_BT_GATT_WRONG_STATE if no client is connected, otherwise the first failing
+*                  GATT notification status or WICED_BT_GATT_SUCCESS.
+*
+******************************************************************************/
+wiced_bt_gatt_status_t wiced_bt_ans_process_and_send_unread_alert_all(wiced_bt_anp_alert_category_id_t category_id);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_process_and_send_new_alert_text
+*
+***************************************************************************//**
+*
+* The application calls this API to send a new alert carrying a sender name or title to an alert client.
+* The text does not need to be NUL terminated and is not accessed after the call returns. Up to
+* WICED_BT_ANS_MAX_TEXT_LEN bytes are kept, and the New Alert carries at most MTU - 5 bytes of them, see
+* \ref wiced_bt_ans_set_mtu. Text beyond that is truncated at a UTF-8 character boundary. The text is
+* interned, so a sender that repeats is neither copied nor rescanned again.
+*
+* \param           conn_id     : GATT connection ID
+* \param           category_id : Alert category ID
+* \param           p_text      : UTF-8 text
+* \param           text_len    : Text length in bytes
+*
+* \return          wiced_bt_gatt_status_t
+*
+******************************************************************************/
+wiced_bt_gatt_status_t wiced_bt_ans_process_and_send_new_alert_text(uint16_t conn_id, wiced_bt_anp_alert_category_id_t category_id,
+                                                                    const char *p_text, uint16_t text_len);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_process_and_send_alerts
+*
+***************************************************************************//**
+*
+* The application calls this API to hand a client several alerts of one category that were raised
+* earlier, for example while no client was connected. The alerts are added to both the new alert count
+* and the unread count, so the client gets one New Alert and one Unread Alert Status for all of them and
+* the rate limit is charged once. Once the call succeeds the alerts belong to the library: a notification
+* that cannot be queued yet is retried, so the caller can drop its copy.
+*
+* \param           conn_id     : GATT connection ID
+* \param           category_id : Alert category ID
+* \param           count       : Number of alerts, at least 1
+* \param           p_text      : UTF-8 text of the latest alert, or NULL for the sample text of the category
+* \param           text_len    : Text length in bytes, 0 if p_text is NULL
+*
+* 
+eturn          WICED_BT_GATT_INVALID_CFG for a bad category, count or text,
+*                  WICED_BT_GATT_WRONG_STATE for an unknown connection, otherwise WICED_BT_GATT_SUCCESS.
+*
+******************************************************************************/
+wiced_bt_gatt_status_t wiced_bt_ans_process_and_send_alerts(uint16_t conn_id, wiced_bt_anp_alert_category_id_t category_id,
+                                                            uint8_t count, const char *p_text, uint16_t text_len);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_process_and_send_new_alert_text_all
+*
+***************************************************************************//**
+*
+* Same as \ref wiced_bt_ans_process_and_send_new_alert_text, for every connected alert client.
+*
+* \param           category_id : Alert category ID
+* \param           p_text      : UTF-8 text
+* \param           text_len    : Text length in bytes
+*
+* \return          wiced_bt_gatt_status_t
+*
+******************************************************************************/
+wiced_bt_gatt_status_t wiced_bt_ans_process_and_send_new_alert_text_all(wiced_bt_anp_alert_category_id_t category_id,
+                                                                        const char *p_text, uint16_t text_len);
+
 /******************************************************************************
 *
 * Function Name: wiced_bt_ans_clear_alerts
@@ -267,6 +609,336 @@ wiced_bt_gatt_status_t wiced_bt_ans_process_and_send_unread_alert(uint16_t conn_
 ******************************************************************************/
 wiced_bool_t wiced_bt_ans_clear_alerts(uint16_t conn_id, wiced_bt_anp_alert_category_id_t category_id);
 
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_clear_alerts_all
+*
+***************************************************************************//**
+*
+* The application calls this API to clear the new alert and unread alert count of the specified category
+* on every connected alert notification client.
+*
+* \param           category_id  : Unread Alert category ID. see @ref ANP_ALERT_CATEGORY_ID. "Alert category ID".
+*
+* \return          WICED_TRUE   : On success.
+*                  WICED_FALSE  : On the invalid category ID.
+*
+******************************************************************************/
+wiced_bool_t wiced_bt_ans_clear_alerts_all(wiced_bt_anp_alert_category_id_t category_id);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_set_coalescing_window
+*
+***************************************************************************//**
+*
+* The application calls this API to coalesce the alerts of a category. The first alert opens the window,
+* the alerts that follow only update the count, and one New Alert and one Unread Alert Status notification
+* with the final count are sent when the window ends. A Notify Immediately command from the client sends
+* the count before the window ends. Setting the window to 0 (default) sends every alert.
+*
+* \param           category_id            : Alert category ID
+* \param           window_ms              : Coalescing window in milliseconds, 0 to disable
+* \param           align_to_conn_interval : Round the window up to whole connection intervals, see
+*                                           \ref wiced_bt_ans_set_conn_interval
+*
+* \return          WICED_TRUE   : On success.
+*                  WICED_FALSE  : On the invalid category ID.
+*
+******************************************************************************/
+wiced_bool_t wiced_bt_ans_set_coalescing_window(wiced_bt_anp_alert_category_id_t category_id, uint16_t window_ms,
+                                                wiced_bool_t align_to_conn_interval);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_set_category_priority
+*
+***************************************************************************//**
+*
+* The application calls this API to change the priority class and the delivery deadline of an alert
+* category. Notifications of a higher class leave the TX queue first, and may push queued notifications
+* of a lower class back to the pending state when the queue is full. Within a class the notification whose
+* deadline runs out first leaves first, notifications without a deadline follow in queue order. The deadline
+* counts from the time the alert was raised, so time held back by the rate limit or coalescing window is
+* included. A notification handed to the stack later than that counts as a deadline miss, see
+* \ref wiced_bt_ans_get_tx_stats.
+*
+* \param           category_id : Alert category ID
+* \param           priority    : Priority class
+* \param           deadline_ms : Delivery deadline in milliseconds, 0 for none
+*
+* \return          WICED_TRUE   : On success.
+*                  WICED_FALSE  : On the invalid category ID or priority.
+*
+******************************************************************************/
+wiced_bool_t wiced_bt_ans_set_category_priority(wiced_bt_anp_alert_category_id_t category_id,
+                                                wiced_bt_ans_priority_t priority, uint16_t deadline_ms);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_set_rate_limit
+*
+***************************************************************************//**
+*
+* The application calls this API to limit the alert rate of an alert category. Every connection has its
+* own token bucket per category holding up to burst alerts and refilled at rate_per_minute. One alert costs
+* one token: the New Alert and the Unread Alert Status of a category counted within one batch, see
+* \ref wiced_bt_ans_begin_batch, share it. Outside a batch every call costs a token. An alert finding the
+* bucket empty still updates the counts, the notifications with the latest counts are deferred until a
+* token is available. Deferred alerts are counted per category, see \ref wiced_bt_ans_get_tx_stats.
+*
+* \param           category_id     : Alert category ID
+* \param           rate_per_minute : Alerts per minute, 0 removes the limit
+* \param           burst           : Alerts that may be sent back to back
+*
+* \return          WICED_TRUE   : On success.
+*                  WICED_FALSE  : On the invalid category ID or a zero burst.
+*
+******************************************************************************/
+wiced_bool_t wiced_bt_ans_set_rate_limit(wiced_bt_anp_alert_category_id_t category_id, uint16_t rate_per_minute,
+                                         uint8_t burst);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_set_conn_interval
+*
+***************************************************************************//**
+*
+* The application calls this API when the connection interval of a client is known, for example on
+* BTM_BLE_CONNECTION_PARAM_UPDATE. Used to align the coalescing windows to connection events.
+*
+* \param           conn_id       : GATT connection ID
+* \param           conn_interval : Connection interval in 1.25 ms units
+*
+* \return          None.
+*
+******************************************************************************/
+void wiced_bt_ans_set_conn_interval(uint16_t conn_id, uint16_t conn_interval);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_set_data_length
+*
+***************************************************************************//**
+*
+* The application calls this API when the data length of a client link is negotiated, for example on
+* BTM_BLE_DATA_LENGTH_UPDATE_EVENT. A New Alert then carries no more text than fits one link layer
+* packet. A data length below 27 bytes is ignored.
+*
+* \param           conn_id       : GATT connection ID
+* \param           max_tx_octets : Link layer TX payload in bytes
+*
+* \return          None.
+*
+******************************************************************************/
+void wiced_bt_ans_set_data_length(uint16_t conn_id, uint16_t max_tx_octets);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_set_multi_ntf
+*
+***************************************************************************//**
+*
+* The application calls this API when a client sets the Multiple Handle Value Notifications bit of its
+* Client Supported Features. The New Alert and the Unread Alert Status of a category waiting to be sent
+* together then go out in one ATT_MULTIPLE_HANDLE_VALUE_NTF, see \ref wiced_bt_ans_begin_batch.
+*
+* \param           conn_id : GATT connection ID
+* \param           enable  : WICED_TRUE if the client supports multiple handle value notifications
+*
+* \return          None.
+*
+******************************************************************************/
+void wiced_bt_ans_set_multi_ntf(uint16_t conn_id, wiced_bool_t enable);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_begin_batch
+*
+***************************************************************************//**
+*
+* The application calls this API before generating several alerts that belong together, for example the
+* New Alert and the Unread Alert Status of one event. Notifications are queued but not sent until
+* \ref wiced_bt_ans_end_batch, so that the two values of a category can share one PDU and one rate limit
+* token. Batches nest.
+*
+* \return          None.
+*
+******************************************************************************/
+void wiced_bt_ans_begin_batch(void);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_end_batch
+*
+***************************************************************************//**
+*
+* The application calls this API to close a batch opened with \ref wiced_bt_ans_begin_batch. The queued
+* notifications are sent when the outermost batch ends.
+*
+* \return          None.
+*
+******************************************************************************/
+void wiced_bt_ans_end_batch(void);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_set_mtu
+*
+***************************************************************************//**
+*
+* The application calls this API once the ATT MTU of a client is negotiated, on GATT_REQ_MTU or on
+* completion of the MTU exchange started by the server. New Alert notifications then carry up to
+* MTU - 3 bytes, at most WICED_BT_ANS_MAX_VALUE_LEN, and alert text beyond that is truncated. The MTU is
+* 23 until this API is called, which leaves 18 bytes of text.
+*
+* \param           conn_id : GATT connection ID
+* \param           mtu     : Negotiated ATT MTU
+*
+* \return          None.
+*
+******************************************************************************/
+void wiced_bt_ans_set_mtu(uint16_t conn_id, uint16_t mtu);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_process_congestion
+*
+***************************************************************************//**
+*
+* The application calls this API on GATT_CONGESTION_EVT. Queued notifications of the connection
+* are held while it is congested and sent when the congestion clears. A congested Enhanced ATT bearer
+* only holds back its own notifications, the other bearers of the client keep sending.
+*
+* \param           conn_id   : GATT connection ID of the legacy or an Enhanced ATT bearer
+* \param           congested : WICED_TRUE when the link is congested
+*
+* \return          None.
+*
+******************************************************************************/
+void wiced_bt_ans_process_congestion(uint16_t conn_id, wiced_bool_t congested);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_process_buffer_transmitted
+*
+***************************************************************************//**
+*
+* The application calls this API on GATT_APP_BUFFER_TRANSMITTED_EVT. The library releases
+* the notification buffer, returns its TX credit and sends the next queued notification.
+*
+* \param           p_app_data : Transmitted buffer
+* \param           p_app_ctx  : Application context passed with the buffer
+*
+* \return          WICED_TRUE   : The buffer belongs to the library.
+*                  WICED_FALSE  : The buffer is not a library buffer, the application must release it.
+*
+******************************************************************************/
+wiced_bool_t wiced_bt_ans_process_buffer_transmitted(uint8_t *p_app_data, void *p_app_ctx);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_set_tx_credits
+*
+***************************************************************************//**
+*
+* The application calls this API to set how many notifications the library may hand to the stack
+* before they are reported transmitted. Match it to the controller LE ACL buffer count.
+*
+* \param           tx_credits : Number of TX credits shared by all connections
+*
+* \return          None.
+*
+******************************************************************************/
+void wiced_bt_ans_set_tx_credits(uint8_t tx_credits);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_get_tx_stats
+*
+***************************************************************************//**
+*
+* The application calls this API to read the notification TX queue statistics of a connection.
+*
+* \param           conn_id : GATT connection ID
+* \param           p_stats : Statistics output
+*
+* \return          WICED_TRUE   : On success.
+*                  WICED_FALSE  : On the unknown connection.
+*
+******************************************************************************/
+wiced_bool_t wiced_bt_ans_get_tx_stats(uint16_t conn_id, wiced_bt_ans_tx_stats_t *p_stats);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_get_latency
+*
+***************************************************************************//**
+*
+* The application calls this API to read the alert latency of one stage of a category, from the
+* monotonic time an alert is counted to the time its notification is queued, handed to the stack and
+* reported transmitted on GATT_APP_BUFFER_TRANSMITTED_EVT.
+*
+* \param           category_id : Alert category ID
+* \param           stage       : Latency stage
+* \param           p_latency   : Latency output
+*
+* \return          WICED_TRUE   : On success.
+*                  WICED_FALSE  : On the wrong category or stage.
+*
+******************************************************************************/
+wiced_bool_t wiced_bt_ans_get_latency(wiced_bt_anp_alert_category_id_t category_id, wiced_bt_ans_latency_stage_t stage,
+                                      wiced_bt_ans_latency_t *p_latency);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_reset_latency
+*
+***************************************************************************//**
+*
+* The application calls this API to clear the alert latency of every stage and category.
+*
+* \return          None.
+*
+******************************************************************************/
+void wiced_bt_ans_reset_latency(void);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_bearer_up
+*
+***************************************************************************//**
+*
+* The application calls this API when an Enhanced ATT bearer to a client opens, or when its MTU is
+* reconfigured. Notifications of the client are spread over its bearers, GATT requests received on the
+* bearer are served for the client.
+*
+* \param           conn_id        : GATT connection ID of the legacy ATT bearer of the client
+* \param           bearer_conn_id : GATT connection ID of the Enhanced ATT bearer
+* \param           mtu            : ATT MTU of the Enhanced ATT bearer
+*
+* \return          WICED_TRUE   : On success.
+*                  WICED_FALSE  : On the unknown connection or when all WICED_BT_ANS_MAX_EATT_BEARERS are in use.
+*
+******************************************************************************/
+wiced_bool_t wiced_bt_ans_bearer_up(uint16_t conn_id, uint16_t bearer_conn_id, uint16_t mtu);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_bearer_down
+*
+***************************************************************************//**
+*
+* The application calls this API when an Enhanced ATT bearer closes. Notifications in flight on the
+* bearer are sent again on the remaining bearers of the client.
+*
+* \param           bearer_conn_id : GATT connection ID of the Enhanced ATT bearer
+*
+* \return          None.
+*
+******************************************************************************/
+void wiced_bt_ans_bearer_down(uint16_t bearer_conn_id);
+
 #ifdef __cplusplus
 }
 #endif
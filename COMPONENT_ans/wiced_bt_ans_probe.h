@@ -0,0 +1,83 @@
+/*
+ * Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+
+/**************************************************************************//**
+* \file
+*
+* \brief USDT probes of the ANS library and application for perf, bpftrace and SystemTap. A probe
+* is a single nop until a tracer attaches to it. Without sys/sdt.h, or with ANS_PROBES_DISABLE
+* defined, the probes compile to nothing.
+*
+* All probes belong to the provider "ans" and carry the GATT connection ID, the alert category
+* and a status, for example `bpftrace -e 'usdt:./linux-example-btstack-alert-server:ans:new_alert_sent { printf("%d %d %d\n", arg0, arg1, arg2); }'`
+*
+* Probe                  | Category argument          | Status argument
+* ---------------------- | -------------------------- | ----------------------------------------------
+* new_alert_accepted     | Category                   | WICED_BT_GATT_SUCCESS
+* unread_alert_accepted  | Category                   | WICED_BT_GATT_SUCCESS
+* new_alert_deferred     | Category                   | WICED_BT_GATT_WRONG_STATE while the client is not ready for it, WICED_BT_GATT_BUSY while it is held back
+* unread_alert_deferred  | Category                   | As new_alert_deferred
+* new_alert_sent         | Category                   | WICED_BT_GATT_SUCCESS, queued for the stack
+* new_alert_failed       | Category                   | WICED_BT_GATT_NO_RESOURCES, the TX queue is full
+* unread_alert_sent      | Category                   | As new_alert_sent
+* unread_alert_failed    | Category                   | As new_alert_failed
+* control_point          | Category, 0xFF for all     | Result of the command, the command ID follows as a fourth argument
+* read_dispatch          | Attribute handle           | Result of the read
+* write_dispatch         | Attribute handle           | Result of the write
+* connection_up          | ANS_PROBE_NO_CATEGORY      | WICED_BT_SUCCESS or WICED_BT_NO_RESOURCES
+* connection_down        | ANS_PROBE_NO_CATEGORY      | WICED_BT_SUCCESS
+*
+******************************************************************************/
+
+#ifndef WICED_BT_ANS_PROBE_H
+#define WICED_BT_ANS_PROBE_H
+
+/**
+* \brief Category argument of the probes not related to a category
+*/
+#define ANS_PROBE_NO_CATEGORY                           0xFF
+
+#if !defined(ANS_PROBES_DISABLE) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define ANS_PROBE(name, conn_id, category, status) DTRACE_PROBE3(ans, name, conn_id, category, status)
+#define ANS_PROBE_CMD(name, conn_id, category, status, cmd) DTRACE_PROBE4(ans, name, conn_id, category, status, cmd)
+#endif
+#endif
+
+#ifndef ANS_PROBE
+#define ANS_PROBE(name, conn_id, category, status)
+#define ANS_PROBE_CMD(name, conn_id, category, status, cmd)
+#endif
+
+#endif /* WICED_BT_ANS_PROBE_H */
@@ -0,0 +1,348 @@
+/*
+ * Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+
+/** @file
+ *
+ * This file implements the binary trace rings of the ANS library and application
+ */
+
+#include "wiced_bt_types.h"
+#include "wiced_bt_trace.h"
+#include "wiced_bt_ans_trace.h"
+#include <stdio.h>
+#include "string.h"
+#include <time.h>
+#include <pthread.h>
+
+#define ANS_TRACE_RING_MASK (WICED_BT_ANS_TRACE_RING_SIZE - 1)
+
+#if (WICED_BT_ANS_TRACE_RING_SIZE & ANS_TRACE_RING_MASK) != 0
+#error "WICED_BT_ANS_TRACE_RING_SIZE must be a power of two"
+#endif
+
+/* Ring indices written by different threads sit on different cache lines */
+#define ANS_TRACE_CACHE_LINE 64
+
+/* Period of the background thread */
+#define ANS_TRACE_DRAIN_MS 10
+
+/* Trace points written to the binary file, open addressed by address. The slot is the format ID */
+#define ANS_TRACE_FMT_TABLE_SIZE 512
+#define ANS_TRACE_FMT_TABLE_MASK (ANS_TRACE_FMT_TABLE_SIZE - 1)
+#define ANS_TRACE_FMT_ID_NONE 0xFFFF
+
+/* Binary file, a magic and then records starting with their type. Fields are little endian */
+#define ANS_TRACE_FILE_MAGIC "ANSTRC1"
+#define ANS_TRACE_REC_FORMAT 'F'  /* id:16 module:8 level:8 line:16 func_len:16 func fmt_len:16 fmt */
+#define ANS_TRACE_REC_EVENT 'E'   /* thread:8 id:16 num_args:8 time_ns:64 args:32 x num_args */
+#define ANS_TRACE_REC_DROPPED 'D' /* thread:8 dropped:32, records dropped so far by the thread */
+
+/* Longest line printed when tracing to WICED_BT_TRACE */
+#define ANS_TRACE_TEXT_MAX 256
+
+typedef struct
+{
+    uint64_t time_ns;                           /* CLOCK_MONOTONIC */
+    const wiced_bt_ans_trace_fmt_t *p_fmt;
+    uint32_t num_args;
+    uint32_t args[WICED_BT_ANS_TRACE_MAX_ARGS];
+} ans_trace_rec_t;
+
+typedef struct
+{
+    uint32_t head __attribute__((aligned(ANS_TRACE_CACHE_LINE))); /* Next record, written by the owning thread */
+    uint32_t dropped;                                              /* Records the owning thread found no room for */
+    uint32_t tail __attribute__((aligned(ANS_TRACE_CACHE_LINE))); /* Next record taken by the background thread */
+    uint32_t dropped_reported;                                     /* Dropped count last written to the file */
+    ans_trace_rec_t rec[WICED_BT_ANS_TRACE_RING_SIZE] __attribute__((aligned(ANS_TRACE_CACHE_LINE)));
+} ans_trace_ring_t;
+
+typedef struct
+{
+    ans_trace_ring_t ring[WICED_BT_ANS_TRACE_MAX_THREADS];
+
+    uint32_t num_rings; /* Rings handed out, may count past WICED_BT_ANS_TRACE_MAX_THREADS */
+
+    uint32_t no_ring_dropped; /* Records of threads that came after the last ring was handed out */
+
+    uint32_t records; /* Records taken by the background thread */
+
+    wiced_bool_t started;
+
+    FILE *p_file; /* Binary trace file, NULL to print */
+
+    const wiced_bt_ans_trace_fmt_t *p_fmt_tbl[ANS_TRACE_FMT_TABLE_SIZE]; /* Trace points written to the file */
+} ans_trace_cb_t;
+
+static ans_trace_cb_t ans_trace_cb;
+
+/* Ring of the calling thread, NULL until its first trace point */
+static __thread ans_trace_ring_t *p_ans_trace_ring;
+static __thread wiced_bool_t ans_trace_no_ring;
+
+/* Hand a ring to the calling thread */
+static ans_trace_ring_t *ans_trace_ring_claim(void)
+{
+    uint32_t idx = __atomic_fetch_add(&ans_trace_cb.num_rings, 1, __ATOMIC_RELAXED);
+
+    if (idx >= WICED_BT_ANS_TRACE_MAX_THREADS)
+    {
+        ans_trace_no_ring = WICED_TRUE;
+        return NULL;
+    }
+
+    p_ans_trace_ring = &ans_trace_cb.ring[idx];
+    return p_ans_trace_ring;
+}
+
+/* Record a trace point, called through ANS_TRACE */
+void wiced_bt_ans_trace_log(const wiced_bt_ans_trace_fmt_t *p_fmt, uint32_t num_args, const uint32_t *p_args)
+{
+    ans_trace_ring_t *p_ring = p_ans_trace_ring;
+    ans_trace_rec_t *p_rec;
+    struct timespec ts;
+    uint32_t head;
+
+    if ((p_ring == NULL) && (ans_trace_no_ring || ((p_ring = ans_trace_ring_claim()) == NULL)))
+    {
+        __atomic_fetch_add(&ans_trace_cb.no_ring_dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    /* only this thread moves the head, the background thread only moves the tail */
+    head = p_ring->head;
+    if ((head - __atomic_load_n(&p_ring->tail, __ATOMIC_ACQUIRE)) >= WICED_BT_ANS_TRACE_RING_SIZE)
+    {
+        __atomic_store_n(&p_ring->dropped, p_ring->dropped + 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    if (num_args > WICED_BT_ANS_TRACE_MAX_ARGS)
+        num_args = WICED_BT_ANS_TRACE_MAX_ARGS;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    p_rec = &p_ring->rec[head & ANS_TRACE_RING_MASK];
+    p_rec->time_ns = (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+    p_rec->p_fmt = p_fmt;
+    p_rec->num_args = num_args;
+    memcpy(p_rec->args, p_args, num_args * sizeof(uint32_t));
+
+    __atomic_store_n(&p_ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+/* Format ID of a trace point in the binary file, its format is written on first use */
+static uint16_t ans_trace_fmt_id(const wiced_bt_ans_trace_fmt_t *p_fmt)
+{
+    uint16_t func_len = (uint16_t)strlen(p_fmt->p_func);
+    uint16_t fmt_len = (uint16_t)strlen(p_fmt->p_format);
+    uint32_t slot = (uint32_t)(((uintptr_t)p_fmt >> 3) * 2654435761u) & ANS_TRACE_FMT_TABLE_MASK;
+    uint32_t probe;
+    uint8_t hdr[10];
+
+    for (probe = 0; probe < ANS_TRACE_FMT_TABLE_SIZE; probe++, slot = (slot + 1) & ANS_TRACE_FMT_TABLE_MASK)
+    {
+        if (ans_trace_cb.p_fmt_tbl[slot] == p_fmt)
+            return (uint16_t)slot;
+
+        if (ans_trace_cb.p_fmt_tbl[slot] == NULL)
+            break;
+    }
+    if (probe == ANS_TRACE_FMT_TABLE_SIZE)
+        return ANS_TRACE_FMT_ID_NONE;
+
+    ans_trace_cb.p_fmt_tbl[slot] = p_fmt;
+
+    hdr[0] = ANS_TRACE_REC_FORMAT;
+    hdr[1] = (uint8_t)slot;
+    hdr[2] = (uint8_t)(slot >> 8);
+    hdr[3] = p_fmt->module;
+    hdr[4] = p_fmt->level;
+    hdr[5] = (uint8_t)p_fmt->line;
+    hdr[6] = (uint8_t)(p_fmt->line >> 8);
+    hdr[7] = (uint8_t)func_len;
+    hdr[8] = (uint8_t)(func_len >> 8);
+    fwrite(hdr, 1, 9, ans_trace_cb.p_file);
+    fwrite(p_fmt->p_func, 1, func_len, ans_trace_cb.p_file);
+    hdr[0] = (uint8_t)fmt_len;
+    hdr[1] = (uint8_t)(fmt_len >> 8);
+    fwrite(hdr, 1, 2, ans_trace_cb.p_file);
+    fwrite(p_fmt->p_format, 1, fmt_len, ans_trace_cb.p_file);
+
+    return (uint16_t)slot;
+}
+
+/* Write a record to the binary file */
+static void ans_trace_write_rec(uint8_t thread, const ans_trace_rec_t *p_rec)
+{
+    uint8_t buf[13 + (4 * WICED_BT_ANS_TRACE_MAX_ARGS)];
+    uint16_t id = ans_trace_fmt_id(p_rec->p_fmt);
+    uint8_t *p = buf;
+    uint32_t i;
+
+    if (id == ANS_TRACE_FMT_ID_NONE)
+        return;
+
+    *p++ = ANS_TRACE_REC_EVENT;
+    *p++ = thread;
+    *p++ = (uint8_t)id;
+    *p++ = (uint8_t)(id >> 8);
+    *p++ = (uint8_t)p_rec->num_args;
+    for (i = 0; i < sizeof(p_rec->time_ns); i++)
+        *p++ = (uint8_t)(p_rec->time_ns >> (8 * i));
+    for (i = 0; i < p_rec->num_args; i++)
+    {
+        *p++ = (uint8_t)p_rec->args[i];
+        *p++ = (uint8_t)(p_rec->args[i] >> 8);
+        *p++ = (uint8_t)(p_rec->args[i] >> 16);
+        *p++ = (uint8_t)(p_rec->args[i] >> 24);
+    }
+    fwrite(buf, 1, p - buf, ans_trace_cb.p_file);
+}
+
+/* Print a record the way the synchronous trace did */
+static void ans_trace_print_rec(const ans_trace_rec_t *p_rec)
+{
+    const uint32_t *a = p_rec->args;
+    char text[ANS_TRACE_TEXT_MAX];
+
+    /* arguments beyond num_args are stale, the format does not use them */
+    snprintf(text, sizeof(text), p_rec->p_fmt->p_format, a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7]);
+    WICED_BT_TRACE("%s%s: %s", (p_rec->p_fmt->level == ANS_TRACE_LEVEL_ERROR) ? "ERR: " : "",
+                   p_rec->p_fmt->p_func, text);
+}
+
+/* Take the records of every ring */
+static void ans_trace_drain(void)
+{
+    uint32_t num_rings = __atomic_load_n(&ans_trace_cb.num_rings, __ATOMIC_RELAXED);
+    ans_trace_ring_t *p_ring;
+    uint32_t head;
+    uint32_t tail;
+    uint32_t dropped;
+    uint8_t buf[6];
+    uint8_t i;
+
+    if (num_rings > WICED_BT_ANS_TRACE_MAX_THREADS)
+        num_rings = WICED_BT_ANS_TRACE_MAX_THREADS;
+
+    for (i = 0; i < num_rings; i++)
+    {
+        p_ring = &ans_trace_cb.ring[i];
+        head = __atomic_load_n(&p_ring->head, __ATOMIC_ACQUIRE);
+        for (tail = p_ring->tail; tail != head; tail++)
+        {
+            if (ans_trace_cb.p_file != NULL)
+                ans_trace_write_rec(i, &p_ring->rec[tail & ANS_TRACE_RING_MASK]);
+            else
+                ans_trace_print_rec(&p_ring->rec[tail & ANS_TRACE_RING_MASK]);
+            __atomic_fetch_add(&ans_trace_cb.records, 1, __ATOMIC_RELAXED);
+        }
+        __atomic_store_n(&p_ring->tail, tail, __ATOMIC_RELEASE);
+
+        dropped = __atomic_load_n(&p_ring->dropped, __ATOMIC_RELAXED);
+        if ((ans_trace_cb.p_file != NULL) && (dropped != p_ring->dropped_reported))
+        {
+            buf[0] = ANS_TRACE_REC_DROPPED;
+            buf[1] = i;
+            buf[2] = (uint8_t)dropped;
+            buf[3] = (uint8_t)(dropped >> 8);
+            buf[4] = (uint8_t)(dropped >> 16);
+            buf[5] = (uint8_t)(dropped >> 24);
+            fwrite(buf, 1, sizeof(buf), ans_trace_cb.p_file);
+            p_ring->dropped_reported = dropped;
+        }
+    }
+
+    if (ans_trace_cb.p_file != NULL)
+        fflush(ans_trace_cb.p_file);
+}
+
+/* Background thread, formats and writes the trace away from the threads recording it */
+static void *ans_trace_thread(void *arg)
+{
+    struct timespec period = {0, ANS_TRACE_DRAIN_MS * 1000000L};
+
+    (void)arg;
+    for (;;)
+    {
+        ans_trace_drain();
+        nanosleep(&period, NULL);
+    }
+    return NULL;
+}
+
+/* Application calls this API to start taking the records of the trace rings */
+wiced_bool_t wiced_bt_ans_trace_start(const char *p_file)
+{
+    pthread_t thread;
+
+    if (ans_trace_cb.started)
+        return WICED_TRUE;
+
+    if (p_file != NULL)
+    {
+        if ((ans_trace_cb.p_file = fopen(p_file, "wb")) == NULL)
+            return WICED_FALSE;
+        fwrite(ANS_TRACE_FILE_MAGIC, 1, sizeof(ANS_TRACE_FILE_MAGIC), ans_trace_cb.p_file);
+    }
+
+    if (pthread_create(&thread, NULL, ans_trace_thread, NULL) != 0)
+    {
+        if (ans_trace_cb.p_file != NULL)
+        {
+            fclose(ans_trace_cb.p_file);
+            ans_trace_cb.p_file = NULL;
+        }
+        return WICED_FALSE;
+    }
+    pthread_detach(thread);
+
+    ans_trace_cb.started = WICED_TRUE;
+    return WICED_TRUE;
+}
+
+/* Application calls this API to get the trace statistics */
+void wiced_bt_ans_trace_get_stats(wiced_bt_ans_trace_stats_t *p_stats)
+{
+    uint32_t num_rings = __atomic_load_n(&ans_trace_cb.num_rings, __ATOMIC_RELAXED);
+    uint32_t i;
+
+    if (num_rings > WICED_BT_ANS_TRACE_MAX_THREADS)
+        num_rings = WICED_BT_ANS_TRACE_MAX_THREADS;
+
+    p_stats->threads = num_rings;
+    p_stats->records = __atomic_load_n(&ans_trace_cb.records, __ATOMIC_RELAXED);
+    p_stats->dropped = __atomic_load_n(&ans_trace_cb.no_ring_dropped, __ATOMIC_RELAXED);
+    for (i = 0; i < num_rings; i++)
+        p_stats->dropped += __atomic_load_n(&ans_trace_cb.ring[i].dropped, __ATOMIC_RELAXED);
+}
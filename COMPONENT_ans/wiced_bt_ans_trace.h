@@ -0,0 +1,195 @@
+/*
+ * Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+
+/**************************************************************************//**
+* \file
+*
+* \brief Binary trace of the ANS library and application. A trace point records its format and
+* integer arguments into a ring of the calling thread; a background thread formats the records
+* or writes them to a file decoded by tools/ans_trace_decode.py.
+*
+******************************************************************************/
+
+#ifndef WICED_BT_ANS_TRACE_H
+#define WICED_BT_ANS_TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "wiced_bt_types.h"
+
+/**
+* \brief Trace levels. A trace point above the level of its module is removed at compile time.
+*/
+#define ANS_TRACE_LEVEL_NONE                            0
+#define ANS_TRACE_LEVEL_ERROR                           1
+#define ANS_TRACE_LEVEL_DEBUG                           2
+
+/**
+* \brief Trace modules, the ANS library and the application
+*/
+#define ANS_TRACE_MODULE_LIB                            0
+#define ANS_TRACE_MODULE_APP                            1
+
+/**
+* \brief Trace level of the ANS library
+*/
+#ifndef ANS_TRACE_LEVEL_LIB
+#define ANS_TRACE_LEVEL_LIB                             ANS_TRACE_LEVEL_DEBUG
+#endif
+
+/**
+* \brief Trace level of the application
+*/
+#ifndef ANS_TRACE_LEVEL_APP
+#define ANS_TRACE_LEVEL_APP                             ANS_TRACE_LEVEL_DEBUG
+#endif
+
+/**
+* \brief Records kept per thread until the background thread takes them, a power of two. Records
+* of a full ring are dropped and counted.
+*/
+#ifndef WICED_BT_ANS_TRACE_RING_SIZE
+#define WICED_BT_ANS_TRACE_RING_SIZE                    1024
+#endif
+
+/**
+* \brief Threads that can trace, each gets a ring on its first trace point
+*/
+#ifndef WICED_BT_ANS_TRACE_MAX_THREADS
+#define WICED_BT_ANS_TRACE_MAX_THREADS                  4
+#endif
+
+/**
+* \brief Integer arguments kept per trace point
+*/
+#define WICED_BT_ANS_TRACE_MAX_ARGS                     8
+
+/**
+* \brief Trace point, one static instance per call site. Its address identifies the format.
+*/
+typedef struct
+{
+    uint8_t module;             /**< ANS_TRACE_MODULE_xxx */
+    uint8_t level;              /**< ANS_TRACE_LEVEL_xxx */
+    uint16_t line;              /**< Source line */
+    const char *p_func;         /**< Function of the trace point */
+    const char *p_format;       /**< printf format taking integer arguments only */
+} wiced_bt_ans_trace_fmt_t;
+
+/**
+* \brief Trace statistics
+*/
+typedef struct
+{
+    uint32_t threads;           /**< Threads that got a ring */
+    uint32_t records;           /**< Records taken by the background thread */
+    uint32_t dropped;           /**< Records lost to a full ring or to a thread without a ring */
+} wiced_bt_ans_trace_stats_t;
+
+/**
+* \brief Record a trace point of a module if the module's level lets it through. Arguments are
+* converted to 32 bit integers, a pointer or string argument does not compile.
+*/
+#define ANS_TRACE(module, level, format, ...)                                                           \
+    do                                                                                                  \
+    {                                                                                                   \
+        if ((level) <= ANS_TRACE_LEVEL_##module)                                                        \
+        {                                                                                               \
+            static const wiced_bt_ans_trace_fmt_t ans_trace_fmt = {ANS_TRACE_MODULE_##module, (level),  \
+                                                                   __LINE__, __func__, format};         \
+            const uint32_t ans_trace_args[] = {0, ##__VA_ARGS__};                                      \
+            wiced_bt_ans_trace_log(&ans_trace_fmt, (sizeof(ans_trace_args) / sizeof(uint32_t)) - 1,     \
+                                   &ans_trace_args[1]);                                                 \
+        }                                                                                               \
+    } while (0)
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_trace_log
+*
+***************************************************************************//**
+*
+* Records a trace point in the ring of the calling thread. Called through \ref ANS_TRACE, it takes
+* a timestamp and copies the arguments, it does not format, lock or block.
+*
+* \param           p_fmt    : Trace point
+* \param           num_args : Number of arguments
+* \param           p_args   : Arguments
+*
+* \return          None.
+*
+******************************************************************************/
+void wiced_bt_ans_trace_log(const wiced_bt_ans_trace_fmt_t *p_fmt, uint32_t num_args, const uint32_t *p_args);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_trace_start
+*
+***************************************************************************//**
+*
+* Starts the background thread that takes the records of every ring. Without a file the records
+* are formatted and printed with WICED_BT_TRACE. With a file they are written in binary, the format
+* of a trace point once before its first record, and tools/ans_trace_decode.py turns the file back
+* into text.
+*
+* \param           p_file : Binary trace file, NULL to print the trace
+*
+* \return          WICED_TRUE   : On success.
+*                  WICED_FALSE  : If the file cannot be created or the thread cannot be started.
+*
+******************************************************************************/
+wiced_bool_t wiced_bt_ans_trace_start(const char *p_file);
+
+/******************************************************************************
+*
+* Function Name: wiced_bt_ans_trace_get_stats
+*
+***************************************************************************//**
+*
+* Gets the number of threads tracing, records taken and records dropped.
+*
+* \param           p_stats : Filled with the statistics
+*
+* \return          None.
+*
+******************************************************************************/
+void wiced_bt_ans_trace_get_stats(wiced_bt_ans_trace_stats_t *p_stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WICED_BT_ANS_TRACE_H */
@@ -61,20 +61,80 @@
 #include "app_bt_utils/app_bt_utils.h"
 #include "COMPONENT_ans/wiced_bt_anp.h"
 #include "COMPONENT_ans/wiced_bt_ans.h"
+#include "COMPONENT_ans/wiced_bt_ans_trace.h"
+#include "COMPONENT_ans/wiced_bt_ans_probe.h"
 #include "COMPONENT_ans/wiced_bt_gatt_util.h"
 #include "app_bt_config/ans_gatt_db.h"
 #include "app_bt_config/ans_bt_settings.h"
 #include "app_bt_config/ans_gap.h"
 #include "bt_app_ans.h"
+#include "bt_app_conn_params.h"
+#include "bt_app_bond_store.h"
+#include "bt_app_offline_alerts.h"
+#include "bt_app_snapshot.h"
+#include "bt_app_metrics.h"
+#include "bt_app_timing.h"
 
 /*******************************************************************************
  *                                   MACROS
  *******************************************************************************/
 #define BT_STACK_HEAP_SIZE ( 0xF000 )
-#define ANS_LOCAL_KEYS_NVRAM_ID WICED_NVRAM_VSID_START
-#define ANS_PAIRED_KEYS_NVRAM_ID ( WICED_NVRAM_VSID_START + 1 )
+#define ANS_LOCAL_KEYS_NVRAM_ID WICED_NVRAM_VSID_START /* Bonds are kept by bt_app_bond_store.c */
 #define ANS_CLIENT_NAME "ANC"
 #define MAX_KEY_SIZE ( 0x10U )
+#define ANS_BULK_ALERT_COALESCING_MS ( 2000U ) /* Email and news bursts are reported once per window */
+#define ANS_MESSAGE_COALESCING_MS ( 500U ) /* Short window for messages, aligned to connection events */
+#define ANS_URGENT_ALERT_DEADLINE_MS ( 100U ) /* Calls and high priority alerts later than this count as missed */
+#define ANS_NEWS_RATE_PER_MINUTE ( 6U ) /* A chatty news feed must not fill the link */
+#define ANS_NEWS_RATE_BURST ( 2U )
+#define ANS_CALL_OFFLINE_TTL_MS ( 30000U ) /* A call raised while no client was connected has stopped ringing by then */
+#define ANS_TRACE_FILE_ENV "ANS_TRACE_FILE" /* Binary trace file, the trace is printed when not set */
+#define ANS_METRICS_SOCKET_ENV "ANS_METRICS_SOCKET" /* Unix socket of the metrics, ans_metrics.sock when not set */
+#define ANS_TIMING_SHM_ENV "ANS_TIMING_SHM" /* Shared memory of the callback timing, /ans_timing when not set */
+
+/* GATT request and alert paths record integer traces in the trace ring, formatted in the background */
+#define BT_APP_TRACE_DBG(format, ...) ANS_TRACE(APP, ANS_TRACE_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#define BT_APP_TRACE_ERR(format, ...) ANS_TRACE(APP, ANS_TRACE_LEVEL_ERROR, format, ##__VA_ARGS__)
+
+/* Dispatch entries of the GATT database layout, see bt_app_ans_attr_tbl */
+#define BT_APP_ANS_ATTR(handle, owner) \
+    [handle] = { &app_gatt_db_ext_attr_tbl[handle], BT_APP_ANS_ATTR_READ_##owner, BT_APP_ANS_ATTR_WRITE_##owner },
+#define BT_APP_ANS_ATTR_NONE(name, uuid)
+#define BT_APP_ANS_ATTR_CHAR(name, uuid, prop, perm, owner, value, len) BT_APP_ANS_ATTR(HDLC_##name##_VALUE, owner)
+#define BT_APP_ANS_ATTR_DESC(name, uuid, perm, owner, value, len) BT_APP_ANS_ATTR(HDLD_##name, owner)
+
+/* Application values are read as they are and are not writable, ANP server library serves its own */
+#define BT_APP_ANS_ATTR_READ_APP NULL
+#define BT_APP_ANS_ATTR_WRITE_APP NULL
+#define BT_APP_ANS_ATTR_READ_LIB wiced_bt_ans_get_attr_value
+#define BT_APP_ANS_ATTR_WRITE_LIB bt_app_ans_lib_write
+#define BT_APP_ANS_ATTR_READ_GATT bt_app_ans_gatt_read
+#define BT_APP_ANS_ATTR_WRITE_GATT bt_app_ans_gatt_write
+
+/* Client Supported Features bits, only the supported ones are kept */
+#define BT_APP_ANS_CSF_ROBUST_CACHING ( 0x01U )
+#define BT_APP_ANS_CSF_EATT ( 0x02U )
+#define BT_APP_ANS_CSF_MULTI_NTF ( 0x04U )
+#define BT_APP_ANS_CSF_SUPPORTED ( BT_APP_ANS_CSF_ROBUST_CACHING | BT_APP_ANS_CSF_EATT | BT_APP_ANS_CSF_MULTI_NTF )
+
+/* Service Changed client configuration */
+#define BT_APP_ANS_CCCD_INDICATION ( 0x0002U )
+
+/* PHY reported by BTM_BLE_PHY_UPDATE_EVT */
+#define BT_APP_ANS_PHY_1M ( 1U )
+#define BT_APP_ANS_PHY_2M ( 2U )
+#define BT_APP_ANS_PHY_CODED ( 3U )
+
+/* LE data channel payload before data length extension */
+#define BT_APP_ANS_LL_OCTETS_DEFAULT ( 27U )
+
+#if ( CY_BT_SERVER_MAX_LINKS > WICED_BT_ANS_MAX_CONNECTIONS )
+#error "ANS library cannot serve CY_BT_SERVER_MAX_LINKS clients, increase WICED_BT_ANS_MAX_CONNECTIONS"
+#endif
+
+#if ( CY_BT_EATT_BEARERS_PER_LINK > WICED_BT_ANS_MAX_EATT_BEARERS )
+#error "ANS library cannot use CY_BT_EATT_BEARERS_PER_LINK bearers, increase WICED_BT_ANS_MAX_EATT_BEARERS"
+#endif
 
 /*******************************************************************************
  *                    STRUCTURES AND ENUMERATIONS
@@ -82,9 +142,43 @@
 typedef struct
 {
     uint16_t conn_id;
+    wiced_bt_device_address_t bd_addr;
+    uint8_t client_features; /* Client Supported Features written by the client, BT_APP_ANS_CSF_xxx */
+    uint16_t service_changed_cccd; /* Service Changed client configuration */
+    wiced_bool_t bonded; /* Client is the bonded device, its GATT state is kept in NVRAM */
+    wiced_bool_t change_aware; /* Client knows the current database, clients that are not bonded always do */
+    wiced_bool_t out_of_sync_sent; /* Database Out Of Sync was sent to the change unaware client */
+    wiced_bool_t gatt_state_dirty; /* GATT state changed in RAM, saved to NVRAM on the next save or disconnect */
+    wiced_bt_db_hash_t db_hash; /* Database Hash the bonded client last knew */
+    wiced_bool_t encrypted; /* Link is encrypted, Enhanced ATT bearers can be opened */
+    wiced_bool_t eatt_requested; /* Enhanced ATT bearers were requested on this connection */
+    uint16_t eatt_conn_id[CY_BT_EATT_BEARERS_PER_LINK]; /* Enhanced ATT bearer connection IDs, 0 if closed */
+    uint8_t tx_phy; /* PHY in use, BT_APP_ANS_PHY_xxx */
+    uint8_t rx_phy;
+    uint16_t max_tx_octets; /* LE data channel payload negotiated by data length extension */
+    uint16_t max_rx_octets;
+} bt_app_ans_conn_t; /* Connected alert notification client */
+
+typedef struct
+{
+    bt_app_ans_conn_t conn[CY_BT_SERVER_MAX_LINKS];
+    uint8_t num_connections;
     wiced_bt_anp_alert_category_enable_t current_enabled_alert_cat;
+    wiced_bt_anp_alert_category_enable_t supported_new_alert_cat; /* Categories the ANS library serves */
+    wiced_bt_anp_alert_category_enable_t supported_unread_alert_cat;
 } bt_app_ans_cb_t; /* Application control block */
 
+typedef wiced_bt_gatt_status_t (*bt_app_ans_attr_read_t)(uint16_t conn_id, uint16_t handle, const uint8_t **pp_val,
+                                                         uint16_t *p_len);
+typedef wiced_bt_gatt_status_t (*bt_app_ans_attr_write_t)(uint16_t conn_id, wiced_bt_gatt_write_req_t *p_data);
+
+typedef struct
+{
+    gatt_db_lookup_table_t *p_attr; /* Attribute record, NULL if the handle has no value */
+    bt_app_ans_attr_read_t p_read; /* Points to the value kept by its owner, NULL to read the record */
+    bt_app_ans_attr_write_t p_write; /* Handles writes, NULL if the handle is not writable */
+} bt_app_ans_attr_t; /* GATT request dispatch entry of a handle */
+
 /******************************************************************************
  *                                EXTERNS
  ******************************************************************************/
@@ -103,20 +197,70 @@ static wiced_result_t bt_app_ans_management_callback(wiced_bt_management_evt_t e
                                                      wiced_bt_management_evt_data_t *p_event_data);
 static void bt_app_ans_scan_result_cback(wiced_bt_ble_scan_results_t *p_scan_result,
                                          uint8_t *p_adv_data);
+static void bt_app_ans_scan_result_process(wiced_bt_ble_scan_results_t *p_scan_result,
+                                           uint8_t *p_adv_data);
 static void bt_app_ans_connection_up(wiced_bt_gatt_connection_status_t *p_conn_status);
 static void bt_app_ans_connection_down(wiced_bt_gatt_connection_status_t *p_conn_status);
 static wiced_bt_gatt_status_t bt_app_ans_gatts_req_callback(wiced_bt_gatt_attribute_request_t *p_data);
 static wiced_bt_gatt_status_t bt_app_ans_gatts_req_read_handler(wiced_bt_gatt_opcode_t opcode, uint16_t conn_id,
                                                                 wiced_bt_gatt_read_t *p_read_data,
                                                                 uint16_t len_requested);
+static wiced_bt_gatt_status_t bt_app_ans_gatts_req_read_by_type_handler(wiced_bt_gatt_opcode_t opcode, uint16_t conn_id,
+                                                                        wiced_bt_gatt_read_by_type_t *p_read_data,
+                                                                        uint16_t len_requested);
+static wiced_bt_gatt_status_t bt_app_ans_gatts_req_read_multi_handler(wiced_bt_gatt_opcode_t opcode, uint16_t conn_id,
+                                                                      wiced_bt_gatt_read_multiple_req_t *p_read_data,
+                                                                      uint16_t len_requested);
 static wiced_bt_gatt_status_t bt_app_ans_gatts_req_write_handler(wiced_bt_gatt_opcode_t opcode, uint16_t conn_id,
                                                                  wiced_bt_gatt_write_req_t *p_data);
 static wiced_bt_gatt_status_t bt_app_ans_gatts_callback(wiced_bt_gatt_evt_t event,
                                                         wiced_bt_gatt_event_data_t *p_data);
-static void bt_app_ans_load_keys_to_addr_resolution_db(void);
-static wiced_bool_t bt_app_ans_save_link_keys(wiced_bt_device_link_keys_t *p_keys);
-static wiced_bool_t bt_app_ans_read_link_keys(wiced_bt_device_link_keys_t *p_keys);
-static gatt_db_lookup_table_t *bt_app_ans_find_attr_by_handle(uint16_t handle);
+static const bt_app_ans_attr_t *bt_app_ans_find_attr_by_handle(uint16_t handle);
+static wiced_bt_gatt_status_t bt_app_ans_attr_value(uint16_t conn_id, uint16_t handle, const uint8_t **pp_val,
+                                                    uint16_t *p_len);
+static bt_app_ans_conn_t *bt_app_ans_find_conn_by_bda(wiced_bt_device_address_t bd_addr);
+static bt_app_ans_conn_t *bt_app_ans_find_conn_by_id(uint16_t conn_id);
+static wiced_bt_gatt_status_t bt_app_ans_gatt_read(uint16_t conn_id, uint16_t handle, const uint8_t **pp_val,
+                                                   uint16_t *p_len);
+static wiced_bt_gatt_status_t bt_app_ans_gatt_write(uint16_t conn_id, wiced_bt_gatt_write_req_t *p_data);
+static void bt_app_ans_gatt_state_restore(bt_app_ans_conn_t *p_conn);
+static void bt_app_ans_gatt_state_save(bt_app_ans_conn_t *p_conn);
+static void bt_app_ans_gatt_bonded(wiced_bt_device_address_t bd_addr);
+static void bt_app_ans_gatt_set_change_aware(bt_app_ans_conn_t *p_conn);
+static void bt_app_ans_gatt_hash_sent(uint16_t conn_id);
+static wiced_bool_t bt_app_ans_gatt_out_of_sync(wiced_bt_gatt_attribute_request_t *p_attr_req);
+static void bt_app_ans_gatt_send_service_changed(wiced_bt_device_address_t bd_addr);
+static void bt_app_ans_eatt_connect_ind(wiced_bt_eatt_connection_indication_event_t *p_ind);
+static void bt_app_ans_eatt_encrypted(wiced_bt_device_address_t bd_addr);
+static void bt_app_ans_eatt_open(bt_app_ans_conn_t *p_conn);
+static void bt_app_ans_eatt_bearer_up(bt_app_ans_conn_t *p_conn, uint16_t conn_id);
+static void bt_app_ans_eatt_bearer_down(bt_app_ans_conn_t *p_conn, uint16_t conn_id);
+static uint8_t bt_app_ans_eatt_num_bearers(bt_app_ans_conn_t *p_conn);
+static void bt_app_ans_link_setup(bt_app_ans_conn_t *p_conn);
+static void bt_app_ans_link_phy_update(wiced_bt_ble_phy_update_t *p_phy);
+static void bt_app_ans_link_data_length_update(wiced_bt_ble_phy_data_length_update_t *p_dle);
+static const char *bt_app_ans_phy_name(uint8_t phy);
+static wiced_bt_gatt_status_t bt_app_ans_lib_write(uint16_t conn_id, wiced_bt_gatt_write_req_t *p_data);
+static wiced_bool_t bt_app_ans_client_state_restore(uint16_t conn_id, wiced_bt_ans_client_state_t *p_state);
+static void bt_app_ans_client_state_save(bt_app_ans_conn_t *p_conn);
+static void bt_app_ans_client_encrypted(wiced_bt_device_address_t bd_addr);
+static void bt_app_ans_snapshot_restore(void);
+static void bt_app_ans_snapshot_update(void);
+static void bt_app_ans_metrics_update(void);
+static void bt_app_ans_metrics_alert(uint8_t category_id, wiced_bt_gatt_status_t gatt_status);
+static void bt_app_ans_print_latency(uint8_t cat);
+
+/* GATT request dispatch, indexed by attribute handle */
+static const bt_app_ans_attr_t bt_app_ans_attr_tbl[HDL_COUNT] =
+{
+    ANS_GATT_DB_LAYOUT(BT_APP_ANS_ATTR_NONE, BT_APP_ANS_ATTR_CHAR, BT_APP_ANS_ATTR_CHAR, BT_APP_ANS_ATTR_DESC)
+};
+
+/* Enhanced ATT, bearers opened by a client are accepted up to CY_BT_EATT_BEARERS_PER_LINK */
+static wiced_bt_eatt_callbacks_t bt_app_ans_eatt_cbs =
+{
+    .eatt_connect_ind_cb = bt_app_ans_eatt_connect_ind,
+};
 
 /*******************************************************************************
  *                       FUNCTION DEFINITIONS
@@ -141,6 +285,15 @@ void application_start()
 
     WICED_BT_TRACE("Bluetooth Alert Server Application\n");
 
+    if (!wiced_bt_ans_trace_start(getenv(ANS_TRACE_FILE_ENV)))
+        WICED_BT_TRACE("Err: trace not started \n");
+
+    if (!bt_app_metrics_start(getenv(ANS_METRICS_SOCKET_ENV)))
+        WICED_BT_TRACE("Err: metrics not started \n");
+
+    if (!bt_app_timing_init(getenv(ANS_TIMING_SHM_ENV)))
+        WICED_BT_TRACE("Err: callback timing not mapped \n");
+
     memset(&ans_app_cb, 0, sizeof(ans_app_cb));
 
     /* Register call back and configuration with stack */
@@ -207,21 +360,50 @@ void ans_application_init(void)
     if (result != WICED_BT_SUCCESS)
         WICED_BT_TRACE("Err: wiced_bt_ans_init failed status:%d\n", result);
 
+    bt_app_conn_params_init();
+
+    /* Alerts raised while no client is connected wait for the next one, calls only while they ring */
+    bt_app_offline_alerts_init();
+    bt_app_offline_alerts_set_ttl(ANP_ALERT_CATEGORY_ID_CALL, ANS_CALL_OFFLINE_TTL_MS);
+
+    /* Bonded clients get their CCCDs, configured categories and pending alerts back on reconnection */
+    wiced_bt_ans_register_client_state_cback(bt_app_ans_client_state_restore);
+
+    /* Alerts a client missed are sent once its link is encrypted, instead of waiting for the control point */
+    wiced_bt_ans_set_catch_up(WICED_TRUE);
+
+    /* Calls and high priority alerts are sent right away, bursts of the other categories are coalesced */
+    wiced_bt_ans_set_coalescing_window(ANP_ALERT_CATEGORY_ID_EMAIL, ANS_BULK_ALERT_COALESCING_MS, WICED_FALSE);
+    wiced_bt_ans_set_coalescing_window(ANP_ALERT_CATEGORY_ID_NEWS, ANS_BULK_ALERT_COALESCING_MS, WICED_FALSE);
+    wiced_bt_ans_set_coalescing_window(ANP_ALERT_CATEGORY_ID_SMS_OR_MMS, ANS_MESSAGE_COALESCING_MS, WICED_TRUE);
+    wiced_bt_ans_set_coalescing_window(ANP_ALERT_CATEGORY_ID_INSTANT_MESSAGE, ANS_MESSAGE_COALESCING_MS, WICED_TRUE);
+    wiced_bt_ans_set_rate_limit(ANP_ALERT_CATEGORY_ID_NEWS, ANS_NEWS_RATE_PER_MINUTE, ANS_NEWS_RATE_BURST);
+    wiced_bt_ans_set_category_priority(ANP_ALERT_CATEGORY_ID_CALL, WICED_BT_ANS_PRIORITY_URGENT,
+                                       ANS_URGENT_ALERT_DEADLINE_MS);
+    wiced_bt_ans_set_category_priority(ANP_ALERT_CATEGORY_ID_HIGH_PRI_ALERT, WICED_BT_ANS_PRIORITY_URGENT,
+                                       ANS_URGENT_ALERT_DEADLINE_MS);
+
     /* Register with stack to receive GATT callback */
     gatt_status = wiced_bt_gatt_register(bt_app_ans_gatts_callback);
 
     WICED_BT_TRACE("wiced_bt_gatt_register: %d\n", gatt_status);
 
-    /*  Tell stack to use our GATT databse */
-    gatt_status = wiced_bt_gatt_db_init(gatt_database, gatt_database_len, NULL);
+    /* Enhanced ATT bearers carry the notifications next to the legacy ATT bearer */
+    gatt_status = wiced_bt_eatt_register(&bt_app_ans_eatt_cbs, CY_BT_EATT_MTU_SIZE, CY_BT_MAX_EATT_BEARERS,
+                                         CY_BT_EATT_MAX_BUFFERS);
+
+    WICED_BT_TRACE("wiced_bt_eatt_register: %d\n", gatt_status);
+
+    /*  Tell stack to use our GATT databse, it computes the Database Hash of it */
+    gatt_status = wiced_bt_gatt_db_init(gatt_database, gatt_database_len, app_gatt_database_hash);
 
     WICED_BT_TRACE("wiced_bt_gatt_db_init %d\n", gatt_status);
 
     /* Allow peer to pair */
     wiced_bt_set_pairable_mode(WICED_TRUE, 0);
 
-    /* Load the address resolution DB with the keys stored in the NVRAM */
-    bt_app_ans_load_keys_to_addr_resolution_db();
+    /* Load the bonds from the NVRAM and the address resolution DB with their keys */
+    bt_app_bond_store_init();
 
     /* Currently application demonstrates,
      * simple alerts, email and SMS or MMS categories*/
@@ -230,8 +412,14 @@ void ans_application_init(void)
                                            ANP_ALERT_CATEGORY_ENABLE_SMS_OR_MMS;
 
     /* tell to ANS library on current supported categories */
-    wiced_bt_ans_set_supported_new_alert_categories(0, ans_app_cb.current_enabled_alert_cat);
-    wiced_bt_ans_set_supported_unread_alert_categories(0, ans_app_cb.current_enabled_alert_cat);
+    ans_app_cb.supported_new_alert_cat = ans_app_cb.current_enabled_alert_cat;
+    ans_app_cb.supported_unread_alert_cat = ans_app_cb.current_enabled_alert_cat;
+    wiced_bt_ans_set_supported_new_alert_categories(0, ans_app_cb.supported_new_alert_cat);
+    wiced_bt_ans_set_supported_unread_alert_categories(0, ans_app_cb.supported_unread_alert_cat);
+
+    /* Continue with the state of the last run, the categories set by the user and the alerts of the
+     * bonded clients that were connected */
+    bt_app_ans_snapshot_restore();
 }
 
 /*******************************************************************************
@@ -254,10 +442,10 @@ void ans_application_init(void)
 wiced_result_t bt_app_ans_management_callback(wiced_bt_management_evt_t event,
                                               wiced_bt_management_evt_data_t *p_event_data)
 {
+    uint64_t start_ns = bt_app_timing_now();
     wiced_bt_device_address_t bda = {0};
     wiced_bt_ble_advert_mode_t *p_adv_mode = NULL;
     wiced_result_t result = WICED_BT_SUCCESS;
-    wiced_bt_device_link_keys_t link_keys;
     uint8_t *p_keys;
 
     WICED_BT_TRACE("Bluetooth Management Event: 0x%x %s\n", event, (char *)get_bt_event_name(event));
@@ -325,6 +513,12 @@ wiced_result_t bt_app_ans_management_callback(wiced_bt_management_evt_t event,
         }
         WICED_BT_TRACE("Encryption Status Event: bd (%B) res %d", p_event_data->encryption_status.bd_addr,
                        p_event_data->encryption_status.result);
+        if (p_event_data->encryption_status.result == WICED_SUCCESS)
+        {
+            bt_app_ans_client_encrypted(p_event_data->encryption_status.bd_addr);
+            bt_app_ans_gatt_send_service_changed(p_event_data->encryption_status.bd_addr);
+            bt_app_ans_eatt_encrypted(p_event_data->encryption_status.bd_addr);
+        }
         break;
 
     case BTM_SECURITY_REQUEST_EVT:
@@ -342,7 +536,8 @@ wiced_result_t bt_app_ans_management_callback(wiced_bt_management_evt_t event,
             WICED_BT_TRACE("Callback data pointer p_event_data is NULL \n");
             break;
         }
-        bt_app_ans_save_link_keys(&p_event_data->paired_device_link_keys_update);
+        bt_app_bond_store_save_keys(&p_event_data->paired_device_link_keys_update);
+        bt_app_ans_gatt_bonded(p_event_data->paired_device_link_keys_update.bd_addr);
         break;
 
     case BTM_PAIRED_DEVICE_LINK_KEYS_REQUEST_EVT:
@@ -351,30 +546,17 @@ wiced_result_t bt_app_ans_management_callback(wiced_bt_management_evt_t event,
             WICED_BT_TRACE("Callback data pointer p_event_data is NULL \n");
             break;
         }
-        p_keys = (uint8_t *)&p_event_data->paired_device_link_keys_request;
-        result = bt_app_ans_save_link_keys(&link_keys);
-        /* Break if link key retrieval is failed or link key is not available. */
-        if (result != WICED_SUCCESS)
+        /* Keys of bonded devices are in memory, the NVRAM is not read here */
+        if (!bt_app_bond_store_get_keys(p_event_data->paired_device_link_keys_request.bd_addr,
+                                        &p_event_data->paired_device_link_keys_request))
         {
+            bt_app_metrics_add(BT_APP_METRIC_KEY_STORE, BT_APP_METRICS_KEY_STORE_MISS, 1);
             result = WICED_BT_ERROR;
-            WICED_BT_TRACE("\n Reading keys from NVRAM failed or link key not available.");
-            break;
-        }
-
-        WICED_BT_TRACE("Keys read from NVRAM ");
-        WICED_BT_TRACE("Result: %d \n", result);
-
-        /* Compare the BDA */
-        if (memcmp(&(link_keys.bd_addr), &(p_event_data->paired_device_link_keys_request.bd_addr),
-                   sizeof(wiced_bt_device_address_t)) == 0)
-        {
-            memcpy(p_keys, (uint8_t *)&link_keys, sizeof(wiced_bt_device_link_keys_t));
-            result = WICED_SUCCESS;
+            WICED_BT_TRACE("Link key not available for %B \n", p_event_data->paired_device_link_keys_request.bd_addr);
         }
         else
         {
-            result = WICED_BT_ERROR;
-            WICED_BT_TRACE("Key retrieval failure\n");
+            bt_app_metrics_add(BT_APP_METRIC_KEY_STORE, BT_APP_METRICS_KEY_STORE_HIT, 1);
         }
         break;
 
@@ -439,6 +621,17 @@ wiced_result_t bt_app_ans_management_callback(wiced_bt_management_evt_t event,
             WICED_BT_TRACE("Callback data pointer p_event_data is NULL \n");
             break;
         }
+        if (p_event_data->ble_connection_param_update.status == WICED_BT_SUCCESS)
+        {
+            bt_app_ans_conn_t *p_conn = bt_app_ans_find_conn_by_bda(p_event_data->ble_connection_param_update.bd_addr);
+
+            if (p_conn != NULL)
+            {
+                wiced_bt_ans_set_conn_interval(p_conn->conn_id,
+                                               p_event_data->ble_connection_param_update.conn_interval);
+            }
+        }
+        bt_app_conn_params_update_evt(&p_event_data->ble_connection_param_update);
         WICED_BT_TRACE("Connection parameter update status:%d, Connection Interval: %d, \
                                        Connection Latency: %d, Connection Timeout: %d\n",
                        p_event_data->ble_connection_param_update.status,
@@ -447,11 +640,43 @@ wiced_result_t bt_app_ans_management_callback(wiced_bt_management_evt_t event,
                        p_event_data->ble_connection_param_update.supervision_timeout);
         break;
 
+    case BTM_BLE_PHY_UPDATE_EVT:
+        if (p_event_data == NULL)
+        {
+            WICED_BT_TRACE("Callback data pointer p_event_data is NULL \n");
+            break;
+        }
+        bt_app_ans_link_phy_update(&p_event_data->ble_phy_update_event);
+        break;
+
+    case BTM_BLE_DATA_LENGTH_UPDATE_EVENT:
+        if (p_event_data == NULL)
+        {
+            WICED_BT_TRACE("Callback data pointer p_event_data is NULL \n");
+            break;
+        }
+        bt_app_ans_link_data_length_update(&p_event_data->ble_data_length_update_event);
+        break;
+
+    case BTM_BLE_SUBRATE_CHANGE_EVENT:
+        if (p_event_data == NULL)
+        {
+            WICED_BT_TRACE("Callback data pointer p_event_data is NULL \n");
+            break;
+        }
+        WICED_BT_TRACE("Subrate change status:%d, Subrate Factor: %d, Peripheral Latency: %d\n",
+                       p_event_data->ble_subrate_change_event.status,
+                       p_event_data->ble_subrate_change_event.subrate_factor,
+                       p_event_data->ble_subrate_change_event.peripheral_latency);
+        bt_app_conn_params_subrate_evt(&p_event_data->ble_subrate_change_event);
+        break;
+
     default:
         // WICED_BT_TRACE("Unhandled Bluetooth Management Event: 0x%x %s\n", event, get_bt_event_name(event));
         break;
     }
 
+    bt_app_timing_record(BT_APP_TIMING_MANAGEMENT, (uint16_t)event, start_ns);
     return result;
 }
 
@@ -459,7 +684,7 @@ wiced_result_t bt_app_ans_management_callback(wiced_bt_management_evt_t event,
  * Function Name: bt_app_ans_scan_result_cback
  ********************************************************************************
  * Summary:
- *   This function handles the scan results and attempt to connect to ANS client.
+ *   Scan result callback of the stack, records the time spent on every result.
  *
  * Parameters:
  *   p_scan_result :Result with details after Scanning
@@ -470,6 +695,28 @@ wiced_result_t bt_app_ans_management_callback(wiced_bt_management_evt_t event,
  *
  *******************************************************************************/
 void bt_app_ans_scan_result_cback(wiced_bt_ble_scan_results_t *p_scan_result, uint8_t *p_adv_data)
+{
+    uint64_t start_ns = bt_app_timing_now();
+
+    bt_app_ans_scan_result_process(p_scan_result, p_adv_data);
+    bt_app_timing_record(BT_APP_TIMING_SCAN, 0, start_ns);
+}
+
+/*******************************************************************************
+ * Function Name: bt_app_ans_scan_result_process
+ ********************************************************************************
+ * Summary:
+ *   This function handles the scan results and attempt to connect to ANS client.
+ *
+ * Parameters:
+ *   p_scan_result :Result with details after Scanning
+ *   p_adv_data    : Pointer to Advertising data
+ *
+ * Return:
+ *  None
+ *
+ *******************************************************************************/
+static void bt_app_ans_scan_result_process(wiced_bt_ble_scan_results_t *p_scan_result, uint8_t *p_adv_data)
 {
     wiced_result_t status;
     wiced_bool_t ret_status;
@@ -488,6 +735,12 @@ void bt_app_ans_scan_result_cback(wiced_bt_ble_scan_results_t *p_scan_result, ui
             return;
         }
 
+        /* Skip clients we are already serving */
+        if (bt_app_ans_find_conn_by_bda(p_scan_result->remote_bd_addr) != NULL)
+        {
+            return;
+        }
+
         WICED_BT_TRACE("Found ANS client : %B \n", p_scan_result->remote_bd_addr);
 
         /* Stop the scan since the desired device is found */
@@ -528,6 +781,7 @@ void bt_app_ans_scan_result_cback(wiced_bt_ble_scan_results_t *p_scan_result, ui
 static wiced_bt_gatt_status_t bt_app_ans_gatts_callback(wiced_bt_gatt_evt_t event,
                                                         wiced_bt_gatt_event_data_t *p_data)
 {
+    uint64_t start_ns = bt_app_timing_now();
     wiced_bt_gatt_status_t result = WICED_BT_GATT_SUCCESS;
 
     if (p_data == NULL)
@@ -552,11 +806,29 @@ static wiced_bt_gatt_status_t bt_app_ans_gatts_callback(wiced_bt_gatt_evt_t even
         result = bt_app_ans_gatts_req_callback(&p_data->attribute_request);
         break;
 
+    case GATT_CONGESTION_EVT:
+        wiced_bt_ans_process_congestion(p_data->congestion.conn_id, p_data->congestion.congested);
+        break;
+
+    case GATT_APP_BUFFER_TRANSMITTED_EVT:
+        /* ANS library notifications, or a read response taken from the default heap */
+        if (!wiced_bt_ans_process_buffer_transmitted(p_data->buffer_xmitted.p_app_data,
+                                                     p_data->buffer_xmitted.p_app_ctx) &&
+            (p_data->buffer_xmitted.p_app_ctx == (void *)p_default_heap))
+        {
+            wiced_bt_free_buffer(p_data->buffer_xmitted.p_app_data);
+        }
+        break;
+
     default:
         result = WICED_BT_GATT_SUCCESS;
         break;
     }
 
+    bt_app_timing_record(BT_APP_TIMING_GATT,
+                         (event == GATT_ATTRIBUTE_REQUEST_EVT) ?
+                             BT_APP_TIMING_GATT_OPCODE(p_data->attribute_request.opcode) : (uint16_t)event,
+                         start_ns);
     return result;
 }
 
@@ -575,28 +847,54 @@ static wiced_bt_gatt_status_t bt_app_ans_gatts_callback(wiced_bt_gatt_evt_t even
 *******************************************************************************/
 void bt_app_ans_connection_up(wiced_bt_gatt_connection_status_t *p_conn_status)
 {
-    wiced_bt_device_link_keys_t keys;
     wiced_result_t result;
     wiced_bt_ble_sec_action_type_t sec_act = BTM_BLE_SEC_ENCRYPT;
+    bt_app_ans_conn_t *p_conn;
 
     if (p_conn_status->connected == TRUE)
     {
-        WICED_BT_TRACE("Connected to ANC \n");
+        /* A bearer the stack returned when it was opened, or another connection of a connected client, is
+         * one of its Enhanced ATT bearers */
+        p_conn = bt_app_ans_find_conn_by_id(p_conn_status->conn_id);
+        if (p_conn == NULL)
+            p_conn = bt_app_ans_find_conn_by_bda(p_conn_status->bd_addr);
+        if (p_conn != NULL)
+        {
+            bt_app_ans_eatt_bearer_up(p_conn, p_conn_status->conn_id);
+            return;
+        }
+
+        WICED_BT_TRACE("Connected to ANC conn_id:%d \n", p_conn_status->conn_id);
 
-        ans_app_cb.conn_id = p_conn_status->conn_id;
+        /* Find a free entry for the new client */
+        p_conn = bt_app_ans_find_conn_by_bda(NULL);
+        if (p_conn == NULL)
+        {
+            WICED_BT_TRACE("Max ANC connections reached, disconnecting conn_id:%d \n", p_conn_status->conn_id);
+            wiced_bt_gatt_disconnect(p_conn_status->conn_id);
+            return;
+        }
+        p_conn->conn_id = p_conn_status->conn_id;
+        memcpy(p_conn->bd_addr, p_conn_status->bd_addr, sizeof(wiced_bt_device_address_t));
+        ans_app_cb.num_connections++;
 
         /* Need to notify ANP Server library that the connection is up */
         wiced_bt_ans_connection_up(p_conn_status->conn_id);
+        bt_app_offline_alerts_deliver(p_conn_status->conn_id);
+        bt_app_conn_params_connection_up(p_conn_status->conn_id, p_conn_status->bd_addr);
+        bt_app_ans_link_setup(p_conn);
+
+        /* A bonded client gets back the GATT state it had, a client that is not bonded starts change aware */
+        bt_app_ans_gatt_state_restore(p_conn);
+        bt_app_ans_snapshot_update();
+        bt_app_ans_metrics_update();
 
         /* if the peer already paired with us initiate encryption instead waiting client to
         initiate*/
-        if (bt_app_ans_save_link_keys(&keys))
+        if (bt_app_bond_store_get_keys(p_conn_status->bd_addr, NULL))
         {
-            if (!memcmp(p_conn_status->bd_addr, keys.bd_addr, LOCAL_BDA_LEN))
-            {
-                result = wiced_bt_dev_set_encryption(keys.bd_addr, BT_TRANSPORT_LE, &sec_act);
-                WICED_BT_TRACE("Start Encryption %B %d \n", keys.bd_addr, result);
-            }
+            result = wiced_bt_dev_set_encryption(p_conn_status->bd_addr, BT_TRANSPORT_LE, &sec_act);
+            WICED_BT_TRACE("Start Encryption %B %d \n", p_conn_status->bd_addr, result);
         }
     }
     else
@@ -620,317 +918,1496 @@ void bt_app_ans_connection_up(wiced_bt_gatt_connection_status_t *p_conn_status)
 *******************************************************************************/
 void bt_app_ans_connection_down(wiced_bt_gatt_connection_status_t *p_conn_status)
 {
-    WICED_BT_TRACE("Disconnected from ANC \n");
+    bt_app_ans_conn_t *p_conn = bt_app_ans_find_conn_by_id(p_conn_status->conn_id);
+    uint8_t i;
 
-    /* tell library that connection is down */
-    wiced_bt_ans_connection_down(p_conn_status->conn_id);
+    if ((p_conn != NULL) && (p_conn->conn_id != p_conn_status->conn_id))
+    {
+        bt_app_ans_eatt_bearer_down(p_conn, p_conn_status->conn_id);
+        return;
+    }
 
-    ans_app_cb.conn_id = 0;
-}
+    WICED_BT_TRACE("Disconnected from ANC conn_id:%d \n", p_conn_status->conn_id);
 
-/*******************************************************************************
- * Function Name: bt_app_ans_gatts_req_callback
- ********************************************************************************
- * Summary:
- *   Process GATT request from the peer. Even our main goal is to be a GATT client for the
- *   ANCS service, we need to support mandatory GATT procedures.
- *
- * Parameters:
- *  p_attr_req     Pointer to LE GATT connection status
- *
- * Return:
- *  wiced_bt_gatt_status_t: See possible status codes in wiced_bt_gatt_status_e
- *  in wiced_bt_gatt.h
- *
- *******************************************************************************/
-static wiced_bt_gatt_status_t bt_app_ans_gatts_req_callback(wiced_bt_gatt_attribute_request_t *p_attr_req)
-{
-    wiced_bt_gatt_status_t gatt_status = WICED_BT_GATT_ERROR;
-    if (NULL != p_attr_req)
+    /* keep the alerts the bonded client missed and the GATT state learnt meanwhile for its next connection */
+    if (p_conn != NULL)
     {
-        switch (p_attr_req->opcode)
-        {
-        case GATT_REQ_READ:
-        case GATT_REQ_READ_BLOB:
-            /* Attribute read request */
-            gatt_status = bt_app_ans_gatts_req_read_handler(p_attr_req->opcode, p_attr_req->conn_id,
-                                                            &(p_attr_req->data.read_req),
-                                                            p_attr_req->len_requested);
-            break;
-
-        case GATT_REQ_WRITE:
-        case GATT_CMD_WRITE:
-            /* Attribute write request */
-            gatt_status = bt_app_ans_gatts_req_write_handler(p_attr_req->opcode, p_attr_req->conn_id,
-                                                             &(p_attr_req->data.write_req));
-            break;
+        if (p_conn->gatt_state_dirty)
+            bt_app_ans_gatt_state_save(p_conn);
+        bt_app_ans_client_state_save(p_conn);
+    }
 
-        case GATT_HANDLE_VALUE_NOTIF:
-            WICED_BT_TRACE("GATT_HANDLE_VALUE_NOTIF received for Notification Sent \n");
-            break;
+    /* tell library that connection is down */
+    wiced_bt_ans_connection_down(p_conn_status->conn_id);
+    bt_app_conn_params_connection_down(p_conn_status->conn_id);
 
-        default:
-            WICED_BT_TRACE("ERROR: Unhandled GATT GATT_ATTRIBUTE_REQUEST_EVT Opcode: 0x%x\n", p_attr_req->opcode);
+    for (i = 0; i < CY_BT_SERVER_MAX_LINKS; i++)
+    {
+        if (ans_app_cb.conn[i].conn_id == p_conn_status->conn_id)
+        {
+            memset(&ans_app_cb.conn[i], 0, sizeof(bt_app_ans_conn_t));
+            ans_app_cb.num_connections--;
             break;
         }
     }
-    return gatt_status;
+    bt_app_ans_snapshot_update();
+    bt_app_ans_metrics_update();
 }
 
 /*******************************************************************************
- * Function Name: bt_app_ans_gatts_req_read_handler
- ********************************************************************************
- * Summary:
- *   This function handles Read Requests received from the client device
+ * Function Name : bt_app_ans_find_conn_by_bda
+ * *****************************************************************************
+ * Summary :
+ *    Find the connected client with the given address. Passing NULL returns
+ *    the first free entry of the connection table.
  *
  * Parameters:
- *   conn_id       Connection ID
- *   opcode        LE GATT request type opcode
- *   p_read_req    Pointer to read request containing the handle to read
- *   len_req       length of data requested
+ *    bd_addr:    address of the client, or NULL
  *
  * Return:
- *   wiced_bt_gatt_status_t: See possible status codes in wiced_bt_gatt_status_e
- *   in wiced_bt_gatt.h
- *
- ********************************************************************************/
-wiced_bt_gatt_status_t bt_app_ans_gatts_req_read_handler(wiced_bt_gatt_opcode_t opcode,
-                                                         uint16_t conn_id,
-                                                         wiced_bt_gatt_read_t *p_data,
-                                                         uint16_t len_requested)
+ *    bt_app_ans_conn_t:   matching entry, NULL if not found
+ ******************************************************************************/
+static bt_app_ans_conn_t *bt_app_ans_find_conn_by_bda(wiced_bt_device_address_t bd_addr)
 {
-    wiced_bt_gatt_status_t gatt_status = WICED_BT_GATT_SUCCESS;
-    int attr_len_to_copy;
-    uint8_t *from;
-    int to_send;
-    gatt_db_lookup_table_t *attrRec;
-
-    WICED_BT_TRACE("Read_handler: conn_id:%d hdl:0x%x offset:%d \n ", conn_id, p_data->handle, p_data->offset);
-    if (NULL == (attrRec = bt_app_ans_find_attr_by_handle(p_data->handle)))
-    {
-        wiced_bt_gatt_server_send_error_rsp(conn_id, opcode, p_data->handle,
-                                            WICED_BT_GATT_INVALID_HANDLE);
-        WICED_BT_TRACE("Invalid Handle \n");
-        return WICED_BT_GATT_INVALID_HANDLE;
-    }
+    uint8_t i;
 
-    /* ANP server library takes care reading of ANS service characteristics */
-    if ((p_data->handle >= HDLS_ANS) && (p_data->handle <= HDLC_ANS_ALERT_NOTIFICATION_CONTROL_POINT_VALUE))
+    for (i = 0; i < CY_BT_SERVER_MAX_LINKS; i++)
     {
-        WICED_BT_TRACE("Calling profile read\n");
-        gatt_status = wiced_bt_ans_process_gatt_read_req(conn_id, p_data, attrRec->p_data,
-                                                         &attrRec->cur_len);
-        if (gatt_status != WICED_BT_GATT_SUCCESS)
+        if (bd_addr == NULL)
         {
-            wiced_bt_gatt_server_send_error_rsp(conn_id, opcode, p_data->handle, gatt_status);
-            return gatt_status;
+            if (ans_app_cb.conn[i].conn_id == 0)
+            {
+                return &ans_app_cb.conn[i];
+            }
+        }
+        else if ((ans_app_cb.conn[i].conn_id != 0) &&
+                 (memcmp(ans_app_cb.conn[i].bd_addr, bd_addr, sizeof(wiced_bt_device_address_t)) == 0))
+        {
+            return &ans_app_cb.conn[i];
         }
     }
-
-    attr_len_to_copy = attrRec->cur_len;
-    if (p_data->offset >= attrRec->cur_len)
-    {
-        wiced_bt_gatt_server_send_error_rsp(conn_id, opcode, p_data->handle,
-                                            WICED_BT_GATT_INVALID_OFFSET);
-        gatt_status = WICED_BT_GATT_INVALID_OFFSET;
-    }
-    else
-    {
-        to_send = attr_len_to_copy - p_data->offset;
-        from = ((uint8_t *)attrRec->p_data) + p_data->offset;
-        /* No need for context, as buff not allocated */
-        WICED_BT_TRACE("Sending Response....\n");
-        gatt_status = wiced_bt_gatt_server_send_read_handle_rsp(conn_id, opcode, to_send, from, NULL);
-    }
-    WICED_BT_TRACE("Returning read_handler: conn_id:%d hdl:0x%x offset:%d \n ",
-                   conn_id, p_data->handle, p_data->offset);
-    return gatt_status;
+    return NULL;
 }
 
 /*******************************************************************************
- * Function Name : bt_app_ans_find_attr_by_handle
+ * Function Name : bt_app_ans_find_conn_by_id
  * *****************************************************************************
  * Summary :
- *    Find attribute description by handle
+ *    Find the connected client with the given connection ID of its legacy or
+ *    of one of its Enhanced ATT bearers
  *
  * Parameters:
- *    handle:    handle to look up
+ *    conn_id:    GATT connection ID
  *
  * Return:
- *    gatt_db_lookup_table_t:   pointer containing handle data
+ *    bt_app_ans_conn_t:   matching entry, NULL if not found
  ******************************************************************************/
-static gatt_db_lookup_table_t *bt_app_ans_find_attr_by_handle(uint16_t handle)
+static bt_app_ans_conn_t *bt_app_ans_find_conn_by_id(uint16_t conn_id)
 {
-    int i;
-    for (i = 0; i < app_gatt_db_ext_attr_tbl_size; i++)
+    uint8_t i;
+    uint8_t j;
+
+    for (i = 0; (i < CY_BT_SERVER_MAX_LINKS) && (conn_id != 0); i++)
     {
-        if (handle == app_gatt_db_ext_attr_tbl[i].handle)
+        if (ans_app_cb.conn[i].conn_id == conn_id)
+        {
+            return &ans_app_cb.conn[i];
+        }
+        for (j = 0; j < CY_BT_EATT_BEARERS_PER_LINK; j++)
         {
-            return (&app_gatt_db_ext_attr_tbl[i]);
+            if (ans_app_cb.conn[i].eatt_conn_id[j] == conn_id)
+            {
+                return &ans_app_cb.conn[i];
+            }
         }
     }
     return NULL;
 }
 
 /*******************************************************************************
- * Function Name : bt_app_ans_gatts_req_write_handler
+ * Function Name : bt_app_ans_gatt_read
  * *****************************************************************************
  * Summary :
- *    Process write request or write command from peer device
+ *    Serve the GATT service values kept per client
  *
  * Parameters:
- *  conn_id       Connection ID
- *  opcode        LE GATT request type opcode
- *  p_data        Pointer to write request containing the data to write
+ *    conn_id:    Connection ID
+ *    handle:     Attribute handle
+ *    pp_val:     Receives the value
+ *    p_len:      Receives the value length
  *
  * Return:
- *  wiced_bt_gatt_status_t: See possible status codes in wiced_bt_gatt_status_e
- *  in wiced_bt_gatt.h
+ *    wiced_bt_gatt_status_t: See possible status codes in wiced_bt_gatt_status_e
  ******************************************************************************/
-wiced_bt_gatt_status_t bt_app_ans_gatts_req_write_handler(wiced_bt_gatt_opcode_t opcode,
-                                                          uint16_t conn_id,
-                                                          wiced_bt_gatt_write_req_t *p_data)
+static wiced_bt_gatt_status_t bt_app_ans_gatt_read(uint16_t conn_id, uint16_t handle, const uint8_t **pp_val,
+                                                   uint16_t *p_len)
 {
-    wiced_bt_gatt_status_t gatt_status = WICED_BT_GATT_SUCCESS;
-    WICED_BT_TRACE("Write_handler: conn_id:%d hdl:0x%x offset:%d len:%d \n ", conn_id, p_data->handle,
-                   p_data->offset, p_data->val_len);
+    bt_app_ans_conn_t *p_conn = bt_app_ans_find_conn_by_id(conn_id);
 
-    /* ANP server library takes care writing to ANS service characteristics */
-    if ((p_data->handle >= HDLS_ANS) && (p_data->handle <= HDLC_ANS_ALERT_NOTIFICATION_CONTROL_POINT_VALUE))
-    {
-        gatt_status = wiced_bt_ans_process_gatt_write_req(conn_id, p_data);
+    if (p_conn == NULL)
+        return WICED_BT_GATT_WRONG_STATE;
 
-        if (gatt_status == WICED_BT_GATT_SUCCESS)
-        {
-            gatt_status = wiced_bt_gatt_server_send_write_rsp(conn_id, opcode, p_data->handle);
-        }
-        else
-        {
-            gatt_status = wiced_bt_gatt_server_send_error_rsp(conn_id, opcode, p_data->handle, gatt_status);
-        }
-    }
-    else
+    switch (handle)
     {
-        gatt_status = WICED_BT_GATT_INVALID_HANDLE;
-    }
+    case HDLC_GATT_CLIENT_SUPPORTED_FEATURES_VALUE:
+        *pp_val = &p_conn->client_features;
+        *p_len = sizeof(p_conn->client_features);
+        return WICED_BT_GATT_SUCCESS;
+
+    case HDLD_GATT_SERVICE_CHANGED_CLIENT_CHAR_CONFIG:
+        *pp_val = (const uint8_t *)&p_conn->service_changed_cccd;
+        *p_len = sizeof(p_conn->service_changed_cccd);
+        return WICED_BT_GATT_SUCCESS;
+
+    case HDLC_GATT_DATABASE_HASH_VALUE:
+        /* the client is change aware once the response is sent, see bt_app_ans_gatt_hash_sent */
+        *pp_val = app_gatt_database_hash;
+        *p_len = app_gatt_database_hash_len;
+        return WICED_BT_GATT_SUCCESS;
 
-    return gatt_status;
+    default:
+        return WICED_BT_GATT_READ_NOT_PERMIT;
+    }
 }
 
 /*******************************************************************************
- * Function Name : bt_app_ans_start_scan_connect
+ * Function Name : bt_app_ans_gatt_write
  * *****************************************************************************
  * Summary :
- *    Does BLE Scan and connects to the device that is advertising as ANC
+ *    Handle writes to the GATT service values kept per client. A client may
+ *    set Client Supported Features bits but never clear them.
  *
  * Parameters:
- *    None
+ *    conn_id:    Connection ID
+ *    p_data:     Write request
  *
  * Return:
- *    uint16_t: Status of the operation. Refer to list of wiced_result_t.
+ *    wiced_bt_gatt_status_t: See possible status codes in wiced_bt_gatt_status_e
  ******************************************************************************/
-uint16_t bt_app_ans_start_scan_connect(void)
+static wiced_bt_gatt_status_t bt_app_ans_gatt_write(uint16_t conn_id, wiced_bt_gatt_write_req_t *p_data)
 {
-    wiced_result_t result = WICED_BT_BUSY;
-    /* Start scan to find ANS Client */
-    if ((wiced_bt_ble_get_current_scan_state() == BTM_BLE_SCAN_TYPE_NONE) &&
-        (ans_app_cb.conn_id == 0))
+    bt_app_ans_conn_t *p_conn = bt_app_ans_find_conn_by_id(conn_id);
+    uint8_t features;
+
+    if (p_conn == NULL)
+        return WICED_BT_GATT_WRONG_STATE;
+
+    switch (p_data->handle)
     {
-        result = wiced_bt_ble_scan(BTM_BLE_SCAN_TYPE_HIGH_DUTY, WICED_TRUE, bt_app_ans_scan_result_cback);
-        WICED_BT_TRACE("BLE Scan Start Status: %d \n", result);
-        if (WICED_BT_PENDING)
-        {
-            result = WICED_BT_SUCCESS;
-        }
+    case HDLC_GATT_CLIENT_SUPPORTED_FEATURES_VALUE:
+        if ((p_data->val_len == 0) || (p_data->p_val == NULL))
+            return WICED_BT_GATT_INVALID_ATTR_LEN;
+
+        features = p_data->p_val[0] & BT_APP_ANS_CSF_SUPPORTED;
+        if ((p_conn->client_features & ~features) != 0)
+            return WICED_BT_GATT_VALUE_NOT_ALLOWED;
+
+        p_conn->client_features = features;
+        wiced_bt_ans_set_multi_ntf(p_conn->conn_id,
+                                   (features & BT_APP_ANS_CSF_MULTI_NTF) ? WICED_TRUE : WICED_FALSE);
+        bt_app_ans_gatt_state_save(p_conn);
+        bt_app_ans_eatt_open(p_conn);
+        return WICED_BT_GATT_SUCCESS;
+
+    case HDLD_GATT_SERVICE_CHANGED_CLIENT_CHAR_CONFIG:
+        if ((p_data->val_len != 2) || (p_data->p_val == NULL))
+            return WICED_BT_GATT_INVALID_ATTR_LEN;
+
+        p_conn->service_changed_cccd = p_data->p_val[0] + (p_data->p_val[1] << 8);
+        bt_app_ans_gatt_state_save(p_conn);
+        return WICED_BT_GATT_SUCCESS;
+
+    default:
+        return WICED_BT_GATT_WRITE_NOT_PERMIT;
     }
-    return result;
 }
 
 /*******************************************************************************
- * Function Name : bt_app_ans_load_keys_to_addr_resolution_db
+ * Function Name : bt_app_ans_gatt_state_restore
  * *****************************************************************************
  * Summary :
- *    Read keys from the NVRAM and update address resolution database
+ *    Restore the GATT state of a newly connected client. The bonded client
+ *    gets its Client Supported Features and Service Changed configuration back
+ *    and is change unaware if the database changed since it last knew it.
  *
  * Parameters:
- *    None
+ *    p_conn:     Connected client
  *
  * Return:
  *    None
  ******************************************************************************/
-void bt_app_ans_load_keys_to_addr_resolution_db(void)
+static void bt_app_ans_gatt_state_restore(bt_app_ans_conn_t *p_conn)
 {
-    uint8_t bytes_read;
-    wiced_result_t result;
-    wiced_bt_device_link_keys_t keys;
-
-    bytes_read = wiced_hal_read_nvram(ANS_PAIRED_KEYS_NVRAM_ID, sizeof(keys), (uint8_t *)&keys, &result);
-
-    WICED_BT_TRACE(" [%s] Read status %d bytes read %d \n", __FUNCTION__, result, bytes_read);
-
-    /* if failed to read NVRAM, there is nothing saved at that location */
-    if (result == WICED_SUCCESS)
-    {
-        result = wiced_bt_dev_add_device_to_address_resolution_db(&keys);
-    }
+    bt_app_bond_gatt_state_t state;
+
+    p_conn->change_aware = WICED_TRUE;
+    memcpy(p_conn->db_hash, app_gatt_database_hash, sizeof(wiced_bt_db_hash_t));
+    p_conn->bonded = bt_app_bond_store_get_keys(p_conn->bd_addr, NULL);
+
+    /* a bonded client without saved GATT state is change aware */
+    if (!p_conn->bonded || !bt_app_bond_store_get_gatt_state(p_conn->bd_addr, &state))
+        return;
+
+    memcpy(p_conn->db_hash, state.db_hash, sizeof(wiced_bt_db_hash_t));
+    p_conn->change_aware = (memcmp(state.db_hash, app_gatt_database_hash, sizeof(wiced_bt_db_hash_t)) == 0) ?
+                           WICED_TRUE : WICED_FALSE;
+    p_conn->client_features = state.client_features & BT_APP_ANS_CSF_SUPPORTED;
+    p_conn->service_changed_cccd = state.service_changed_cccd;
+    wiced_bt_ans_set_multi_ntf(p_conn->conn_id,
+                               (p_conn->client_features & BT_APP_ANS_CSF_MULTI_NTF) ? WICED_TRUE : WICED_FALSE);
+
+    WICED_BT_TRACE("Bonded ANC %B change aware:%d features:0x%x \n", p_conn->bd_addr, p_conn->change_aware,
+                   p_conn->client_features);
 }
 
 /*******************************************************************************
- * Function Name : bt_app_ans_save_link_keys
+ * Function Name : bt_app_ans_gatt_state_save
  * *****************************************************************************
  * Summary :
- *    This function is called to save keys generated as a result of pairing
- *    or keys update
+ *    Save the GATT state of the bonded client to the NVRAM, including a
+ *    change of the change aware state not saved yet
  *
  * Parameters:
- *    p_keys: Link keys to be saved for the bonded device
+ *    p_conn:     Connected client
  *
  * Return:
- *    wiced_bool_t: 1 if True and 0 if false
+ *    None
  ******************************************************************************/
-wiced_bool_t bt_app_ans_save_link_keys(wiced_bt_device_link_keys_t *p_keys)
+static void bt_app_ans_gatt_state_save(bt_app_ans_conn_t *p_conn)
 {
-    uint8_t bytes_written;
-    wiced_result_t result;
+    bt_app_bond_gatt_state_t state;
+
+    /* GATT state of a client that is not bonded does not survive the connection */
+    if (!p_conn->bonded)
+        return;
 
-    bytes_written = wiced_hal_write_nvram(ANS_PAIRED_KEYS_NVRAM_ID, sizeof(wiced_bt_device_link_keys_t),
-                                          (uint8_t *)p_keys, &result);
-    WICED_BT_TRACE("Saved %d bytes at id:%d \n", bytes_written, ANS_PAIRED_KEYS_NVRAM_ID);
-    return (bytes_written == sizeof(wiced_bt_device_link_keys_t));
+    p_conn->gatt_state_dirty = WICED_FALSE;
+    memset(&state, 0, sizeof(state));
+    memcpy(state.db_hash, p_conn->db_hash, sizeof(wiced_bt_db_hash_t));
+    state.client_features = p_conn->client_features;
+    state.service_changed_cccd = p_conn->service_changed_cccd;
+
+    if (!bt_app_bond_store_save_gatt_state(p_conn->bd_addr, &state))
+        WICED_BT_TRACE("Err: saving GATT state of %B failed \n", p_conn->bd_addr);
 }
 
 /*******************************************************************************
- * Function Name : bt_app_ans_read_link_keys
+ * Function Name : bt_app_ans_gatt_bonded
  * *****************************************************************************
  * Summary :
- *    This function is called to read keys for specific bdaddr
+ *    A connected client bonded with us. It knows the current database, its
+ *    GATT state is kept from now on.
  *
  * Parameters:
- *    p_keys: Link keys to be saved for the bonded device
+ *    bd_addr:    address of the client
  *
  * Return:
- *    wiced_bool_t: 1 if True and 0 if false
+ *    None
  ******************************************************************************/
-wiced_bool_t bt_app_ans_read_link_keys(wiced_bt_device_link_keys_t *p_keys)
+static void bt_app_ans_gatt_bonded(wiced_bt_device_address_t bd_addr)
 {
-    uint8_t bytes_read;
-    wiced_result_t result;
+    bt_app_ans_conn_t *p_conn = bt_app_ans_find_conn_by_bda(bd_addr);
+
+    if (p_conn == NULL)
+        return;
 
-    bytes_read = wiced_hal_read_nvram(ANS_PAIRED_KEYS_NVRAM_ID, sizeof(wiced_bt_device_link_keys_t),
-                                      (uint8_t *)p_keys, &result);
-    WICED_BT_TRACE("Read %d bytes at id:%d \n", bytes_read, ANS_PAIRED_KEYS_NVRAM_ID);
-    return (bytes_read == sizeof(wiced_bt_device_link_keys_t));
+    p_conn->bonded = WICED_TRUE;
+    bt_app_ans_gatt_set_change_aware(p_conn);
+    bt_app_ans_gatt_state_save(p_conn);
+    bt_app_ans_client_state_save(p_conn);
+    bt_app_ans_snapshot_update();
 }
 
 /*******************************************************************************
- * Function Name : bt_app_ans_handle_set_supported_new_alert_categories
+ * Function Name : bt_app_ans_gatt_set_change_aware
  * *****************************************************************************
  * Summary :
- *    This function is sets the selected new alert categories
+ *    The client knows the current database, remember its hash for the
+ *    bonded client. This runs inside GATT requests, so the NVRAM is only
+ *    written with the next GATT state save or when the client disconnects.
  *
  * Parameters:
- *    p_data: 2 byte data containing the Bit fields pertaining to the Categories
- *    length: length of the data
+ *    p_conn:     Connected client
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_ans_gatt_set_change_aware(bt_app_ans_conn_t *p_conn)
+{
+    p_conn->change_aware = WICED_TRUE;
+    p_conn->out_of_sync_sent = WICED_FALSE;
+    memcpy(p_conn->db_hash, app_gatt_database_hash, sizeof(wiced_bt_db_hash_t));
+    if (p_conn->bonded)
+        p_conn->gatt_state_dirty = WICED_TRUE;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_gatt_hash_sent
+ * *****************************************************************************
+ * Summary :
+ *    A read response carrying the Database Hash was sent. The client compares
+ *    it with its cache, it is change aware from now on.
+ *
+ * Parameters:
+ *    conn_id:    Connection ID of the bearer the response went on
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_ans_gatt_hash_sent(uint16_t conn_id)
+{
+    bt_app_ans_conn_t *p_conn = bt_app_ans_find_conn_by_id(conn_id);
+
+    if ((p_conn != NULL) && !p_conn->change_aware)
+        bt_app_ans_gatt_set_change_aware(p_conn);
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_gatt_out_of_sync
+ * *****************************************************************************
+ * Summary :
+ *    Robust caching for a change unaware client that enabled it. The first
+ *    request is answered with Database Out Of Sync, the client is change aware
+ *    once it sends another request or is sent the Database Hash, read by
+ *    handle or by type. Commands are ignored meanwhile. The MTU exchange and
+ *    the confirmation are not attribute requests and always go through. Find
+ *    Information, Find By Type Value and Read By Group Type are answered by
+ *    the stack from the database and never reach the application.
+ *
+ * Parameters:
+ *    p_attr_req:     GATT request
+ *
+ * Return:
+ *    wiced_bool_t: WICED_TRUE if the request is not to be processed
+ ******************************************************************************/
+static wiced_bool_t bt_app_ans_gatt_out_of_sync(wiced_bt_gatt_attribute_request_t *p_attr_req)
+{
+    bt_app_ans_conn_t *p_conn = bt_app_ans_find_conn_by_id(p_attr_req->conn_id);
+    wiced_bt_gatt_read_by_type_t *p_by_type = &p_attr_req->data.read_by_type;
+    uint16_t handle;
+
+    if ((p_conn == NULL) || p_conn->change_aware || !(p_conn->client_features & BT_APP_ANS_CSF_ROBUST_CACHING))
+        return WICED_FALSE;
+
+    switch (p_attr_req->opcode)
+    {
+    case GATT_REQ_READ:
+    case GATT_REQ_READ_BLOB:
+        handle = p_attr_req->data.read_req.handle;
+        if (handle == HDLC_GATT_DATABASE_HASH_VALUE)
+            return WICED_FALSE;
+        break;
+
+    case GATT_REQ_READ_BY_TYPE:
+        handle = p_by_type->s_handle;
+        if ((p_by_type->uuid.len == LEN_UUID_16) &&
+            (p_by_type->uuid.uu.uuid16 == __UUID_CHARACTERISTIC_DATABASE_HASH))
+        {
+            return WICED_FALSE;
+        }
+        break;
+
+    case GATT_REQ_READ_MULTI:
+    case GATT_REQ_READ_MULTI_VAR:
+        handle = 0;
+        if ((p_attr_req->data.read_multiple_req.num_handles != 0) &&
+            (p_attr_req->data.read_multiple_req.p_handle_stream != NULL))
+        {
+            handle = p_attr_req->data.read_multiple_req.p_handle_stream[0] +
+                     (p_attr_req->data.read_multiple_req.p_handle_stream[1] << 8);
+        }
+        break;
+
+    case GATT_REQ_WRITE:
+    case GATT_REQ_PREPARE_WRITE:
+        handle = p_attr_req->data.write_req.handle;
+        break;
+
+    case GATT_REQ_EXECUTE_WRITE:
+        handle = 0;
+        break;
+
+    case GATT_CMD_WRITE:
+    case GATT_CMD_SIGNED_WRITE:
+        return WICED_TRUE;
+
+    default:
+        return WICED_FALSE;
+    }
+
+    if (p_conn->out_of_sync_sent)
+    {
+        bt_app_ans_gatt_set_change_aware(p_conn);
+        return WICED_FALSE;
+    }
+
+    p_conn->out_of_sync_sent = WICED_TRUE;
+    wiced_bt_gatt_server_send_error_rsp(p_attr_req->conn_id, p_attr_req->opcode, handle,
+                                        WICED_BT_GATT_DATABASE_OUT_OF_SYNC);
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_gatt_send_service_changed
+ * *****************************************************************************
+ * Summary :
+ *    Indicate Service Changed for the whole database to a change unaware
+ *    bonded client once the link is encrypted. Its confirmation makes the
+ *    client change aware.
+ *
+ * Parameters:
+ *    bd_addr:    address of the client
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_ans_gatt_send_service_changed(wiced_bt_device_address_t bd_addr)
+{
+    bt_app_ans_conn_t *p_conn = bt_app_ans_find_conn_by_bda(bd_addr);
+    wiced_bt_gatt_status_t gatt_status;
+
+    if ((p_conn == NULL) || p_conn->change_aware || !(p_conn->service_changed_cccd & BT_APP_ANS_CCCD_INDICATION))
+        return;
+
+    gatt_status = wiced_bt_gatt_server_send_indication(p_conn->conn_id, HDLC_GATT_SERVICE_CHANGED_VALUE,
+                                                       app_gatt_service_changed_len, app_gatt_service_changed, NULL);
+    WICED_BT_TRACE("Service Changed indication conn_id:%d status:%d \n", p_conn->conn_id, gatt_status);
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_lib_write
+ * *****************************************************************************
+ * Summary :
+ *    Write to an attribute of the ANP server library. The new CCCD or control
+ *    point configuration of a bonded client is saved right away.
+ *
+ * Parameters:
+ *    conn_id:    Connection ID
+ *    p_data:     Write request
+ *
+ * Return:
+ *    wiced_bt_gatt_status_t: See possible status codes in wiced_bt_gatt_status_e
+ ******************************************************************************/
+static wiced_bt_gatt_status_t bt_app_ans_lib_write(uint16_t conn_id, wiced_bt_gatt_write_req_t *p_data)
+{
+    wiced_bt_gatt_status_t gatt_status = wiced_bt_ans_process_gatt_write_req(conn_id, p_data);
+    bt_app_ans_conn_t *p_conn;
+
+    if ((gatt_status == WICED_BT_GATT_SUCCESS) && ((p_conn = bt_app_ans_find_conn_by_id(conn_id)) != NULL))
+    {
+        bt_app_ans_client_state_save(p_conn);
+        bt_app_ans_snapshot_update();
+        bt_app_ans_metrics_update();
+    }
+
+    return gatt_status;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_client_state_restore
+ * *****************************************************************************
+ * Summary :
+ *    Called by the ANP server library on connection up to get the state a
+ *    bonded client had on its last connection
+ *
+ * Parameters:
+ *    conn_id:    Connection ID
+ *    p_state:    ANS client state
+ *
+ * Return:
+ *    wiced_bool_t: WICED_TRUE if the client is bonded and its state known
+ ******************************************************************************/
+static wiced_bool_t bt_app_ans_client_state_restore(uint16_t conn_id, wiced_bt_ans_client_state_t *p_state)
+{
+    bt_app_ans_conn_t *p_conn = bt_app_ans_find_conn_by_id(conn_id);
+
+    if ((p_conn == NULL) || !bt_app_bond_store_get_ans_state(p_conn->bd_addr, p_state))
+        return WICED_FALSE;
+
+    WICED_BT_TRACE("Restored ANS state of %B \n", p_conn->bd_addr);
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_client_state_save
+ * *****************************************************************************
+ * Summary :
+ *    Save the ANS client state of the bonded client with its bond
+ *
+ * Parameters:
+ *    p_conn:     Connected client
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_ans_client_state_save(bt_app_ans_conn_t *p_conn)
+{
+    wiced_bt_ans_client_state_t state;
+
+    /* ANS state of a client that is not bonded does not survive the connection */
+    if (!p_conn->bonded || !wiced_bt_ans_get_client_state(p_conn->conn_id, &state))
+        return;
+
+    if (!bt_app_bond_store_save_ans_state(p_conn->bd_addr, &state))
+        WICED_BT_TRACE("Err: saving ANS state of %B failed \n", p_conn->bd_addr);
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_client_encrypted
+ * *****************************************************************************
+ * Summary :
+ *    The link to a client is encrypted, a client with restored ANS state gets
+ *    notifications from now on
+ *
+ * Parameters:
+ *    bd_addr:    address of the client
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_ans_client_encrypted(wiced_bt_device_address_t bd_addr)
+{
+    bt_app_ans_conn_t *p_conn = bt_app_ans_find_conn_by_bda(bd_addr);
+
+    if (p_conn != NULL)
+    {
+        wiced_bt_ans_connection_encrypted(p_conn->conn_id);
+        bt_app_ans_metrics_update();
+    }
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_snapshot_restore
+ * *****************************************************************************
+ * Summary :
+ *    Restore the state of the last run from the snapshot. The ANS state of the
+ *    bonded clients that were connected goes to their bonds, they get their
+ *    alerts when they reconnect.
+ *
+ * Parameters:
+ *    None
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_ans_snapshot_restore(void)
+{
+    bt_app_snapshot_t snapshot;
+    uint8_t i;
+
+    if (!bt_app_snapshot_init(&snapshot))
+        return;
+
+    ans_app_cb.supported_new_alert_cat = snapshot.supported_new_alert_cat;
+    ans_app_cb.supported_unread_alert_cat = snapshot.supported_unread_alert_cat;
+    wiced_bt_ans_set_supported_new_alert_categories(0, ans_app_cb.supported_new_alert_cat);
+    wiced_bt_ans_set_supported_unread_alert_categories(0, ans_app_cb.supported_unread_alert_cat);
+
+    for (i = 0; (i < snapshot.num_clients) && (i < CY_BT_SERVER_MAX_LINKS); i++)
+    {
+        /* a bond removed since is not brought back */
+        if (bt_app_bond_store_get_keys(snapshot.client[i].bd_addr, NULL))
+            bt_app_bond_store_save_ans_state(snapshot.client[i].bd_addr, &snapshot.client[i].state);
+    }
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_snapshot_update
+ * *****************************************************************************
+ * Summary :
+ *    Take a snapshot of the supported categories and the ANS state of the
+ *    connected bonded clients, written only if something changed
+ *
+ * Parameters:
+ *    None
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_ans_snapshot_update(void)
+{
+    bt_app_snapshot_t snapshot;
+    bt_app_snapshot_client_t *p_client;
+    uint8_t i;
+
+    memset(&snapshot, 0, sizeof(snapshot));
+    snapshot.supported_new_alert_cat = ans_app_cb.supported_new_alert_cat;
+    snapshot.supported_unread_alert_cat = ans_app_cb.supported_unread_alert_cat;
+
+    for (i = 0; i < CY_BT_SERVER_MAX_LINKS; i++)
+    {
+        p_client = &snapshot.client[snapshot.num_clients];
+        if ((ans_app_cb.conn[i].conn_id != 0) && ans_app_cb.conn[i].bonded &&
+            wiced_bt_ans_get_client_state(ans_app_cb.conn[i].conn_id, &p_client->state))
+        {
+            memcpy(p_client->bd_addr, ans_app_cb.conn[i].bd_addr, BD_ADDR_LEN);
+            snapshot.num_clients++;
+        }
+    }
+
+    bt_app_snapshot_write(&snapshot);
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_metrics_update
+ * *****************************************************************************
+ * Summary :
+ *    Update the gauges of the metrics: the connected clients, how many of them
+ *    have a new alert not sent yet in every category and the default heap
+ *    usage. Runs on the thread that changed the state, a scrape only reads.
+ *
+ * Parameters:
+ *    None
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_ans_metrics_update(void)
+{
+    wiced_bt_ans_client_state_t state;
+    wiced_bt_heap_statistics_t heap_stats;
+    uint8_t not_sent[ANP_NOTIFY_CATEGORY_COUNT] = {0};
+    uint8_t cat;
+    uint8_t i;
+
+    for (i = 0; i < CY_BT_SERVER_MAX_LINKS; i++)
+    {
+        if ((ans_app_cb.conn[i].conn_id == 0) || !wiced_bt_ans_get_client_state(ans_app_cb.conn[i].conn_id, &state))
+            continue;
+        for (cat = 0; cat < ANP_NOTIFY_CATEGORY_COUNT; cat++)
+        {
+            if (state.new_alert_not_sent & (1 << cat))
+                not_sent[cat]++;
+        }
+    }
+
+    bt_app_metrics_set(BT_APP_METRIC_CONNECTIONS, 0, ans_app_cb.num_connections);
+    for (cat = 0; cat < ANP_NOTIFY_CATEGORY_COUNT; cat++)
+        bt_app_metrics_set(BT_APP_METRIC_NOT_SENT, cat, not_sent[cat]);
+
+    if ((p_default_heap != NULL) && wiced_bt_get_heap_statistics(p_default_heap, &heap_stats))
+    {
+        bt_app_metrics_set(BT_APP_METRIC_HEAP_USED, 0, heap_stats.heap_size - heap_stats.remaining_size);
+        bt_app_metrics_set(BT_APP_METRIC_HEAP_MAX_USED, 0, heap_stats.max_heap_size_used);
+    }
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_metrics_alert
+ * *****************************************************************************
+ * Summary :
+ *    Count an alert the ANS library accepted, and its send failure if any.
+ *    An alert rejected before it was counted, for an invalid category or
+ *    without a client, is not an alert of any category.
+ *
+ * Parameters:
+ *    category_id:    alert category
+ *    gatt_status:    status of sending the alert to the connected clients
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_ans_metrics_alert(uint8_t category_id, wiced_bt_gatt_status_t gatt_status)
+{
+    if ((gatt_status == WICED_BT_GATT_INVALID_CFG) || (gatt_status == WICED_BT_GATT_WRONG_STATE))
+        return;
+
+    bt_app_metrics_add(BT_APP_METRIC_ALERTS, category_id, 1);
+    if (gatt_status != WICED_BT_GATT_SUCCESS)
+        bt_app_metrics_add(BT_APP_METRIC_SEND_FAILURES, category_id, 1);
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_link_setup
+ * *****************************************************************************
+ * Summary :
+ *    Ask for the LE 2M PHY and the longest LE data channel PDU on a new link,
+ *    alerts then take fewer and shorter packets. The link stays on the LE 1M
+ *    PHY if either side does not support LE 2M.
+ *
+ * Parameters:
+ *    p_conn:     Connected client
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_ans_link_setup(bt_app_ans_conn_t *p_conn)
+{
+    wiced_bt_ble_phy_preferences_t phy_preferences;
+    wiced_result_t result;
+
+    p_conn->tx_phy = BT_APP_ANS_PHY_1M;
+    p_conn->rx_phy = BT_APP_ANS_PHY_1M;
+    p_conn->max_tx_octets = BT_APP_ANS_LL_OCTETS_DEFAULT;
+    p_conn->max_rx_octets = BT_APP_ANS_LL_OCTETS_DEFAULT;
+
+    memset(&phy_preferences, 0, sizeof(phy_preferences));
+    memcpy(phy_preferences.remote_bd_addr, p_conn->bd_addr, sizeof(wiced_bt_device_address_t));
+    phy_preferences.tx_phys = BTM_BLE_PREFER_2M_PHY;
+    phy_preferences.rx_phys = BTM_BLE_PREFER_2M_PHY;
+    phy_preferences.phy_opts = BTM_BLE_PREFER_NO_LELR;
+    result = wiced_bt_ble_set_phy(&phy_preferences);
+    if (result != WICED_BT_SUCCESS)
+        WICED_BT_TRACE("LE 2M PHY not requested conn_id:%d result:%d, staying on LE 1M \n", p_conn->conn_id, result);
+
+    result = wiced_bt_ble_set_data_packet_length(p_conn->bd_addr, CY_BT_LE_MAX_TX_OCTETS, CY_BT_LE_MAX_TX_TIME);
+    if (result != WICED_BT_SUCCESS)
+        WICED_BT_TRACE("Data length not requested conn_id:%d result:%d \n", p_conn->conn_id, result);
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_link_phy_update
+ * *****************************************************************************
+ * Summary :
+ *    Handle BTM_BLE_PHY_UPDATE_EVT. A failed update leaves the PHY as it was.
+ *
+ * Parameters:
+ *    p_phy:      PHY update event
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_ans_link_phy_update(wiced_bt_ble_phy_update_t *p_phy)
+{
+    bt_app_ans_conn_t *p_conn = bt_app_ans_find_conn_by_bda(p_phy->bd_address);
+
+    if (p_conn == NULL)
+        return;
+
+    if (p_phy->status != WICED_BT_SUCCESS)
+    {
+        WICED_BT_TRACE("PHY update failed conn_id:%d status:%d, staying on %s \n", p_conn->conn_id, p_phy->status,
+                       bt_app_ans_phy_name(p_conn->tx_phy));
+        return;
+    }
+
+    p_conn->tx_phy = p_phy->tx_phy;
+    p_conn->rx_phy = p_phy->rx_phy;
+    WICED_BT_TRACE("PHY conn_id:%d tx:%s rx:%s \n", p_conn->conn_id, bt_app_ans_phy_name(p_conn->tx_phy),
+                   bt_app_ans_phy_name(p_conn->rx_phy));
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_link_data_length_update
+ * *****************************************************************************
+ * Summary :
+ *    Handle BTM_BLE_DATA_LENGTH_UPDATE_EVENT, the ANS library then keeps the
+ *    New Alert text within one link layer packet
+ *
+ * Parameters:
+ *    p_dle:      Data length update event
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_ans_link_data_length_update(wiced_bt_ble_phy_data_length_update_t *p_dle)
+{
+    bt_app_ans_conn_t *p_conn = bt_app_ans_find_conn_by_bda(p_dle->bd_address);
+
+    if (p_conn == NULL)
+        return;
+
+    p_conn->max_tx_octets = p_dle->max_tx_octets;
+    p_conn->max_rx_octets = p_dle->max_rx_octets;
+    wiced_bt_ans_set_data_length(p_conn->conn_id, p_dle->max_tx_octets);
+    WICED_BT_TRACE("Data length conn_id:%d tx:%d rx:%d \n", p_conn->conn_id, p_dle->max_tx_octets,
+                   p_dle->max_rx_octets);
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_phy_name
+ * *****************************************************************************
+ * Summary :
+ *    Name of a PHY for the trace and the statistics
+ *
+ * Parameters:
+ *    phy:        BT_APP_ANS_PHY_xxx
+ *
+ * Return:
+ *    const char *:   PHY name
+ ******************************************************************************/
+static const char *bt_app_ans_phy_name(uint8_t phy)
+{
+    switch (phy)
+    {
+    case BT_APP_ANS_PHY_1M:
+        return "LE 1M";
+    case BT_APP_ANS_PHY_2M:
+        return "LE 2M";
+    case BT_APP_ANS_PHY_CODED:
+        return "LE Coded";
+    default:
+        return "unknown";
+    }
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_eatt_num_bearers
+ * *****************************************************************************
+ * Summary :
+ *    Count the Enhanced ATT bearers open to a client
+ *
+ * Parameters:
+ *    p_conn:     Connected client
+ *
+ * Return:
+ *    uint8_t:    Number of open bearers
+ ******************************************************************************/
+static uint8_t bt_app_ans_eatt_num_bearers(bt_app_ans_conn_t *p_conn)
+{
+    uint8_t num_bearers = 0;
+    uint8_t i;
+
+    for (i = 0; i < CY_BT_EATT_BEARERS_PER_LINK; i++)
+    {
+        if (p_conn->eatt_conn_id[i] != 0)
+            num_bearers++;
+    }
+    return num_bearers;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_eatt_connect_ind
+ * *****************************************************************************
+ * Summary :
+ *    A client opens Enhanced ATT bearers. They are accepted as long as the
+ *    client has less than CY_BT_EATT_BEARERS_PER_LINK, and the connection IDs
+ *    the stack returns for them become bearers of the client.
+ *
+ * Parameters:
+ *    p_ind:      Connection indication
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_ans_eatt_connect_ind(wiced_bt_eatt_connection_indication_event_t *p_ind)
+{
+    bt_app_ans_conn_t *p_conn = bt_app_ans_find_conn_by_bda(p_ind->bdaddr);
+    wiced_bt_eatt_connection_response_t rsp;
+    wiced_bt_gatt_eatt_conn_id_list conn_ids;
+    wiced_bt_gatt_status_t gatt_status;
+    uint8_t num_free;
+    uint8_t i;
+
+    memset(conn_ids, 0, sizeof(conn_ids));
+
+    memset(&rsp, 0, sizeof(rsp));
+    memcpy(rsp.bdaddr, p_ind->bdaddr, sizeof(wiced_bt_device_address_t));
+    rsp.trans_id = p_ind->trans_id;
+    rsp.our_rx_mtu = CY_BT_EATT_MTU_SIZE;
+    rsp.response = WICED_BT_GATT_NO_RESOURCES;
+
+    num_free = (p_conn != NULL) ? (CY_BT_EATT_BEARERS_PER_LINK - bt_app_ans_eatt_num_bearers(p_conn)) : 0;
+    for (i = 0; (i < p_ind->num_bearers) && (i < EATT_CHANNELS_PER_TRANSACTION) && (i < num_free); i++)
+    {
+        rsp.lcids[i] = p_ind->lcids[i];
+        rsp.response = WICED_BT_GATT_SUCCESS;
+    }
+
+    gatt_status = wiced_bt_eatt_send_connect_response(&rsp, conn_ids);
+    WICED_BT_TRACE("EATT connect %B bearers:%d accepted:%d status:%d \n", p_ind->bdaddr, p_ind->num_bearers, i,
+                   gatt_status);
+    if ((gatt_status != WICED_BT_GATT_SUCCESS) || (rsp.response != WICED_BT_GATT_SUCCESS))
+        return;
+
+    for (i = 0; i < EATT_CHANNELS_PER_TRANSACTION; i++)
+    {
+        if (conn_ids[i] != 0)
+            bt_app_ans_eatt_bearer_up(p_conn, conn_ids[i]);
+    }
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_eatt_encrypted
+ * *****************************************************************************
+ * Summary :
+ *    The link to a client is encrypted, Enhanced ATT bearers can be opened
+ *
+ * Parameters:
+ *    bd_addr:    address of the client
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_ans_eatt_encrypted(wiced_bt_device_address_t bd_addr)
+{
+    bt_app_ans_conn_t *p_conn = bt_app_ans_find_conn_by_bda(bd_addr);
+
+    if (p_conn == NULL)
+        return;
+
+    p_conn->encrypted = WICED_TRUE;
+    bt_app_ans_eatt_open(p_conn);
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_eatt_open
+ * *****************************************************************************
+ * Summary :
+ *    Open the Enhanced ATT bearers to a client that supports them, once the
+ *    link is encrypted. The connection IDs the stack returns are bearers of
+ *    the client right away, they carry alerts once their GATT connection is
+ *    up and their MTU is known.
+ *
+ * Parameters:
+ *    p_conn:     Connected client
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_ans_eatt_open(bt_app_ans_conn_t *p_conn)
+{
+    wiced_bt_gatt_eatt_conn_id_list conn_ids;
+    wiced_bt_gatt_status_t gatt_status;
+    uint8_t num_bearers = CY_BT_EATT_BEARERS_PER_LINK - bt_app_ans_eatt_num_bearers(p_conn);
+    uint8_t i;
+
+    if (!p_conn->encrypted || p_conn->eatt_requested || !(p_conn->client_features & BT_APP_ANS_CSF_EATT) ||
+        (num_bearers == 0))
+    {
+        return;
+    }
+
+    memset(conn_ids, 0, sizeof(conn_ids));
+    gatt_status = wiced_bt_eatt_connect(p_conn->bd_addr, CY_BT_EATT_MTU_SIZE, num_bearers, conn_ids);
+    WICED_BT_TRACE("EATT connect conn_id:%d bearers:%d status:%d \n", p_conn->conn_id, num_bearers, gatt_status);
+    if (gatt_status != WICED_BT_GATT_SUCCESS)
+        return;
+
+    p_conn->eatt_requested = WICED_TRUE;
+    for (i = 0; i < EATT_CHANNELS_PER_TRANSACTION; i++)
+    {
+        if (conn_ids[i] != 0)
+            bt_app_ans_eatt_bearer_up(p_conn, conn_ids[i]);
+    }
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_eatt_bearer_up
+ * *****************************************************************************
+ * Summary :
+ *    An Enhanced ATT bearer to a client is opened or connected, alerts of the
+ *    client are spread over it. A known bearer only gets its MTU updated. A
+ *    bearer the client has no room for is closed.
+ *
+ * Parameters:
+ *    p_conn:     Connected client
+ *    conn_id:    GATT connection ID of the bearer
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_ans_eatt_bearer_up(bt_app_ans_conn_t *p_conn, uint16_t conn_id)
+{
+    uint16_t mtu = wiced_bt_gatt_get_bearer_mtu(conn_id);
+    uint8_t slot = CY_BT_EATT_BEARERS_PER_LINK;
+    uint8_t i;
+
+    for (i = 0; i < CY_BT_EATT_BEARERS_PER_LINK; i++)
+    {
+        if (p_conn->eatt_conn_id[i] == conn_id)
+        {
+            slot = i;
+            break;
+        }
+        if ((p_conn->eatt_conn_id[i] == 0) && (slot == CY_BT_EATT_BEARERS_PER_LINK))
+            slot = i;
+    }
+
+    if ((slot == CY_BT_EATT_BEARERS_PER_LINK) || !wiced_bt_ans_bearer_up(p_conn->conn_id, conn_id, mtu))
+    {
+        WICED_BT_TRACE("No room for EATT bearer conn_id:%d of conn_id:%d \n", conn_id, p_conn->conn_id);
+        wiced_bt_gatt_disconnect(conn_id);
+        return;
+    }
+
+    p_conn->eatt_conn_id[slot] = conn_id;
+    WICED_BT_TRACE("EATT bearer conn_id:%d of conn_id:%d mtu:%d \n", conn_id, p_conn->conn_id, mtu);
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_eatt_bearer_down
+ * *****************************************************************************
+ * Summary :
+ *    An Enhanced ATT bearer to a client is disconnected
+ *
+ * Parameters:
+ *    p_conn:     Connected client
+ *    conn_id:    GATT connection ID of the bearer
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_ans_eatt_bearer_down(bt_app_ans_conn_t *p_conn, uint16_t conn_id)
+{
+    uint8_t i;
+
+    for (i = 0; i < CY_BT_EATT_BEARERS_PER_LINK; i++)
+    {
+        if (p_conn->eatt_conn_id[i] == conn_id)
+            p_conn->eatt_conn_id[i] = 0;
+    }
+
+    wiced_bt_ans_bearer_down(conn_id);
+    WICED_BT_TRACE("EATT bearer conn_id:%d of conn_id:%d closed \n", conn_id, p_conn->conn_id);
+}
+
+/*******************************************************************************
+ * Function Name: bt_app_ans_gatts_req_callback
+ ********************************************************************************
+ * Summary:
+ *   Process GATT request from the peer. Even our main goal is to be a GATT client for the
+ *   ANCS service, we need to support mandatory GATT procedures.
+ *
+ * Parameters:
+ *  p_attr_req     Pointer to LE GATT connection status
+ *
+ * Return:
+ *  wiced_bt_gatt_status_t: See possible status codes in wiced_bt_gatt_status_e
+ *  in wiced_bt_gatt.h
+ *
+ *******************************************************************************/
+static wiced_bt_gatt_status_t bt_app_ans_gatts_req_callback(wiced_bt_gatt_attribute_request_t *p_attr_req)
+{
+    wiced_bt_gatt_status_t gatt_status = WICED_BT_GATT_ERROR;
+    bt_app_ans_conn_t *p_conn;
+
+    if (NULL != p_attr_req)
+    {
+        /* a change unaware client gets Database Out Of Sync before any request is looked at */
+        if (bt_app_ans_gatt_out_of_sync(p_attr_req))
+            return WICED_BT_GATT_SUCCESS;
+
+        switch (p_attr_req->opcode)
+        {
+        case GATT_REQ_READ:
+        case GATT_REQ_READ_BLOB:
+            /* Attribute read request */
+            gatt_status = bt_app_ans_gatts_req_read_handler(p_attr_req->opcode, p_attr_req->conn_id,
+                                                            &(p_attr_req->data.read_req),
+                                                            p_attr_req->len_requested);
+            break;
+
+        case GATT_REQ_READ_BY_TYPE:
+            /* Read Using Characteristic UUID, robust caching clients read the Database Hash this way */
+            gatt_status = bt_app_ans_gatts_req_read_by_type_handler(p_attr_req->opcode, p_attr_req->conn_id,
+                                                                    &(p_attr_req->data.read_by_type),
+                                                                    p_attr_req->len_requested);
+            break;
+
+        case GATT_REQ_READ_MULTI:
+        case GATT_REQ_READ_MULTI_VAR:
+            gatt_status = bt_app_ans_gatts_req_read_multi_handler(p_attr_req->opcode, p_attr_req->conn_id,
+                                                                  &(p_attr_req->data.read_multiple_req),
+                                                                  p_attr_req->len_requested);
+            break;
+
+        case GATT_REQ_WRITE:
+        case GATT_CMD_WRITE:
+            /* Attribute write request */
+            gatt_status = bt_app_ans_gatts_req_write_handler(p_attr_req->opcode, p_attr_req->conn_id,
+                                                             &(p_attr_req->data.write_req));
+            break;
+
+        case GATT_REQ_PREPARE_WRITE:
+            /* No writable value is longer than a Write Request carries, long writes are not supported */
+            gatt_status = wiced_bt_gatt_server_send_error_rsp(p_attr_req->conn_id, p_attr_req->opcode,
+                                                              p_attr_req->data.write_req.handle,
+                                                              WICED_BT_GATT_REQ_NOT_SUPPORTED);
+            break;
+
+        case GATT_REQ_EXECUTE_WRITE:
+            gatt_status = wiced_bt_gatt_server_send_error_rsp(p_attr_req->conn_id, p_attr_req->opcode, 0,
+                                                              WICED_BT_GATT_REQ_NOT_SUPPORTED);
+            break;
+
+        case GATT_REQ_MTU:
+            /* Client starts the MTU exchange, New Alerts grow to the MTU both sides support */
+            gatt_status = wiced_bt_gatt_server_send_mtu_rsp(p_attr_req->conn_id,
+                                                            p_attr_req->data.remote_mtu,
+                                                            CY_BT_MTU_SIZE);
+            wiced_bt_ans_set_mtu(p_attr_req->conn_id,
+                                 (p_attr_req->data.remote_mtu < CY_BT_MTU_SIZE) ?
+                                 p_attr_req->data.remote_mtu : CY_BT_MTU_SIZE);
+            BT_APP_TRACE_DBG("GATT_REQ_MTU conn_id:%d remote_mtu:%d \n", p_attr_req->conn_id,
+                             p_attr_req->data.remote_mtu);
+            break;
+
+        case GATT_HANDLE_VALUE_NOTIF:
+            BT_APP_TRACE_DBG("GATT_HANDLE_VALUE_NOTIF conn_id:%d \n", p_attr_req->conn_id);
+            break;
+
+        case GATT_HANDLE_VALUE_CONF:
+            /* Service Changed is the only indication, the client has seen it */
+            p_conn = bt_app_ans_find_conn_by_id(p_attr_req->conn_id);
+            if ((p_conn != NULL) && !p_conn->change_aware)
+                bt_app_ans_gatt_set_change_aware(p_conn);
+            gatt_status = WICED_BT_GATT_SUCCESS;
+            break;
+
+        default:
+            BT_APP_TRACE_ERR("Unhandled GATT_ATTRIBUTE_REQUEST_EVT Opcode: 0x%x\n", p_attr_req->opcode);
+            break;
+        }
+    }
+    return gatt_status;
+}
+
+/*******************************************************************************
+ * Function Name: bt_app_ans_gatts_req_read_handler
+ ********************************************************************************
+ * Summary:
+ *   This function handles Read Requests received from the client device
+ *
+ * Parameters:
+ *   conn_id       Connection ID
+ *   opcode        LE GATT request type opcode
+ *   p_read_req    Pointer to read request containing the handle to read
+ *   len_req       length of data requested
+ *
+ * Return:
+ *   wiced_bt_gatt_status_t: See possible status codes in wiced_bt_gatt_status_e
+ *   in wiced_bt_gatt.h
+ *
+ ********************************************************************************/
+wiced_bt_gatt_status_t bt_app_ans_gatts_req_read_handler(wiced_bt_gatt_opcode_t opcode,
+                                                         uint16_t conn_id,
+                                                         wiced_bt_gatt_read_t *p_data,
+                                                         uint16_t len_requested)
+{
+    wiced_bt_gatt_status_t gatt_status;
+    const uint8_t *p_val;
+    uint16_t len;
+
+    /* Served straight from the owner's storage, the stack copies it into the response */
+    gatt_status = bt_app_ans_attr_value(conn_id, p_data->handle, &p_val, &len);
+
+    /* Read Blob continues from the offset, a read starts at 0. Offset at the end reads nothing */
+    if ((gatt_status == WICED_BT_GATT_SUCCESS) && (p_data->offset > len))
+        gatt_status = WICED_BT_GATT_INVALID_OFFSET;
+
+    ANS_PROBE(read_dispatch, conn_id, p_data->handle, gatt_status);
+
+    if (gatt_status != WICED_BT_GATT_SUCCESS)
+    {
+        BT_APP_TRACE_ERR("conn_id:%d hdl:0x%x offset:%d status:0x%x \n", conn_id, p_data->handle,
+                         p_data->offset, gatt_status);
+        wiced_bt_gatt_server_send_error_rsp(conn_id, opcode, p_data->handle, gatt_status);
+        return gatt_status;
+    }
+
+    len -= p_data->offset;
+    if (len > len_requested)
+        len = len_requested;
+
+    /* No need for context, as buff not allocated */
+    gatt_status = wiced_bt_gatt_server_send_read_handle_rsp(conn_id, opcode, len, (uint8_t *)&p_val[p_data->offset],
+                                                            NULL);
+    if ((gatt_status == WICED_BT_GATT_SUCCESS) && (p_data->handle == HDLC_GATT_DATABASE_HASH_VALUE))
+        bt_app_ans_gatt_hash_sent(conn_id);
+    return gatt_status;
+}
+
+/*******************************************************************************
+ * Function Name: bt_app_ans_gatts_req_read_by_type_handler
+ ********************************************************************************
+ * Summary:
+ *   This function handles Read By Type Requests received from the client
+ *   device. The values of the attributes of the type in the range are sent
+ *   while they have the length of the first one and fit in the response.
+ *
+ * Parameters:
+ *   opcode        LE GATT request type opcode
+ *   conn_id       Connection ID
+ *   p_data        Pointer to read request containing the range and type
+ *   len_requested length of data requested
+ *
+ * Return:
+ *   wiced_bt_gatt_status_t: See possible status codes in wiced_bt_gatt_status_e
+ *   in wiced_bt_gatt.h
+ *
+ ********************************************************************************/
+static wiced_bt_gatt_status_t bt_app_ans_gatts_req_read_by_type_handler(wiced_bt_gatt_opcode_t opcode,
+                                                                        uint16_t conn_id,
+                                                                        wiced_bt_gatt_read_by_type_t *p_data,
+                                                                        uint16_t len_requested)
+{
+    wiced_bt_gatt_status_t gatt_status = WICED_BT_GATT_SUCCESS;
+    wiced_bool_t hash_sent = WICED_FALSE;
+    uint16_t handle = p_data->s_handle;
+    const uint8_t *p_val;
+    uint8_t *p_rsp;
+    uint8_t pair_len = 0;
+    uint16_t len;
+    int used = 0;
+    int filled;
+
+    if ((p_rsp = wiced_bt_get_buffer_from_heap(p_default_heap, len_requested)) == NULL)
+    {
+        return wiced_bt_gatt_server_send_error_rsp(conn_id, opcode, p_data->s_handle,
+                                                   WICED_BT_GATT_INSUF_RESOURCE);
+    }
+
+    while ((handle != 0) && (handle <= p_data->e_handle))
+    {
+        if ((handle = wiced_bt_gatt_find_handle_by_type(handle, p_data->e_handle, &p_data->uuid)) == 0)
+            break;
+
+        /* an attribute that cannot be read ends the response, or fails it if it is the first one */
+        if ((gatt_status = bt_app_ans_attr_value(conn_id, handle, &p_val, &len)) != WICED_BT_GATT_SUCCESS)
+            break;
+
+        filled = wiced_bt_gatt_put_read_by_type_rsp_in_stream(p_rsp + used, len_requested - used, &pair_len, handle,
+                                                              len, (uint8_t *)p_val);
+        if (filled == 0)
+            break;
+
+        used += filled;
+        if (handle == HDLC_GATT_DATABASE_HASH_VALUE)
+            hash_sent = WICED_TRUE;
+        handle++;
+    }
+
+    ANS_PROBE(read_dispatch, conn_id, p_data->s_handle, (used != 0) ? WICED_BT_GATT_SUCCESS : gatt_status);
+
+    if (used == 0)
+    {
+        wiced_bt_free_buffer(p_rsp);
+        if (gatt_status == WICED_BT_GATT_SUCCESS)
+        {
+            gatt_status = WICED_BT_GATT_ATTRIBUTE_NOT_FOUND;
+            handle = p_data->s_handle;
+        }
+        BT_APP_TRACE_ERR("conn_id:%d read by type hdl:0x%x status:0x%x \n", conn_id, handle, gatt_status);
+        return wiced_bt_gatt_server_send_error_rsp(conn_id, opcode, handle, gatt_status);
+    }
+
+    /* the buffer goes back to the heap with GATT_APP_BUFFER_TRANSMITTED_EVT */
+    gatt_status = wiced_bt_gatt_server_send_read_by_type_rsp(conn_id, opcode, pair_len, (uint16_t)used, p_rsp,
+                                                             (void *)p_default_heap);
+    if (gatt_status != WICED_BT_GATT_SUCCESS)
+        wiced_bt_free_buffer(p_rsp);
+    else if (hash_sent)
+        bt_app_ans_gatt_hash_sent(conn_id);
+    return gatt_status;
+}
+
+/*******************************************************************************
+ * Function Name: bt_app_ans_gatts_req_read_multi_handler
+ ********************************************************************************
+ * Summary:
+ *   This function handles Read Multiple and Read Multiple Variable Length
+ *   Requests received from the client device. A handle that cannot be read
+ *   fails the whole request.
+ *
+ * Parameters:
+ *   opcode        LE GATT request type opcode
+ *   conn_id       Connection ID
+ *   p_data        Pointer to read request containing the handles to read
+ *   len_requested length of data requested
+ *
+ * Return:
+ *   wiced_bt_gatt_status_t: See possible status codes in wiced_bt_gatt_status_e
+ *   in wiced_bt_gatt.h
+ *
+ ********************************************************************************/
+static wiced_bt_gatt_status_t bt_app_ans_gatts_req_read_multi_handler(wiced_bt_gatt_opcode_t opcode,
+                                                                      uint16_t conn_id,
+                                                                      wiced_bt_gatt_read_multiple_req_t *p_data,
+                                                                      uint16_t len_requested)
+{
+    wiced_bt_gatt_status_t gatt_status;
+    wiced_bool_t hash_sent = WICED_FALSE;
+    const uint8_t *p_val;
+    uint8_t *p_rsp;
+    uint16_t handle;
+    uint16_t len;
+    uint16_t i;
+    int used = 0;
+    int filled;
+
+    if ((p_data->num_handles == 0) || (p_data->p_handle_stream == NULL))
+        return wiced_bt_gatt_server_send_error_rsp(conn_id, opcode, 0, WICED_BT_GATT_INVALID_PDU);
+
+    if ((p_rsp = wiced_bt_get_buffer_from_heap(p_default_heap, len_requested)) == NULL)
+    {
+        return wiced_bt_gatt_server_send_error_rsp(conn_id, opcode,
+                                                   wiced_bt_gatt_get_handle_from_stream(p_data->p_handle_stream, 0),
+                                                   WICED_BT_GATT_INSUF_RESOURCE);
+    }
+
+    for (i = 0; i < p_data->num_handles; i++)
+    {
+        handle = wiced_bt_gatt_get_handle_from_stream(p_data->p_handle_stream, i);
+        gatt_status = bt_app_ans_attr_value(conn_id, handle, &p_val, &len);
+        ANS_PROBE(read_dispatch, conn_id, handle, gatt_status);
+        if (gatt_status != WICED_BT_GATT_SUCCESS)
+        {
+            BT_APP_TRACE_ERR("conn_id:%d read multiple hdl:0x%x status:0x%x \n", conn_id, handle, gatt_status);
+            wiced_bt_free_buffer(p_rsp);
+            return wiced_bt_gatt_server_send_error_rsp(conn_id, opcode, handle, gatt_status);
+        }
+
+        /* values past the response size are left out, as in a long read */
+        filled = wiced_bt_gatt_put_read_multi_rsp_in_stream(opcode, p_rsp + used, len_requested - used, handle, len,
+                                                            (uint8_t *)p_val);
+        if (filled == 0)
+            break;
+
+        used += filled;
+        if (handle == HDLC_GATT_DATABASE_HASH_VALUE)
+            hash_sent = WICED_TRUE;
+    }
+
+    /* the buffer goes back to the heap with GATT_APP_BUFFER_TRANSMITTED_EVT */
+    gatt_status = wiced_bt_gatt_server_send_read_multiple_rsp(conn_id, opcode, (uint16_t)used, p_rsp,
+                                                              (void *)p_default_heap);
+    if (gatt_status != WICED_BT_GATT_SUCCESS)
+        wiced_bt_free_buffer(p_rsp);
+    else if (hash_sent)
+        bt_app_ans_gatt_hash_sent(conn_id);
+    return gatt_status;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_find_attr_by_handle
+ * *****************************************************************************
+ * Summary :
+ *    Find the dispatch entry of an attribute handle
+ *
+ * Parameters:
+ *    handle:    handle to look up
+ *
+ * Return:
+ *    bt_app_ans_attr_t:   dispatch entry, NULL if the handle has no value
+ ******************************************************************************/
+static const bt_app_ans_attr_t *bt_app_ans_find_attr_by_handle(uint16_t handle)
+{
+    if ((handle < HDL_COUNT) && (bt_app_ans_attr_tbl[handle].p_attr != NULL))
+    {
+        return &bt_app_ans_attr_tbl[handle];
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_attr_value
+ * *****************************************************************************
+ * Summary :
+ *    Get the value of an attribute as the client reads it, from its owner or
+ *    from the attribute record
+ *
+ * Parameters:
+ *    conn_id:    Connection ID
+ *    handle:     Attribute handle
+ *    pp_val:     Receives the value
+ *    p_len:      Receives the value length
+ *
+ * Return:
+ *    wiced_bt_gatt_status_t: See possible status codes in wiced_bt_gatt_status_e
+ ******************************************************************************/
+static wiced_bt_gatt_status_t bt_app_ans_attr_value(uint16_t conn_id, uint16_t handle, const uint8_t **pp_val,
+                                                    uint16_t *p_len)
+{
+    const bt_app_ans_attr_t *p_attr = bt_app_ans_find_attr_by_handle(handle);
+
+    if (p_attr == NULL)
+        return WICED_BT_GATT_INVALID_HANDLE;
+
+    if (p_attr->p_read != NULL)
+        return p_attr->p_read(conn_id, handle, pp_val, p_len);
+
+    *pp_val = p_attr->p_attr->p_data;
+    *p_len = p_attr->p_attr->cur_len;
+    return WICED_BT_GATT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_gatts_req_write_handler
+ * *****************************************************************************
+ * Summary :
+ *    Process write request or write command from peer device
+ *
+ * Parameters:
+ *  conn_id       Connection ID
+ *  opcode        LE GATT request type opcode
+ *  p_data        Pointer to write request containing the data to write
+ *
+ * Return:
+ *  wiced_bt_gatt_status_t: See possible status codes in wiced_bt_gatt_status_e
+ *  in wiced_bt_gatt.h
+ ******************************************************************************/
+wiced_bt_gatt_status_t bt_app_ans_gatts_req_write_handler(wiced_bt_gatt_opcode_t opcode,
+                                                          uint16_t conn_id,
+                                                          wiced_bt_gatt_write_req_t *p_data)
+{
+    wiced_bt_gatt_status_t gatt_status = WICED_BT_GATT_SUCCESS;
+    const bt_app_ans_attr_t *p_attr = bt_app_ans_find_attr_by_handle(p_data->handle);
+
+    BT_APP_TRACE_DBG("conn_id:%d hdl:0x%x offset:%d len:%d \n", conn_id, p_data->handle,
+                     p_data->offset, p_data->val_len);
+
+    if ((p_attr != NULL) && (p_attr->p_write != NULL))
+    {
+        gatt_status = p_attr->p_write(conn_id, p_data);
+        ANS_PROBE(write_dispatch, conn_id, p_data->handle, gatt_status);
+
+        if (gatt_status == WICED_BT_GATT_SUCCESS)
+        {
+            gatt_status = wiced_bt_gatt_server_send_write_rsp(conn_id, opcode, p_data->handle);
+        }
+        else
+        {
+            gatt_status = wiced_bt_gatt_server_send_error_rsp(conn_id, opcode, p_data->handle, gatt_status);
+        }
+    }
+    else
+    {
+        gatt_status = WICED_BT_GATT_INVALID_HANDLE;
+        ANS_PROBE(write_dispatch, conn_id, p_data->handle, gatt_status);
+    }
+
+    return gatt_status;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_start_scan_connect
+ * *****************************************************************************
+ * Summary :
+ *    Does BLE Scan and connects to the device that is advertising as ANC
+ *
+ * Parameters:
+ *    None
+ *
+ * Return:
+ *    uint16_t: Status of the operation. Refer to list of wiced_result_t.
+ ******************************************************************************/
+uint16_t bt_app_ans_start_scan_connect(void)
+{
+    wiced_result_t result = WICED_BT_BUSY;
+    /* Start scan to find ANS Client */
+    if ((wiced_bt_ble_get_current_scan_state() == BTM_BLE_SCAN_TYPE_NONE) &&
+        (ans_app_cb.num_connections < CY_BT_SERVER_MAX_LINKS))
+    {
+        result = wiced_bt_ble_scan(BTM_BLE_SCAN_TYPE_HIGH_DUTY, WICED_TRUE, bt_app_ans_scan_result_cback);
+        WICED_BT_TRACE("BLE Scan Start Status: %d \n", result);
+        if (WICED_BT_PENDING)
+        {
+            result = WICED_BT_SUCCESS;
+        }
+    }
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_handle_set_supported_new_alert_categories
+ * *****************************************************************************
+ * Summary :
+ *    This function is sets the selected new alert categories
+ *
+ * Parameters:
+ *    p_data: 2 byte data containing the Bit fields pertaining to the Categories
+ *    length: length of the data
  *
  * Return:
  *    uint16_t: See possible status codes in wiced_bt_gatt_status_e
@@ -938,11 +2415,10 @@ wiced_bool_t bt_app_ans_read_link_keys(wiced_bt_device_link_keys_t *p_keys)
  ******************************************************************************/
 uint16_t bt_app_ans_handle_set_supported_new_alert_categories(uint16_t p_data, uint8_t length)
 {
-    uint16_t conn_id = ans_app_cb.conn_id;
     uint16_t supported_new_alert_cat;
     wiced_bt_gatt_status_t status = WICED_BT_GATT_SUCCESS;
 
-    if (ans_app_cb.conn_id != 0)
+    if (ans_app_cb.num_connections != 0)
     {
         WICED_BT_TRACE("Request not supported: ANS connected with ANC \n");
         return WICED_BT_GATT_WRONG_STATE;
@@ -955,7 +2431,9 @@ uint16_t bt_app_ans_handle_set_supported_new_alert_categories(uint16_t p_data, u
         /* Make sure user sets choice only in supported categories */
 
         /* supported_new_alert_cat &= ans_app_cb.current_enabled_alert_cat;*/
-        wiced_bt_ans_set_supported_new_alert_categories(conn_id, supported_new_alert_cat);
+        wiced_bt_ans_set_supported_new_alert_categories(0, supported_new_alert_cat);
+        ans_app_cb.supported_new_alert_cat = supported_new_alert_cat;
+        bt_app_ans_snapshot_update();
     }
     else
     {
@@ -981,11 +2459,10 @@ uint16_t bt_app_ans_handle_set_supported_new_alert_categories(uint16_t p_data, u
  ******************************************************************************/
 uint16_t bt_app_ans_handle_set_supported_unread_alert_categories(uint16_t p_data, uint8_t length)
 {
-    uint16_t conn_id = ans_app_cb.conn_id;
     uint16_t supported_unread_alert_cat = 0;
     wiced_bt_gatt_status_t gatt_status = WICED_BT_GATT_SUCCESS;
 
-    if (ans_app_cb.conn_id != 0)
+    if (ans_app_cb.num_connections != 0)
     {
         WICED_BT_TRACE("Request not supported: ANS connected with ANC \n");
         return WICED_BT_GATT_WRONG_STATE;
@@ -997,7 +2474,9 @@ uint16_t bt_app_ans_handle_set_supported_unread_alert_categories(uint16_t p_data
 
         /* Make sure user sets choice only in supported categories */
         /*supported_unread_alert_cat &= ans_app_cb.current_enabled_alert_cat; */
-        wiced_bt_ans_set_supported_unread_alert_categories(conn_id, supported_unread_alert_cat);
+        wiced_bt_ans_set_supported_unread_alert_categories(0, supported_unread_alert_cat);
+        ans_app_cb.supported_unread_alert_cat = supported_unread_alert_cat;
+        bt_app_ans_snapshot_update();
     }
     else
     {
@@ -1011,8 +2490,9 @@ uint16_t bt_app_ans_handle_set_supported_unread_alert_categories(uint16_t p_data
  * Function Name : bt_app_ans_handle_generate_alert
  * *****************************************************************************
  * Summary :
- *    This function generates alert in the chosen category depending on the
- *    Alert Control point written by the Client
+ *    This function generates alert in the chosen category on every connected
+ *    client depending on the Alert Control point written by that Client. While
+ *    no client is connected the alert is kept for the next one.
  *
  * Parameters:
  *    p_data: 1 byte data containing alert category
@@ -1024,34 +2504,96 @@ uint16_t bt_app_ans_handle_set_supported_unread_alert_categories(uint16_t p_data
  ******************************************************************************/
 uint16_t bt_app_ans_handle_generate_alert(uint8_t p_data, uint8_t len)
 {
-    uint16_t conn_id = ans_app_cb.conn_id;
     wiced_bt_gatt_status_t gatt_status = WICED_BT_GATT_SUCCESS;
 
-    if (ans_app_cb.conn_id == 0)
+    if (len != 1)
+    {
+        gatt_status = WICED_BT_GATT_ILLEGAL_PARAMETER;
+    }
+    else if (ans_app_cb.num_connections == 0)
     {
-        WICED_BT_TRACE("Generate alert failed: Service not connected \n");
-        gatt_status = WICED_BT_GATT_WRONG_STATE;
+        /* kept for the next client that connects */
+        if (!bt_app_offline_alerts_add(p_data, NULL, 0))
+            gatt_status = WICED_BT_GATT_INVALID_CFG;
+        else
+            bt_app_metrics_add(BT_APP_METRIC_ALERTS, p_data, 1);
     }
-    else if (len == 1)
+    else
     {
-        gatt_status = wiced_bt_ans_process_and_send_new_alert(conn_id, p_data);
+        /* Queue both values before sending, clients supporting it get them in one PDU */
+        bt_app_conn_params_alert(p_data);
+        wiced_bt_ans_begin_batch();
+        gatt_status = wiced_bt_ans_process_and_send_new_alert_all(p_data);
         if (gatt_status == WICED_BT_GATT_SUCCESS)
         {
-            gatt_status = wiced_bt_ans_process_and_send_unread_alert(conn_id, p_data);
+            gatt_status = wiced_bt_ans_process_and_send_unread_alert_all(p_data);
             if (gatt_status != WICED_BT_GATT_SUCCESS)
             {
-                WICED_BT_TRACE("Unread Alert Send Error %d \n", gatt_status);
+                BT_APP_TRACE_ERR("Unread Alert Send Error %d \n", gatt_status);
             }
         }
         else
         {
-            WICED_BT_TRACE("New Alert Send Error %d \n", gatt_status);
+            BT_APP_TRACE_ERR("New Alert Send Error %d \n", gatt_status);
+        }
+        bt_app_ans_metrics_alert(p_data, gatt_status);
+        wiced_bt_ans_end_batch();
+        bt_app_ans_snapshot_update();
+        bt_app_ans_metrics_update();
+    }
+
+    return gatt_status;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_handle_generate_alert_text
+ * *****************************************************************************
+ * Summary :
+ *    This function generates alert with a sender name or title in the chosen
+ *    category on every connected client, or keeps it for the next client
+ *    while none is connected
+ *
+ * Parameters:
+ *    alert_id: alert category
+ *    p_text: UTF-8 text, does not need to be NUL terminated
+ *    text_len: length of the text
+ *
+ * Return:
+ *    uint16_t: See possible status codes in wiced_bt_gatt_status_e
+ *  in wiced_bt_gatt.h
+ ******************************************************************************/
+uint16_t bt_app_ans_handle_generate_alert_text(uint8_t alert_id, const char *p_text, uint16_t text_len)
+{
+    wiced_bt_gatt_status_t gatt_status;
+
+    if (ans_app_cb.num_connections == 0)
+    {
+        /* kept for the next client that connects */
+        if (!bt_app_offline_alerts_add(alert_id, p_text, text_len))
+            return WICED_BT_GATT_INVALID_CFG;
+        bt_app_metrics_add(BT_APP_METRIC_ALERTS, alert_id, 1);
+        return WICED_BT_GATT_SUCCESS;
+    }
+
+    bt_app_conn_params_alert(alert_id);
+    wiced_bt_ans_begin_batch();
+    gatt_status = wiced_bt_ans_process_and_send_new_alert_text_all(alert_id, p_text, text_len);
+    if (gatt_status == WICED_BT_GATT_SUCCESS)
+    {
+        gatt_status = wiced_bt_ans_process_and_send_unread_alert_all(alert_id);
+        if (gatt_status != WICED_BT_GATT_SUCCESS)
+        {
+            BT_APP_TRACE_ERR("Unread Alert Send Error %d \n", gatt_status);
         }
     }
     else
     {
-        gatt_status = WICED_BT_GATT_ILLEGAL_PARAMETER;
+        BT_APP_TRACE_ERR("New Alert Send Error %d \n", gatt_status);
     }
+    bt_app_ans_metrics_alert(alert_id, gatt_status);
+    wiced_bt_ans_end_batch();
+    bt_app_ans_snapshot_update();
+    bt_app_ans_metrics_update();
 
     return gatt_status;
 }
@@ -1060,7 +2602,8 @@ uint16_t bt_app_ans_handle_generate_alert(uint8_t p_data, uint8_t len)
  * Function Name : bt_app_ans_handle_clear_alert
  * *****************************************************************************
  * Summary :
- *    This function clears alert in the chosen category
+ *    This function clears alert in the chosen category on every connected
+ *    client
  *
  * Parameters:
  *    p_data: 1 byte data containing alert category
@@ -1072,15 +2615,18 @@ uint16_t bt_app_ans_handle_generate_alert(uint8_t p_data, uint8_t len)
  ******************************************************************************/
 uint16_t bt_app_ans_handle_clear_alert(uint8_t p_data, uint8_t len)
 {
-    uint16_t conn_id = ans_app_cb.conn_id;
     wiced_bt_gatt_status_t gatt_status = WICED_BT_GATT_SUCCESS;
 
     if (len == 1)
     {
-        if (wiced_bt_ans_clear_alerts(conn_id, p_data) != WICED_TRUE)
+        bt_app_conn_params_alert_cleared(p_data);
+        bt_app_offline_alerts_clear(p_data);
+        if (wiced_bt_ans_clear_alerts_all(p_data) != WICED_TRUE)
         {
             gatt_status = WICED_BT_GATT_ERROR;
         }
+        bt_app_ans_snapshot_update();
+        bt_app_ans_metrics_update();
     }
     else
     {
@@ -1094,7 +2640,7 @@ uint16_t bt_app_ans_handle_clear_alert(uint8_t p_data, uint8_t len)
  * Function Name : bt_app_ans_disconnect
  * *****************************************************************************
  * Summary :
- *    This function clears alert in the chosen category
+ *    This function disconnects every connected client
  *
  * Parameters:
  *    None
@@ -1105,7 +2651,139 @@ uint16_t bt_app_ans_handle_clear_alert(uint8_t p_data, uint8_t len)
  ******************************************************************************/
 uint16_t bt_app_ans_disconnect()
 {
-    return wiced_bt_gatt_disconnect(ans_app_cb.conn_id);
+    wiced_bt_gatt_status_t gatt_status = WICED_BT_GATT_SUCCESS;
+    wiced_bt_gatt_status_t conn_status;
+    uint8_t i;
+
+    if (ans_app_cb.num_connections == 0)
+    {
+        return WICED_BT_GATT_WRONG_STATE;
+    }
+
+    for (i = 0; i < CY_BT_SERVER_MAX_LINKS; i++)
+    {
+        if (ans_app_cb.conn[i].conn_id != 0)
+        {
+            conn_status = wiced_bt_gatt_disconnect(ans_app_cb.conn[i].conn_id);
+            if (gatt_status == WICED_BT_GATT_SUCCESS)
+            {
+                gatt_status = conn_status;
+            }
+        }
+    }
+    return gatt_status;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_print_latency
+ * *****************************************************************************
+ * Summary :
+ *    Print the alert latency of a category, from the alert to the notification
+ *    transmitted and for every stage in between
+ *
+ * Parameters:
+ *    cat:    alert category ID
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_ans_print_latency(uint8_t cat)
+{
+    static const char *stage_name[WICED_BT_ANS_LATENCY_STAGES] = {"hold", "queue", "stack", "total"};
+    wiced_bt_ans_latency_t latency;
+    uint8_t stage;
+
+    if (!wiced_bt_ans_get_latency(cat, WICED_BT_ANS_LATENCY_TOTAL, &latency) || (latency.count == 0))
+        return;
+
+    fprintf(stdout, "category %d latency us (p50/p99/p99.9/max) of %u notifications\n", cat,
+            (unsigned)latency.count);
+    for (stage = 0; stage < WICED_BT_ANS_LATENCY_STAGES; stage++)
+    {
+        wiced_bt_ans_get_latency(cat, stage, &latency);
+        fprintf(stdout, "    %-5s %u/%u/%u/%u\n", stage_name[stage], (unsigned)latency.p50_us,
+                (unsigned)latency.p99_us, (unsigned)latency.p999_us, (unsigned)latency.max_us);
+    }
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_ans_print_stats
+ * *****************************************************************************
+ * Summary :
+ *    This function prints the occupancy of the offline alert buffer and the
+ *    notification TX queue statistics of every connected client
+ *
+ * Parameters:
+ *    None
+ *
+ * Return:
+ *    uint16_t: See possible status codes in wiced_bt_gatt_status_e
+ *  in wiced_bt_gatt.h
+ ******************************************************************************/
+uint16_t bt_app_ans_print_stats(void)
+{
+    wiced_bt_ans_tx_stats_t tx_stats;
+    bt_app_offline_alerts_stats_t offline_stats;
+    wiced_bt_ans_trace_stats_t trace_stats;
+    uint8_t cat;
+    uint8_t i;
+
+    wiced_bt_ans_trace_get_stats(&trace_stats);
+    fprintf(stdout, "trace: threads %u records %u dropped %u\n", (unsigned)trace_stats.threads,
+            (unsigned)trace_stats.records, (unsigned)trace_stats.dropped);
+
+    bt_app_offline_alerts_get_stats(&offline_stats);
+    fprintf(stdout, "offline alerts: buffered %d of %d max %d, folded %u expired %u delivered %u\n",
+            offline_stats.occupancy, offline_stats.capacity, offline_stats.max_occupancy,
+            (unsigned)offline_stats.folded, (unsigned)offline_stats.expired, (unsigned)offline_stats.delivered);
+    for (cat = 0; cat < ANP_NOTIFY_CATEGORY_COUNT; cat++)
+    {
+        if (offline_stats.pending[cat] != 0)
+            fprintf(stdout, "    category %d pending %d\n", cat, offline_stats.pending[cat]);
+    }
+
+    for (cat = 0; cat < ANP_NOTIFY_CATEGORY_COUNT; cat++)
+    {
+        bt_app_ans_print_latency(cat);
+    }
+
+    if (ans_app_cb.num_connections == 0)
+    {
+        return WICED_BT_GATT_WRONG_STATE;
+    }
+
+    for (i = 0; i < CY_BT_SERVER_MAX_LINKS; i++)
+    {
+        if ((ans_app_cb.conn[i].conn_id == 0) ||
+            (!wiced_bt_ans_get_tx_stats(ans_app_cb.conn[i].conn_id, &tx_stats)))
+        {
+            continue;
+        }
+        fprintf(stdout, "conn_id %d: queued %d in flight %d max depth %d %s\n",
+                ans_app_cb.conn[i].conn_id, tx_stats.queue_depth, tx_stats.in_flight,
+                tx_stats.max_depth, tx_stats.congested ? "congested" : "");
+        fprintf(stdout, "    sent %u dropped %u retried %u combined %u eatt bearers %d\n",
+                (unsigned)tx_stats.sent, (unsigned)tx_stats.drops, (unsigned)tx_stats.retries,
+                (unsigned)tx_stats.combined, tx_stats.eatt_bearers);
+        fprintf(stdout, "    phy tx %s rx %s, data length tx %d rx %d\n",
+                bt_app_ans_phy_name(ans_app_cb.conn[i].tx_phy), bt_app_ans_phy_name(ans_app_cb.conn[i].rx_phy),
+                ans_app_cb.conn[i].max_tx_octets, ans_app_cb.conn[i].max_rx_octets);
+        bt_app_conn_params_print_stats(ans_app_cb.conn[i].conn_id);
+        for (cat = 0; cat < ANP_NOTIFY_CATEGORY_COUNT; cat++)
+        {
+            if (tx_stats.deadline_misses[cat] != 0)
+            {
+                fprintf(stdout, "    category %d missed deadline %u times\n", cat,
+                        (unsigned)tx_stats.deadline_misses[cat]);
+            }
+            if (tx_stats.throttled[cat] != 0)
+            {
+                fprintf(stdout, "    category %d throttled %u alerts\n", cat,
+                        (unsigned)tx_stats.throttled[cat]);
+            }
+        }
+    }
+    return WICED_BT_GATT_SUCCESS;
 }
 
 /* END OF FILE [] */
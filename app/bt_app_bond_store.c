@@ -0,0 +1,601 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+/******************************************************************************
+ * File Name: bt_app_bond_store.c
+ *
+ * Description:
+ * Bond store of the LE Alert Notification Server. The link keys, the GATT
+ * state and the ANS client state of up to CY_BT_MAX_BONDED_DEVICES bonded
+ * clients are kept in memory, indexed by BD address, and written through to
+ * the NVRAM. When the store is full a new bond replaces the least recently
+ * used one.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include <string.h>
+#include "wiced_bt_dev.h"
+#include "wiced_bt_trace.h"
+#include "wiced_hal_nvram.h"
+#include "COMPONENT_ans/wiced_bt_ans.h"
+#include "app_bt_config/ans_gap.h"
+#include "bt_app_bond_store.h"
+
+/*******************************************************************************
+ *                                   MACROS
+ *******************************************************************************/
+/* One NVRAM entry per bond, above the entries of bt_app_ans.c, and one for its ANS client state. The
+ * client state changes far more often than the keys, it is written on its own */
+#define BT_APP_BOND_STORE_NVRAM_ID ( WICED_NVRAM_VSID_START + 0x10U )
+#define BT_APP_BOND_STORE_ANS_NVRAM_ID ( BT_APP_BOND_STORE_NVRAM_ID + CY_BT_MAX_BONDED_DEVICES )
+
+/* Single bond entries written by earlier versions, moved into the store once */
+#define BT_APP_BOND_STORE_LEGACY_KEYS_NVRAM_ID ( WICED_NVRAM_VSID_START + 1 )
+#define BT_APP_BOND_STORE_LEGACY_GATT_NVRAM_ID ( WICED_NVRAM_VSID_START + 2 )
+
+/* BD address index, open addressing with linear probing kept at most half full */
+#define BT_APP_BOND_STORE_INDEX_SIZE ( 16U )
+#define BT_APP_BOND_STORE_INDEX_MASK ( BT_APP_BOND_STORE_INDEX_SIZE - 1 )
+#define BT_APP_BOND_STORE_INDEX_FREE ( 0xFFU )
+
+#if ( CY_BT_MAX_BONDED_DEVICES * 2 > BT_APP_BOND_STORE_INDEX_SIZE ) || ( CY_BT_MAX_BONDED_DEVICES == 0 )
+#error "CY_BT_MAX_BONDED_DEVICES out of range, increase BT_APP_BOND_STORE_INDEX_SIZE"
+#endif
+
+/*******************************************************************************
+ *                    STRUCTURES AND ENUMERATIONS
+ *******************************************************************************/
+typedef struct
+{
+    wiced_bt_device_link_keys_t keys;
+    bt_app_bond_gatt_state_t gatt_state;
+    uint8_t gatt_state_valid; /* GATT state was saved since the client bonded */
+    uint32_t last_used; /* Use order, the bond with the lowest value is replaced first */
+} bt_app_bond_store_entry_t; /* Bond as kept in memory and in its NVRAM entry */
+
+typedef struct
+{
+    wiced_bt_device_address_t bd_addr;
+    wiced_bt_db_hash_t db_hash;
+    uint8_t client_features;
+    uint16_t service_changed_cccd;
+} bt_app_bond_store_legacy_gatt_t; /* Single GATT state entry written by earlier versions */
+
+typedef struct
+{
+    bt_app_bond_store_entry_t entry[CY_BT_MAX_BONDED_DEVICES];
+    uint8_t valid[CY_BT_MAX_BONDED_DEVICES];
+    wiced_bt_ans_client_state_t ans_state[CY_BT_MAX_BONDED_DEVICES];
+    uint8_t ans_state_valid[CY_BT_MAX_BONDED_DEVICES];
+    uint8_t index[BT_APP_BOND_STORE_INDEX_SIZE]; /* Entry of a BD address, at its hash or probed after */
+    uint32_t use_count; /* Last use order given out */
+} bt_app_bond_store_cb_t;
+
+/*******************************************************************************
+ *                           GLOBAL VARIABLES
+ *******************************************************************************/
+static bt_app_bond_store_cb_t bt_app_bond_store_cb;
+
+/*******************************************************************************
+ *                           FUNCTION DECLARATIONS
+ *******************************************************************************/
+static uint8_t bt_app_bond_store_home(wiced_bt_device_address_t bd_addr);
+static uint8_t bt_app_bond_store_find(wiced_bt_device_address_t bd_addr);
+static void bt_app_bond_store_index_add(uint8_t idx);
+static void bt_app_bond_store_index_remove(uint8_t idx);
+static uint8_t bt_app_bond_store_alloc(void);
+static wiced_bool_t bt_app_bond_store_write(uint8_t idx);
+static void bt_app_bond_store_migrate(void);
+
+/*******************************************************************************
+ *                       FUNCTION DEFINITIONS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * Function Name : bt_app_bond_store_home
+ * *****************************************************************************
+ * Summary :
+ *    Home position of a BD address in the index, FNV-1a hash of the address
+ *
+ * Parameters:
+ *    bd_addr:    BD address
+ *
+ * Return:
+ *    uint8_t:    Index position
+ ******************************************************************************/
+static uint8_t bt_app_bond_store_home(wiced_bt_device_address_t bd_addr)
+{
+    uint32_t hash = 2166136261U;
+    uint8_t i;
+
+    for (i = 0; i < sizeof(wiced_bt_device_address_t); i++)
+        hash = (hash ^ bd_addr[i]) * 16777619U;
+
+    return (uint8_t)(hash & BT_APP_BOND_STORE_INDEX_MASK);
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_bond_store_find
+ * *****************************************************************************
+ * Summary :
+ *    Find the bond of a BD address
+ *
+ * Parameters:
+ *    bd_addr:    BD address
+ *
+ * Return:
+ *    uint8_t:    Entry of the bond, BT_APP_BOND_STORE_INDEX_FREE if not bonded
+ ******************************************************************************/
+static uint8_t bt_app_bond_store_find(wiced_bt_device_address_t bd_addr)
+{
+    uint8_t pos = bt_app_bond_store_home(bd_addr);
+    uint8_t idx;
+
+    while ((idx = bt_app_bond_store_cb.index[pos]) != BT_APP_BOND_STORE_INDEX_FREE)
+    {
+        if (memcmp(bt_app_bond_store_cb.entry[idx].keys.bd_addr, bd_addr, sizeof(wiced_bt_device_address_t)) == 0)
+            return idx;
+
+        pos = (pos + 1) & BT_APP_BOND_STORE_INDEX_MASK;
+    }
+    return BT_APP_BOND_STORE_INDEX_FREE;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_bond_store_index_add
+ * *****************************************************************************
+ * Summary :
+ *    Add an entry to the BD address index
+ *
+ * Parameters:
+ *    idx:        Entry
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_bond_store_index_add(uint8_t idx)
+{
+    uint8_t pos = bt_app_bond_store_home(bt_app_bond_store_cb.entry[idx].keys.bd_addr);
+
+    while (bt_app_bond_store_cb.index[pos] != BT_APP_BOND_STORE_INDEX_FREE)
+        pos = (pos + 1) & BT_APP_BOND_STORE_INDEX_MASK;
+
+    bt_app_bond_store_cb.index[pos] = idx;
+    bt_app_bond_store_cb.valid[idx] = WICED_TRUE;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_bond_store_index_remove
+ * *****************************************************************************
+ * Summary :
+ *    Remove an entry from the BD address index. The entries following it are
+ *    shifted back so that every probe sequence stays intact.
+ *
+ * Parameters:
+ *    idx:        Entry
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_bond_store_index_remove(uint8_t idx)
+{
+    uint8_t pos = bt_app_bond_store_home(bt_app_bond_store_cb.entry[idx].keys.bd_addr);
+    uint8_t next;
+    uint8_t home;
+
+    while (bt_app_bond_store_cb.index[pos] != idx)
+        pos = (pos + 1) & BT_APP_BOND_STORE_INDEX_MASK;
+
+    next = pos;
+    for (;;)
+    {
+        bt_app_bond_store_cb.index[pos] = BT_APP_BOND_STORE_INDEX_FREE;
+        for (;;)
+        {
+            next = (next + 1) & BT_APP_BOND_STORE_INDEX_MASK;
+            if (bt_app_bond_store_cb.index[next] == BT_APP_BOND_STORE_INDEX_FREE)
+            {
+                bt_app_bond_store_cb.valid[idx] = WICED_FALSE;
+                return;
+            }
+
+            /* entry at next can move to pos only if its home is not in (pos, next] */
+            home = bt_app_bond_store_home(bt_app_bond_store_cb.entry[bt_app_bond_store_cb.index[next]].keys.bd_addr);
+            if (((next - home) & BT_APP_BOND_STORE_INDEX_MASK) >= ((next - pos) & BT_APP_BOND_STORE_INDEX_MASK))
+                break;
+        }
+        bt_app_bond_store_cb.index[pos] = bt_app_bond_store_cb.index[next];
+        pos = next;
+    }
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_bond_store_alloc
+ * *****************************************************************************
+ * Summary :
+ *    Get an entry for a new bond, a free one or else the least recently used
+ *    one. A replaced bond is taken out of the address resolution database.
+ *
+ * Parameters:
+ *    None
+ *
+ * Return:
+ *    uint8_t:    Entry for the new bond, out of the index
+ ******************************************************************************/
+static uint8_t bt_app_bond_store_alloc(void)
+{
+    uint8_t lru = 0;
+    uint8_t idx;
+
+    for (idx = 0; idx < CY_BT_MAX_BONDED_DEVICES; idx++)
+    {
+        if (!bt_app_bond_store_cb.valid[idx])
+            return idx;
+
+        if (bt_app_bond_store_cb.entry[idx].last_used < bt_app_bond_store_cb.entry[lru].last_used)
+            lru = idx;
+    }
+
+    WICED_BT_TRACE("Bond store full, replacing %B \n", bt_app_bond_store_cb.entry[lru].keys.bd_addr);
+    wiced_bt_dev_remove_device_from_address_resolution_db(&bt_app_bond_store_cb.entry[lru].keys);
+    bt_app_bond_store_index_remove(lru);
+    return lru;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_bond_store_write
+ * *****************************************************************************
+ * Summary :
+ *    Write an entry through to its NVRAM entry
+ *
+ * Parameters:
+ *    idx:        Entry
+ *
+ * Return:
+ *    wiced_bool_t: WICED_TRUE if the entry was written
+ ******************************************************************************/
+static wiced_bool_t bt_app_bond_store_write(uint8_t idx)
+{
+    uint16_t bytes_written;
+    wiced_result_t result;
+
+    bytes_written = wiced_hal_write_nvram(BT_APP_BOND_STORE_NVRAM_ID + idx, sizeof(bt_app_bond_store_entry_t),
+                                          (uint8_t *)&bt_app_bond_store_cb.entry[idx], &result);
+    if ((result != WICED_SUCCESS) || (bytes_written != sizeof(bt_app_bond_store_entry_t)))
+    {
+        WICED_BT_TRACE("Err: saving bond %d failed status:%d \n", idx, result);
+        return WICED_FALSE;
+    }
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_bond_store_migrate
+ * *****************************************************************************
+ * Summary :
+ *    Move the single bond of earlier versions into the store
+ *
+ * Parameters:
+ *    None
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_bond_store_migrate(void)
+{
+    wiced_bt_device_link_keys_t keys;
+    bt_app_bond_store_legacy_gatt_t legacy_gatt;
+    bt_app_bond_gatt_state_t gatt_state;
+    uint16_t bytes_read;
+    wiced_result_t result;
+
+    bytes_read = wiced_hal_read_nvram(BT_APP_BOND_STORE_LEGACY_KEYS_NVRAM_ID, sizeof(keys), (uint8_t *)&keys,
+                                      &result);
+    if ((result != WICED_SUCCESS) || (bytes_read != sizeof(keys)))
+        return;
+
+    WICED_BT_TRACE("Moving bond of %B to the bond store \n", keys.bd_addr);
+    if (!bt_app_bond_store_save_keys(&keys))
+        return;
+
+    bytes_read = wiced_hal_read_nvram(BT_APP_BOND_STORE_LEGACY_GATT_NVRAM_ID, sizeof(legacy_gatt),
+                                      (uint8_t *)&legacy_gatt, &result);
+    if ((result == WICED_SUCCESS) && (bytes_read == sizeof(legacy_gatt)) &&
+        (memcmp(legacy_gatt.bd_addr, keys.bd_addr, sizeof(wiced_bt_device_address_t)) == 0))
+    {
+        memcpy(gatt_state.db_hash, legacy_gatt.db_hash, sizeof(wiced_bt_db_hash_t));
+        gatt_state.client_features = legacy_gatt.client_features;
+        gatt_state.service_changed_cccd = legacy_gatt.service_changed_cccd;
+        bt_app_bond_store_save_gatt_state(keys.bd_addr, &gatt_state);
+    }
+
+    wiced_hal_delete_nvram(BT_APP_BOND_STORE_LEGACY_KEYS_NVRAM_ID, &result);
+    wiced_hal_delete_nvram(BT_APP_BOND_STORE_LEGACY_GATT_NVRAM_ID, &result);
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_bond_store_init
+ * *****************************************************************************
+ * Summary :
+ *    Load the bonds from the NVRAM and add their keys to the address
+ *    resolution database. Call once the stack is enabled, later lookups do
+ *    not access the NVRAM.
+ *
+ * Parameters:
+ *    None
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+void bt_app_bond_store_init(void)
+{
+    bt_app_bond_store_entry_t *p_entry;
+    uint16_t bytes_read;
+    wiced_result_t result;
+    uint8_t num_bonds = 0;
+    uint8_t idx;
+
+    memset(&bt_app_bond_store_cb, 0, sizeof(bt_app_bond_store_cb));
+    memset(bt_app_bond_store_cb.index, BT_APP_BOND_STORE_INDEX_FREE, sizeof(bt_app_bond_store_cb.index));
+
+    for (idx = 0; idx < CY_BT_MAX_BONDED_DEVICES; idx++)
+    {
+        p_entry = &bt_app_bond_store_cb.entry[idx];
+        bytes_read = wiced_hal_read_nvram(BT_APP_BOND_STORE_NVRAM_ID + idx, sizeof(*p_entry), (uint8_t *)p_entry,
+                                          &result);
+
+        /* if failed to read NVRAM, there is no bond at that location */
+        if ((result != WICED_SUCCESS) || (bytes_read != sizeof(*p_entry)) ||
+            (bt_app_bond_store_find(p_entry->keys.bd_addr) != BT_APP_BOND_STORE_INDEX_FREE))
+        {
+            memset(p_entry, 0, sizeof(*p_entry));
+            continue;
+        }
+
+        bt_app_bond_store_index_add(idx);
+        if (p_entry->last_used > bt_app_bond_store_cb.use_count)
+            bt_app_bond_store_cb.use_count = p_entry->last_used;
+
+        bytes_read = wiced_hal_read_nvram(BT_APP_BOND_STORE_ANS_NVRAM_ID + idx, sizeof(wiced_bt_ans_client_state_t),
+                                          (uint8_t *)&bt_app_bond_store_cb.ans_state[idx], &result);
+        bt_app_bond_store_cb.ans_state_valid[idx] = ((result == WICED_SUCCESS) &&
+                                                     (bytes_read == sizeof(wiced_bt_ans_client_state_t))) ?
+                                                    WICED_TRUE : WICED_FALSE;
+
+        wiced_bt_dev_add_device_to_address_resolution_db(&p_entry->keys);
+        num_bonds++;
+    }
+
+    if (num_bonds == 0)
+        bt_app_bond_store_migrate();
+
+    WICED_BT_TRACE("Bond store: %d bonded devices \n", num_bonds);
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_bond_store_get_keys
+ * *****************************************************************************
+ * Summary :
+ *    Look up the link keys of a bonded device and mark the bond used. The use
+ *    order reaches the NVRAM with the next write of the bond.
+ *
+ * Parameters:
+ *    bd_addr:    BD address of the device
+ *    p_keys:     Link keys of the device, may be NULL to check for a bond
+ *
+ * Return:
+ *    wiced_bool_t: WICED_TRUE if the device is bonded
+ ******************************************************************************/
+wiced_bool_t bt_app_bond_store_get_keys(wiced_bt_device_address_t bd_addr, wiced_bt_device_link_keys_t *p_keys)
+{
+    uint8_t idx = bt_app_bond_store_find(bd_addr);
+
+    if (idx == BT_APP_BOND_STORE_INDEX_FREE)
+        return WICED_FALSE;
+
+    bt_app_bond_store_cb.entry[idx].last_used = ++bt_app_bond_store_cb.use_count;
+    if (p_keys != NULL)
+        memcpy(p_keys, &bt_app_bond_store_cb.entry[idx].keys, sizeof(wiced_bt_device_link_keys_t));
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_bond_store_save_keys
+ * *****************************************************************************
+ * Summary :
+ *    Save the link keys of a device after pairing or a keys update. A new
+ *    bond replaces the least recently used one if the store is full.
+ *
+ * Parameters:
+ *    p_keys:     Link keys of the device
+ *
+ * Return:
+ *    wiced_bool_t: WICED_TRUE if the keys were written to the NVRAM
+ ******************************************************************************/
+wiced_bool_t bt_app_bond_store_save_keys(wiced_bt_device_link_keys_t *p_keys)
+{
+    bt_app_bond_store_entry_t *p_entry;
+    wiced_result_t result;
+    uint8_t idx = bt_app_bond_store_find(p_keys->bd_addr);
+
+    if (idx == BT_APP_BOND_STORE_INDEX_FREE)
+    {
+        idx = bt_app_bond_store_alloc();
+        p_entry = &bt_app_bond_store_cb.entry[idx];
+        memset(p_entry, 0, sizeof(*p_entry));
+        memcpy(&p_entry->keys, p_keys, sizeof(wiced_bt_device_link_keys_t));
+        bt_app_bond_store_index_add(idx);
+
+        /* the client state of a replaced bond goes with it */
+        if (bt_app_bond_store_cb.ans_state_valid[idx])
+        {
+            bt_app_bond_store_cb.ans_state_valid[idx] = WICED_FALSE;
+            wiced_hal_delete_nvram(BT_APP_BOND_STORE_ANS_NVRAM_ID + idx, &result);
+        }
+    }
+    else
+    {
+        p_entry = &bt_app_bond_store_cb.entry[idx];
+        memcpy(&p_entry->keys, p_keys, sizeof(wiced_bt_device_link_keys_t));
+    }
+
+    p_entry->last_used = ++bt_app_bond_store_cb.use_count;
+    return bt_app_bond_store_write(idx);
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_bond_store_get_gatt_state
+ * *****************************************************************************
+ * Summary :
+ *    Look up the GATT state of a bonded client
+ *
+ * Parameters:
+ *    bd_addr:    BD address of the client
+ *    p_state:    GATT state of the client
+ *
+ * Return:
+ *    wiced_bool_t: WICED_TRUE if the client is bonded and its GATT state saved
+ ******************************************************************************/
+wiced_bool_t bt_app_bond_store_get_gatt_state(wiced_bt_device_address_t bd_addr, bt_app_bond_gatt_state_t *p_state)
+{
+    uint8_t idx = bt_app_bond_store_find(bd_addr);
+
+    if ((idx == BT_APP_BOND_STORE_INDEX_FREE) || !bt_app_bond_store_cb.entry[idx].gatt_state_valid)
+        return WICED_FALSE;
+
+    memcpy(p_state, &bt_app_bond_store_cb.entry[idx].gatt_state, sizeof(bt_app_bond_gatt_state_t));
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_bond_store_save_gatt_state
+ * *****************************************************************************
+ * Summary :
+ *    Save the GATT state of a bonded client
+ *
+ * Parameters:
+ *    bd_addr:    BD address of the client
+ *    p_state:    GATT state of the client
+ *
+ * Return:
+ *    wiced_bool_t: WICED_TRUE if the client is bonded and the state written
+ *    to the NVRAM
+ ******************************************************************************/
+wiced_bool_t bt_app_bond_store_save_gatt_state(wiced_bt_device_address_t bd_addr,
+                                               const bt_app_bond_gatt_state_t *p_state)
+{
+    bt_app_bond_store_entry_t *p_entry;
+    uint8_t idx = bt_app_bond_store_find(bd_addr);
+
+    if (idx == BT_APP_BOND_STORE_INDEX_FREE)
+        return WICED_FALSE;
+
+    p_entry = &bt_app_bond_store_cb.entry[idx];
+    if (p_entry->gatt_state_valid && (memcmp(&p_entry->gatt_state, p_state, sizeof(*p_state)) == 0))
+        return WICED_TRUE;
+
+    memcpy(&p_entry->gatt_state, p_state, sizeof(bt_app_bond_gatt_state_t));
+    p_entry->gatt_state_valid = WICED_TRUE;
+    return bt_app_bond_store_write(idx);
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_bond_store_get_ans_state
+ * *****************************************************************************
+ * Summary :
+ *    Look up the ANS client state of a bonded client
+ *
+ * Parameters:
+ *    bd_addr:    BD address of the client
+ *    p_state:    ANS client state
+ *
+ * Return:
+ *    wiced_bool_t: WICED_TRUE if the client is bonded and its state saved
+ ******************************************************************************/
+wiced_bool_t bt_app_bond_store_get_ans_state(wiced_bt_device_address_t bd_addr, wiced_bt_ans_client_state_t *p_state)
+{
+    uint8_t idx = bt_app_bond_store_find(bd_addr);
+
+    if ((idx == BT_APP_BOND_STORE_INDEX_FREE) || !bt_app_bond_store_cb.ans_state_valid[idx])
+        return WICED_FALSE;
+
+    memcpy(p_state, &bt_app_bond_store_cb.ans_state[idx], sizeof(wiced_bt_ans_client_state_t));
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_bond_store_save_ans_state
+ * *****************************************************************************
+ * Summary :
+ *    Save the ANS client state of a bonded client, the NVRAM is written only
+ *    if the state changed
+ *
+ * Parameters:
+ *    bd_addr:    BD address of the client
+ *    p_state:    ANS client state
+ *
+ * Return:
+ *    wiced_bool_t: WICED_TRUE if the client is bonded and the state written
+ *    to the NVRAM
+ ******************************************************************************/
+wiced_bool_t bt_app_bond_store_save_ans_state(wiced_bt_device_address_t bd_addr,
+                                              const wiced_bt_ans_client_state_t *p_state)
+{
+    uint8_t idx = bt_app_bond_store_find(bd_addr);
+    uint16_t bytes_written;
+    wiced_result_t result;
+
+    if (idx == BT_APP_BOND_STORE_INDEX_FREE)
+        return WICED_FALSE;
+
+    if (bt_app_bond_store_cb.ans_state_valid[idx] &&
+        (memcmp(&bt_app_bond_store_cb.ans_state[idx], p_state, sizeof(*p_state)) == 0))
+    {
+        return WICED_TRUE;
+    }
+
+    memcpy(&bt_app_bond_store_cb.ans_state[idx], p_state, sizeof(wiced_bt_ans_client_state_t));
+    bt_app_bond_store_cb.ans_state_valid[idx] = WICED_TRUE;
+
+    bytes_written = wiced_hal_write_nvram(BT_APP_BOND_STORE_ANS_NVRAM_ID + idx, sizeof(wiced_bt_ans_client_state_t),
+                                          (uint8_t *)&bt_app_bond_store_cb.ans_state[idx], &result);
+    if ((result != WICED_SUCCESS) || (bytes_written != sizeof(wiced_bt_ans_client_state_t)))
+    {
+        WICED_BT_TRACE("Err: saving client state %d failed status:%d \n", idx, result);
+        return WICED_FALSE;
+    }
+    return WICED_TRUE;
+}
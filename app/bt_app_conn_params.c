@@ -0,0 +1,581 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+/******************************************************************************
+ * File Name: bt_app_conn_params.c
+ *
+ * Description:
+ * Connection parameter manager of the LE Alert Notification Server. A client
+ * gets a short connection interval while alerts are queued or a call rings,
+ * and a long interval with peripheral latency, or a subrated connection where
+ * the controllers support it, while idle.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include "wiced_bt_dev.h"
+#include "wiced_bt_ble.h"
+#include "wiced_bt_l2c.h"
+#include "wiced_bt_trace.h"
+#include "wiced_timer.h"
+#include "COMPONENT_ans/wiced_bt_anp.h"
+#include "COMPONENT_ans/wiced_bt_ans.h"
+#include "app_bt_config/ans_gap.h"
+#include "bt_app_conn_params.h"
+
+/*******************************************************************************
+ *                                   MACROS
+ *******************************************************************************/
+/* Connection intervals are in 1.25 ms units, the supervision timeout in 10 ms units */
+#define BT_APP_CONN_PARAMS_FAST_MIN_INTERVAL ( 12U ) /* 15 ms */
+#define BT_APP_CONN_PARAMS_FAST_MAX_INTERVAL ( 24U ) /* 30 ms */
+#define BT_APP_CONN_PARAMS_IDLE_MIN_INTERVAL ( 160U ) /* 200 ms */
+#define BT_APP_CONN_PARAMS_IDLE_MAX_INTERVAL ( 200U ) /* 250 ms */
+#define BT_APP_CONN_PARAMS_IDLE_LATENCY ( 4U ) /* ANS listens about once a second while idle */
+#define BT_APP_CONN_PARAMS_SUPERVISION_TIMEOUT ( 600U ) /* 6 s */
+
+/* Idle with subrating keeps the fast interval and uses every 8th event, going fast again needs no
+ * connection update */
+#define BT_APP_CONN_PARAMS_IDLE_SUBRATE ( 8U )
+#define BT_APP_CONN_PARAMS_IDLE_SUBRATE_LATENCY ( 4U )
+#define BT_APP_CONN_PARAMS_SUBRATE_CONTINUATION ( 1U )
+
+#define BT_APP_CONN_PARAMS_HOLD_MS ( 2000U ) /* Fast parameters are kept this long after the last alert */
+#define BT_APP_CONN_PARAMS_CONNECT_HOLD_MS ( 5000U ) /* Time for discovery and configuration after connecting */
+#define BT_APP_CONN_PARAMS_RING_MS ( 30000U ) /* A call alert that is not cleared stops ringing after this */
+#define BT_APP_CONN_PARAMS_CHECK_MS ( 500U ) /* Load check period while any client is fast */
+
+#define BT_APP_CONN_PARAMS_MODE_FAST ( 0U )
+#define BT_APP_CONN_PARAMS_MODE_IDLE ( 1U )
+
+#define BT_APP_CONN_PARAMS_SUBRATE_UNKNOWN ( 0U )
+#define BT_APP_CONN_PARAMS_SUBRATE_SUPPORTED ( 1U )
+#define BT_APP_CONN_PARAMS_SUBRATE_UNSUPPORTED ( 2U )
+
+/*******************************************************************************
+ *                    STRUCTURES AND ENUMERATIONS
+ *******************************************************************************/
+typedef struct
+{
+    uint16_t conn_id; /* 0 if the entry is free */
+    wiced_bt_device_address_t bd_addr;
+    uint8_t mode; /* Requested parameters, BT_APP_CONN_PARAMS_MODE_xxx */
+    uint8_t subrate; /* Subrating support of the link, BT_APP_CONN_PARAMS_SUBRATE_xxx */
+    uint16_t conn_interval; /* Connection interval in use, 0 until reported */
+    uint16_t conn_latency; /* Peripheral latency in connection events */
+    uint16_t subrate_factor; /* Connection events per subrated event, 1 when not subrated */
+    uint16_t subrate_latency; /* Peripheral latency in subrated events */
+    uint32_t hold_until_ms; /* Fast parameters are kept at least until then */
+    uint32_t since_ms; /* Time the parameters in use were accounted last */
+    uint32_t fast_ms; /* Time spent with an alert latency of the fast interval or less */
+    uint32_t idle_ms; /* Time spent with longer alert latency */
+    uint64_t wakeups_milli; /* Connection events the ANS listened to, in thousandths */
+    uint32_t updates; /* Parameter changes completed */
+    uint32_t rejected; /* Parameter changes refused by the client or the controller */
+} bt_app_conn_params_conn_t; /* Connection parameters of a client */
+
+typedef struct
+{
+    bt_app_conn_params_conn_t conn[CY_BT_SERVER_MAX_LINKS];
+    wiced_bool_t ringing; /* A call alert is ringing */
+    uint32_t ring_until_ms; /* A call alert that is not cleared stops ringing then */
+    wiced_timer_t timer; /* Load check while a client is fast */
+} bt_app_conn_params_cb_t;
+
+/*******************************************************************************
+ *                           GLOBAL VARIABLES
+ *******************************************************************************/
+static bt_app_conn_params_cb_t bt_app_conn_params_cb;
+
+/*******************************************************************************
+ *                           FUNCTION DECLARATIONS
+ *******************************************************************************/
+static uint32_t bt_app_conn_params_now_ms(void);
+static bt_app_conn_params_conn_t *bt_app_conn_params_find(uint16_t conn_id, wiced_bt_device_address_t bd_addr);
+static void bt_app_conn_params_account(bt_app_conn_params_conn_t *p_conn, uint32_t now);
+static void bt_app_conn_params_request(bt_app_conn_params_conn_t *p_conn, uint8_t mode);
+static void bt_app_conn_params_timeout(WICED_TIMER_PARAM_TYPE param);
+
+/*******************************************************************************
+ *                       FUNCTION DEFINITIONS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * Function Name : bt_app_conn_params_now_ms
+ * *****************************************************************************
+ * Summary :
+ *    Monotonic time in ms, compare with signed differences
+ *
+ * Parameters:
+ *    None
+ *
+ * Return:
+ *    uint32_t:   Time in ms
+ ******************************************************************************/
+static uint32_t bt_app_conn_params_now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000);
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_conn_params_find
+ * *****************************************************************************
+ * Summary :
+ *    Find the entry of a client by connection ID or, if bd_addr is not NULL,
+ *    by address. Connection ID 0 finds a free entry.
+ *
+ * Parameters:
+ *    conn_id:    GATT connection ID
+ *    bd_addr:    address of the client, or NULL
+ *
+ * Return:
+ *    bt_app_conn_params_conn_t:   matching entry, NULL if not found
+ ******************************************************************************/
+static bt_app_conn_params_conn_t *bt_app_conn_params_find(uint16_t conn_id, wiced_bt_device_address_t bd_addr)
+{
+    bt_app_conn_params_conn_t *p_conn;
+    uint8_t i;
+
+    for (i = 0; i < CY_BT_SERVER_MAX_LINKS; i++)
+    {
+        p_conn = &bt_app_conn_params_cb.conn[i];
+        if (bd_addr != NULL)
+        {
+            if ((p_conn->conn_id != 0) && (memcmp(p_conn->bd_addr, bd_addr, sizeof(wiced_bt_device_address_t)) == 0))
+                return p_conn;
+        }
+        else if (p_conn->conn_id == conn_id)
+        {
+            return p_conn;
+        }
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_conn_params_account
+ * *****************************************************************************
+ * Summary :
+ *    Account the time since the last call to the parameters in use. An alert
+ *    waits up to one subrated interval, the ANS wakes up once per subrated
+ *    interval and peripheral latency.
+ *
+ * Parameters:
+ *    p_conn:     Client entry
+ *    now:        Current time in ms
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_conn_params_account(bt_app_conn_params_conn_t *p_conn, uint32_t now)
+{
+    uint32_t elapsed = now - p_conn->since_ms;
+    uint32_t latency = (p_conn->subrate_factor > 1) ? p_conn->subrate_latency : p_conn->conn_latency;
+    uint64_t wake_us;
+
+    p_conn->since_ms = now;
+    if (p_conn->conn_interval == 0)
+        return;
+
+    if ((uint32_t)p_conn->conn_interval * p_conn->subrate_factor <= BT_APP_CONN_PARAMS_FAST_MAX_INTERVAL)
+        p_conn->fast_ms += elapsed;
+    else
+        p_conn->idle_ms += elapsed;
+
+    wake_us = (uint64_t)p_conn->conn_interval * 1250 * p_conn->subrate_factor * (latency + 1);
+    p_conn->wakeups_milli += (uint64_t)elapsed * 1000000 / wake_us;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_conn_params_request
+ * *****************************************************************************
+ * Summary :
+ *    Ask for the fast or the idle parameters. Where subrating is supported the
+ *    client stays on the fast interval and idles with a subrate factor,
+ *    otherwise the connection is updated to the long interval with latency.
+ *
+ * Parameters:
+ *    p_conn:     Client entry
+ *    mode:       BT_APP_CONN_PARAMS_MODE_xxx
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_conn_params_request(bt_app_conn_params_conn_t *p_conn, uint8_t mode)
+{
+    wiced_result_t result;
+    wiced_bool_t fast_interval = ((p_conn->conn_interval != 0) &&
+                                  (p_conn->conn_interval <= BT_APP_CONN_PARAMS_FAST_MAX_INTERVAL)) ? WICED_TRUE :
+                                                                                                     WICED_FALSE;
+
+    p_conn->mode = mode;
+
+    if (mode == BT_APP_CONN_PARAMS_MODE_FAST)
+    {
+        if (fast_interval && (p_conn->subrate_factor > 1))
+        {
+            result = wiced_bt_ble_subrate_request(p_conn->bd_addr, 1, 1, 0, 0, BT_APP_CONN_PARAMS_SUPERVISION_TIMEOUT);
+            WICED_BT_TRACE("Subrate off conn_id:%d result:%d \n", p_conn->conn_id, result);
+            if ((result == WICED_BT_SUCCESS) || (result == WICED_BT_PENDING))
+                return;
+        }
+        if (fast_interval && (p_conn->subrate_factor <= 1))
+            return;
+
+        if (!wiced_bt_l2cap_update_ble_conn_params(p_conn->bd_addr, BT_APP_CONN_PARAMS_FAST_MIN_INTERVAL,
+                                                   BT_APP_CONN_PARAMS_FAST_MAX_INTERVAL, 0,
+                                                   BT_APP_CONN_PARAMS_SUPERVISION_TIMEOUT))
+        {
+            p_conn->rejected++;
+        }
+        WICED_BT_TRACE("Fast connection parameters conn_id:%d \n", p_conn->conn_id);
+        return;
+    }
+
+    if (fast_interval && (p_conn->subrate != BT_APP_CONN_PARAMS_SUBRATE_UNSUPPORTED))
+    {
+        result = wiced_bt_ble_subrate_request(p_conn->bd_addr, BT_APP_CONN_PARAMS_IDLE_SUBRATE,
+                                              BT_APP_CONN_PARAMS_IDLE_SUBRATE,
+                                              BT_APP_CONN_PARAMS_IDLE_SUBRATE_LATENCY,
+                                              BT_APP_CONN_PARAMS_SUBRATE_CONTINUATION,
+                                              BT_APP_CONN_PARAMS_SUPERVISION_TIMEOUT);
+        WICED_BT_TRACE("Subrate idle conn_id:%d result:%d \n", p_conn->conn_id, result);
+        if ((result == WICED_BT_SUCCESS) || (result == WICED_BT_PENDING))
+            return;
+
+        /* the local controller has no subrating */
+        p_conn->subrate = BT_APP_CONN_PARAMS_SUBRATE_UNSUPPORTED;
+    }
+
+    if (!wiced_bt_l2cap_update_ble_conn_params(p_conn->bd_addr, BT_APP_CONN_PARAMS_IDLE_MIN_INTERVAL,
+                                               BT_APP_CONN_PARAMS_IDLE_MAX_INTERVAL,
+                                               BT_APP_CONN_PARAMS_IDLE_LATENCY,
+                                               BT_APP_CONN_PARAMS_SUPERVISION_TIMEOUT))
+    {
+        p_conn->rejected++;
+    }
+    WICED_BT_TRACE("Idle connection parameters conn_id:%d \n", p_conn->conn_id);
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_conn_params_timeout
+ * *****************************************************************************
+ * Summary :
+ *    Load check while a client is fast. A client with nothing queued or in
+ *    flight, past its hold time and without a ringing call goes idle.
+ *
+ * Parameters:
+ *    param:      Not used
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_conn_params_timeout(WICED_TIMER_PARAM_TYPE param)
+{
+    uint32_t now = bt_app_conn_params_now_ms();
+    wiced_bt_ans_tx_stats_t tx_stats;
+    bt_app_conn_params_conn_t *p_conn;
+    wiced_bool_t fast = WICED_FALSE;
+    uint8_t i;
+
+    if (bt_app_conn_params_cb.ringing && ((int32_t)(now - bt_app_conn_params_cb.ring_until_ms) >= 0))
+        bt_app_conn_params_cb.ringing = WICED_FALSE;
+
+    for (i = 0; i < CY_BT_SERVER_MAX_LINKS; i++)
+    {
+        p_conn = &bt_app_conn_params_cb.conn[i];
+        if ((p_conn->conn_id == 0) || (p_conn->mode != BT_APP_CONN_PARAMS_MODE_FAST))
+            continue;
+
+        if (bt_app_conn_params_cb.ringing || ((int32_t)(now - p_conn->hold_until_ms) < 0) ||
+            (wiced_bt_ans_get_tx_stats(p_conn->conn_id, &tx_stats) &&
+             ((tx_stats.queue_depth != 0) || (tx_stats.in_flight != 0))))
+        {
+            fast = WICED_TRUE;
+            continue;
+        }
+        bt_app_conn_params_request(p_conn, BT_APP_CONN_PARAMS_MODE_IDLE);
+    }
+
+    if (fast)
+        wiced_start_timer(&bt_app_conn_params_cb.timer, BT_APP_CONN_PARAMS_CHECK_MS);
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_conn_params_init
+ * *****************************************************************************
+ * Summary :
+ *    Initialize the connection parameter manager
+ *
+ * Parameters:
+ *    None
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+void bt_app_conn_params_init(void)
+{
+    memset(&bt_app_conn_params_cb, 0, sizeof(bt_app_conn_params_cb));
+    wiced_init_timer(&bt_app_conn_params_cb.timer, bt_app_conn_params_timeout, 0, WICED_MILLI_SECONDS_TIMER);
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_conn_params_connection_up
+ * *****************************************************************************
+ * Summary :
+ *    A client connected, it is fast while it discovers and configures the
+ *    service
+ *
+ * Parameters:
+ *    conn_id:    GATT connection ID
+ *    bd_addr:    address of the client
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+void bt_app_conn_params_connection_up(uint16_t conn_id, wiced_bt_device_address_t bd_addr)
+{
+    bt_app_conn_params_conn_t *p_conn = bt_app_conn_params_find(0, NULL);
+    uint32_t now = bt_app_conn_params_now_ms();
+
+    if (p_conn == NULL)
+        return;
+
+    memset(p_conn, 0, sizeof(*p_conn));
+    p_conn->conn_id = conn_id;
+    memcpy(p_conn->bd_addr, bd_addr, sizeof(wiced_bt_device_address_t));
+    p_conn->subrate_factor = 1;
+    p_conn->since_ms = now;
+    p_conn->hold_until_ms = now + BT_APP_CONN_PARAMS_CONNECT_HOLD_MS;
+
+    bt_app_conn_params_request(p_conn, BT_APP_CONN_PARAMS_MODE_FAST);
+    wiced_start_timer(&bt_app_conn_params_cb.timer, BT_APP_CONN_PARAMS_CHECK_MS);
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_conn_params_connection_down
+ * *****************************************************************************
+ * Summary :
+ *    A client disconnected
+ *
+ * Parameters:
+ *    conn_id:    GATT connection ID
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+void bt_app_conn_params_connection_down(uint16_t conn_id)
+{
+    bt_app_conn_params_conn_t *p_conn = bt_app_conn_params_find(conn_id, NULL);
+
+    if ((conn_id != 0) && (p_conn != NULL))
+        memset(p_conn, 0, sizeof(*p_conn));
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_conn_params_alert
+ * *****************************************************************************
+ * Summary :
+ *    Alerts are about to be sent to every client. Clients go fast and stay
+ *    fast while the alerts are queued, and while a call rings.
+ *
+ * Parameters:
+ *    category_id:    Alert category
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+void bt_app_conn_params_alert(uint8_t category_id)
+{
+    uint32_t now = bt_app_conn_params_now_ms();
+    bt_app_conn_params_conn_t *p_conn;
+    uint8_t i;
+
+    if (category_id == ANP_ALERT_CATEGORY_ID_CALL)
+    {
+        bt_app_conn_params_cb.ringing = WICED_TRUE;
+        bt_app_conn_params_cb.ring_until_ms = now + BT_APP_CONN_PARAMS_RING_MS;
+    }
+
+    for (i = 0; i < CY_BT_SERVER_MAX_LINKS; i++)
+    {
+        p_conn = &bt_app_conn_params_cb.conn[i];
+        if (p_conn->conn_id == 0)
+            continue;
+
+        p_conn->hold_until_ms = now + BT_APP_CONN_PARAMS_HOLD_MS;
+        if (p_conn->mode != BT_APP_CONN_PARAMS_MODE_FAST)
+            bt_app_conn_params_request(p_conn, BT_APP_CONN_PARAMS_MODE_FAST);
+    }
+
+    if (!wiced_is_timer_in_use(&bt_app_conn_params_cb.timer))
+        wiced_start_timer(&bt_app_conn_params_cb.timer, BT_APP_CONN_PARAMS_CHECK_MS);
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_conn_params_alert_cleared
+ * *****************************************************************************
+ * Summary :
+ *    Alerts of a category were cleared, a cleared call stops ringing
+ *
+ * Parameters:
+ *    category_id:    Alert category
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+void bt_app_conn_params_alert_cleared(uint8_t category_id)
+{
+    if (category_id == ANP_ALERT_CATEGORY_ID_CALL)
+        bt_app_conn_params_cb.ringing = WICED_FALSE;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_conn_params_update_evt
+ * *****************************************************************************
+ * Summary :
+ *    Handle BTM_BLE_CONNECTION_PARAM_UPDATE
+ *
+ * Parameters:
+ *    p_update:   Connection parameter update event
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+void bt_app_conn_params_update_evt(wiced_bt_ble_connection_param_update_t *p_update)
+{
+    bt_app_conn_params_conn_t *p_conn = bt_app_conn_params_find(0, p_update->bd_addr);
+
+    if (p_conn == NULL)
+        return;
+
+    if (p_update->status != WICED_BT_SUCCESS)
+    {
+        p_conn->rejected++;
+        return;
+    }
+
+    bt_app_conn_params_account(p_conn, bt_app_conn_params_now_ms());
+    p_conn->conn_interval = p_update->conn_interval;
+    p_conn->conn_latency = p_update->conn_latency;
+    p_conn->updates++;
+
+    /* now on the fast interval, an idle client can be subrated */
+    if ((p_conn->mode == BT_APP_CONN_PARAMS_MODE_IDLE) &&
+        (p_conn->conn_interval <= BT_APP_CONN_PARAMS_FAST_MAX_INTERVAL) && (p_conn->subrate_factor <= 1) &&
+        (p_conn->subrate != BT_APP_CONN_PARAMS_SUBRATE_UNSUPPORTED))
+    {
+        bt_app_conn_params_request(p_conn, BT_APP_CONN_PARAMS_MODE_IDLE);
+    }
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_conn_params_subrate_evt
+ * *****************************************************************************
+ * Summary :
+ *    Handle BTM_BLE_SUBRATE_CHANGE_EVENT. A client that cannot be subrated
+ *    idles on the long interval instead.
+ *
+ * Parameters:
+ *    p_subrate:  Subrate change event
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+void bt_app_conn_params_subrate_evt(wiced_bt_ble_subrate_change_event_t *p_subrate)
+{
+    bt_app_conn_params_conn_t *p_conn = bt_app_conn_params_find(0, p_subrate->bd_address);
+
+    if (p_conn == NULL)
+        return;
+
+    if (p_subrate->status != WICED_BT_SUCCESS)
+    {
+        p_conn->rejected++;
+        p_conn->subrate = BT_APP_CONN_PARAMS_SUBRATE_UNSUPPORTED;
+        if (p_conn->mode == BT_APP_CONN_PARAMS_MODE_IDLE)
+            bt_app_conn_params_request(p_conn, BT_APP_CONN_PARAMS_MODE_IDLE);
+        return;
+    }
+
+    bt_app_conn_params_account(p_conn, bt_app_conn_params_now_ms());
+    p_conn->subrate = BT_APP_CONN_PARAMS_SUBRATE_SUPPORTED;
+    p_conn->subrate_factor = (p_subrate->subrate_factor != 0) ? p_subrate->subrate_factor : 1;
+    p_conn->subrate_latency = p_subrate->peripheral_latency;
+    p_conn->updates++;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_conn_params_print_stats
+ * *****************************************************************************
+ * Summary :
+ *    Print the parameters in use by a client and the latency and power
+ *    tradeoff achieved since it connected
+ *
+ * Parameters:
+ *    conn_id:    GATT connection ID
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+void bt_app_conn_params_print_stats(uint16_t conn_id)
+{
+    bt_app_conn_params_conn_t *p_conn = bt_app_conn_params_find(conn_id, NULL);
+    uint32_t alert_latency_us;
+    uint32_t total_ms;
+    uint32_t wakeups;
+
+    if ((conn_id == 0) || (p_conn == NULL))
+        return;
+
+    bt_app_conn_params_account(p_conn, bt_app_conn_params_now_ms());
+    alert_latency_us = (uint32_t)p_conn->conn_interval * 1250 * p_conn->subrate_factor;
+    total_ms = p_conn->fast_ms + p_conn->idle_ms;
+    wakeups = (total_ms != 0) ? (uint32_t)(p_conn->wakeups_milli * 100 / total_ms) : 0;
+
+    fprintf(stdout, "    %s interval %u.%02u ms latency %d subrate %d, alert latency up to %u ms\n",
+            (p_conn->mode == BT_APP_CONN_PARAMS_MODE_FAST) ? "fast" : "idle",
+            (unsigned)(p_conn->conn_interval * 125 / 100), (unsigned)(p_conn->conn_interval * 125 % 100),
+            p_conn->conn_latency, p_conn->subrate_factor, (unsigned)(alert_latency_us / 1000));
+    fprintf(stdout, "    fast %u s idle %u s, %u.%02u wake ups/s, %u updates %u rejected\n",
+            (unsigned)(p_conn->fast_ms / 1000), (unsigned)(p_conn->idle_ms / 1000), (unsigned)(wakeups / 100),
+            (unsigned)(wakeups % 100), (unsigned)p_conn->updates, (unsigned)p_conn->rejected);
+}
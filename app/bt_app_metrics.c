@@ -0,0 +1,416 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+/******************************************************************************
+ * File Name: bt_app_metrics.c
+ *
+ * Description:
+ * Metrics of the LE Alert Notification Server in the Prometheus text format.
+ * Every thread updating a metric gets its own cache line aligned slot and is
+ * the only writer of it, so an update is a plain add on a line no other
+ * thread writes. A scrape on the local Unix socket sums the slots with
+ * relaxed loads in its own thread and never takes a lock the BT stack thread
+ * could be waiting for.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include "wiced_bt_trace.h"
+#include "COMPONENT_ans/wiced_bt_anp.h"
+#include "bt_app_metrics.h"
+
+/*******************************************************************************
+ *                                   MACROS
+ *******************************************************************************/
+#define BT_APP_METRICS_SOCKET "ans_metrics.sock" /* Used when no path is given */
+#define BT_APP_METRICS_SLOTS ( 8U ) /* Threads beyond BT_APP_METRICS_SLOTS - 1 share the last slot */
+#define BT_APP_METRICS_LABELS_MAX ANP_NOTIFY_CATEGORY_COUNT
+#define BT_APP_METRICS_CACHE_LINE ( 64U )
+#define BT_APP_METRICS_BODY_MAX ( 8192U )
+#define BT_APP_METRICS_REQUEST_MAX ( 1024U )
+#define BT_APP_METRICS_REQUEST_TIMEOUT_US ( 100000 ) /* A scraper that sends no request still gets the metrics */
+
+/*******************************************************************************
+ *                    STRUCTURES AND ENUMERATIONS
+ *******************************************************************************/
+typedef struct
+{
+    const char *p_name;
+    const char *p_help;
+    const char *p_type;          /* "counter" or "gauge" */
+    const char *p_label;         /* Label name, NULL for a single value */
+    const char *const *p_values; /* Label values */
+    uint8_t num_values;
+} bt_app_metric_desc_t;
+
+typedef struct
+{
+    int64_t value[BT_APP_METRIC_COUNT][BT_APP_METRICS_LABELS_MAX];
+} __attribute__((aligned(BT_APP_METRICS_CACHE_LINE))) bt_app_metrics_slot_t;
+
+typedef struct
+{
+    bt_app_metrics_slot_t slot[BT_APP_METRICS_SLOTS];
+    uint32_t num_slots; /* Slots claimed, may run past BT_APP_METRICS_SLOTS */
+    int listen_fd;
+    char body[BT_APP_METRICS_BODY_MAX]; /* Used by the metrics thread only */
+} bt_app_metrics_cb_t;
+
+/*******************************************************************************
+ *                           GLOBAL VARIABLES
+ *******************************************************************************/
+static const char *const bt_app_metrics_category[ANP_NOTIFY_CATEGORY_COUNT] =
+    {"simple_alert", "email", "news", "call", "missed_call", "sms_mms", "voice_mail", "schedule",
+     "high_priority", "instant_message"};
+
+static const char *const bt_app_metrics_key_store[] = {"hit", "miss"};
+
+static const bt_app_metric_desc_t bt_app_metrics_desc[BT_APP_METRIC_COUNT] =
+    {
+        {"ans_alerts_total", "Alerts generated", "counter", "category", bt_app_metrics_category,
+         ANP_NOTIFY_CATEGORY_COUNT},
+        {"ans_send_failures_total", "Alerts the ANS library failed to send", "counter", "category",
+         bt_app_metrics_category, ANP_NOTIFY_CATEGORY_COUNT},
+        {"ans_new_alert_not_sent", "Connected clients with a new alert not sent yet", "gauge", "category",
+         bt_app_metrics_category, ANP_NOTIFY_CATEGORY_COUNT},
+        {"ans_connections", "Connected clients", "gauge", NULL, NULL, 1},
+        {"ans_key_store_requests_total", "Link key requests of the stack", "counter", "result",
+         bt_app_metrics_key_store, 2},
+        {"ans_heap_used_bytes", "Bytes in use in the default heap", "gauge", NULL, NULL, 1},
+        {"ans_heap_max_used_bytes", "Most bytes ever in use in the default heap", "gauge", NULL, NULL, 1},
+};
+
+static bt_app_metrics_cb_t bt_app_metrics_cb = {.listen_fd = -1};
+
+static __thread bt_app_metrics_slot_t *p_bt_app_metrics_slot;
+
+/*******************************************************************************
+ *                           FUNCTION DECLARATIONS
+ *******************************************************************************/
+static bt_app_metrics_slot_t *bt_app_metrics_thread_slot(void);
+static int64_t bt_app_metrics_sum(bt_app_metric_t metric, uint8_t label);
+static uint32_t bt_app_metrics_format(char *p_buf, uint32_t size);
+static void bt_app_metrics_serve(int fd);
+static void *bt_app_metrics_thread(void *p_arg);
+
+/*******************************************************************************
+ *                       FUNCTION DEFINITIONS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * Function Name : bt_app_metrics_thread_slot
+ * *****************************************************************************
+ * Summary :
+ *    Slot of the calling thread, claimed on its first update
+ *
+ * Parameters:
+ *    None
+ *
+ * Return:
+ *    bt_app_metrics_slot_t *:   Slot of the thread
+ ******************************************************************************/
+static bt_app_metrics_slot_t *bt_app_metrics_thread_slot(void)
+{
+    uint32_t idx;
+
+    if (p_bt_app_metrics_slot == NULL)
+    {
+        idx = __atomic_fetch_add(&bt_app_metrics_cb.num_slots, 1, __ATOMIC_RELAXED);
+        if (idx >= BT_APP_METRICS_SLOTS - 1)
+            idx = BT_APP_METRICS_SLOTS - 1;
+        p_bt_app_metrics_slot = &bt_app_metrics_cb.slot[idx];
+    }
+    return p_bt_app_metrics_slot;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_metrics_add
+ * *****************************************************************************
+ * Summary :
+ *    Add to a counter or a gauge
+ *
+ * Parameters:
+ *    metric:     Metric
+ *    label:      Index of the label value, 0 for a metric without label
+ *    value:      Value to add
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+void bt_app_metrics_add(bt_app_metric_t metric, uint8_t label, int64_t value)
+{
+    bt_app_metrics_slot_t *p_slot;
+    int64_t *p_value;
+
+    if ((metric >= BT_APP_METRIC_COUNT) || (label >= bt_app_metrics_desc[metric].num_values))
+        return;
+
+    p_slot = bt_app_metrics_thread_slot();
+    p_value = &p_slot->value[metric][label];
+
+    /* the shared slot has several writers */
+    if (p_slot == &bt_app_metrics_cb.slot[BT_APP_METRICS_SLOTS - 1])
+        __atomic_fetch_add(p_value, value, __ATOMIC_RELAXED);
+    else
+        __atomic_store_n(p_value, __atomic_load_n(p_value, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_metrics_set
+ * *****************************************************************************
+ * Summary :
+ *    Set a gauge. The difference to the current value goes to the slot of the
+ *    calling thread, a gauge is set by one thread at a time.
+ *
+ * Parameters:
+ *    metric:     Metric
+ *    label:      Index of the label value, 0 for a metric without label
+ *    value:      New value
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+void bt_app_metrics_set(bt_app_metric_t metric, uint8_t label, int64_t value)
+{
+    if ((metric >= BT_APP_METRIC_COUNT) || (label >= bt_app_metrics_desc[metric].num_values))
+        return;
+
+    bt_app_metrics_add(metric, label, value - bt_app_metrics_sum(metric, label));
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_metrics_sum
+ * *****************************************************************************
+ * Summary :
+ *    Value of a metric, the sum of all slots
+ *
+ * Parameters:
+ *    metric:     Metric
+ *    label:      Index of the label value
+ *
+ * Return:
+ *    int64_t:    Value
+ ******************************************************************************/
+static int64_t bt_app_metrics_sum(bt_app_metric_t metric, uint8_t label)
+{
+    int64_t sum = 0;
+    uint8_t i;
+
+    for (i = 0; i < BT_APP_METRICS_SLOTS; i++)
+        sum += __atomic_load_n(&bt_app_metrics_cb.slot[i].value[metric][label], __ATOMIC_RELAXED);
+
+    return sum;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_metrics_format
+ * *****************************************************************************
+ * Summary :
+ *    Write all metrics in the Prometheus text exposition format
+ *
+ * Parameters:
+ *    p_buf:      Output buffer
+ *    size:       Size of the buffer
+ *
+ * Return:
+ *    uint32_t:   Bytes written, a metric that does not fit is left out
+ ******************************************************************************/
+static uint32_t bt_app_metrics_format(char *p_buf, uint32_t size)
+{
+    const bt_app_metric_desc_t *p_desc;
+    uint32_t len = 0;
+    uint32_t start;
+    int n;
+    uint8_t metric;
+    uint8_t label;
+
+    for (metric = 0; metric < BT_APP_METRIC_COUNT; metric++)
+    {
+        p_desc = &bt_app_metrics_desc[metric];
+        start = len;
+        n = snprintf(&p_buf[len], size - len, "# HELP %s %s\n# TYPE %s %s\n", p_desc->p_name, p_desc->p_help,
+                     p_desc->p_name, p_desc->p_type);
+        for (label = 0; (n > 0) && ((uint32_t)n < size - len) && (label < p_desc->num_values); label++)
+        {
+            len += (uint32_t)n;
+            if (p_desc->p_label != NULL)
+                n = snprintf(&p_buf[len], size - len, "%s{%s=\"%s\"} %lld\n", p_desc->p_name, p_desc->p_label,
+                             p_desc->p_values[label], (long long)bt_app_metrics_sum(metric, label));
+            else
+                n = snprintf(&p_buf[len], size - len, "%s %lld\n", p_desc->p_name,
+                             (long long)bt_app_metrics_sum(metric, label));
+        }
+        if ((n <= 0) || ((uint32_t)n >= size - len))
+        {
+            len = start;
+            break;
+        }
+        len += (uint32_t)n;
+    }
+    return len;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_metrics_serve
+ * *****************************************************************************
+ * Summary :
+ *    Answer one scrape with an HTTP/1.0 response carrying the metrics. The
+ *    request itself is not looked at.
+ *
+ * Parameters:
+ *    fd:         Accepted connection
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_metrics_serve(int fd)
+{
+    struct timeval timeout = {0, BT_APP_METRICS_REQUEST_TIMEOUT_US};
+    char request[BT_APP_METRICS_REQUEST_MAX];
+    char header[128];
+    uint32_t body_len;
+    int header_len;
+
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    (void)recv(fd, request, sizeof(request), 0);
+
+    body_len = bt_app_metrics_format(bt_app_metrics_cb.body, sizeof(bt_app_metrics_cb.body));
+    header_len = snprintf(header, sizeof(header),
+                          "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                          "Content-Length: %u\r\n\r\n", (unsigned)body_len);
+
+    if (send(fd, header, (size_t)header_len, MSG_NOSIGNAL) == header_len)
+        (void)send(fd, bt_app_metrics_cb.body, body_len, MSG_NOSIGNAL);
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_metrics_thread
+ * *****************************************************************************
+ * Summary :
+ *    Serve scrapes one after the other
+ *
+ * Parameters:
+ *    p_arg:      Not used
+ *
+ * Return:
+ *    void *:     NULL
+ ******************************************************************************/
+static void *bt_app_metrics_thread(void *p_arg)
+{
+    int fd;
+
+    (void)p_arg;
+
+    for (;;)
+    {
+        fd = accept(bt_app_metrics_cb.listen_fd, NULL, NULL);
+        if (fd < 0)
+        {
+            if ((errno == EINTR) || (errno == ECONNABORTED))
+                continue;
+            WICED_BT_TRACE("Metrics accept error %d \n", errno);
+            break;
+        }
+        bt_app_metrics_serve(fd);
+        close(fd);
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_metrics_start
+ * *****************************************************************************
+ * Summary :
+ *    Listen for scrapes on a Unix socket only the user running the
+ *    application can connect to
+ *
+ * Parameters:
+ *    p_path:     Socket path, BT_APP_METRICS_SOCKET when NULL
+ *
+ * Return:
+ *    wiced_bool_t:   WICED_TRUE when the socket is listening
+ ******************************************************************************/
+wiced_bool_t bt_app_metrics_start(const char *p_path)
+{
+    struct sockaddr_un addr;
+    pthread_t thread;
+    int fd;
+
+    if (bt_app_metrics_cb.listen_fd >= 0)
+        return WICED_TRUE;
+
+    if (p_path == NULL)
+        p_path = BT_APP_METRICS_SOCKET;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(p_path) >= sizeof(addr.sun_path))
+        return WICED_FALSE;
+    strcpy(addr.sun_path, p_path);
+
+    if ((fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0)
+        return WICED_FALSE;
+
+    /* a socket left behind by the previous run */
+    unlink(p_path);
+    if ((bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) || (chmod(p_path, S_IRUSR | S_IWUSR) != 0) ||
+        (listen(fd, 4) != 0))
+    {
+        close(fd);
+        return WICED_FALSE;
+    }
+
+    bt_app_metrics_cb.listen_fd = fd;
+    if (pthread_create(&thread, NULL, bt_app_metrics_thread, NULL) != 0)
+    {
+        bt_app_metrics_cb.listen_fd = -1;
+        close(fd);
+        unlink(p_path);
+        return WICED_FALSE;
+    }
+    pthread_detach(thread);
+
+    WICED_BT_TRACE("Metrics on %s \n", p_path);
+    return WICED_TRUE;
+}
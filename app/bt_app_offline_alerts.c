@@ -0,0 +1,441 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+/******************************************************************************
+ * File Name: bt_app_offline_alerts.c
+ *
+ * Description:
+ * Offline alert buffer of the LE Alert Notification Server. Alerts raised
+ * while no client is connected are kept, up to CY_BT_OFFLINE_ALERTS_MAX one by
+ * one and beyond that as per category counts, and handed to the next client
+ * that connects. A category with a time to live drops its alerts once they are
+ * older, a call nobody answered in time is not worth reporting as ringing.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include <string.h>
+#include <time.h>
+#include "wiced_bt_dev.h"
+#include "wiced_bt_trace.h"
+#include "COMPONENT_ans/wiced_bt_anp.h"
+#include "COMPONENT_ans/wiced_bt_ans.h"
+#include "app_bt_config/ans_gap.h"
+#include "bt_app_offline_alerts.h"
+
+/*******************************************************************************
+ *                                   MACROS
+ *******************************************************************************/
+/* Alert counts are a single octet on the air, more alerts of a category add nothing */
+#define BT_APP_OFFLINE_ALERTS_COUNT_MAX ( 0xFFU )
+
+#if (CY_BT_OFFLINE_ALERTS_MAX == 0) || (CY_BT_OFFLINE_ALERTS_MAX > 0xFF)
+#error "CY_BT_OFFLINE_ALERTS_MAX out of range"
+#endif
+
+/*******************************************************************************
+ *                    STRUCTURES AND ENUMERATIONS
+ *******************************************************************************/
+typedef struct
+{
+    uint32_t time_ms; /* Time the alert was raised */
+    uint8_t category_id;
+} bt_app_offline_alert_t;
+
+typedef struct
+{
+    bt_app_offline_alert_t alert[CY_BT_OFFLINE_ALERTS_MAX]; /* Oldest first */
+    uint8_t num_alerts;
+    uint16_t folded[ANP_NOTIFY_CATEGORY_COUNT]; /* Alerts folded into a count when the buffer was full */
+    uint32_t folded_time_ms[ANP_NOTIFY_CATEGORY_COUNT]; /* Time the latest folded alert was raised */
+    uint32_t ttl_ms[ANP_NOTIFY_CATEGORY_COUNT]; /* Time to live per category, 0 keeps the alerts */
+    wiced_bool_t text_valid[ANP_NOTIFY_CATEGORY_COUNT]; /* The latest alert of the category came with a text */
+    uint8_t text_len[ANP_NOTIFY_CATEGORY_COUNT];
+    char text[ANP_NOTIFY_CATEGORY_COUNT][WICED_BT_ANS_MAX_TEXT_LEN];
+    uint8_t max_occupancy;
+    uint32_t buffered;
+    uint32_t folded_total;
+    uint32_t expired;
+    uint32_t delivered;
+} bt_app_offline_alerts_cb_t;
+
+/*******************************************************************************
+ *                           GLOBAL VARIABLES
+ *******************************************************************************/
+static bt_app_offline_alerts_cb_t bt_app_offline_alerts_cb;
+
+/*******************************************************************************
+ *                           FUNCTION DECLARATIONS
+ *******************************************************************************/
+static uint32_t bt_app_offline_alerts_now_ms(void);
+static uint16_t bt_app_offline_alerts_pending(uint8_t category_id);
+static void bt_app_offline_alerts_remove(uint8_t index);
+static void bt_app_offline_alerts_expire(uint32_t now);
+
+/*******************************************************************************
+ *                       FUNCTION DEFINITIONS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * Function Name : bt_app_offline_alerts_now_ms
+ * *****************************************************************************
+ * Summary :
+ *    Monotonic time in ms, compare with differences
+ *
+ * Parameters:
+ *    None
+ *
+ * Return:
+ *    uint32_t:   Time in ms
+ ******************************************************************************/
+static uint32_t bt_app_offline_alerts_now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000);
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_offline_alerts_pending
+ * *****************************************************************************
+ * Summary :
+ *    Number of alerts of a category waiting for a client
+ *
+ * Parameters:
+ *    category_id:    alert category
+ *
+ * Return:
+ *    uint16_t:   buffered and folded alerts of the category
+ ******************************************************************************/
+static uint16_t bt_app_offline_alerts_pending(uint8_t category_id)
+{
+    uint32_t count = bt_app_offline_alerts_cb.folded[category_id];
+    uint8_t i;
+
+    for (i = 0; i < bt_app_offline_alerts_cb.num_alerts; i++)
+    {
+        if (bt_app_offline_alerts_cb.alert[i].category_id == category_id)
+            count++;
+    }
+    return (count > 0xFFFF) ? 0xFFFF : (uint16_t)count;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_offline_alerts_remove
+ * *****************************************************************************
+ * Summary :
+ *    Remove a buffered alert, the later ones move up and stay in order
+ *
+ * Parameters:
+ *    index:  index of the alert
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_offline_alerts_remove(uint8_t index)
+{
+    bt_app_offline_alerts_cb.num_alerts--;
+    memmove(&bt_app_offline_alerts_cb.alert[index], &bt_app_offline_alerts_cb.alert[index + 1],
+            (bt_app_offline_alerts_cb.num_alerts - index) * sizeof(bt_app_offline_alert_t));
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_offline_alerts_expire
+ * *****************************************************************************
+ * Summary :
+ *    Drop the alerts that outlived the time to live of their category. Folded
+ *    alerts go together, once the latest of them is too old.
+ *
+ * Parameters:
+ *    now:    current time in ms
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void bt_app_offline_alerts_expire(uint32_t now)
+{
+    bt_app_offline_alert_t *p_alert;
+    uint32_t ttl;
+    uint8_t cat;
+    uint8_t i = 0;
+
+    while (i < bt_app_offline_alerts_cb.num_alerts)
+    {
+        p_alert = &bt_app_offline_alerts_cb.alert[i];
+        ttl = bt_app_offline_alerts_cb.ttl_ms[p_alert->category_id];
+        if ((ttl != 0) && ((now - p_alert->time_ms) >= ttl))
+        {
+            bt_app_offline_alerts_remove(i);
+            bt_app_offline_alerts_cb.expired++;
+            continue;
+        }
+        i++;
+    }
+
+    for (cat = 0; cat < ANP_NOTIFY_CATEGORY_COUNT; cat++)
+    {
+        ttl = bt_app_offline_alerts_cb.ttl_ms[cat];
+        if ((bt_app_offline_alerts_cb.folded[cat] != 0) && (ttl != 0) &&
+            ((now - bt_app_offline_alerts_cb.folded_time_ms[cat]) >= ttl))
+        {
+            bt_app_offline_alerts_cb.expired += bt_app_offline_alerts_cb.folded[cat];
+            bt_app_offline_alerts_cb.folded[cat] = 0;
+        }
+
+        /* the text goes with the last alert of the category */
+        if (bt_app_offline_alerts_pending(cat) == 0)
+            bt_app_offline_alerts_cb.text_valid[cat] = WICED_FALSE;
+    }
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_offline_alerts_init
+ * *****************************************************************************
+ * Summary :
+ *    Start with an empty buffer, no category expires
+ *
+ * Parameters:
+ *    None
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+void bt_app_offline_alerts_init(void)
+{
+    memset(&bt_app_offline_alerts_cb, 0, sizeof(bt_app_offline_alerts_cb));
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_offline_alerts_set_ttl
+ * *****************************************************************************
+ * Summary :
+ *    Set how long the alerts of a category are kept while no client is
+ *    connected
+ *
+ * Parameters:
+ *    category_id:    alert category
+ *    ttl_ms:         time to live in ms, 0 keeps the alerts until delivered
+ *
+ * Return:
+ *    wiced_bool_t:   WICED_FALSE on an invalid category
+ ******************************************************************************/
+wiced_bool_t bt_app_offline_alerts_set_ttl(uint8_t category_id, uint32_t ttl_ms)
+{
+    if (category_id >= ANP_NOTIFY_CATEGORY_COUNT)
+        return WICED_FALSE;
+
+    bt_app_offline_alerts_cb.ttl_ms[category_id] = ttl_ms;
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_offline_alerts_add
+ * *****************************************************************************
+ * Summary :
+ *    Keep an alert raised while no client is connected. When the buffer is
+ *    full the oldest alert is folded into the count of its category.
+ *
+ * Parameters:
+ *    category_id:    alert category
+ *    p_text:         UTF-8 sender name or title, NULL for the sample text
+ *    text_len:       length of the text
+ *
+ * Return:
+ *    wiced_bool_t:   WICED_FALSE on an invalid category
+ ******************************************************************************/
+wiced_bool_t bt_app_offline_alerts_add(uint8_t category_id, const char *p_text, uint16_t text_len)
+{
+    bt_app_offline_alert_t *p_oldest;
+    uint32_t now = bt_app_offline_alerts_now_ms();
+
+    if (category_id >= ANP_NOTIFY_CATEGORY_COUNT)
+        return WICED_FALSE;
+
+    bt_app_offline_alerts_expire(now);
+
+    if (bt_app_offline_alerts_cb.num_alerts == CY_BT_OFFLINE_ALERTS_MAX)
+    {
+        p_oldest = &bt_app_offline_alerts_cb.alert[0];
+        if (bt_app_offline_alerts_cb.folded[p_oldest->category_id] != 0xFFFF)
+            bt_app_offline_alerts_cb.folded[p_oldest->category_id]++;
+        if ((bt_app_offline_alerts_cb.folded[p_oldest->category_id] == 1) ||
+            ((int32_t)(p_oldest->time_ms - bt_app_offline_alerts_cb.folded_time_ms[p_oldest->category_id]) > 0))
+        {
+            bt_app_offline_alerts_cb.folded_time_ms[p_oldest->category_id] = p_oldest->time_ms;
+        }
+        bt_app_offline_alerts_remove(0);
+        bt_app_offline_alerts_cb.folded_total++;
+    }
+
+    bt_app_offline_alerts_cb.alert[bt_app_offline_alerts_cb.num_alerts].time_ms = now;
+    bt_app_offline_alerts_cb.alert[bt_app_offline_alerts_cb.num_alerts].category_id = category_id;
+    bt_app_offline_alerts_cb.num_alerts++;
+    bt_app_offline_alerts_cb.buffered++;
+    if (bt_app_offline_alerts_cb.num_alerts > bt_app_offline_alerts_cb.max_occupancy)
+        bt_app_offline_alerts_cb.max_occupancy = bt_app_offline_alerts_cb.num_alerts;
+
+    /* a client is sent the text of the latest alert only, keep that one */
+    bt_app_offline_alerts_cb.text_valid[category_id] = (p_text != NULL);
+    if (p_text != NULL)
+    {
+        if (text_len > WICED_BT_ANS_MAX_TEXT_LEN)
+        {
+            /* do not cut a UTF-8 character */
+            text_len = WICED_BT_ANS_MAX_TEXT_LEN;
+            while ((text_len != 0) && ((p_text[text_len] & 0xC0) == 0x80))
+                text_len--;
+        }
+        memcpy(bt_app_offline_alerts_cb.text[category_id], p_text, text_len);
+        bt_app_offline_alerts_cb.text_len[category_id] = (uint8_t)text_len;
+    }
+
+    WICED_BT_TRACE("Alert category %d buffered until a client connects (%d of %d)\n", category_id,
+                   bt_app_offline_alerts_cb.num_alerts, CY_BT_OFFLINE_ALERTS_MAX);
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_offline_alerts_clear
+ * *****************************************************************************
+ * Summary :
+ *    Drop the buffered alerts of a category the user cleared
+ *
+ * Parameters:
+ *    category_id:    alert category
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+void bt_app_offline_alerts_clear(uint8_t category_id)
+{
+    uint8_t i = 0;
+
+    if (category_id >= ANP_NOTIFY_CATEGORY_COUNT)
+        return;
+
+    while (i < bt_app_offline_alerts_cb.num_alerts)
+    {
+        if (bt_app_offline_alerts_cb.alert[i].category_id == category_id)
+            bt_app_offline_alerts_remove(i);
+        else
+            i++;
+    }
+    bt_app_offline_alerts_cb.folded[category_id] = 0;
+    bt_app_offline_alerts_cb.text_valid[category_id] = WICED_FALSE;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_offline_alerts_deliver
+ * *****************************************************************************
+ * Summary :
+ *    Hand the alerts that are still alive to a client that connected. Each
+ *    category goes to the ANS library as one count, so the client gets one
+ *    New Alert and one Unread Alert Status per category. A category the
+ *    library did not accept stays buffered for the next client.
+ *
+ * Parameters:
+ *    conn_id:    GATT connection ID of the client
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+void bt_app_offline_alerts_deliver(uint16_t conn_id)
+{
+    wiced_bt_gatt_status_t status;
+    uint16_t pending;
+    uint8_t count;
+    uint8_t cat;
+
+    bt_app_offline_alerts_expire(bt_app_offline_alerts_now_ms());
+
+    for (cat = 0; cat < ANP_NOTIFY_CATEGORY_COUNT; cat++)
+    {
+        if ((pending = bt_app_offline_alerts_pending(cat)) == 0)
+            continue;
+
+        /* the count is a single octet on the air */
+        count = (pending > BT_APP_OFFLINE_ALERTS_COUNT_MAX) ? BT_APP_OFFLINE_ALERTS_COUNT_MAX : (uint8_t)pending;
+
+        if (bt_app_offline_alerts_cb.text_valid[cat])
+        {
+            status = wiced_bt_ans_process_and_send_alerts(conn_id, cat, count, bt_app_offline_alerts_cb.text[cat],
+                                                          bt_app_offline_alerts_cb.text_len[cat]);
+        }
+        else
+        {
+            status = wiced_bt_ans_process_and_send_alerts(conn_id, cat, count, NULL, 0);
+        }
+        if (status != WICED_BT_GATT_SUCCESS)
+        {
+            WICED_BT_TRACE("Offline alert category %d kept, not accepted status:%d\n", cat, status);
+            continue;
+        }
+
+        bt_app_offline_alerts_cb.delivered += pending;
+        bt_app_offline_alerts_clear(cat);
+        WICED_BT_TRACE("conn_id:%d %d offline alerts of category %d\n", conn_id, pending, cat);
+    }
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_offline_alerts_get_stats
+ * *****************************************************************************
+ * Summary :
+ *    Get the occupancy and counters of the buffer
+ *
+ * Parameters:
+ *    p_stats:    filled with the statistics
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+void bt_app_offline_alerts_get_stats(bt_app_offline_alerts_stats_t *p_stats)
+{
+    uint8_t cat;
+
+    bt_app_offline_alerts_expire(bt_app_offline_alerts_now_ms());
+
+    memset(p_stats, 0, sizeof(*p_stats));
+    p_stats->occupancy = bt_app_offline_alerts_cb.num_alerts;
+    p_stats->capacity = CY_BT_OFFLINE_ALERTS_MAX;
+    p_stats->max_occupancy = bt_app_offline_alerts_cb.max_occupancy;
+    for (cat = 0; cat < ANP_NOTIFY_CATEGORY_COUNT; cat++)
+        p_stats->pending[cat] = bt_app_offline_alerts_pending(cat);
+    p_stats->buffered = bt_app_offline_alerts_cb.buffered;
+    p_stats->folded = bt_app_offline_alerts_cb.folded_total;
+    p_stats->expired = bt_app_offline_alerts_cb.expired;
+    p_stats->delivered = bt_app_offline_alerts_cb.delivered;
+}
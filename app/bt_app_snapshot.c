@@ -0,0 +1,271 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+/******************************************************************************
+ * File Name: bt_app_snapshot.c
+ *
+ * Description:
+ * Snapshot of the ANS server state in a memory mapped file. The file holds two
+ * slots, each with a sequence number and a CRC-32. A new snapshot is written
+ * to the slot not in use and only then becomes the current one, so a crash
+ * while writing leaves the previous snapshot intact. Nothing is written while
+ * the state does not change.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include <string.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "wiced_bt_dev.h"
+#include "wiced_bt_trace.h"
+#include "bt_app_snapshot.h"
+
+/*******************************************************************************
+ *                                   MACROS
+ *******************************************************************************/
+/* Kept in the current directory, next to the NVRAM files */
+#define BT_APP_SNAPSHOT_FILE "ans_snapshot.bin"
+
+/* "ANS" and the format version, a snapshot of another format is ignored */
+#define BT_APP_SNAPSHOT_MAGIC ( 0x414E5301U )
+
+#define BT_APP_SNAPSHOT_NUM_SLOTS ( 2U )
+#define BT_APP_SNAPSHOT_SLOT_NONE ( 0xFFU )
+
+/*******************************************************************************
+ *                    STRUCTURES AND ENUMERATIONS
+ *******************************************************************************/
+typedef struct
+{
+    uint32_t crc; /* CRC-32 of the rest of the slot */
+    uint32_t magic;
+    uint32_t sequence; /* The valid slot with the later sequence is the current snapshot */
+    uint32_t length; /* Size of the data */
+    bt_app_snapshot_t data;
+} bt_app_snapshot_slot_t;
+
+typedef struct
+{
+    bt_app_snapshot_slot_t slot[BT_APP_SNAPSHOT_NUM_SLOTS];
+} bt_app_snapshot_file_t;
+
+typedef struct
+{
+    bt_app_snapshot_file_t *p_file; /* Mapped file, NULL if it could not be mapped */
+    uint8_t active; /* Slot of the current snapshot, BT_APP_SNAPSHOT_SLOT_NONE before the first one */
+} bt_app_snapshot_cb_t;
+
+/*******************************************************************************
+ *                           GLOBAL VARIABLES
+ *******************************************************************************/
+static bt_app_snapshot_cb_t bt_app_snapshot_cb = {NULL, BT_APP_SNAPSHOT_SLOT_NONE};
+
+/* CRC-32 (IEEE 802.3, reflected) of every nibble value */
+static const uint32_t bt_app_snapshot_crc_tbl[16] =
+{
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+/*******************************************************************************
+ *                           FUNCTION DECLARATIONS
+ *******************************************************************************/
+static uint32_t bt_app_snapshot_crc(const uint8_t *p_data, uint32_t len);
+static wiced_bool_t bt_app_snapshot_slot_valid(const bt_app_snapshot_slot_t *p_slot);
+
+/*******************************************************************************
+ *                       FUNCTION DEFINITIONS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * Function Name : bt_app_snapshot_crc
+ * *****************************************************************************
+ * Summary :
+ *    CRC-32 of a buffer, one nibble at a time
+ *
+ * Parameters:
+ *    p_data:     data
+ *    len:        length of the data
+ *
+ * Return:
+ *    uint32_t:   CRC-32
+ ******************************************************************************/
+static uint32_t bt_app_snapshot_crc(const uint8_t *p_data, uint32_t len)
+{
+    uint32_t crc = 0xFFFFFFFF;
+
+    while (len--)
+    {
+        crc ^= *p_data++;
+        crc = (crc >> 4) ^ bt_app_snapshot_crc_tbl[crc & 0x0F];
+        crc = (crc >> 4) ^ bt_app_snapshot_crc_tbl[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_snapshot_slot_valid
+ * *****************************************************************************
+ * Summary :
+ *    Check that a slot holds a complete snapshot of the current format
+ *
+ * Parameters:
+ *    p_slot:     slot of the mapped file
+ *
+ * Return:
+ *    wiced_bool_t:   WICED_TRUE if the snapshot can be restored
+ ******************************************************************************/
+static wiced_bool_t bt_app_snapshot_slot_valid(const bt_app_snapshot_slot_t *p_slot)
+{
+    return ((p_slot->magic == BT_APP_SNAPSHOT_MAGIC) && (p_slot->length == sizeof(bt_app_snapshot_t)) &&
+            (p_slot->crc == bt_app_snapshot_crc((const uint8_t *)&p_slot->magic,
+                                                sizeof(bt_app_snapshot_slot_t) -
+                                                offsetof(bt_app_snapshot_slot_t, magic))));
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_snapshot_init
+ * *****************************************************************************
+ * Summary :
+ *    Map the snapshot file, creating it on the first start, and get the last
+ *    snapshot written
+ *
+ * Parameters:
+ *    p_snapshot:     filled with the last snapshot
+ *
+ * Return:
+ *    wiced_bool_t:   WICED_TRUE if a snapshot was found
+ ******************************************************************************/
+wiced_bool_t bt_app_snapshot_init(bt_app_snapshot_t *p_snapshot)
+{
+    bt_app_snapshot_file_t *p_file;
+    struct stat file_stat;
+    uint8_t active = BT_APP_SNAPSHOT_SLOT_NONE;
+    uint8_t i;
+    int fd;
+
+    if ((fd = open(BT_APP_SNAPSHOT_FILE, O_RDWR | O_CREAT, 0600)) < 0)
+    {
+        WICED_BT_TRACE("Err: opening %s failed, the state is not kept across restarts \n", BT_APP_SNAPSHOT_FILE);
+        return WICED_FALSE;
+    }
+
+    /* a file of another size is of another format, it is resized and its slots fail the check */
+    if ((fstat(fd, &file_stat) != 0) ||
+        ((file_stat.st_size != sizeof(bt_app_snapshot_file_t)) && (ftruncate(fd, sizeof(bt_app_snapshot_file_t)) != 0)))
+    {
+        WICED_BT_TRACE("Err: sizing %s failed \n", BT_APP_SNAPSHOT_FILE);
+        close(fd);
+        return WICED_FALSE;
+    }
+
+    p_file = mmap(NULL, sizeof(bt_app_snapshot_file_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p_file == MAP_FAILED)
+    {
+        WICED_BT_TRACE("Err: mapping %s failed \n", BT_APP_SNAPSHOT_FILE);
+        return WICED_FALSE;
+    }
+    bt_app_snapshot_cb.p_file = p_file;
+
+    for (i = 0; i < BT_APP_SNAPSHOT_NUM_SLOTS; i++)
+    {
+        if (bt_app_snapshot_slot_valid(&p_file->slot[i]) &&
+            ((active == BT_APP_SNAPSHOT_SLOT_NONE) ||
+             ((int32_t)(p_file->slot[i].sequence - p_file->slot[active].sequence) > 0)))
+        {
+            active = i;
+        }
+    }
+    bt_app_snapshot_cb.active = active;
+
+    if (active == BT_APP_SNAPSHOT_SLOT_NONE)
+        return WICED_FALSE;
+
+    memcpy(p_snapshot, &p_file->slot[active].data, sizeof(bt_app_snapshot_t));
+    WICED_BT_TRACE("Snapshot %u restored from slot %d \n", (unsigned)p_file->slot[active].sequence, active);
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_snapshot_write
+ * *****************************************************************************
+ * Summary :
+ *    Make a snapshot the current one if it differs from the current one. It
+ *    is written to the other slot, which is checked only once complete.
+ *
+ * Parameters:
+ *    p_snapshot:     state to keep, padding cleared so that equal states compare equal
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+void bt_app_snapshot_write(const bt_app_snapshot_t *p_snapshot)
+{
+    bt_app_snapshot_file_t *p_file = bt_app_snapshot_cb.p_file;
+    bt_app_snapshot_slot_t *p_slot;
+    uint32_t sequence = 0;
+    uint8_t next = 0;
+
+    if (p_file == NULL)
+        return;
+
+    if (bt_app_snapshot_cb.active != BT_APP_SNAPSHOT_SLOT_NONE)
+    {
+        p_slot = &p_file->slot[bt_app_snapshot_cb.active];
+        if (memcmp(&p_slot->data, p_snapshot, sizeof(bt_app_snapshot_t)) == 0)
+            return;
+
+        sequence = p_slot->sequence + 1;
+        next = bt_app_snapshot_cb.active ^ 1;
+    }
+
+    p_slot = &p_file->slot[next];
+    p_slot->magic = BT_APP_SNAPSHOT_MAGIC;
+    p_slot->sequence = sequence;
+    p_slot->length = sizeof(bt_app_snapshot_t);
+    memcpy(&p_slot->data, p_snapshot, sizeof(bt_app_snapshot_t));
+    p_slot->crc = bt_app_snapshot_crc((const uint8_t *)&p_slot->magic,
+                                      sizeof(bt_app_snapshot_slot_t) - offsetof(bt_app_snapshot_slot_t, magic));
+
+    /* the page cache survives a crash of the application, write back for a power loss too */
+    msync(p_file, sizeof(bt_app_snapshot_file_t), MS_ASYNC);
+
+    bt_app_snapshot_cb.active = next;
+}
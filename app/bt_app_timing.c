@@ -0,0 +1,271 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+/******************************************************************************
+ * File Name: bt_app_timing.c
+ *
+ * Description:
+ * Processing time of the BT stack callbacks of the application, kept in one
+ * shared memory page that tools/ans_timing.py maps to sample it from outside
+ * the process. Every callback and event or opcode has a slot with the number
+ * of calls and the total, largest and latest time. A slot is guarded by a
+ * sequence count that is odd while the stack thread updates it, a reader
+ * retries when the count is odd or changed under it.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "wiced_bt_trace.h"
+#include "bt_app_timing.h"
+
+/*******************************************************************************
+ *                                   MACROS
+ *******************************************************************************/
+#define BT_APP_TIMING_SHM "/ans_timing" /* Used when no name is given, /dev/shm/ans_timing */
+#define BT_APP_TIMING_PAGE_SIZE ( 4096U )
+
+/* "ANT" and the layout version, see tools/ans_timing.py */
+#define BT_APP_TIMING_MAGIC ( 0x414E5401U )
+
+#define BT_APP_TIMING_MAX_SLOTS ((BT_APP_TIMING_PAGE_SIZE - sizeof(bt_app_timing_header_t)) / sizeof(bt_app_timing_slot_t))
+#define BT_APP_TIMING_KEYS ( 0x200U )
+#define BT_APP_TIMING_SLOT_NONE ( 0U )
+
+/*******************************************************************************
+ *                    STRUCTURES AND ENUMERATIONS
+ *******************************************************************************/
+typedef struct
+{
+    uint32_t magic;       /* Written last, the page is valid once it is set */
+    uint16_t header_size;
+    uint16_t slot_size;
+    uint32_t max_slots;
+    uint32_t num_slots;   /* Slots in use, only grows */
+    uint64_t start_ns;    /* CLOCK_MONOTONIC when the page was set up, changes on a restart */
+    uint32_t pid;
+    uint8_t reserved[36];
+} bt_app_timing_header_t;
+
+typedef struct
+{
+    uint32_t seq;       /* Odd while the slot is updated */
+    uint8_t callback;   /* bt_app_timing_callback_t */
+    uint8_t reserved;
+    uint16_t key;       /* Event or opcode */
+    uint64_t count;     /* Calls */
+    uint64_t total_ns;  /* Time spent in all calls */
+    uint64_t max_ns;    /* Longest call */
+    uint64_t last_ns;   /* Latest call */
+} bt_app_timing_slot_t;
+
+typedef struct
+{
+    bt_app_timing_header_t *p_header; /* Mapped page, NULL if it could not be mapped */
+    bt_app_timing_slot_t *p_slot;
+    uint8_t slot_index[BT_APP_TIMING_CALLBACKS][BT_APP_TIMING_KEYS]; /* Slot + 1 of a key, BT_APP_TIMING_SLOT_NONE before its first call */
+} bt_app_timing_cb_t;
+
+/*******************************************************************************
+ *                           GLOBAL VARIABLES
+ *******************************************************************************/
+static bt_app_timing_cb_t bt_app_timing_cb;
+
+/*******************************************************************************
+ *                           FUNCTION DECLARATIONS
+ *******************************************************************************/
+static bt_app_timing_slot_t *bt_app_timing_slot(bt_app_timing_callback_t callback, uint16_t key);
+
+/*******************************************************************************
+ *                       FUNCTION DEFINITIONS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * Function Name : bt_app_timing_init
+ * *****************************************************************************
+ * Summary :
+ *    Map the timing page, a page left by an earlier run is started over
+ *
+ * Parameters:
+ *    p_name:     POSIX shared memory name, BT_APP_TIMING_SHM when NULL
+ *
+ * Return:
+ *    wiced_bool_t:   WICED_TRUE when the page is mapped
+ ******************************************************************************/
+wiced_bool_t bt_app_timing_init(const char *p_name)
+{
+    bt_app_timing_header_t *p_header;
+    int fd;
+
+    if (bt_app_timing_cb.p_header != NULL)
+        return WICED_TRUE;
+
+    if (p_name == NULL)
+        p_name = BT_APP_TIMING_SHM;
+
+    if ((fd = shm_open(p_name, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR)) < 0)
+        return WICED_FALSE;
+
+    if (ftruncate(fd, BT_APP_TIMING_PAGE_SIZE) != 0)
+    {
+        close(fd);
+        return WICED_FALSE;
+    }
+
+    p_header = mmap(NULL, BT_APP_TIMING_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p_header == MAP_FAILED)
+        return WICED_FALSE;
+
+    /* a reader still attached sees the magic go away while the page is set up */
+    __atomic_store_n(&p_header->magic, 0, __ATOMIC_RELEASE);
+    memset((uint8_t *)p_header + sizeof(p_header->magic), 0, BT_APP_TIMING_PAGE_SIZE - sizeof(p_header->magic));
+    p_header->header_size = sizeof(bt_app_timing_header_t);
+    p_header->slot_size = sizeof(bt_app_timing_slot_t);
+    p_header->max_slots = BT_APP_TIMING_MAX_SLOTS;
+    p_header->pid = (uint32_t)getpid();
+
+    bt_app_timing_cb.p_slot = (bt_app_timing_slot_t *)(p_header + 1);
+    bt_app_timing_cb.p_header = p_header;
+    p_header->start_ns = bt_app_timing_now();
+    __atomic_store_n(&p_header->magic, BT_APP_TIMING_MAGIC, __ATOMIC_RELEASE);
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_timing_now
+ * *****************************************************************************
+ * Summary :
+ *    Monotonic time in ns to pass to bt_app_timing_record
+ *
+ * Parameters:
+ *    None
+ *
+ * Return:
+ *    uint64_t:   Time in ns, 0 while the timing page is not mapped
+ ******************************************************************************/
+uint64_t bt_app_timing_now(void)
+{
+    struct timespec ts;
+
+    if (bt_app_timing_cb.p_header == NULL)
+        return 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_timing_slot
+ * *****************************************************************************
+ * Summary :
+ *    Slot of a callback and key, taken from the page on the first call
+ *
+ * Parameters:
+ *    callback:   Callback
+ *    key:        Event or opcode
+ *
+ * Return:
+ *    bt_app_timing_slot_t *:   Slot, NULL when the page is full
+ ******************************************************************************/
+static bt_app_timing_slot_t *bt_app_timing_slot(bt_app_timing_callback_t callback, uint16_t key)
+{
+    bt_app_timing_header_t *p_header = bt_app_timing_cb.p_header;
+    bt_app_timing_slot_t *p_slot;
+    uint32_t idx = bt_app_timing_cb.slot_index[callback][key];
+
+    if (idx != BT_APP_TIMING_SLOT_NONE)
+        return &bt_app_timing_cb.p_slot[idx - 1];
+
+    idx = p_header->num_slots;
+    if (idx >= p_header->max_slots)
+        return NULL;
+
+    /* readers only look at the slot once num_slots covers it */
+    p_slot = &bt_app_timing_cb.p_slot[idx];
+    p_slot->callback = (uint8_t)callback;
+    p_slot->key = key;
+    __atomic_store_n(&p_header->num_slots, idx + 1, __ATOMIC_RELEASE);
+
+    bt_app_timing_cb.slot_index[callback][key] = (uint8_t)(idx + 1);
+    return p_slot;
+}
+
+/*******************************************************************************
+ * Function Name : bt_app_timing_record
+ * *****************************************************************************
+ * Summary :
+ *    Record a call that started at start_ns. Called from the BT stack thread
+ *    only, every slot has a single writer.
+ *
+ * Parameters:
+ *    callback:   Callback
+ *    key:        Event or opcode
+ *    start_ns:   bt_app_timing_now when the call started
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+void bt_app_timing_record(bt_app_timing_callback_t callback, uint16_t key, uint64_t start_ns)
+{
+    bt_app_timing_slot_t *p_slot;
+    uint64_t duration;
+    uint32_t seq;
+
+    if ((bt_app_timing_cb.p_header == NULL) || (callback >= BT_APP_TIMING_CALLBACKS) ||
+        (key >= BT_APP_TIMING_KEYS) || ((p_slot = bt_app_timing_slot(callback, key)) == NULL))
+    {
+        return;
+    }
+
+    duration = bt_app_timing_now() - start_ns;
+
+    seq = p_slot->seq;
+    __atomic_store_n(&p_slot->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    __atomic_store_n(&p_slot->count, p_slot->count + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&p_slot->total_ns, p_slot->total_ns + duration, __ATOMIC_RELAXED);
+    if (duration > p_slot->max_ns)
+        __atomic_store_n(&p_slot->max_ns, duration, __ATOMIC_RELAXED);
+    __atomic_store_n(&p_slot->last_ns, duration, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&p_slot->seq, seq + 2, __ATOMIC_RELEASE);
+}
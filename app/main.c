@@ -61,6 +61,7 @@
 #define INVALID_IP_CMD ( 15 )
 #define EXP_IP_RET_VAL ( 1 )
 #define INVALID_SCAN   ( 0 )
+#define ALERT_TEXT_LEN ( 64 )
 
 /*******************************************************************************
  *                    STRUCTURES AND ENUMERATIONS
@@ -76,8 +77,10 @@ static const char bt_app_ans_app_menu[] = "\n\
     4.  Clear Alert \n\
     5.  Scan and Connect \n\
     6.  Disconnect \n\
+    7.  Show Notification Statistics \n\
+    8.  Generate Alert with Text \n\
  =================================\n\
- Choose option (0-6): ";
+ Choose option (0-8): ";
 
 static const char alert_ids[] = "\
     ----------------------------- \n\
@@ -173,6 +176,7 @@ int main(int argc, char *argv[])
     int ip = 0;
     unsigned int alert_id = 0;
     unsigned int alert_category = 0;
+    char alert_text[ALERT_TEXT_LEN];
     int len = 0;
     int filename_len = 0;
     char fw_patch_file[MAX_PATH];
@@ -318,6 +322,34 @@ int main(int argc, char *argv[])
             }
             break;
 
+        case 7: /* Show Notification Statistics */
+            status = bt_app_ans_print_stats();
+            break;
+
+        case 8: /* Generate Alert with Text */
+            fprintf(stdout, "\n    Alert Categories \n");
+            fprintf(stdout, "%s", alert_ids);
+            fprintf(stdout,
+                    "Generate Alert for a particular Category ID (0-9): ");
+            if ( INVALID_SCAN == fscanf(stdin, "%u", &alert_id) )
+            {
+                fprintf(stdout, "Unknown input for generate alert categories\n");
+                continue;
+            }
+            fprintf(stdout, "Sender name or title of the alert: ");
+            if ( INVALID_SCAN == fscanf(stdin, " %63[^\n]", alert_text) )
+            {
+                fprintf(stdout, "Unknown input for alert text\n");
+                continue;
+            }
+            status = bt_app_ans_handle_generate_alert_text((uint8_t)alert_id, alert_text,
+                                                           (uint16_t)strlen(alert_text));
+            if (status == WICED_BT_GATT_SUCCESS)
+            {
+                fprintf(stdout, "Generate Alert initiated \n");
+            }
+            break;
+
         default:
             fprintf(stdout,
                     "Unknown ANS Command. Choose option from the Menu \n");
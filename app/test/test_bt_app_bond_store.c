@@ -0,0 +1,388 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+/******************************************************************************
+ * File Name: test_bt_app_bond_store.c
+ *
+ * Description:
+ * Unit tests of the bond store: replacement of the least recently used bond,
+ * persistence through the NVRAM, writes only on change, the move of the bond
+ * of earlier versions, and the BD address index under churn.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include "test_stubs.h"
+
+/* built in to check the BD address index */
+#include "app/bt_app_bond_store.c"
+
+/*******************************************************************************
+ *                                   MACROS
+ *******************************************************************************/
+/* BD addresses used by the churn, more than the store holds */
+#define TEST_BOND_STORE_ADDRS ( 3 * CY_BT_MAX_BONDED_DEVICES )
+#define TEST_BOND_STORE_ROUNDS 20000
+
+/*******************************************************************************
+ *                       FUNCTION DEFINITIONS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * Function Name : test_bond_store_keys
+ * *****************************************************************************
+ * Summary :
+ *    Link keys of a test device, the address and keys follow from its number
+ *
+ * Parameters:
+ *    n:          Device number
+ *    p_keys:     Link keys of the device
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void test_bond_store_keys(uint32_t n, wiced_bt_device_link_keys_t *p_keys)
+{
+    memset(p_keys, 0, sizeof(*p_keys));
+    p_keys->bd_addr[0] = 0x00;
+    p_keys->bd_addr[1] = 0xA0;
+    p_keys->bd_addr[2] = 0x50;
+    p_keys->bd_addr[3] = (uint8_t)(n >> 16);
+    p_keys->bd_addr[4] = (uint8_t)(n >> 8);
+    p_keys->bd_addr[5] = (uint8_t)n;
+    p_keys->key_data.le_keys.pltk[0] = (uint8_t)(n * 7 + 1);
+}
+
+/*******************************************************************************
+ * Function Name : test_bond_store_bonded
+ * *****************************************************************************
+ * Summary :
+ *    Check whether a test device is bonded without marking the bond used
+ *
+ * Parameters:
+ *    n:          Device number
+ *
+ * Return:
+ *    wiced_bool_t: WICED_TRUE if the device is bonded with its own keys
+ ******************************************************************************/
+static wiced_bool_t test_bond_store_bonded(uint32_t n)
+{
+    wiced_bt_device_link_keys_t keys;
+    uint8_t idx;
+
+    test_bond_store_keys(n, &keys);
+    idx = bt_app_bond_store_find(keys.bd_addr);
+    if (idx == BT_APP_BOND_STORE_INDEX_FREE)
+        return WICED_FALSE;
+
+    TEST_ASSERT(memcmp(&bt_app_bond_store_cb.entry[idx].keys, &keys, sizeof(keys)) == 0);
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+ * Function Name : test_bond_store_check_index
+ * *****************************************************************************
+ * Summary :
+ *    Check that the index holds every valid entry once, reachable from its
+ *    home position without crossing a free position
+ *
+ * Parameters:
+ *    None
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void test_bond_store_check_index(void)
+{
+    uint8_t valid = 0;
+    uint8_t used = 0;
+    uint8_t pos;
+    uint8_t idx;
+
+    for (idx = 0; idx < CY_BT_MAX_BONDED_DEVICES; idx++)
+    {
+        if (!bt_app_bond_store_cb.valid[idx])
+            continue;
+
+        valid++;
+        pos = bt_app_bond_store_home(bt_app_bond_store_cb.entry[idx].keys.bd_addr);
+        while (bt_app_bond_store_cb.index[pos] != idx)
+        {
+            TEST_ASSERT(bt_app_bond_store_cb.index[pos] != BT_APP_BOND_STORE_INDEX_FREE);
+            pos = (pos + 1) & BT_APP_BOND_STORE_INDEX_MASK;
+        }
+    }
+
+    for (pos = 0; pos < BT_APP_BOND_STORE_INDEX_SIZE; pos++)
+    {
+        if (bt_app_bond_store_cb.index[pos] != BT_APP_BOND_STORE_INDEX_FREE)
+            used++;
+    }
+    TEST_ASSERT(used == valid);
+}
+
+/* A new bond replaces the least recently used one when the store is full */
+static void test_bond_store_lru(void)
+{
+    wiced_bt_device_link_keys_t keys;
+    wiced_bt_ans_client_state_t state;
+    uint32_t n;
+
+    test_stubs_reset();
+    bt_app_bond_store_init();
+
+    for (n = 0; n < CY_BT_MAX_BONDED_DEVICES; n++)
+    {
+        test_bond_store_keys(n, &keys);
+        TEST_ASSERT(bt_app_bond_store_save_keys(&keys));
+    }
+
+    /* device 0 is used again, device 1 becomes the oldest */
+    test_bond_store_keys(0, &keys);
+    TEST_ASSERT(bt_app_bond_store_get_keys(keys.bd_addr, NULL));
+    memset(&state, 0, sizeof(state));
+    state.new_alert_cccd = 1;
+    test_bond_store_keys(1, &keys);
+    TEST_ASSERT(bt_app_bond_store_save_ans_state(keys.bd_addr, &state));
+
+    test_bond_store_keys(CY_BT_MAX_BONDED_DEVICES, &keys);
+    TEST_ASSERT(bt_app_bond_store_save_keys(&keys));
+    TEST_ASSERT(test_stubs.resolution_db_removes == 1);
+    TEST_ASSERT(!test_bond_store_bonded(1));
+    for (n = 0; n <= CY_BT_MAX_BONDED_DEVICES; n++)
+        TEST_ASSERT((n == 1) || test_bond_store_bonded(n));
+
+    /* the client state of the replaced bond is not handed to the new one */
+    TEST_ASSERT(!bt_app_bond_store_get_ans_state(keys.bd_addr, &state));
+    test_bond_store_check_index();
+}
+
+/* Bonds and their state survive a restart, the use order too */
+static void test_bond_store_persist(void)
+{
+    wiced_bt_device_link_keys_t keys;
+    wiced_bt_device_link_keys_t read_keys;
+    bt_app_bond_gatt_state_t gatt_state;
+    bt_app_bond_gatt_state_t read_gatt_state;
+    wiced_bt_ans_client_state_t state;
+    wiced_bt_ans_client_state_t read_state;
+    uint32_t n;
+
+    test_stubs_reset();
+    bt_app_bond_store_init();
+
+    for (n = 0; n < CY_BT_MAX_BONDED_DEVICES; n++)
+    {
+        test_bond_store_keys(n, &keys);
+        TEST_ASSERT(bt_app_bond_store_save_keys(&keys));
+    }
+
+    test_bond_store_keys(3, &keys);
+    memset(&gatt_state, 0x5A, sizeof(gatt_state));
+    TEST_ASSERT(bt_app_bond_store_save_gatt_state(keys.bd_addr, &gatt_state));
+    memset(&state, 0, sizeof(state));
+    state.client_configured_new_alerts = 0x3FF;
+    state.num_of_new_alerts[ANP_ALERT_CATEGORY_ID_EMAIL] = 4;
+    TEST_ASSERT(bt_app_bond_store_save_ans_state(keys.bd_addr, &state));
+
+    /* device 0 is used last, the use order reaches the NVRAM with the next write */
+    test_bond_store_keys(0, &keys);
+    TEST_ASSERT(bt_app_bond_store_get_keys(keys.bd_addr, NULL));
+    TEST_ASSERT(bt_app_bond_store_save_keys(&keys));
+
+    test_stubs.resolution_db_adds = 0;
+    bt_app_bond_store_init();
+    TEST_ASSERT(test_stubs.resolution_db_adds == CY_BT_MAX_BONDED_DEVICES);
+    test_bond_store_check_index();
+
+    test_bond_store_keys(3, &keys);
+    TEST_ASSERT(bt_app_bond_store_get_keys(keys.bd_addr, &read_keys));
+    TEST_ASSERT(memcmp(&read_keys, &keys, sizeof(keys)) == 0);
+    TEST_ASSERT(bt_app_bond_store_get_gatt_state(keys.bd_addr, &read_gatt_state));
+    TEST_ASSERT(memcmp(&read_gatt_state, &gatt_state, sizeof(gatt_state)) == 0);
+    TEST_ASSERT(bt_app_bond_store_get_ans_state(keys.bd_addr, &read_state));
+    TEST_ASSERT(memcmp(&read_state, &state, sizeof(state)) == 0);
+
+    test_bond_store_keys(4, &keys);
+    TEST_ASSERT(!bt_app_bond_store_get_gatt_state(keys.bd_addr, &read_gatt_state));
+    TEST_ASSERT(!bt_app_bond_store_get_ans_state(keys.bd_addr, &read_state));
+
+    /* device 1 is the oldest after the restart */
+    test_bond_store_keys(CY_BT_MAX_BONDED_DEVICES, &keys);
+    TEST_ASSERT(bt_app_bond_store_save_keys(&keys));
+    TEST_ASSERT(!test_bond_store_bonded(1) && test_bond_store_bonded(0) && test_bond_store_bonded(2));
+}
+
+/* The NVRAM is written only when a state changes */
+static void test_bond_store_writes(void)
+{
+    wiced_bt_device_link_keys_t keys;
+    bt_app_bond_gatt_state_t gatt_state;
+    wiced_bt_ans_client_state_t state;
+    uint32_t writes;
+
+    test_stubs_reset();
+    bt_app_bond_store_init();
+
+    test_bond_store_keys(0, &keys);
+    memset(&gatt_state, 0, sizeof(gatt_state));
+    memset(&state, 0, sizeof(state));
+
+    /* no bond, no write */
+    TEST_ASSERT(!bt_app_bond_store_save_gatt_state(keys.bd_addr, &gatt_state));
+    TEST_ASSERT(!bt_app_bond_store_save_ans_state(keys.bd_addr, &state));
+    TEST_ASSERT(test_stubs.nvram_writes == 0);
+
+    TEST_ASSERT(bt_app_bond_store_save_keys(&keys));
+    TEST_ASSERT(bt_app_bond_store_save_gatt_state(keys.bd_addr, &gatt_state));
+    TEST_ASSERT(bt_app_bond_store_save_ans_state(keys.bd_addr, &state));
+    writes = test_stubs.nvram_writes;
+    TEST_ASSERT(writes == 3);
+
+    TEST_ASSERT(bt_app_bond_store_save_gatt_state(keys.bd_addr, &gatt_state));
+    TEST_ASSERT(bt_app_bond_store_save_ans_state(keys.bd_addr, &state));
+    TEST_ASSERT(test_stubs.nvram_writes == writes);
+
+    state.num_of_unread_count[ANP_ALERT_CATEGORY_ID_SMS_OR_MMS] = 1;
+    TEST_ASSERT(bt_app_bond_store_save_ans_state(keys.bd_addr, &state));
+    gatt_state.client_features = 1;
+    TEST_ASSERT(bt_app_bond_store_save_gatt_state(keys.bd_addr, &gatt_state));
+    TEST_ASSERT(test_stubs.nvram_writes == writes + 2);
+
+    /* a failed write is reported */
+    test_stubs.nvram_status = WICED_ERROR;
+    state.num_of_unread_count[ANP_ALERT_CATEGORY_ID_SMS_OR_MMS] = 2;
+    TEST_ASSERT(!bt_app_bond_store_save_ans_state(keys.bd_addr, &state));
+}
+
+/* The single bond of earlier versions is moved into an empty store */
+static void test_bond_store_migrate(void)
+{
+    wiced_bt_device_link_keys_t keys;
+    wiced_bt_device_link_keys_t read_keys;
+    bt_app_bond_store_legacy_gatt_t legacy_gatt;
+    bt_app_bond_gatt_state_t gatt_state;
+    wiced_result_t result;
+
+    test_stubs_reset();
+    test_bond_store_keys(42, &keys);
+    memcpy(legacy_gatt.bd_addr, keys.bd_addr, sizeof(wiced_bt_device_address_t));
+    memset(legacy_gatt.db_hash, 0xA5, sizeof(wiced_bt_db_hash_t));
+    legacy_gatt.client_features = 1;
+    legacy_gatt.service_changed_cccd = 2;
+    wiced_hal_write_nvram(BT_APP_BOND_STORE_LEGACY_KEYS_NVRAM_ID, sizeof(keys), (uint8_t *)&keys, &result);
+    wiced_hal_write_nvram(BT_APP_BOND_STORE_LEGACY_GATT_NVRAM_ID, sizeof(legacy_gatt), (uint8_t *)&legacy_gatt,
+                          &result);
+
+    bt_app_bond_store_init();
+    TEST_ASSERT(bt_app_bond_store_get_keys(keys.bd_addr, &read_keys));
+    TEST_ASSERT(memcmp(&read_keys, &keys, sizeof(keys)) == 0);
+    TEST_ASSERT(bt_app_bond_store_get_gatt_state(keys.bd_addr, &gatt_state));
+    TEST_ASSERT(memcmp(gatt_state.db_hash, legacy_gatt.db_hash, sizeof(wiced_bt_db_hash_t)) == 0);
+    TEST_ASSERT((gatt_state.client_features == 1) && (gatt_state.service_changed_cccd == 2));
+    TEST_ASSERT(!test_stubs.nvram[BT_APP_BOND_STORE_LEGACY_KEYS_NVRAM_ID - WICED_NVRAM_VSID_START].used);
+    TEST_ASSERT(!test_stubs.nvram[BT_APP_BOND_STORE_LEGACY_GATT_NVRAM_ID - WICED_NVRAM_VSID_START].used);
+
+    /* kept over a restart, not moved again */
+    wiced_hal_write_nvram(BT_APP_BOND_STORE_LEGACY_KEYS_NVRAM_ID, sizeof(keys), (uint8_t *)&keys, &result);
+    bt_app_bond_store_init();
+    TEST_ASSERT(test_bond_store_bonded(42));
+    TEST_ASSERT(test_stubs.nvram[BT_APP_BOND_STORE_LEGACY_KEYS_NVRAM_ID - WICED_NVRAM_VSID_START].used);
+}
+
+/* Random saves and uses against a model of the least recently used replacement */
+static void test_bond_store_churn(void)
+{
+    wiced_bt_device_link_keys_t keys;
+    uint32_t used[TEST_BOND_STORE_ADDRS];
+    uint32_t seed = 12345;
+    uint32_t use_count = 0;
+    uint32_t bonded = 0;
+    uint32_t round;
+    uint32_t lru;
+    uint32_t n;
+
+    test_stubs_reset();
+    bt_app_bond_store_init();
+    memset(used, 0, sizeof(used));
+
+    for (round = 0; round < TEST_BOND_STORE_ROUNDS; round++)
+    {
+        seed = seed * 1103515245 + 12345;
+        n = (seed >> 16) % TEST_BOND_STORE_ADDRS;
+        test_bond_store_keys(n, &keys);
+
+        if ((seed >> 8) & 1)
+        {
+            TEST_ASSERT(bt_app_bond_store_get_keys(keys.bd_addr, NULL) == (used[n] != 0));
+            if (used[n] != 0)
+                used[n] = ++use_count;
+        }
+        else
+        {
+            if ((used[n] == 0) && (bonded == CY_BT_MAX_BONDED_DEVICES))
+            {
+                for (lru = 0; used[lru] == 0; lru++)
+                    ;
+                for (n = lru + 1; n < TEST_BOND_STORE_ADDRS; n++)
+                {
+                    if ((used[n] != 0) && (used[n] < used[lru]))
+                        lru = n;
+                }
+                used[lru] = 0;
+                bonded--;
+                n = (seed >> 16) % TEST_BOND_STORE_ADDRS;
+            }
+            if (used[n] == 0)
+                bonded++;
+            used[n] = ++use_count;
+            TEST_ASSERT(bt_app_bond_store_save_keys(&keys));
+        }
+
+        for (n = 0; n < TEST_BOND_STORE_ADDRS; n++)
+            TEST_ASSERT(test_bond_store_bonded(n) == (used[n] != 0));
+        test_bond_store_check_index();
+    }
+}
+
+int main(void)
+{
+    test_bond_store_lru();
+    test_bond_store_persist();
+    test_bond_store_writes();
+    test_bond_store_migrate();
+    test_bond_store_churn();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,198 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+/******************************************************************************
+ * File Name: test_bt_app_offline_alerts.c
+ *
+ * Description:
+ * Unit tests of the offline alert buffer: alerts folded into the count of
+ * their category when the buffer is full, the time to live per category, and
+ * the delivery to a client that connects.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include "COMPONENT_ans/test/test_ans.h"
+
+/* the buffer reads CLOCK_MONOTONIC, the tests move the clock by hand */
+#define clock_gettime test_stubs_clock_gettime
+#include "app/bt_app_offline_alerts.c"
+#undef clock_gettime
+
+/*******************************************************************************
+ *                                   MACROS
+ *******************************************************************************/
+#define TEST_CONN_ID 5
+
+/*******************************************************************************
+ *                       FUNCTION DEFINITIONS
+ *******************************************************************************/
+
+/* Alerts past the capacity are folded into the count of their category */
+static void test_offline_alerts_fold(void)
+{
+    bt_app_offline_alerts_stats_t stats;
+    uint8_t i;
+
+    test_ans_init(4);
+    bt_app_offline_alerts_init();
+
+    for (i = 0; i < CY_BT_OFFLINE_ALERTS_MAX + 4; i++)
+        TEST_ASSERT(bt_app_offline_alerts_add(ANP_ALERT_CATEGORY_ID_EMAIL, NULL, 0));
+    TEST_ASSERT(!bt_app_offline_alerts_add(ANP_NOTIFY_CATEGORY_COUNT, NULL, 0));
+
+    bt_app_offline_alerts_get_stats(&stats);
+    TEST_ASSERT((stats.occupancy == CY_BT_OFFLINE_ALERTS_MAX) && (stats.capacity == CY_BT_OFFLINE_ALERTS_MAX));
+    TEST_ASSERT((stats.max_occupancy == CY_BT_OFFLINE_ALERTS_MAX) && (stats.folded == 4));
+    TEST_ASSERT((stats.buffered == CY_BT_OFFLINE_ALERTS_MAX + 4) && (stats.pending[ANP_ALERT_CATEGORY_ID_EMAIL] == 20));
+
+    /* a new category pushes out the oldest alert, its category keeps the count */
+    TEST_ASSERT(bt_app_offline_alerts_add(ANP_ALERT_CATEGORY_ID_NEWS, "x", 1));
+    TEST_ASSERT(bt_app_offline_alerts_add(ANP_ALERT_CATEGORY_ID_CALL, NULL, 0));
+    bt_app_offline_alerts_get_stats(&stats);
+    TEST_ASSERT((stats.occupancy == CY_BT_OFFLINE_ALERTS_MAX) && (stats.folded == 6));
+    TEST_ASSERT(stats.pending[ANP_ALERT_CATEGORY_ID_EMAIL] == 20);
+    TEST_ASSERT((stats.pending[ANP_ALERT_CATEGORY_ID_NEWS] == 1) && (stats.pending[ANP_ALERT_CATEGORY_ID_CALL] == 1));
+
+    /* clearing a category drops its buffered and folded alerts */
+    bt_app_offline_alerts_clear(ANP_ALERT_CATEGORY_ID_EMAIL);
+    bt_app_offline_alerts_get_stats(&stats);
+    TEST_ASSERT((stats.occupancy == 2) && (stats.pending[ANP_ALERT_CATEGORY_ID_EMAIL] == 0));
+    TEST_ASSERT(stats.max_occupancy == CY_BT_OFFLINE_ALERTS_MAX);
+}
+
+/* Alerts are dropped once the time to live of their category runs out */
+static void test_offline_alerts_expire(void)
+{
+    bt_app_offline_alerts_stats_t stats;
+    uint8_t i;
+
+    test_ans_init(4);
+    bt_app_offline_alerts_init();
+    TEST_ASSERT(bt_app_offline_alerts_set_ttl(ANP_ALERT_CATEGORY_ID_CALL, 50));
+    TEST_ASSERT(!bt_app_offline_alerts_set_ttl(ANP_NOTIFY_CATEGORY_COUNT, 50));
+
+    TEST_ASSERT(bt_app_offline_alerts_add(ANP_ALERT_CATEGORY_ID_CALL, "Bob", 3));
+    TEST_ASSERT(bt_app_offline_alerts_add(ANP_ALERT_CATEGORY_ID_EMAIL, NULL, 0));
+    test_stubs_advance_ms(49);
+    bt_app_offline_alerts_get_stats(&stats);
+    TEST_ASSERT((stats.pending[ANP_ALERT_CATEGORY_ID_CALL] == 1) && (stats.expired == 0));
+    test_stubs_advance_ms(1);
+    bt_app_offline_alerts_get_stats(&stats);
+    TEST_ASSERT((stats.pending[ANP_ALERT_CATEGORY_ID_CALL] == 0) && (stats.expired == 1));
+    TEST_ASSERT(!bt_app_offline_alerts_cb.text_valid[ANP_ALERT_CATEGORY_ID_CALL]);
+
+    /* the category without a time to live is kept */
+    test_stubs_advance_ms(100000);
+    bt_app_offline_alerts_get_stats(&stats);
+    TEST_ASSERT((stats.occupancy == 1) && (stats.pending[ANP_ALERT_CATEGORY_ID_EMAIL] == 1));
+
+    /* calls 1 ms apart, the first four folded, they go with the latest of them */
+    bt_app_offline_alerts_clear(ANP_ALERT_CATEGORY_ID_EMAIL);
+    for (i = 0; i < CY_BT_OFFLINE_ALERTS_MAX; i++)
+    {
+        TEST_ASSERT(bt_app_offline_alerts_add(ANP_ALERT_CATEGORY_ID_CALL, NULL, 0));
+        test_stubs_advance_ms(1);
+    }
+    for (i = 0; i < 4; i++)
+        TEST_ASSERT(bt_app_offline_alerts_add(ANP_ALERT_CATEGORY_ID_EMAIL, NULL, 0));
+
+    /* the latest folded call was raised at 3 ms, it expires at 53 ms */
+    test_stubs_advance_ms(53 - CY_BT_OFFLINE_ALERTS_MAX - 1);
+    bt_app_offline_alerts_get_stats(&stats);
+    TEST_ASSERT(stats.pending[ANP_ALERT_CATEGORY_ID_CALL] == CY_BT_OFFLINE_ALERTS_MAX);
+    test_stubs_advance_ms(1);
+    bt_app_offline_alerts_get_stats(&stats);
+    TEST_ASSERT(stats.pending[ANP_ALERT_CATEGORY_ID_CALL] == CY_BT_OFFLINE_ALERTS_MAX - 4);
+    test_stubs_advance_ms(1);
+    bt_app_offline_alerts_get_stats(&stats);
+    TEST_ASSERT(stats.pending[ANP_ALERT_CATEGORY_ID_CALL] == CY_BT_OFFLINE_ALERTS_MAX - 5);
+    TEST_ASSERT(stats.expired == 1 + 5);
+    TEST_ASSERT(stats.pending[ANP_ALERT_CATEGORY_ID_EMAIL] == 4);
+}
+
+/* A client that connects gets one count per category */
+static void test_offline_alerts_deliver(void)
+{
+    bt_app_offline_alerts_stats_t stats;
+    wiced_bt_ans_client_state_t state;
+    const test_stubs_ntf_t *p_ntf;
+    uint32_t i;
+
+    test_ans_init(250);
+    bt_app_offline_alerts_init();
+
+    for (i = 0; i < 300; i++)
+        TEST_ASSERT(bt_app_offline_alerts_add(ANP_ALERT_CATEGORY_ID_EMAIL, NULL, 0));
+    TEST_ASSERT(bt_app_offline_alerts_add(ANP_ALERT_CATEGORY_ID_NEWS, "Bob", 3));
+    TEST_ASSERT(bt_app_offline_alerts_add(ANP_ALERT_CATEGORY_ID_NEWS, "Alice", 5));
+
+    /* no client, the alerts stay */
+    bt_app_offline_alerts_deliver(TEST_CONN_ID);
+    bt_app_offline_alerts_get_stats(&stats);
+    TEST_ASSERT((stats.delivered == 0) && (stats.pending[ANP_ALERT_CATEGORY_ID_EMAIL] == 300));
+
+    test_ans_connect(TEST_CONN_ID);
+    bt_app_offline_alerts_deliver(TEST_CONN_ID);
+    test_stubs_transmit(UINT32_MAX);
+
+    bt_app_offline_alerts_get_stats(&stats);
+    TEST_ASSERT((stats.occupancy == 0) && (stats.delivered == 302));
+    TEST_ASSERT(stats.pending[ANP_ALERT_CATEGORY_ID_EMAIL] == 0);
+
+    /* the count is a single octet, the text is the latest one */
+    TEST_ASSERT(wiced_bt_ans_get_client_state(TEST_CONN_ID, &state));
+    TEST_ASSERT(state.num_of_new_alerts[ANP_ALERT_CATEGORY_ID_EMAIL] == 0xFF);
+    TEST_ASSERT(state.num_of_unread_count[ANP_ALERT_CATEGORY_ID_EMAIL] == 0xFF);
+    TEST_ASSERT(state.num_of_new_alerts[ANP_ALERT_CATEGORY_ID_NEWS] == 2);
+    TEST_ASSERT(state.num_of_unread_count[ANP_ALERT_CATEGORY_ID_NEWS] == 2);
+
+    for (i = 0; i < test_stubs.ntf_count; i++)
+    {
+        p_ntf = test_stubs_ntf(i);
+        if ((p_ntf->handle == test_ans_handles.new_alert.value) && (p_ntf->value[0] == ANP_ALERT_CATEGORY_ID_NEWS))
+            break;
+    }
+    TEST_ASSERT(i < test_stubs.ntf_count);
+    TEST_ASSERT((p_ntf->len == 2 + 5) && (p_ntf->value[1] == 2) && (memcmp(&p_ntf->value[2], "Alice", 5) == 0));
+}
+
+int main(void)
+{
+    test_offline_alerts_fold();
+    test_offline_alerts_expire();
+    test_offline_alerts_deliver();
+    return EXIT_SUCCESS;
+}
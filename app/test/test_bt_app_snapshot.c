@@ -0,0 +1,250 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+/******************************************************************************
+ * File Name: test_bt_app_snapshot.c
+ *
+ * Description:
+ * Unit tests of the state snapshot: the choice of the current slot across a
+ * restart, the fallback to the other slot when one is damaged, the wrap of
+ * the sequence number, and the CRC-32 against a reference.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include "test_stubs.h"
+
+/* built in to check the slots of the mapped file */
+#include "app/bt_app_snapshot.c"
+
+/*******************************************************************************
+ *                       FUNCTION DEFINITIONS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * Function Name : test_snapshot_crc_ref
+ * *****************************************************************************
+ * Summary :
+ *    CRC-32 computed one bit at a time, the reference of the table version
+ *
+ * Parameters:
+ *    p_data:     data
+ *    len:        length of the data
+ *
+ * Return:
+ *    uint32_t:   CRC-32
+ ******************************************************************************/
+static uint32_t test_snapshot_crc_ref(const uint8_t *p_data, uint32_t len)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    uint8_t bit;
+
+    while (len--)
+    {
+        crc ^= *p_data++;
+        for (bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+    }
+    return ~crc;
+}
+
+/*******************************************************************************
+ * Function Name : test_snapshot_restart
+ * *****************************************************************************
+ * Summary :
+ *    Unmap the file and map it again, as a restart of the application does
+ *
+ * Parameters:
+ *    p_snapshot:     filled with the last snapshot
+ *
+ * Return:
+ *    wiced_bool_t:   WICED_TRUE if a snapshot was found
+ ******************************************************************************/
+static wiced_bool_t test_snapshot_restart(bt_app_snapshot_t *p_snapshot)
+{
+    if (bt_app_snapshot_cb.p_file != NULL)
+        munmap(bt_app_snapshot_cb.p_file, sizeof(bt_app_snapshot_file_t));
+    bt_app_snapshot_cb.p_file = NULL;
+    bt_app_snapshot_cb.active = BT_APP_SNAPSHOT_SLOT_NONE;
+
+    memset(p_snapshot, 0, sizeof(*p_snapshot));
+    return bt_app_snapshot_init(p_snapshot);
+}
+
+/*******************************************************************************
+ * Function Name : test_snapshot_fill
+ * *****************************************************************************
+ * Summary :
+ *    Make a snapshot that differs with its seed
+ *
+ * Parameters:
+ *    p_snapshot:     snapshot
+ *    seed:           value spread over the snapshot
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+static void test_snapshot_fill(bt_app_snapshot_t *p_snapshot, uint8_t seed)
+{
+    memset(p_snapshot, 0, sizeof(*p_snapshot));
+    p_snapshot->supported_new_alert_cat = seed;
+    p_snapshot->supported_unread_alert_cat = (uint16_t)(seed << 2);
+    p_snapshot->num_clients = 1;
+    memset(p_snapshot->client[0].bd_addr, seed, sizeof(wiced_bt_device_address_t));
+    p_snapshot->client[0].state.num_of_new_alerts[ANP_ALERT_CATEGORY_ID_EMAIL] = seed;
+}
+
+/* The table CRC-32 matches the bitwise one */
+static void test_snapshot_crc(void)
+{
+    uint8_t data[300];
+    uint32_t i;
+
+    TEST_ASSERT(bt_app_snapshot_crc((const uint8_t *)"123456789", 9) == 0xCBF43926);
+    TEST_ASSERT(bt_app_snapshot_crc(data, 0) == 0);
+
+    for (i = 0; i < sizeof(data); i++)
+        data[i] = (uint8_t)(i * 31 + 7);
+    for (i = 0; i <= sizeof(data); i += 37)
+        TEST_ASSERT(bt_app_snapshot_crc(data, i) == test_snapshot_crc_ref(data, i));
+}
+
+/* The later snapshot is restored, a damaged slot falls back to the other one */
+static void test_snapshot_slots(void)
+{
+    bt_app_snapshot_t a;
+    bt_app_snapshot_t b;
+    bt_app_snapshot_t c;
+    bt_app_snapshot_t read;
+
+    test_snapshot_fill(&a, 1);
+    test_snapshot_fill(&b, 2);
+    test_snapshot_fill(&c, 3);
+
+    /* first start, an empty file */
+    TEST_ASSERT(!test_snapshot_restart(&read));
+    TEST_ASSERT(bt_app_snapshot_cb.p_file != NULL);
+
+    bt_app_snapshot_write(&a);
+    TEST_ASSERT((bt_app_snapshot_cb.active == 0) && (bt_app_snapshot_cb.p_file->slot[0].sequence == 0));
+    bt_app_snapshot_write(&a);
+    TEST_ASSERT(bt_app_snapshot_cb.active == 0);
+    bt_app_snapshot_write(&b);
+    TEST_ASSERT((bt_app_snapshot_cb.active == 1) && (bt_app_snapshot_cb.p_file->slot[1].sequence == 1));
+
+    TEST_ASSERT(test_snapshot_restart(&read));
+    TEST_ASSERT(memcmp(&read, &b, sizeof(b)) == 0);
+
+    /* a write torn in slot 1 leaves slot 0 */
+    bt_app_snapshot_cb.p_file->slot[1].data.supported_new_alert_cat ^= 0x100;
+    TEST_ASSERT(test_snapshot_restart(&read));
+    TEST_ASSERT((memcmp(&read, &a, sizeof(a)) == 0) && (bt_app_snapshot_cb.active == 0));
+
+    /* the next write goes over the damaged slot */
+    bt_app_snapshot_write(&c);
+    TEST_ASSERT((bt_app_snapshot_cb.active == 1) && (bt_app_snapshot_cb.p_file->slot[1].sequence == 1));
+    TEST_ASSERT(test_snapshot_restart(&read));
+    TEST_ASSERT(memcmp(&read, &c, sizeof(c)) == 0);
+
+    /* slots of another format are ignored */
+    bt_app_snapshot_cb.p_file->slot[1].magic++;
+    bt_app_snapshot_cb.p_file->slot[0].length--;
+    TEST_ASSERT(!test_snapshot_restart(&read));
+}
+
+/* The sequence number wraps */
+static void test_snapshot_wrap(void)
+{
+    bt_app_snapshot_slot_t *p_slot;
+    bt_app_snapshot_t read;
+    uint32_t sequence[BT_APP_SNAPSHOT_NUM_SLOTS] = {0xFFFFFFFF, 0};
+    uint8_t i;
+
+    TEST_ASSERT(!test_snapshot_restart(&read));
+
+    for (i = 0; i < BT_APP_SNAPSHOT_NUM_SLOTS; i++)
+    {
+        p_slot = &bt_app_snapshot_cb.p_file->slot[i];
+        memset(p_slot, 0, sizeof(*p_slot));
+        p_slot->magic = BT_APP_SNAPSHOT_MAGIC;
+        p_slot->sequence = sequence[i];
+        p_slot->length = sizeof(bt_app_snapshot_t);
+        test_snapshot_fill(&p_slot->data, (uint8_t)(10 + i));
+        p_slot->crc = test_snapshot_crc_ref((const uint8_t *)&p_slot->magic,
+                                            sizeof(*p_slot) - offsetof(bt_app_snapshot_slot_t, magic));
+    }
+
+    TEST_ASSERT(test_snapshot_restart(&read));
+    TEST_ASSERT((bt_app_snapshot_cb.active == 1) && (read.supported_new_alert_cat == 11));
+
+    test_snapshot_fill(&read, 12);
+    bt_app_snapshot_write(&read);
+    TEST_ASSERT((bt_app_snapshot_cb.active == 0) && (bt_app_snapshot_cb.p_file->slot[0].sequence == 1));
+    TEST_ASSERT(test_snapshot_restart(&read));
+    TEST_ASSERT(read.supported_new_alert_cat == 12);
+}
+
+/* A file of another size is resized and starts empty */
+static void test_snapshot_size(void)
+{
+    bt_app_snapshot_t read;
+
+    munmap(bt_app_snapshot_cb.p_file, sizeof(bt_app_snapshot_file_t));
+    bt_app_snapshot_cb.p_file = NULL;
+    TEST_ASSERT(truncate(BT_APP_SNAPSHOT_FILE, 10) == 0);
+
+    TEST_ASSERT(!test_snapshot_restart(&read));
+    TEST_ASSERT(bt_app_snapshot_cb.p_file != NULL);
+    munmap(bt_app_snapshot_cb.p_file, sizeof(bt_app_snapshot_file_t));
+    bt_app_snapshot_cb.p_file = NULL;
+}
+
+int main(void)
+{
+    char dir[] = "/tmp/test_bt_app_snapshot.XXXXXX";
+
+    /* the snapshot file is made in the current directory */
+    TEST_ASSERT(mkdtemp(dir) != NULL);
+    TEST_ASSERT(chdir(dir) == 0);
+
+    test_snapshot_crc();
+    test_snapshot_slots();
+    test_snapshot_wrap();
+    test_snapshot_size();
+
+    unlink(BT_APP_SNAPSHOT_FILE);
+    TEST_ASSERT((chdir("/") == 0) && (rmdir(dir) == 0));
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,222 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+/******************************************************************************
+ * File Name: test_bt_app_timing.c
+ *
+ * Description:
+ * Unit tests of the callback timing page: the layout read by
+ * tools/ans_timing.py, the slots taken per callback and key, and the seqlock
+ * of a slot against a reader that maps the page on its own.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include <pthread.h>
+#include "test_stubs.h"
+
+/* the page reads CLOCK_MONOTONIC, the tests move the clock by hand */
+#define clock_gettime test_stubs_clock_gettime
+#include "app/bt_app_timing.c"
+#undef clock_gettime
+
+/*******************************************************************************
+ *                                   MACROS
+ *******************************************************************************/
+#define TEST_TIMING_RECORDS 200000
+#define TEST_TIMING_DURATION_NS 1500
+
+/*******************************************************************************
+ *                    STRUCTURES AND ENUMERATIONS
+ *******************************************************************************/
+typedef struct
+{
+    const bt_app_timing_slot_t *p_slot; /* Slot in the page mapped by the reader */
+    volatile int done;                  /* Set by the writer when it is through */
+    uint64_t reads;                     /* Consistent reads */
+} test_timing_reader_t;
+
+/*******************************************************************************
+ *                       FUNCTION DEFINITIONS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * Function Name : test_timing_reader
+ * *****************************************************************************
+ * Summary :
+ *    Read a slot the way tools/ans_timing.py does and check every read that
+ *    the sequence number reports consistent
+ *
+ * Parameters:
+ *    p_arg:      test_timing_reader_t
+ *
+ * Return:
+ *    void *:     NULL
+ ******************************************************************************/
+static void *test_timing_reader(void *p_arg)
+{
+    test_timing_reader_t *p_reader = p_arg;
+    const bt_app_timing_slot_t *p_slot = p_reader->p_slot;
+    uint64_t last_count = 0;
+    uint64_t count;
+    uint64_t total;
+    uint64_t max;
+    uint64_t last;
+    uint32_t seq;
+
+    while (!p_reader->done)
+    {
+        seq = __atomic_load_n(&p_slot->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1)
+            continue;
+
+        count = __atomic_load_n(&p_slot->count, __ATOMIC_RELAXED);
+        total = __atomic_load_n(&p_slot->total_ns, __ATOMIC_RELAXED);
+        max = __atomic_load_n(&p_slot->max_ns, __ATOMIC_RELAXED);
+        last = __atomic_load_n(&p_slot->last_ns, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&p_slot->seq, __ATOMIC_RELAXED) != seq)
+            continue;
+
+        TEST_ASSERT(count == seq / 2);
+        TEST_ASSERT(count >= last_count);
+        TEST_ASSERT(total == count * TEST_TIMING_DURATION_NS);
+        TEST_ASSERT((count == 0) || ((max == TEST_TIMING_DURATION_NS) && (last == TEST_TIMING_DURATION_NS)));
+        last_count = count;
+        __atomic_store_n(&p_reader->reads, p_reader->reads + 1, __ATOMIC_RELAXED);
+    }
+    return NULL;
+}
+
+/* Page layout and the slots given out */
+static void test_timing_slots(const char *p_name)
+{
+    const bt_app_timing_header_t *p_header;
+    uint64_t now;
+    uint16_t key;
+
+    /* not mapped yet, nothing is recorded */
+    TEST_ASSERT(bt_app_timing_now() == 0);
+    bt_app_timing_record(BT_APP_TIMING_GATT, 1, 0);
+
+    TEST_ASSERT(bt_app_timing_init(p_name));
+    TEST_ASSERT(bt_app_timing_init(p_name));
+    p_header = bt_app_timing_cb.p_header;
+
+    TEST_ASSERT((sizeof(bt_app_timing_header_t) == 64) && (sizeof(bt_app_timing_slot_t) == 40));
+    TEST_ASSERT(p_header->magic == BT_APP_TIMING_MAGIC);
+    TEST_ASSERT((p_header->header_size == 64) && (p_header->slot_size == 40) && (p_header->max_slots == 100));
+    TEST_ASSERT((p_header->num_slots == 0) && (p_header->pid == (uint32_t)getpid()));
+    TEST_ASSERT(p_header->start_ns == TEST_STUBS_CLOCK_START_NS);
+
+    now = bt_app_timing_now();
+    bt_app_timing_record(BT_APP_TIMING_GATT, BT_APP_TIMING_GATT_OPCODE(0x12), now - 300);
+    bt_app_timing_record(BT_APP_TIMING_GATT, BT_APP_TIMING_GATT_OPCODE(0x12), now - 100);
+    bt_app_timing_record(BT_APP_TIMING_MANAGEMENT, 0x12, now - 50);
+    TEST_ASSERT(p_header->num_slots == 2);
+    TEST_ASSERT((bt_app_timing_cb.p_slot[0].key == 0x112) && (bt_app_timing_cb.p_slot[0].callback == BT_APP_TIMING_GATT));
+    TEST_ASSERT((bt_app_timing_cb.p_slot[0].count == 2) && (bt_app_timing_cb.p_slot[0].total_ns == 400));
+    TEST_ASSERT((bt_app_timing_cb.p_slot[0].max_ns == 300) && (bt_app_timing_cb.p_slot[0].last_ns == 100));
+    TEST_ASSERT((bt_app_timing_cb.p_slot[0].seq == 4) && (bt_app_timing_cb.p_slot[1].seq == 2));
+    TEST_ASSERT(bt_app_timing_cb.p_slot[1].callback == BT_APP_TIMING_MANAGEMENT);
+
+    /* keys and callbacks out of range are ignored */
+    bt_app_timing_record(BT_APP_TIMING_CALLBACKS, 0, now);
+    bt_app_timing_record(BT_APP_TIMING_SCAN, BT_APP_TIMING_KEYS, now);
+    TEST_ASSERT(p_header->num_slots == 2);
+
+    /* a full page keeps counting the keys it has */
+    for (key = 0; key < BT_APP_TIMING_KEYS; key++)
+        bt_app_timing_record(BT_APP_TIMING_SCAN, key, now);
+    TEST_ASSERT(p_header->num_slots == p_header->max_slots);
+    bt_app_timing_record(BT_APP_TIMING_GATT, BT_APP_TIMING_GATT_OPCODE(0x12), now);
+    TEST_ASSERT(bt_app_timing_cb.p_slot[0].count == 3);
+    TEST_ASSERT(bt_app_timing_cb.slot_index[BT_APP_TIMING_SCAN][BT_APP_TIMING_KEYS - 1] == BT_APP_TIMING_SLOT_NONE);
+}
+
+/* A reader never sees a slot half updated */
+static void test_timing_seqlock(const char *p_name)
+{
+    test_timing_reader_t reader;
+    const bt_app_timing_header_t *p_header;
+    pthread_t thread;
+    uint32_t i;
+    int fd;
+
+    /* a run that restarts starts the page over */
+    munmap(bt_app_timing_cb.p_header, BT_APP_TIMING_PAGE_SIZE);
+    memset(&bt_app_timing_cb, 0, sizeof(bt_app_timing_cb));
+    test_stubs_advance_ms(1);
+    TEST_ASSERT(bt_app_timing_init(p_name));
+    TEST_ASSERT(bt_app_timing_cb.p_header->num_slots == 0);
+
+    /* the reader maps the page read only, as a separate process would */
+    TEST_ASSERT((fd = shm_open(p_name, O_RDONLY, 0)) >= 0);
+    p_header = mmap(NULL, BT_APP_TIMING_PAGE_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    TEST_ASSERT(p_header != MAP_FAILED);
+    TEST_ASSERT((p_header->magic == BT_APP_TIMING_MAGIC) && (p_header->start_ns == TEST_STUBS_CLOCK_START_NS + 1000000));
+
+    bt_app_timing_record(BT_APP_TIMING_GATT, 0, bt_app_timing_now() - TEST_TIMING_DURATION_NS);
+    TEST_ASSERT(__atomic_load_n(&p_header->num_slots, __ATOMIC_ACQUIRE) == 1);
+
+    memset(&reader, 0, sizeof(reader));
+    reader.p_slot = (const bt_app_timing_slot_t *)((const uint8_t *)p_header + p_header->header_size);
+    TEST_ASSERT(pthread_create(&thread, NULL, test_timing_reader, &reader) == 0);
+    while (__atomic_load_n(&reader.reads, __ATOMIC_RELAXED) == 0)
+        ;
+
+    for (i = 1; i < TEST_TIMING_RECORDS; i++)
+        bt_app_timing_record(BT_APP_TIMING_GATT, 0, bt_app_timing_now() - TEST_TIMING_DURATION_NS);
+
+    reader.done = 1;
+    TEST_ASSERT(pthread_join(thread, NULL) == 0);
+    TEST_ASSERT((reader.p_slot->count == TEST_TIMING_RECORDS) && (reader.p_slot->seq == 2 * TEST_TIMING_RECORDS));
+    munmap((void *)p_header, BT_APP_TIMING_PAGE_SIZE);
+}
+
+int main(void)
+{
+    char name[32];
+
+    test_stubs_reset();
+    snprintf(name, sizeof(name), "/test_ans_timing_%d", (int)getpid());
+
+    test_timing_slots(name);
+    test_timing_seqlock(name);
+
+    shm_unlink(name);
+    return EXIT_SUCCESS;
+}
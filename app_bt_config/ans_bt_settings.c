@@ -133,7 +133,7 @@
     const wiced_bt_cfg_gatt_t cy_bt_cfg_gatt =
     {
         .max_db_service_modules          = 0,                                                             /* Maximum number of service modules in the DB */
-        .max_eatt_bearers                = 0,                                                             /* Maximum number of allowed gatt bearers */
+        .max_eatt_bearers                = CY_BT_MAX_EATT_BEARERS,                                        /* Maximum number of allowed gatt bearers */
     };
 
     /* Application-managed L2CAP protocol configuration */
@@ -59,15 +59,31 @@
 /* Maximum attribute length */
 #define CY_BT_MAX_ATTR_LEN                                    512
 /* Maximum attribute MTU size */
-#define CY_BT_MTU_SIZE                                        23
+#define CY_BT_MTU_SIZE                                        512
 
 /* RX PDU size */
 #define CY_BT_RX_PDU_SIZE                                     512
 
 /* Maximum connections */
-#define CY_BT_SERVER_MAX_LINKS                                1
+#define CY_BT_SERVER_MAX_LINKS                                4
 #define CY_BT_CLIENT_MAX_LINKS                                0
 
+/* Enhanced ATT bearers per client, their ATT MTU fills one LE data channel PDU */
+#define CY_BT_EATT_BEARERS_PER_LINK                           3
+#define CY_BT_MAX_EATT_BEARERS                                (CY_BT_SERVER_MAX_LINKS * CY_BT_EATT_BEARERS_PER_LINK)
+#define CY_BT_EATT_MTU_SIZE                                   247
+#define CY_BT_EATT_MAX_BUFFERS                                4
+
+/* Data length extension, longest LE data channel payload and its air time on the LE 1M PHY */
+#define CY_BT_LE_MAX_TX_OCTETS                                251
+#define CY_BT_LE_MAX_TX_TIME                                  2120
+
+/* Bonded devices kept, a new bond replaces the least recently used one */
+#define CY_BT_MAX_BONDED_DEVICES                              8
+
+/* Alerts kept one by one while no client is connected, more are folded into per category counts */
+#define CY_BT_OFFLINE_ALERTS_MAX                              16
+
 /* BLE white list size */
 #define CY_BT_WHITE_LIST_SIZE                                 0
 
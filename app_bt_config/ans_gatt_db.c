@@ -45,34 +45,18 @@
 * GATT server definitions
 *************************************************************************************/
 
+#define ANS_GATT_DB_SERVICE(name, uuid) \
+    PRIMARY_SERVICE_UUID16 (HDLS_##name, uuid),
+#define ANS_GATT_DB_CHAR(name, uuid, prop, perm, owner, value, len) \
+    CHARACTERISTIC_UUID16 (HDLC_##name, HDLC_##name##_VALUE, uuid, prop, perm),
+#define ANS_GATT_DB_CHAR_WRITABLE(name, uuid, prop, perm, owner, value, len) \
+    CHARACTERISTIC_UUID16_WRITABLE (HDLC_##name, HDLC_##name##_VALUE, uuid, prop, perm),
+#define ANS_GATT_DB_DESC_WRITABLE(name, uuid, perm, owner, value, len) \
+    CHAR_DESCRIPTOR_UUID16_WRITABLE (HDLD_##name, uuid, perm),
+
 const uint8_t gatt_database[] = 
 {
-    /* Primary Service: Generic Access */
-    PRIMARY_SERVICE_UUID16 (HDLS_GAP, __UUID_SERVICE_GENERIC_ACCESS),
-        /* Characteristic: Device Name */
-        CHARACTERISTIC_UUID16 (HDLC_GAP_DEVICE_NAME, HDLC_GAP_DEVICE_NAME_VALUE, __UUID_CHARACTERISTIC_DEVICE_NAME, GATTDB_CHAR_PROP_READ, GATTDB_PERM_READABLE),
-        /* Characteristic: Appearance */
-        CHARACTERISTIC_UUID16 (HDLC_GAP_APPEARANCE, HDLC_GAP_APPEARANCE_VALUE, __UUID_CHARACTERISTIC_APPEARANCE, GATTDB_CHAR_PROP_READ, GATTDB_PERM_READABLE),
-
-    /* Primary Service: Generic Attribute */
-    PRIMARY_SERVICE_UUID16 (HDLS_GATT, __UUID_SERVICE_GENERIC_ATTRIBUTE),
-
-    /* Primary Service: Alert Notification */
-    PRIMARY_SERVICE_UUID16 (HDLS_ANS, __UUID_SERVICE_ALERT_NOTIFICATION),
-        /* Characteristic: Supported New Alert Category */
-        CHARACTERISTIC_UUID16 (HDLC_ANS_SUPPORTED_NEW_ALERT_CATEGORY, HDLC_ANS_SUPPORTED_NEW_ALERT_CATEGORY_VALUE, __UUID_CHARACTERISTIC_SUPPORTED_NEW_ALERT_CATEGORY, GATTDB_CHAR_PROP_READ, GATTDB_PERM_READABLE),
-        /* Characteristic: New Alert */
-        CHARACTERISTIC_UUID16 (HDLC_ANS_NEW_ALERT, HDLC_ANS_NEW_ALERT_VALUE, __UUID_CHARACTERISTIC_NEW_ALERT, GATTDB_CHAR_PROP_NOTIFY, GATTDB_PERM_NONE),
-            /* Descriptor: Client Characteristic Configuration */
-            CHAR_DESCRIPTOR_UUID16_WRITABLE (HDLD_ANS_NEW_ALERT_CLIENT_CHAR_CONFIG, __UUID_DESCRIPTOR_CLIENT_CHARACTERISTIC_CONFIGURATION, GATTDB_PERM_READABLE | GATTDB_PERM_WRITE_REQ),
-        /* Characteristic: Supported Unread Alert Category */
-        CHARACTERISTIC_UUID16 (HDLC_ANS_SUPPORTED_UNREAD_ALERT_CATEGORY, HDLC_ANS_SUPPORTED_UNREAD_ALERT_CATEGORY_VALUE, __UUID_CHARACTERISTIC_SUPPORTED_UNREAD_ALERT_CATEGORY, GATTDB_CHAR_PROP_READ, GATTDB_PERM_READABLE),
-        /* Characteristic: Unread Alert Status */
-        CHARACTERISTIC_UUID16 (HDLC_ANS_UNREAD_ALERT_STATUS, HDLC_ANS_UNREAD_ALERT_STATUS_VALUE, __UUID_CHARACTERISTIC_UNREAD_ALERT_STATUS, GATTDB_CHAR_PROP_NOTIFY, GATTDB_PERM_NONE),
-            /* Descriptor: Client Characteristic Configuration */
-            CHAR_DESCRIPTOR_UUID16_WRITABLE (HDLD_ANS_UNREAD_ALERT_STATUS_CLIENT_CHAR_CONFIG, __UUID_DESCRIPTOR_CLIENT_CHARACTERISTIC_CONFIGURATION, GATTDB_PERM_READABLE | GATTDB_PERM_WRITE_REQ),
-        /* Characteristic: Alert Notification Control Point */
-        CHARACTERISTIC_UUID16_WRITABLE (HDLC_ANS_ALERT_NOTIFICATION_CONTROL_POINT, HDLC_ANS_ALERT_NOTIFICATION_CONTROL_POINT_VALUE, __UUID_CHARACTERISTIC_ALERT_NOTIFICATION_CONTROL_POINT, GATTDB_CHAR_PROP_WRITE, GATTDB_PERM_WRITE_REQ),
+    ANS_GATT_DB_LAYOUT(ANS_GATT_DB_SERVICE, ANS_GATT_DB_CHAR, ANS_GATT_DB_CHAR_WRITABLE, ANS_GATT_DB_DESC_WRITABLE)
 };
 
 /* Length of the GATT database */
@@ -84,6 +68,11 @@ const uint16_t gatt_database_len = sizeof(gatt_database);
  
 uint8_t app_gap_device_name[]                            = {'A', 'N', 'S', '\0', };
 uint8_t app_gap_appearance[]                             = {0x00, 0x00, };
+uint8_t app_gatt_service_changed[]                       = {0x01, 0x00, 0xFF, 0xFF, };
+uint8_t app_gatt_service_changed_client_char_config[]    = {0x00, 0x00, };
+uint8_t app_gatt_client_supported_features[]             = {0x00, };
+uint8_t app_gatt_database_hash[]                         = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                                            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, };
 uint8_t app_ans_supported_new_alert_category[]           = {0x00, 0x00, };
 uint8_t app_ans_new_alert[]                              = {0x00, 0x00, };
 uint8_t app_ans_new_alert_client_char_config[]           = {0x00, 0x00, };
@@ -96,30 +85,26 @@ uint8_t app_ans_alert_notification_control_point[]       = {0x00, 0x00, };
  * GATT Lookup Table
  ************************************************************************************/
  
-gatt_db_lookup_table_t app_gatt_db_ext_attr_tbl[] =
+#define ANS_GATT_DB_ATTR_NONE(name, uuid)
+#define ANS_GATT_DB_ATTR_CHAR(name, uuid, prop, perm, owner, value, len) \
+    [HDLC_##name##_VALUE] = { HDLC_##name##_VALUE, len, len, app_##value },
+#define ANS_GATT_DB_ATTR_DESC(name, uuid, perm, owner, value, len) \
+    [HDLD_##name] = { HDLD_##name, len, len, app_##value },
+
+/* Indexed by attribute handle, handles without a value in the application are left empty */
+gatt_db_lookup_table_t app_gatt_db_ext_attr_tbl[HDL_COUNT] =
 {
-    /* { attribute handle,                             maxlen, curlen, attribute data } */
-    { HDLC_GAP_DEVICE_NAME_VALUE,                      3,      3,      app_gap_device_name },
-    { HDLC_GAP_APPEARANCE_VALUE,                       2,      2,      app_gap_appearance },
-    { HDLC_ANS_SUPPORTED_NEW_ALERT_CATEGORY_VALUE,     2,      2,      app_ans_supported_new_alert_category },
-    { HDLC_ANS_NEW_ALERT_VALUE,                        2,      2,      app_ans_new_alert },
-    { HDLD_ANS_NEW_ALERT_CLIENT_CHAR_CONFIG,           2,      2,      app_ans_new_alert_client_char_config },
-    { HDLC_ANS_SUPPORTED_UNREAD_ALERT_CATEGORY_VALUE,  2,      2,      app_ans_supported_unread_alert_category },
-    { HDLC_ANS_UNREAD_ALERT_STATUS_VALUE,              2,      2,      app_ans_unread_alert_status },
-    { HDLD_ANS_UNREAD_ALERT_STATUS_CLIENT_CHAR_CONFIG, 2,      2,      app_ans_unread_alert_status_client_char_config },
-    { HDLC_ANS_ALERT_NOTIFICATION_CONTROL_POINT_VALUE, 2,      2,      app_ans_alert_notification_control_point },
+    ANS_GATT_DB_LAYOUT(ANS_GATT_DB_ATTR_NONE, ANS_GATT_DB_ATTR_CHAR, ANS_GATT_DB_ATTR_CHAR, ANS_GATT_DB_ATTR_DESC)
 };
 
 /* Number of Lookup Table entries */
 const uint16_t app_gatt_db_ext_attr_tbl_size = (sizeof(app_gatt_db_ext_attr_tbl) / sizeof(gatt_db_lookup_table_t));
 
 /* Number of GATT initial value arrays entries */
-const uint16_t app_gap_device_name_len = 3;
-const uint16_t app_gap_appearance_len = (sizeof(app_gap_appearance));
-const uint16_t app_ans_supported_new_alert_category_len = (sizeof(app_ans_supported_new_alert_category));
-const uint16_t app_ans_new_alert_len = (sizeof(app_ans_new_alert));
-const uint16_t app_ans_new_alert_client_char_config_len = (sizeof(app_ans_new_alert_client_char_config));
-const uint16_t app_ans_supported_unread_alert_category_len = (sizeof(app_ans_supported_unread_alert_category));
-const uint16_t app_ans_unread_alert_status_len = (sizeof(app_ans_unread_alert_status));
-const uint16_t app_ans_unread_alert_status_client_char_config_len = (sizeof(app_ans_unread_alert_status_client_char_config));
-const uint16_t app_ans_alert_notification_control_point_len = (sizeof(app_ans_alert_notification_control_point));
+#define ANS_GATT_DB_LEN_NONE(name, uuid)
+#define ANS_GATT_DB_LEN_CHAR(name, uuid, prop, perm, owner, value, len) \
+    const uint16_t app_##value##_len = len;
+#define ANS_GATT_DB_LEN_DESC(name, uuid, perm, owner, value, len) \
+    const uint16_t app_##value##_len = len;
+
+ANS_GATT_DB_LAYOUT(ANS_GATT_DB_LEN_NONE, ANS_GATT_DB_LEN_CHAR, ANS_GATT_DB_LEN_CHAR, ANS_GATT_DB_LEN_DESC)
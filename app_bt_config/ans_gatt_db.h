@@ -46,6 +46,9 @@
 #define __UUID_CHARACTERISTIC_DEVICE_NAME                  0x2A00
 #define __UUID_CHARACTERISTIC_APPEARANCE                   0x2A01
 #define __UUID_SERVICE_GENERIC_ATTRIBUTE                   0x1801
+#define __UUID_CHARACTERISTIC_SERVICE_CHANGED              0x2A05
+#define __UUID_CHARACTERISTIC_CLIENT_SUPPORTED_FEATURES    0x2B29
+#define __UUID_CHARACTERISTIC_DATABASE_HASH                0x2B2A
 #define __UUID_SERVICE_ALERT_NOTIFICATION                  0x1811
 #define __UUID_CHARACTERISTIC_SUPPORTED_NEW_ALERT_CATEGORY    0x2A47
 #define __UUID_CHARACTERISTIC_NEW_ALERT                    0x2A46
@@ -54,39 +57,65 @@
 #define __UUID_CHARACTERISTIC_UNREAD_ALERT_STATUS          0x2A45
 #define __UUID_CHARACTERISTIC_ALERT_NOTIFICATION_CONTROL_POINT    0x2A44
 
-/* Service Generic Access */
-#define HDLS_GAP                                           0x0001
-/* Characteristic Device Name */
-#define HDLC_GAP_DEVICE_NAME                               0x0002
-#define HDLC_GAP_DEVICE_NAME_VALUE                         0x0003
-/* Characteristic Appearance */
-#define HDLC_GAP_APPEARANCE                                0x0004
-#define HDLC_GAP_APPEARANCE_VALUE                          0x0005
+/*
+ * GATT database layout, the single description of the attributes. Handles are assigned in order,
+ * starting at 1, and the GATT database, the handle constants, the lookup table and the application
+ * dispatch table are all expanded from it:
+ *
+ *   SERVICE(name, uuid)                                      HDLS_<name>
+ *   CHAR(name, uuid, properties, permissions, owner, value, len)
+ *   CHAR_WRITABLE(name, uuid, properties, permissions, owner, value, len)
+ *                                                            HDLC_<name>, HDLC_<name>_VALUE
+ *   DESC_WRITABLE(name, uuid, permissions, owner, value, len)
+ *                                                            HDLD_<name>
+ *
+ * owner is APP for values kept by the application, GATT for per client GATT service values kept by the
+ * application and LIB for values served by the ANS library.
+ * value names the app_<value>[] initial value array, len is its length.
+ */
+#define ANS_GATT_DB_LAYOUT(SERVICE, CHAR, CHAR_WRITABLE, DESC_WRITABLE) \
+    SERVICE(GAP, __UUID_SERVICE_GENERIC_ACCESS) \
+        CHAR(GAP_DEVICE_NAME, __UUID_CHARACTERISTIC_DEVICE_NAME, \
+             GATTDB_CHAR_PROP_READ, GATTDB_PERM_READABLE, APP, gap_device_name, 3) \
+        CHAR(GAP_APPEARANCE, __UUID_CHARACTERISTIC_APPEARANCE, \
+             GATTDB_CHAR_PROP_READ, GATTDB_PERM_READABLE, APP, gap_appearance, 2) \
+    SERVICE(GATT, __UUID_SERVICE_GENERIC_ATTRIBUTE) \
+        CHAR(GATT_SERVICE_CHANGED, __UUID_CHARACTERISTIC_SERVICE_CHANGED, \
+             GATTDB_CHAR_PROP_INDICATE, GATTDB_PERM_NONE, GATT, gatt_service_changed, 4) \
+            DESC_WRITABLE(GATT_SERVICE_CHANGED_CLIENT_CHAR_CONFIG, __UUID_DESCRIPTOR_CLIENT_CHARACTERISTIC_CONFIGURATION, \
+                          GATTDB_PERM_READABLE | GATTDB_PERM_WRITE_REQ, GATT, gatt_service_changed_client_char_config, 2) \
+        CHAR_WRITABLE(GATT_CLIENT_SUPPORTED_FEATURES, __UUID_CHARACTERISTIC_CLIENT_SUPPORTED_FEATURES, \
+                      GATTDB_CHAR_PROP_READ | GATTDB_CHAR_PROP_WRITE, GATTDB_PERM_READABLE | GATTDB_PERM_WRITE_REQ, \
+                      GATT, gatt_client_supported_features, 1) \
+        CHAR(GATT_DATABASE_HASH, __UUID_CHARACTERISTIC_DATABASE_HASH, \
+             GATTDB_CHAR_PROP_READ, GATTDB_PERM_READABLE, GATT, gatt_database_hash, 16) \
+    SERVICE(ANS, __UUID_SERVICE_ALERT_NOTIFICATION) \
+        CHAR(ANS_SUPPORTED_NEW_ALERT_CATEGORY, __UUID_CHARACTERISTIC_SUPPORTED_NEW_ALERT_CATEGORY, \
+             GATTDB_CHAR_PROP_READ, GATTDB_PERM_READABLE, LIB, ans_supported_new_alert_category, 2) \
+        CHAR(ANS_NEW_ALERT, __UUID_CHARACTERISTIC_NEW_ALERT, \
+             GATTDB_CHAR_PROP_NOTIFY, GATTDB_PERM_NONE, LIB, ans_new_alert, 2) \
+            DESC_WRITABLE(ANS_NEW_ALERT_CLIENT_CHAR_CONFIG, __UUID_DESCRIPTOR_CLIENT_CHARACTERISTIC_CONFIGURATION, \
+                          GATTDB_PERM_READABLE | GATTDB_PERM_WRITE_REQ, LIB, ans_new_alert_client_char_config, 2) \
+        CHAR(ANS_SUPPORTED_UNREAD_ALERT_CATEGORY, __UUID_CHARACTERISTIC_SUPPORTED_UNREAD_ALERT_CATEGORY, \
+             GATTDB_CHAR_PROP_READ, GATTDB_PERM_READABLE, LIB, ans_supported_unread_alert_category, 2) \
+        CHAR(ANS_UNREAD_ALERT_STATUS, __UUID_CHARACTERISTIC_UNREAD_ALERT_STATUS, \
+             GATTDB_CHAR_PROP_NOTIFY, GATTDB_PERM_NONE, LIB, ans_unread_alert_status, 2) \
+            DESC_WRITABLE(ANS_UNREAD_ALERT_STATUS_CLIENT_CHAR_CONFIG, __UUID_DESCRIPTOR_CLIENT_CHARACTERISTIC_CONFIGURATION, \
+                          GATTDB_PERM_READABLE | GATTDB_PERM_WRITE_REQ, LIB, ans_unread_alert_status_client_char_config, 2) \
+        CHAR_WRITABLE(ANS_ALERT_NOTIFICATION_CONTROL_POINT, __UUID_CHARACTERISTIC_ALERT_NOTIFICATION_CONTROL_POINT, \
+                      GATTDB_CHAR_PROP_WRITE, GATTDB_PERM_WRITE_REQ, LIB, ans_alert_notification_control_point, 2)
 
-/* Service Generic Attribute */
-#define HDLS_GATT                                          0x0006
+/* Handle constants */
+#define ANS_GATT_DB_HDL_SERVICE(name, uuid) HDLS_##name,
+#define ANS_GATT_DB_HDL_CHAR(name, uuid, prop, perm, owner, value, len) HDLC_##name, HDLC_##name##_VALUE,
+#define ANS_GATT_DB_HDL_DESC(name, uuid, perm, owner, value, len) HDLD_##name,
 
-/* Service Alert Notification */
-#define HDLS_ANS                                           0x0007
-/* Characteristic Supported New Alert Category */
-#define HDLC_ANS_SUPPORTED_NEW_ALERT_CATEGORY              0x0008
-#define HDLC_ANS_SUPPORTED_NEW_ALERT_CATEGORY_VALUE        0x0009
-/* Characteristic New Alert */
-#define HDLC_ANS_NEW_ALERT                                 0x000A
-#define HDLC_ANS_NEW_ALERT_VALUE                           0x000B
-/* Descriptor Client Characteristic Configuration */
-#define HDLD_ANS_NEW_ALERT_CLIENT_CHAR_CONFIG              0x000C
-/* Characteristic Supported Unread Alert Category */
-#define HDLC_ANS_SUPPORTED_UNREAD_ALERT_CATEGORY           0x000D
-#define HDLC_ANS_SUPPORTED_UNREAD_ALERT_CATEGORY_VALUE     0x000E
-/* Characteristic Unread Alert Status */
-#define HDLC_ANS_UNREAD_ALERT_STATUS                       0x000F
-#define HDLC_ANS_UNREAD_ALERT_STATUS_VALUE                 0x0010
-/* Descriptor Client Characteristic Configuration */
-#define HDLD_ANS_UNREAD_ALERT_STATUS_CLIENT_CHAR_CONFIG    0x0011
-/* Characteristic Alert Notification Control Point */
-#define HDLC_ANS_ALERT_NOTIFICATION_CONTROL_POINT          0x0012
-#define HDLC_ANS_ALERT_NOTIFICATION_CONTROL_POINT_VALUE    0x0013
+enum
+{
+    HDL_NONE = 0,
+    ANS_GATT_DB_LAYOUT(ANS_GATT_DB_HDL_SERVICE, ANS_GATT_DB_HDL_CHAR, ANS_GATT_DB_HDL_CHAR, ANS_GATT_DB_HDL_DESC)
+    HDL_COUNT /* highest handle + 1, size of the handle indexed tables */
+};
 
 /* External Lookup Table Entry */
 typedef struct
@@ -100,25 +129,16 @@ typedef struct
 /* External definitions */
 extern const uint8_t  gatt_database[];
 extern const uint16_t gatt_database_len;
-extern gatt_db_lookup_table_t app_gatt_db_ext_attr_tbl[];
+extern gatt_db_lookup_table_t app_gatt_db_ext_attr_tbl[]; /* indexed by attribute handle */
 extern const uint16_t app_gatt_db_ext_attr_tbl_size;
-extern uint8_t app_gap_device_name[];
-extern const uint16_t app_gap_device_name_len;
-extern uint8_t app_gap_appearance[];
-extern const uint16_t app_gap_appearance_len;
-extern uint8_t app_ans_supported_new_alert_category[];
-extern const uint16_t app_ans_supported_new_alert_category_len;
-extern uint8_t app_ans_new_alert[];
-extern const uint16_t app_ans_new_alert_len;
-extern uint8_t app_ans_new_alert_client_char_config[];
-extern const uint16_t app_ans_new_alert_client_char_config_len;
-extern uint8_t app_ans_supported_unread_alert_category[];
-extern const uint16_t app_ans_supported_unread_alert_category_len;
-extern uint8_t app_ans_unread_alert_status[];
-extern const uint16_t app_ans_unread_alert_status_len;
-extern uint8_t app_ans_unread_alert_status_client_char_config[];
-extern const uint16_t app_ans_unread_alert_status_client_char_config_len;
-extern uint8_t app_ans_alert_notification_control_point[];
-extern const uint16_t app_ans_alert_notification_control_point_len;
+
+#define ANS_GATT_DB_EXTERN_NONE(name, uuid)
+#define ANS_GATT_DB_EXTERN_CHAR(name, uuid, prop, perm, owner, value, len) ANS_GATT_DB_EXTERN(value)
+#define ANS_GATT_DB_EXTERN_DESC(name, uuid, perm, owner, value, len) ANS_GATT_DB_EXTERN(value)
+#define ANS_GATT_DB_EXTERN(value) \
+    extern uint8_t app_##value[]; \
+    extern const uint16_t app_##value##_len;
+
+ANS_GATT_DB_LAYOUT(ANS_GATT_DB_EXTERN_NONE, ANS_GATT_DB_EXTERN_CHAR, ANS_GATT_DB_EXTERN_CHAR, ANS_GATT_DB_EXTERN_DESC)
 
 #endif /* CYCFG_GATT_DB_H */
@@ -68,8 +68,10 @@ void application_start(void);
 uint16_t bt_app_ans_handle_set_supported_new_alert_categories(uint16_t p_data, uint8_t length);
 uint16_t bt_app_ans_handle_set_supported_unread_alert_categories(uint16_t p_data, uint8_t length);
 uint16_t bt_app_ans_handle_generate_alert(uint8_t p_data, uint8_t len);
+uint16_t bt_app_ans_handle_generate_alert_text(uint8_t alert_id, const char *p_text, uint16_t text_len);
 uint16_t bt_app_ans_handle_clear_alert(uint8_t p_data, uint8_t len);
 uint16_t bt_app_ans_start_scan_connect(void);
 uint16_t bt_app_ans_disconnect(void);
+uint16_t bt_app_ans_print_stats(void);
 
 #endif /* _BT_APP_ANS_H_ */
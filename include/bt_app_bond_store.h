@@ -0,0 +1,75 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+/******************************************************************************
+ * File Name: bt_app_bond_store.h
+ *
+ * Description: Header file for bt_app_bond_store.c
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+#ifndef _BT_APP_BOND_STORE_H_
+#define _BT_APP_BOND_STORE_H_
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include <stdint.h>
+#include "wiced_bt_dev.h"
+#include "wiced_bt_gatt.h"
+#include "COMPONENT_ans/wiced_bt_ans.h"
+
+/*******************************************************************************
+ *                    STRUCTURES AND ENUMERATIONS
+ *******************************************************************************/
+typedef struct
+{
+    wiced_bt_db_hash_t db_hash; /* Database Hash the client last knew */
+    uint8_t client_features; /* Client Supported Features written by the client */
+    uint16_t service_changed_cccd; /* Service Changed client configuration */
+} bt_app_bond_gatt_state_t; /* GATT state of a bonded client */
+
+/******************************************************************************
+ *                           FUNCTION PROTOTYPES
+ ******************************************************************************/
+void bt_app_bond_store_init(void);
+wiced_bool_t bt_app_bond_store_get_keys(wiced_bt_device_address_t bd_addr, wiced_bt_device_link_keys_t *p_keys);
+wiced_bool_t bt_app_bond_store_save_keys(wiced_bt_device_link_keys_t *p_keys);
+wiced_bool_t bt_app_bond_store_get_gatt_state(wiced_bt_device_address_t bd_addr, bt_app_bond_gatt_state_t *p_state);
+wiced_bool_t bt_app_bond_store_save_gatt_state(wiced_bt_device_address_t bd_addr,
+                                               const bt_app_bond_gatt_state_t *p_state);
+wiced_bool_t bt_app_bond_store_get_ans_state(wiced_bt_device_address_t bd_addr, wiced_bt_ans_client_state_t *p_state);
+wiced_bool_t bt_app_bond_store_save_ans_state(wiced_bt_device_address_t bd_addr,
+                                              const wiced_bt_ans_client_state_t *p_state);
+
+#endif /* _BT_APP_BOND_STORE_H_ */
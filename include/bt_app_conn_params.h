@@ -0,0 +1,62 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+/******************************************************************************
+ * File Name: bt_app_conn_params.h
+ *
+ * Description: Header file for bt_app_conn_params.c
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+#ifndef _BT_APP_CONN_PARAMS_H_
+#define _BT_APP_CONN_PARAMS_H_
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include <stdint.h>
+#include "wiced_bt_dev.h"
+
+/******************************************************************************
+ *                           FUNCTION PROTOTYPES
+ ******************************************************************************/
+void bt_app_conn_params_init(void);
+void bt_app_conn_params_connection_up(uint16_t conn_id, wiced_bt_device_address_t bd_addr);
+void bt_app_conn_params_connection_down(uint16_t conn_id);
+void bt_app_conn_params_alert(uint8_t category_id);
+void bt_app_conn_params_alert_cleared(uint8_t category_id);
+void bt_app_conn_params_update_evt(wiced_bt_ble_connection_param_update_t *p_update);
+void bt_app_conn_params_subrate_evt(wiced_bt_ble_subrate_change_event_t *p_subrate);
+void bt_app_conn_params_print_stats(uint16_t conn_id);
+
+#endif /* _BT_APP_CONN_PARAMS_H_ */
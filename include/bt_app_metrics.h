@@ -0,0 +1,79 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+/******************************************************************************
+ * File Name: bt_app_metrics.h
+ *
+ * Description: Header file for bt_app_metrics.c
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+#ifndef _BT_APP_METRICS_H_
+#define _BT_APP_METRICS_H_
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include <stdint.h>
+#include "wiced_bt_types.h"
+
+/*******************************************************************************
+ *                                   MACROS
+ *******************************************************************************/
+/* Labels of BT_APP_METRIC_KEY_STORE */
+#define BT_APP_METRICS_KEY_STORE_HIT ( 0U )
+#define BT_APP_METRICS_KEY_STORE_MISS ( 1U )
+
+/*******************************************************************************
+ *                    STRUCTURES AND ENUMERATIONS
+ *******************************************************************************/
+typedef enum
+{
+    BT_APP_METRIC_ALERTS,        /* Counter of alerts generated, labelled by category */
+    BT_APP_METRIC_SEND_FAILURES, /* Counter of alerts the ANS library failed to send, labelled by category */
+    BT_APP_METRIC_NOT_SENT,      /* Gauge of connected clients with a new alert not sent, labelled by category */
+    BT_APP_METRIC_CONNECTIONS,   /* Gauge of connected clients */
+    BT_APP_METRIC_KEY_STORE,     /* Counter of link key requests, labelled BT_APP_METRICS_KEY_STORE_xxx */
+    BT_APP_METRIC_HEAP_USED,     /* Gauge of bytes in use in the default heap */
+    BT_APP_METRIC_HEAP_MAX_USED, /* Gauge of the most bytes ever in use in the default heap */
+    BT_APP_METRIC_COUNT
+} bt_app_metric_t;
+
+/******************************************************************************
+ *                           FUNCTION PROTOTYPES
+ ******************************************************************************/
+wiced_bool_t bt_app_metrics_start(const char *p_path);
+void bt_app_metrics_add(bt_app_metric_t metric, uint8_t label, int64_t value);
+void bt_app_metrics_set(bt_app_metric_t metric, uint8_t label, int64_t value);
+
+#endif /* _BT_APP_METRICS_H_ */
@@ -0,0 +1,76 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+/******************************************************************************
+ * File Name: bt_app_offline_alerts.h
+ *
+ * Description: Header file for bt_app_offline_alerts.c
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+#ifndef _BT_APP_OFFLINE_ALERTS_H_
+#define _BT_APP_OFFLINE_ALERTS_H_
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include <stdint.h>
+#include "wiced_bt_dev.h"
+#include "COMPONENT_ans/wiced_bt_anp.h"
+
+/*******************************************************************************
+ *                    STRUCTURES AND ENUMERATIONS
+ *******************************************************************************/
+typedef struct
+{
+    uint8_t occupancy; /* Alerts buffered one by one */
+    uint8_t capacity; /* CY_BT_OFFLINE_ALERTS_MAX */
+    uint8_t max_occupancy; /* Highest occupancy seen */
+    uint16_t pending[ANP_NOTIFY_CATEGORY_COUNT]; /* Alerts per category waiting for a client, folded ones included */
+    uint32_t buffered; /* Alerts raised while no client was connected */
+    uint32_t folded; /* Alerts folded into a category count because the buffer was full */
+    uint32_t expired; /* Alerts dropped when their category's time to live ran out */
+    uint32_t delivered; /* Alerts handed to a client that connected */
+} bt_app_offline_alerts_stats_t; /* Occupancy of the offline alert buffer */
+
+/******************************************************************************
+ *                           FUNCTION PROTOTYPES
+ ******************************************************************************/
+void bt_app_offline_alerts_init(void);
+wiced_bool_t bt_app_offline_alerts_set_ttl(uint8_t category_id, uint32_t ttl_ms);
+wiced_bool_t bt_app_offline_alerts_add(uint8_t category_id, const char *p_text, uint16_t text_len);
+void bt_app_offline_alerts_clear(uint8_t category_id);
+void bt_app_offline_alerts_deliver(uint16_t conn_id);
+void bt_app_offline_alerts_get_stats(bt_app_offline_alerts_stats_t *p_stats);
+
+#endif /* _BT_APP_OFFLINE_ALERTS_H_ */
@@ -0,0 +1,75 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+/******************************************************************************
+ * File Name: bt_app_snapshot.h
+ *
+ * Description: Header file for bt_app_snapshot.c
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+#ifndef _BT_APP_SNAPSHOT_H_
+#define _BT_APP_SNAPSHOT_H_
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include <stdint.h>
+#include "wiced_bt_dev.h"
+#include "COMPONENT_ans/wiced_bt_ans.h"
+#include "app_bt_config/ans_gap.h"
+
+/*******************************************************************************
+ *                    STRUCTURES AND ENUMERATIONS
+ *******************************************************************************/
+typedef struct
+{
+    wiced_bt_device_address_t bd_addr;
+    wiced_bt_ans_client_state_t state;
+} bt_app_snapshot_client_t; /* ANS state of a connected bonded client */
+
+typedef struct
+{
+    uint16_t supported_new_alert_cat; /* Categories set with the 'Set Supported New Alert Categories' option */
+    uint16_t supported_unread_alert_cat; /* Categories set with the 'Set Supported Unread Alert Categories' option */
+    uint8_t num_clients;
+    bt_app_snapshot_client_t client[CY_BT_SERVER_MAX_LINKS];
+} bt_app_snapshot_t; /* ANS server state that survives a restart of the application */
+
+/******************************************************************************
+ *                           FUNCTION PROTOTYPES
+ ******************************************************************************/
+wiced_bool_t bt_app_snapshot_init(bt_app_snapshot_t *p_snapshot);
+void bt_app_snapshot_write(const bt_app_snapshot_t *p_snapshot);
+
+#endif /* _BT_APP_SNAPSHOT_H_ */
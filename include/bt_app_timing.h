@@ -0,0 +1,74 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+/******************************************************************************
+ * File Name: bt_app_timing.h
+ *
+ * Description: Header file for bt_app_timing.c
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+#ifndef _BT_APP_TIMING_H_
+#define _BT_APP_TIMING_H_
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include <stdint.h>
+#include "wiced_bt_types.h"
+
+/*******************************************************************************
+ *                                   MACROS
+ *******************************************************************************/
+/* Key of a GATT attribute request, other GATT events use the event as key */
+#define BT_APP_TIMING_GATT_OPCODE(opcode) ( 0x100U | (uint8_t)(opcode) )
+
+/*******************************************************************************
+ *                    STRUCTURES AND ENUMERATIONS
+ *******************************************************************************/
+typedef enum
+{
+    BT_APP_TIMING_MANAGEMENT, /* bt_app_ans_management_callback, keyed by wiced_bt_management_evt_t */
+    BT_APP_TIMING_GATT,       /* bt_app_ans_gatts_callback, keyed by event or BT_APP_TIMING_GATT_OPCODE */
+    BT_APP_TIMING_SCAN,       /* bt_app_ans_scan_result_cback, key 0 */
+    BT_APP_TIMING_CALLBACKS
+} bt_app_timing_callback_t;
+
+/******************************************************************************
+ *                           FUNCTION PROTOTYPES
+ ******************************************************************************/
+wiced_bool_t bt_app_timing_init(const char *p_name);
+uint64_t bt_app_timing_now(void);
+void bt_app_timing_record(bt_app_timing_callback_t callback, uint16_t key, uint64_t start_ns);
+
+#endif /* _BT_APP_TIMING_H_ */
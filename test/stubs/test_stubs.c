@@ -0,0 +1,229 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+/******************************************************************************
+ * File Name: test_stubs.c
+ *
+ * Description:
+ * Stack functions used by the modules under unit test: a clock the test
+ * advances by hand, a single timer the test fires, an NVRAM kept in memory
+ * and the address resolution database. The GATT sends are in
+ * test_stubs_gatt.c, linked only with the ANS library.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include <string.h>
+#include "test_stubs.h"
+
+/*******************************************************************************
+ *                           GLOBAL VARIABLES
+ *******************************************************************************/
+test_stubs_t test_stubs;
+
+/*******************************************************************************
+ *                       FUNCTION DEFINITIONS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * Function Name : test_stubs_reset
+ * *****************************************************************************
+ * Summary :
+ *    Forget everything recorded and start the clock over
+ *
+ * Parameters:
+ *    None
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+void test_stubs_reset(void)
+{
+    memset(&test_stubs, 0, sizeof(test_stubs));
+    test_stubs.now_ns = TEST_STUBS_CLOCK_START_NS;
+}
+
+/*******************************************************************************
+ * Function Name : test_stubs_advance_ms
+ * *****************************************************************************
+ * Summary :
+ *    Move the clock forward
+ *
+ * Parameters:
+ *    ms:     time to add in ms
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+void test_stubs_advance_ms(uint32_t ms)
+{
+    test_stubs.now_ns += (uint64_t)ms * 1000000;
+}
+
+/*******************************************************************************
+ * Function Name : test_stubs_clock_gettime
+ * *****************************************************************************
+ * Summary :
+ *    clock_gettime of the module under test, mapped to it by the test. Every
+ *    clock reads the same time.
+ *
+ * Parameters:
+ *    clock_id:   ignored
+ *    p_ts:       current time
+ *
+ * Return:
+ *    int:        0
+ ******************************************************************************/
+int test_stubs_clock_gettime(clockid_t clock_id, struct timespec *p_ts)
+{
+    (void)clock_id;
+    p_ts->tv_sec = (time_t)(test_stubs.now_ns / 1000000000);
+    p_ts->tv_nsec = (long)(test_stubs.now_ns % 1000000000);
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name : test_stubs_timer_fire
+ * *****************************************************************************
+ * Summary :
+ *    Expire the running timer, nothing if it is not running
+ *
+ * Parameters:
+ *    None
+ *
+ * Return:
+ *    None
+ ******************************************************************************/
+void test_stubs_timer_fire(void)
+{
+    if (!test_stubs.timer_running)
+        return;
+
+    test_stubs.timer_running = WICED_FALSE;
+    test_stubs.p_timer->cb(test_stubs.p_timer->cb_params);
+}
+
+void test_stubs_trace(const char *p_fmt, ...)
+{
+    (void)p_fmt;
+}
+
+wiced_result_t wiced_init_timer(wiced_timer_t *p_timer, wiced_timer_callback_t TimerCb,
+                                WICED_TIMER_PARAM_TYPE cBackparam, wiced_timer_type_t type)
+{
+    (void)type;
+    p_timer->cb = TimerCb;
+    p_timer->cb_params = cBackparam;
+    return WICED_SUCCESS;
+}
+
+wiced_result_t wiced_start_timer(wiced_timer_t *p_timer, uint32_t timeout)
+{
+    test_stubs.p_timer = p_timer;
+    test_stubs.timer_running = WICED_TRUE;
+    test_stubs.timer_timeout = timeout;
+    return WICED_SUCCESS;
+}
+
+wiced_result_t wiced_stop_timer(wiced_timer_t *p_timer)
+{
+    if (test_stubs.p_timer == p_timer)
+        test_stubs.timer_running = WICED_FALSE;
+    return WICED_SUCCESS;
+}
+
+wiced_bool_t wiced_is_timer_in_use(wiced_timer_t *p_timer)
+{
+    return ((test_stubs.p_timer == p_timer) && test_stubs.timer_running) ? WICED_TRUE : WICED_FALSE;
+}
+
+uint16_t wiced_hal_write_nvram(uint16_t vs_id, uint16_t data_length, uint8_t *p_data, wiced_result_t *p_status)
+{
+    test_stubs_nvram_t *p_nvram = &test_stubs.nvram[vs_id - WICED_NVRAM_VSID_START];
+
+    TEST_ASSERT((vs_id >= WICED_NVRAM_VSID_START) && (vs_id < WICED_NVRAM_VSID_START + TEST_STUBS_NVRAM_IDS));
+    TEST_ASSERT(data_length <= TEST_STUBS_NVRAM_LEN_MAX);
+
+    *p_status = test_stubs.nvram_status;
+    if (test_stubs.nvram_status != WICED_SUCCESS)
+        return 0;
+
+    test_stubs.nvram_writes++;
+    p_nvram->used = WICED_TRUE;
+    p_nvram->len = data_length;
+    memcpy(p_nvram->data, p_data, data_length);
+    return data_length;
+}
+
+uint16_t wiced_hal_read_nvram(uint16_t vs_id, uint16_t data_length, uint8_t *p_data, wiced_result_t *p_status)
+{
+    test_stubs_nvram_t *p_nvram = &test_stubs.nvram[vs_id - WICED_NVRAM_VSID_START];
+
+    TEST_ASSERT((vs_id >= WICED_NVRAM_VSID_START) && (vs_id < WICED_NVRAM_VSID_START + TEST_STUBS_NVRAM_IDS));
+
+    if (!p_nvram->used)
+    {
+        *p_status = WICED_ERROR;
+        return 0;
+    }
+
+    if (data_length > p_nvram->len)
+        data_length = p_nvram->len;
+    memcpy(p_data, p_nvram->data, data_length);
+    *p_status = WICED_SUCCESS;
+    return data_length;
+}
+
+void wiced_hal_delete_nvram(uint16_t vs_id, wiced_result_t *p_status)
+{
+    TEST_ASSERT((vs_id >= WICED_NVRAM_VSID_START) && (vs_id < WICED_NVRAM_VSID_START + TEST_STUBS_NVRAM_IDS));
+
+    test_stubs.nvram[vs_id - WICED_NVRAM_VSID_START].used = WICED_FALSE;
+    *p_status = WICED_SUCCESS;
+}
+
+wiced_result_t wiced_bt_dev_add_device_to_address_resolution_db(wiced_bt_device_link_keys_t *p_link_keys)
+{
+    (void)p_link_keys;
+    test_stubs.resolution_db_adds++;
+    return WICED_BT_SUCCESS;
+}
+
+wiced_result_t wiced_bt_dev_remove_device_from_address_resolution_db(wiced_bt_device_link_keys_t *p_link_keys)
+{
+    (void)p_link_keys;
+    test_stubs.resolution_db_removes++;
+    return WICED_BT_SUCCESS;
+}
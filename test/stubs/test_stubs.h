@@ -0,0 +1,140 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+/******************************************************************************
+ * File Name: test_stubs.h
+ *
+ * Description: Stack stubs of the unit tests. They record what the module under\n *              test hands to the stack and let the test drive the clock, the\n *              timer and the transmit completions.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+#ifndef _TEST_STUBS_H_
+#define _TEST_STUBS_H_
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "wiced_bt_types.h"
+#include "wiced_bt_dev.h"
+#include "wiced_bt_gatt.h"
+#include "wiced_hal_nvram.h"
+#include "wiced_timer.h"
+
+/*******************************************************************************
+ *                                   MACROS
+ *******************************************************************************/
+/* Stop the test at the first failed check, not compiled out by NDEBUG */
+#define TEST_ASSERT(cond)                                                          \
+    do                                                                             \
+    {                                                                              \
+        if (!(cond))                                                               \
+        {                                                                          \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE);                                                    \
+        }                                                                          \
+    } while (0)
+
+/* Notifications remembered, the oldest are overwritten */
+#define TEST_STUBS_NTF_MAX 64
+#define TEST_STUBS_VALUE_MAX 600
+
+/* NVRAM entries from WICED_NVRAM_VSID_START */
+#define TEST_STUBS_NVRAM_IDS 64
+#define TEST_STUBS_NVRAM_LEN_MAX 512
+
+/* Clock value after test_stubs_reset, the modules take 0 for "not stamped" */
+#define TEST_STUBS_CLOCK_START_NS ( 1000000000ULL )
+
+/*******************************************************************************
+ *                    STRUCTURES AND ENUMERATIONS
+ *******************************************************************************/
+typedef struct
+{
+    uint16_t conn_id;
+    uint16_t handle;                     /* 0 for a multiple notification */
+    uint16_t len;
+    uint8_t *p_data;                     /* Buffer handed to the stack */
+    void *p_app_ctx;                     /* Context handed to the stack */
+    uint8_t value[TEST_STUBS_VALUE_MAX]; /* Copy of the buffer when it was sent */
+} test_stubs_ntf_t; /* Notification handed to the stack */
+
+typedef struct
+{
+    uint8_t used;
+    uint16_t len;
+    uint8_t data[TEST_STUBS_NVRAM_LEN_MAX];
+} test_stubs_nvram_t; /* NVRAM entry */
+
+typedef struct
+{
+    wiced_bt_gatt_status_t ntf_status;  /* Returned by the sends, anything but success rejects them */
+    uint32_t ntf_count;                 /* Notifications accepted */
+    uint32_t ntf_done;                  /* Notifications reported transmitted */
+    uint32_t multi_count;               /* Multiple notifications accepted */
+    test_stubs_ntf_t ntf[TEST_STUBS_NTF_MAX];
+
+    wiced_timer_t *p_timer;             /* Last timer started */
+    wiced_bool_t timer_running;
+    uint32_t timer_timeout;             /* Timeout of the last start */
+
+    uint64_t now_ns;                    /* Returned by test_stubs_clock_gettime */
+
+    wiced_result_t nvram_status;        /* Result of the NVRAM writes */
+    uint32_t nvram_writes;
+    test_stubs_nvram_t nvram[TEST_STUBS_NVRAM_IDS];
+
+    uint32_t resolution_db_adds;
+    uint32_t resolution_db_removes;
+} test_stubs_t;
+
+/*******************************************************************************
+ *                           GLOBAL VARIABLES
+ *******************************************************************************/
+extern test_stubs_t test_stubs;
+
+/*******************************************************************************
+ *                           FUNCTION DECLARATIONS
+ *******************************************************************************/
+void test_stubs_reset(void);
+void test_stubs_advance_ms(uint32_t ms);
+int test_stubs_clock_gettime(clockid_t clock_id, struct timespec *p_ts);
+void test_stubs_timer_fire(void);
+const test_stubs_ntf_t *test_stubs_ntf(uint32_t n);
+const test_stubs_ntf_t *test_stubs_last_ntf(void);
+uint32_t test_stubs_transmit(uint32_t count);
+
+#endif /* _TEST_STUBS_H_ */
@@ -0,0 +1,177 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+/******************************************************************************
+ * File Name: test_stubs_gatt.c
+ *
+ * Description:
+ * GATT notification sends of the ANS library. Every accepted send is
+ * recorded in order, test_stubs_transmit reports them transmitted back to
+ * the library the way GATT_APP_BUFFER_TRANSMITTED_EVT does.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include <string.h>
+#include "test_stubs.h"
+#include "COMPONENT_ans/wiced_bt_ans.h"
+
+/*******************************************************************************
+ *                           FUNCTION DECLARATIONS
+ *******************************************************************************/
+static wiced_bt_gatt_status_t test_stubs_send(uint16_t conn_id, uint16_t handle, uint16_t len, uint8_t *p_val,
+                                              void *p_app_ctx);
+
+/*******************************************************************************
+ *                       FUNCTION DEFINITIONS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * Function Name : test_stubs_send
+ * *****************************************************************************
+ * Summary :
+ *    Record a notification unless test_stubs.ntf_status rejects it
+ *
+ * Parameters:
+ *    conn_id:    bearer the notification is sent on
+ *    handle:     attribute handle, 0 for a multiple notification
+ *    len:        length of the value
+ *    p_val:      value
+ *    p_app_ctx:  context reported back with the transmitted event
+ *
+ * Return:
+ *    wiced_bt_gatt_status_t: test_stubs.ntf_status
+ ******************************************************************************/
+static wiced_bt_gatt_status_t test_stubs_send(uint16_t conn_id, uint16_t handle, uint16_t len, uint8_t *p_val,
+                                              void *p_app_ctx)
+{
+    test_stubs_ntf_t *p_ntf;
+
+    if (test_stubs.ntf_status != WICED_BT_GATT_SUCCESS)
+        return test_stubs.ntf_status;
+
+    /* a notification not reported transmitted yet must not be overwritten */
+    TEST_ASSERT(test_stubs.ntf_count - test_stubs.ntf_done < TEST_STUBS_NTF_MAX);
+    TEST_ASSERT(len <= TEST_STUBS_VALUE_MAX);
+
+    p_ntf = &test_stubs.ntf[test_stubs.ntf_count % TEST_STUBS_NTF_MAX];
+    p_ntf->conn_id = conn_id;
+    p_ntf->handle = handle;
+    p_ntf->len = len;
+    p_ntf->p_data = p_val;
+    p_ntf->p_app_ctx = p_app_ctx;
+    memcpy(p_ntf->value, p_val, len);
+    test_stubs.ntf_count++;
+    return WICED_BT_GATT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name : test_stubs_ntf
+ * *****************************************************************************
+ * Summary :
+ *    Notification accepted n-th, from 0
+ *
+ * Parameters:
+ *    n:          order of the notification, one of the last TEST_STUBS_NTF_MAX
+ *
+ * Return:
+ *    const test_stubs_ntf_t *: the notification
+ ******************************************************************************/
+const test_stubs_ntf_t *test_stubs_ntf(uint32_t n)
+{
+    TEST_ASSERT((n < test_stubs.ntf_count) && (test_stubs.ntf_count - n <= TEST_STUBS_NTF_MAX));
+    return &test_stubs.ntf[n % TEST_STUBS_NTF_MAX];
+}
+
+/*******************************************************************************
+ * Function Name : test_stubs_last_ntf
+ * *****************************************************************************
+ * Summary :
+ *    Notification accepted last
+ *
+ * Parameters:
+ *    None
+ *
+ * Return:
+ *    const test_stubs_ntf_t *: the notification
+ ******************************************************************************/
+const test_stubs_ntf_t *test_stubs_last_ntf(void)
+{
+    return test_stubs_ntf(test_stubs.ntf_count - 1);
+}
+
+/*******************************************************************************
+ * Function Name : test_stubs_transmit
+ * *****************************************************************************
+ * Summary :
+ *    Report the oldest notifications transmitted, in the order they were
+ *    accepted. Notifications the library sends from the transmitted event
+ *    are reported too while count allows.
+ *
+ * Parameters:
+ *    count:      notifications to report at most
+ *
+ * Return:
+ *    uint32_t:   notifications reported
+ ******************************************************************************/
+uint32_t test_stubs_transmit(uint32_t count)
+{
+    test_stubs_ntf_t *p_ntf;
+    uint32_t reported = 0;
+
+    while ((reported < count) && (test_stubs.ntf_done < test_stubs.ntf_count))
+    {
+        p_ntf = &test_stubs.ntf[test_stubs.ntf_done++ % TEST_STUBS_NTF_MAX];
+        wiced_bt_ans_process_buffer_transmitted(p_ntf->p_data, p_ntf->p_app_ctx);
+        reported++;
+    }
+    return reported;
+}
+
+wiced_bt_gatt_status_t wiced_bt_gatt_server_send_notification(uint16_t conn_id, uint16_t attr_handle,
+                                                              uint16_t val_len, uint8_t *p_val, void *p_app_ctx)
+{
+    return test_stubs_send(conn_id, attr_handle, val_len, p_val, p_app_ctx);
+}
+
+wiced_bt_gatt_status_t wiced_bt_gatt_server_send_multiple_notifications(uint16_t conn_id, int16_t app_buffer_len,
+                                                                        uint8_t *p_app_buffer, void *p_app_ctx)
+{
+    wiced_bt_gatt_status_t status = test_stubs_send(conn_id, 0, (uint16_t)app_buffer_len, p_app_buffer, p_app_ctx);
+
+    if (status == WICED_BT_GATT_SUCCESS)
+        test_stubs.multi_count++;
+    return status;
+}
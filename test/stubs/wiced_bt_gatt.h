@@ -0,0 +1,115 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+/******************************************************************************
+ * File Name: wiced_bt_gatt.h
+ *
+ * Description: Subset of the BTSTACK wiced_bt_gatt.h used by the modules under\n *              unit test
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+#ifndef _WICED_BT_GATT_H_
+#define _WICED_BT_GATT_H_
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include "wiced_bt_types.h"
+
+/*******************************************************************************
+ *                    STRUCTURES AND ENUMERATIONS
+ *******************************************************************************/
+enum
+{
+    WICED_BT_GATT_SUCCESS = 0x00,
+    WICED_BT_GATT_INVALID_HANDLE = 0x01,
+    WICED_BT_GATT_READ_NOT_PERMIT = 0x02,
+    WICED_BT_GATT_WRITE_NOT_PERMIT = 0x03,
+    WICED_BT_GATT_INVALID_PDU = 0x04,
+    WICED_BT_GATT_INSUF_AUTHENTICATION = 0x05,
+    WICED_BT_GATT_REQ_NOT_SUPPORTED = 0x06,
+    WICED_BT_GATT_INVALID_OFFSET = 0x07,
+    WICED_BT_GATT_INSUF_AUTHORIZATION = 0x08,
+    WICED_BT_GATT_PREPARE_Q_FULL = 0x09,
+    WICED_BT_GATT_ATTRIBUTE_NOT_FOUND = 0x0A,
+    WICED_BT_GATT_NOT_LONG = 0x0B,
+    WICED_BT_GATT_INSUF_KEY_SIZE = 0x0C,
+    WICED_BT_GATT_INVALID_ATTR_LEN = 0x0D,
+    WICED_BT_GATT_ERR_UNLIKELY = 0x0E,
+    WICED_BT_GATT_INSUF_ENCRYPTION = 0x0F,
+    WICED_BT_GATT_UNSUPPORT_GRP_TYPE = 0x10,
+    WICED_BT_GATT_INSUF_RESOURCE = 0x11,
+    WICED_BT_GATT_DATABASE_OUT_OF_SYNC = 0x12,
+    WICED_BT_GATT_VALUE_NOT_ALLOWED = 0x13,
+    WICED_BT_GATT_ILLEGAL_PARAMETER = 0x8780,
+    WICED_BT_GATT_NO_RESOURCES,
+    WICED_BT_GATT_INTERNAL_ERROR,
+    WICED_BT_GATT_WRONG_STATE,
+    WICED_BT_GATT_DB_FULL,
+    WICED_BT_GATT_BUSY,
+    WICED_BT_GATT_ERROR,
+    WICED_BT_GATT_CMD_STARTED,
+    WICED_BT_GATT_PENDING,
+    WICED_BT_GATT_AUTH_FAIL,
+    WICED_BT_GATT_MORE,
+    WICED_BT_GATT_INVALID_CFG,
+    WICED_BT_GATT_SERVICE_STARTED,
+    WICED_BT_GATT_ENCRYPTED_NO_MITM,
+    WICED_BT_GATT_NOT_ENCRYPTED,
+    WICED_BT_GATT_CONGESTED,
+};
+typedef uint16_t wiced_bt_gatt_status_t;
+
+typedef struct
+{
+    uint16_t handle;
+    uint16_t offset;
+} wiced_bt_gatt_read_t;
+
+typedef struct
+{
+    uint16_t handle;
+    uint16_t offset;
+    uint8_t *p_val;
+    uint16_t val_len;
+} wiced_bt_gatt_write_req_t;
+
+/*******************************************************************************
+ *                           FUNCTION DECLARATIONS
+ *******************************************************************************/
+wiced_bt_gatt_status_t wiced_bt_gatt_server_send_notification(uint16_t conn_id, uint16_t attr_handle,
+                                                              uint16_t val_len, uint8_t *p_val, void *p_app_ctx);
+wiced_bt_gatt_status_t wiced_bt_gatt_server_send_multiple_notifications(uint16_t conn_id, int16_t app_buffer_len,
+                                                                        uint8_t *p_app_buffer, void *p_app_ctx);
+
+#endif /* _WICED_BT_GATT_H_ */
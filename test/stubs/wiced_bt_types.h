@@ -0,0 +1,84 @@
+/******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+/******************************************************************************
+ * File Name: wiced_bt_types.h
+ *
+ * Description: Subset of the BTSTACK wiced_bt_types.h used by the modules under\n *              unit test, see test/CMakeLists.txt
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************/
+
+#ifndef _WICED_BT_TYPES_H_
+#define _WICED_BT_TYPES_H_
+
+/*******************************************************************************
+ *                                   INCLUDES
+ *******************************************************************************/
+#include <stdint.h>
+#include <stddef.h>
+
+/*******************************************************************************
+ *                                   MACROS
+ *******************************************************************************/
+#define WICED_TRUE 1
+#define WICED_FALSE 0
+
+#ifndef TRUE
+#define TRUE 1
+#define FALSE 0
+#endif
+
+#define WICED_SUCCESS 0
+#define WICED_ERROR 0x01
+
+#define WICED_BT_SUCCESS 0
+#define WICED_BT_PENDING 0x01
+#define WICED_BT_BUSY 0x02
+#define WICED_BT_NO_RESOURCES 0x03
+#define WICED_BT_UNSUPPORTED 0x04
+#define WICED_BT_ILLEGAL_VALUE 0x05
+#define WICED_BT_BADARG 0x06
+
+#define BD_ADDR_LEN 6
+
+/*******************************************************************************
+ *                    STRUCTURES AND ENUMERATIONS
+ *******************************************************************************/
+typedef uint8_t wiced_bool_t;
+typedef uint32_t wiced_result_t;
+typedef uint8_t wiced_bt_device_address_t[BD_ADDR_LEN];
+typedef uint8_t wiced_bt_transport_t;
+typedef uint8_t wiced_bt_ble_address_type_t;
+typedef uint8_t wiced_bt_db_hash_t[16];
+
+#endif /* _WICED_BT_TYPES_H_ */
@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+#
+# Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+# an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+#
+# Samples the callback timing page of the Alert Notification Server, see
+# app/bt_app_timing.c for the layout, and prints the calls per second and the
+# average time of every callback over each interval.
+#
+# Usage: ans_timing.py [/dev/shm/ans_timing] [--interval seconds] [--count samples]
+
+import mmap
+import struct
+import sys
+import time
+
+MAGIC = 0x414E5401
+HEADER = struct.Struct("<IHHIIQI")
+SLOT = struct.Struct("<IBxHQQQQ")
+CALLBACKS = {0: "management", 1: "gatt", 2: "scan"}
+GATT_OPCODE = 0x100
+
+# ATT opcodes of the GATT attribute requests
+OPCODES = {
+    0x02: "mtu_req", 0x04: "find_info_req", 0x06: "find_by_type_value_req", 0x08: "read_by_type_req",
+    0x0A: "read_req", 0x0C: "read_blob_req", 0x0E: "read_multi_req", 0x10: "read_by_grp_type_req",
+    0x12: "write_req", 0x16: "prepare_write_req", 0x18: "execute_write_req", 0x1B: "handle_value_ntf",
+    0x1D: "handle_value_ind", 0x1E: "handle_value_conf", 0x20: "read_multi_var_req",
+    0x23: "multi_handle_value_ntf", 0x52: "write_cmd", 0xD2: "signed_write_cmd",
+}
+
+
+def key_name(callback, key):
+    if callback == 1 and key & GATT_OPCODE:
+        opcode = key & 0xFF
+        return OPCODES.get(opcode, "opcode 0x%02x" % opcode)
+    if callback == 2:
+        return "result"
+    return "event %d" % key
+
+
+def read_slot(page, offset):
+    # seqlock: retry while the stack thread is in the middle of an update, give up on a
+    # slot left odd by an application that died while updating it
+    for _ in range(10000):
+        seq = struct.unpack_from("<I", page, offset)[0]
+        if seq & 1:
+            continue
+        slot = SLOT.unpack_from(page, offset)
+        if struct.unpack_from("<I", page, offset)[0] == seq:
+            return slot[1:]
+    return None
+
+
+def sample(page):
+    magic, header_size, slot_size, max_slots, num_slots, start_ns, pid = HEADER.unpack_from(page, 0)
+    if magic != MAGIC:
+        return None, {}
+    slots = {}
+    for i in range(min(num_slots, max_slots)):
+        slot = read_slot(page, header_size + i * slot_size)
+        if slot is not None:
+            slots[slot[:2]] = slot[2:]
+    return (start_ns, pid), slots
+
+
+def main():
+    path = "/dev/shm/ans_timing"
+    interval = 1.0
+    count = 0
+    args = sys.argv[1:]
+    while args:
+        arg = args.pop(0)
+        if arg == "--interval":
+            interval = float(args.pop(0))
+        elif arg == "--count":
+            count = int(args.pop(0))
+        else:
+            path = arg
+
+    with open(path, "rb") as f:
+        page = mmap.mmap(f.fileno(), 0, prot=mmap.PROT_READ)
+
+    run, prev = sample(page)
+    prev_time = time.monotonic()
+    samples = 0
+    while count == 0 or samples < count:
+        time.sleep(interval)
+        now = time.monotonic()
+        cur_run, cur = sample(page)
+        if cur_run is None:
+            print("waiting for the application")
+            continue
+        if cur_run != run:
+            print("application restarted, pid %d" % cur_run[1])
+            run, prev = cur_run, {}
+
+        elapsed = now - prev_time
+        print("%-10s %-24s %10s %10s %10s %10s %10s" %
+              ("callback", "event", "calls", "calls/s", "avg us", "max us", "last us"))
+        for (callback, key), (calls, total_ns, max_ns, last_ns) in sorted(cur.items()):
+            prev_calls, prev_total_ns = prev.get((callback, key), (0, 0, 0, 0))[:2]
+            delta = calls - prev_calls
+            avg = (total_ns - prev_total_ns) / delta / 1000 if delta else 0.0
+            print("%-10s %-24s %10d %10.1f %10.1f %10.1f %10.1f" %
+                  (CALLBACKS.get(callback, callback), key_name(callback, key), calls, delta / elapsed, avg,
+                   max_ns / 1000, last_ns / 1000))
+        print()
+        prev, prev_time = cur, now
+        samples += 1
+
+
+if __name__ == "__main__":
+    main()
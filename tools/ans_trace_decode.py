@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+#
+# Copyright 2016-2022, Cypress Semiconductor Corporation (an Infineon company) or
+# an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+#
+# Decodes a binary trace written by the Alert Notification Server when it runs
+# with ANS_TRACE_FILE set, see COMPONENT_ans/wiced_bt_ans_trace.c for the format.
+#
+# Usage: ans_trace_decode.py ans_trace.bin [--follow]
+
+import re
+import struct
+import sys
+import time
+
+MAGIC = b"ANSTRC1\0"
+MODULES = {0: "LIB", 1: "APP"}
+LEVEL_ERROR = 1
+
+# printf conversions the trace points use, the arguments are 32 bit integers
+CONVERSION = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z)?([diuxXc%])")
+
+
+def format_args(fmt, args):
+    out = []
+    pos = 0
+    arg = 0
+    for m in CONVERSION.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        flags, conv = m.groups()
+        if conv == "%":
+            out.append("%")
+            continue
+        value = args[arg] if arg < len(args) else 0
+        arg += 1
+        if conv in "di":
+            value = struct.unpack("<i", struct.pack("<I", value))[0]
+            conv = "d"
+        elif conv == "u":
+            conv = "d"
+        out.append(("%" + flags + conv) % value)
+    out.append(fmt[pos:])
+    return "".join(out)
+
+
+class Reader:
+    def __init__(self, f, follow):
+        self.f = f
+        self.follow = follow
+
+    def read(self, n):
+        data = self.f.read(n)
+        while self.follow and len(data) < n:
+            time.sleep(0.1)
+            data += self.f.read(n - len(data))
+        if len(data) < n:
+            raise EOFError
+        return data
+
+
+def decode(f, follow):
+    r = Reader(f, follow)
+    if r.read(len(MAGIC)) != MAGIC:
+        sys.exit("not an ANS trace file")
+
+    formats = {}
+    start = None
+    while True:
+        try:
+            rec = r.read(1)
+            if rec == b"F":
+                fid, module, level, line, func_len = struct.unpack("<HBBHH", r.read(8))
+                func = r.read(func_len).decode("utf-8", "replace")
+                (fmt_len,) = struct.unpack("<H", r.read(2))
+                fmt = r.read(fmt_len).decode("utf-8", "replace")
+                formats[fid] = (module, level, line, func, fmt)
+            elif rec == b"E":
+                thread, fid, num_args, time_ns = struct.unpack("<BHBQ", r.read(12))
+                args = struct.unpack("<%dI" % num_args, r.read(4 * num_args))
+                module, level, line, func, fmt = formats[fid]
+                if start is None:
+                    start = time_ns
+                text = format_args(fmt, args).rstrip()
+                print("%12.6f [%d] %s %s%s: %s" % ((time_ns - start) / 1e9, thread,
+                      MODULES.get(module, module), "ERR: " if level == LEVEL_ERROR else "",
+                      func, text))
+            elif rec == b"D":
+                thread, dropped = struct.unpack("<BI", r.read(5))
+                print("             [%d] %d records dropped so far" % (thread, dropped))
+            else:
+                sys.exit("corrupt trace file, record type %r" % rec)
+        except EOFError:
+            break
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit("usage: %s trace_file [--follow]" % sys.argv[0])
+    with open(sys.argv[1], "rb") as f:
+        decode(f, "--follow" in sys.argv[2:])
+
+
+if __name__ == "__main__":
+    main()